@@ -68,6 +68,12 @@ recompute path. Also enables more complicated dependencies beyond trees.
 
 #include <QCoreApplication>
 #include <QCryptographicHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtConcurrentRun>
 
 
 #include "Document.h"
@@ -116,7 +122,7 @@ using namespace zipios;
 typedef boost::adjacency_list <
 boost::vecS,           // class OutEdgeListS  : a Sequence or an AssociativeContainer
 boost::vecS,           // class VertexListS   : a Sequence or a RandomAccessContainer
-boost::directedS,      // class DirectedS     : This is a directed graph
+boost::bidirectionalS, // class DirectedS     : A directed graph that also keeps the in edges
 boost::no_property,    // class VertexProperty:
 boost::no_property,    // class EdgeProperty:
 boost::no_property,    // class GraphProperty:
@@ -149,8 +155,23 @@ struct DocumentP
     unsigned int UndoMaxStackSize;
     DependencyList DepList;
     std::map<DocumentObject*,Vertex> VertexObjectList;
+    // incremental maintenance of the dependency graph
+    bool DepListValid;
+    bool DepOrderValid;
+    std::set<const DocumentObject*> DepListChanged;
+    std::list<Vertex> DepOrder;
+    // state of a parallel recompute
+    QMutex recomputeMutex;
+    QWaitCondition recomputeDone;
+    QThread* recomputeThread;
+    std::vector<std::pair<DocumentObject*, bool> > finishedObjects;
+    std::vector<std::pair<const DocumentObject*, const Property*> > pendingChanges;
+    RecomputeProfiler profiler;
 
     DocumentP() {
+        recomputeThread = 0;
+        DepListValid = false;
+        DepOrderValid = false;
         activeObject = 0;
         activeUndoTransaction = 0;
         activeTransaction = 0;
@@ -823,17 +844,55 @@ void Document::onChanged(const Property* prop)
 
 void Document::onBeforeChangeProperty(const DocumentObject *Who, const Property *What)
 {
+    // during a parallel recompute this may be called from several worker threads
+    QMutexLocker locker(d->recomputeThread ? &d->recomputeMutex : 0);
     if (d->activeUndoTransaction && !d->rollback)
         d->activeUndoTransaction->addObjectChange(Who,What);
 }
 
+static bool isDependencyProperty(const Property *prop)
+{
+    Base::Type type = prop->getTypeId();
+    return type.isDerivedFrom(PropertyLink::getClassTypeId()) ||
+           type.isDerivedFrom(PropertyLinkSub::getClassTypeId()) ||
+           type.isDerivedFrom(PropertyLinkList::getClassTypeId()) ||
+           type.isDerivedFrom(PropertyLinkSubList::getClassTypeId()) ||
+           type.isDerivedFrom(PropertyExpressionEngine::getClassTypeId());
+}
+
 void Document::onChangedProperty(const DocumentObject *Who, const Property *What)
 {
+    if (d->recomputeThread && QThread::currentThread() != d->recomputeThread) {
+        // the observers are not thread-safe, hence the recomputing thread emits
+        // the signal once the worker has finished
+        QMutexLocker locker(&d->recomputeMutex);
+        if (isDependencyProperty(What))
+            d->DepListChanged.insert(Who);
+        if (d->activeTransaction && !d->rollback)
+            d->activeTransaction->addObjectChange(Who,What);
+        d->pendingChanges.push_back(std::make_pair(Who, What));
+        return;
+    }
+
+    // only the out edges of this object must be updated in the dependency graph
+    if (isDependencyProperty(What))
+        d->DepListChanged.insert(Who);
+    // expressions may refer to an object by its label
+    else if (What == &Who->Label)
+        d->DepListValid = false;
+
     if (d->activeTransaction && !d->rollback)
         d->activeTransaction->addObjectChange(Who,What);
     signalChangedObject(*Who, *What);
 }
 
+void Document::onRemoveProperty(const DocumentObject *Who, const Property *What)
+{
+    // the edges of a removed link must leave the dependency graph as well
+    if (isDependencyProperty(What))
+        d->DepListChanged.insert(Who);
+}
+
 void Document::setTransactionMode(int iMode)
 {
     /*  if(_iTransactionMode == 0 && iMode == 1)
@@ -1360,6 +1419,8 @@ bool Document::save (void)
 
             writer.setComment("FreeCAD Document");
             writer.setLevel(compression);
+            writer.setParallel(App::GetApplication().GetParameterGroupByPath
+                ("User parameter:BaseApp/Preferences/Document")->GetBool("ParallelSave",false));
             writer.putNextEntry("Document.xml");
 
             Document::Save(writer);
@@ -1453,6 +1514,7 @@ void Document::restore (void)
     d->objectArray.clear();
     d->objectMap.clear();
     d->activeObject = 0;
+    d->DepListValid = false;
 
     Base::FileInfo fi(FileName.getValue());
     Base::ifstream file(fi, std::ios::in | std::ios::binary);
@@ -1482,6 +1544,15 @@ void Document::restore (void)
     // Note: This file doesn't need to be available if the document has been created
     // without GUI. But if available then follow after all data files of the App document.
     signalRestoreDocument(reader);
+
+    // In lazy mode big files are only read when their data is accessed the first time.
+    // With the GUI up this is pointless because the view providers show all data.
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document");
+    if (hGrp->GetBool("LazyLoading", false) && Application::Config()["RunMode"] != "Gui") {
+        long minSize = hGrp->GetInt("LazyLoadingMinSize", 1024); // in kB
+        reader.setLazyLoading(true, static_cast<unsigned long>(std::max<long>(minSize, 0)) * 1024);
+    }
     reader.readFiles(zipstream);
     
     // reset all touched
@@ -1712,6 +1783,44 @@ void Document::_rebuildDependencyList(void)
                 add_edge(d->VertexObjectList[It->second],d->VertexObjectList[*It2],d->DepList);
         }
     }
+
+    d->DepListValid = true;
+    d->DepOrderValid = false;
+    d->DepListChanged.clear();
+}
+
+/**
+ * @brief Update the dependency graph for objects whose links or expressions
+ * have changed since the last recompute.
+ *
+ * Only the out edges of the changed objects are replaced, i.e. the cost
+ * depends on the number of changed links rather than on the document size.
+ * Adding or removing objects still requires a full _rebuildDependencyList().
+ */
+void Document::_updateDependencyList(void)
+{
+    for (std::set<const DocumentObject*>::const_iterator It = d->DepListChanged.begin(); It != d->DepListChanged.end(); ++It) {
+        DocumentObject* obj = const_cast<DocumentObject*>(*It);
+        std::map<DocumentObject*,Vertex>::iterator i = d->VertexObjectList.find(obj);
+        if (i == d->VertexObjectList.end())
+            i = d->VertexObjectList.insert(std::make_pair(obj, add_vertex(d->DepList))).first;
+        Vertex v = i->second;
+        clear_out_edges(v, d->DepList);
+
+        std::vector<DocumentObject*> OutList = obj->getOutList();
+        for (std::vector<DocumentObject*>::const_iterator It2=OutList.begin();It2!=OutList.end();++It2) {
+            if (*It2) {
+                std::map<DocumentObject*,Vertex>::iterator j = d->VertexObjectList.find(*It2);
+                if (j == d->VertexObjectList.end())
+                    j = d->VertexObjectList.insert(std::make_pair(*It2, add_vertex(d->DepList))).first;
+                add_edge(v,j->second,d->DepList);
+            }
+        }
+
+        d->DepOrderValid = false;
+    }
+
+    d->DepListChanged.clear();
 }
 
 void Document::recompute()
@@ -1722,25 +1831,55 @@ void Document::recompute()
     _RecomputeLog.clear();
 
     // updates the dependency graph
-    _rebuildDependencyList();
+    if (d->DepListValid)
+        _updateDependencyList();
+    else
+        _rebuildDependencyList();
 
-    std::list<Vertex> make_order;
     DependencyList::out_edge_iterator j, jend;
 
-
-    try {
-        // this sort gives the execute
-        boost::topological_sort(d->DepList, std::front_inserter(make_order));
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Document::recompute: " << e.what() << std::endl;
-        return;
+    if (!d->DepOrderValid) {
+        d->DepOrder.clear();
+        try {
+            // this sort gives the execute
+            boost::topological_sort(d->DepList, std::front_inserter(d->DepOrder));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Document::recompute: " << e.what() << std::endl;
+            return;
+        }
+        d->DepOrderValid = true;
     }
 
+    if (d->profiler.isEnabled())
+        d->profiler.start();
+
+    // a feature may alter the graph while it gets recomputed, so work on a copy
+    std::list<Vertex> make_order = d->DepOrder;
+
     // caching vertex to DocObject
     for (std::map<DocumentObject*,Vertex>::const_iterator It1= d->VertexObjectList.begin();It1 != d->VertexObjectList.end(); ++It1)
         d->vertexMap[It1->second] = It1->first;
 
+    // only the touched objects and the objects depending on them can need a
+    // recompute, so collect them by following the in edges
+    std::set<Vertex> downstream;
+    std::vector<Vertex> stack;
+    for (std::map<Vertex,DocumentObject*>::const_iterator It1 = d->vertexMap.begin(); It1 != d->vertexMap.end(); ++It1) {
+        DocumentObject* Cur = It1->second;
+        if (Cur && (Cur->isTouched() || Cur->mustExecute() == 1 || Cur->ExpressionEngine.depsAreTouched()))
+            stack.push_back(It1->first);
+    }
+    DependencyList::in_edge_iterator k, kend;
+    while (!stack.empty()) {
+        Vertex v = stack.back();
+        stack.pop_back();
+        if (!downstream.insert(v).second)
+            continue;
+        for (boost::tie(k, kend) = in_edges(v, d->DepList); k != kend; ++k)
+            stack.push_back(source(*k, d->DepList));
+    }
+
 #ifdef FC_LOGFEATUREUPDATE
     std::clog << "make ordering: " << std::endl;
 #endif
@@ -1748,6 +1887,7 @@ void Document::recompute()
     std::set<DocumentObject*> recomputeList;
 
     for (std::list<Vertex>::reverse_iterator i = make_order.rbegin();i != make_order.rend(); ++i) {
+        if (downstream.find(*i) == downstream.end()) continue;
         DocumentObject* Cur = d->vertexMap[*i];
         if (!Cur) continue;
 #ifdef FC_LOGFEATUREUPDATE
@@ -1799,15 +1939,34 @@ void Document::recompute()
     }
 #endif
 
-    for (std::list<Vertex>::reverse_iterator i = make_order.rbegin();i != make_order.rend(); ++i) {
-        DocumentObject* Cur = d->vertexMap[*i];
+    bool parallel = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document")->GetBool("ParallelRecompute",false);
+    if (parallel && QThreadPool::globalInstance()->maxThreadCount() > 1) {
+        std::vector<DocumentObject*> objs;
+        for (std::list<Vertex>::reverse_iterator i = make_order.rbegin();i != make_order.rend(); ++i) {
+            DocumentObject* Cur = d->vertexMap[*i];
+            if (Cur && (recomputeList.find(Cur) != recomputeList.end() ||
+                    Cur->ExpressionEngine.depsAreTouched()))
+                objs.push_back(Cur);
+        }
 
-        if (recomputeList.find(Cur) != recomputeList.end() ||
-                Cur->ExpressionEngine.depsAreTouched()) {
-            if ( _recomputeFeature(Cur)) {
-                // if somthing happen break execution of recompute
-                d->vertexMap.clear();
-                return;
+        if (_recomputeParallel(objs)) {
+            // if somthing happen break execution of recompute
+            d->vertexMap.clear();
+            return;
+        }
+    }
+    else {
+        for (std::list<Vertex>::reverse_iterator i = make_order.rbegin();i != make_order.rend(); ++i) {
+            DocumentObject* Cur = d->vertexMap[*i];
+
+            if (recomputeList.find(Cur) != recomputeList.end() ||
+                    Cur->ExpressionEngine.depsAreTouched()) {
+                if ( _recomputeFeature(Cur)) {
+                    // if somthing happen break execution of recompute
+                    d->vertexMap.clear();
+                    return;
+                }
             }
         }
     }
@@ -1822,8 +1981,128 @@ void Document::recompute()
     signalRecomputed(*this);
 }
 
+/**
+ * @brief Recompute the given objects, which are sorted in execution order.
+ *
+ * An object is scheduled as soon as all objects it depends on and which are
+ * part of \a objs are up-to-date. Objects with a thread-safe execute() run on
+ * the global thread pool, all other objects (e.g. Python features) are
+ * recomputed one after another by the calling thread while the pool is idle.
+ * Changes made on worker threads are signalled from the calling thread.
+ *
+ * @return true if the recompute has to be aborted, false otherwise.
+ */
+bool Document::_recomputeParallel(const std::vector<DocumentObject*>& objs)
+{
+    // count the prerequisites of each object that get recomputed as well
+    std::set<DocumentObject*> jobs(objs.begin(), objs.end());
+    std::map<DocumentObject*, int> pending;
+    std::map<DocumentObject*, std::vector<DocumentObject*> > dependents;
+    DependencyList::out_edge_iterator j, jend;
+    for (std::vector<DocumentObject*>::const_iterator it = objs.begin(); it != objs.end(); ++it) {
+        pending[*it] = 0;
+        std::map<DocumentObject*,Vertex>::const_iterator v = d->VertexObjectList.find(*it);
+        if (v == d->VertexObjectList.end())
+            continue;
+        for (boost::tie(j, jend) = out_edges(v->second, d->DepList); j != jend; ++j) {
+            DocumentObject* Test = d->vertexMap[target(*j, d->DepList)];
+            if (Test && jobs.find(Test) != jobs.end()) {
+                pending[*it]++;
+                dependents[Test].push_back(*it);
+            }
+        }
+    }
+
+    std::list<DocumentObject*> ready;
+    for (std::vector<DocumentObject*>::const_iterator it = objs.begin(); it != objs.end(); ++it) {
+        if (pending[*it] == 0)
+            ready.push_back(*it);
+    }
+
+    d->recomputeThread = QThread::currentThread();
+    std::size_t running = 0;
+    bool abort = false;
+    while (!ready.empty() || running > 0) {
+        std::vector<std::pair<DocumentObject*, bool> > done;
+        if (abort)
+            ready.clear();
+
+        for (std::list<DocumentObject*>::iterator it = ready.begin(); it != ready.end();) {
+            if ((*it)->isExecuteThreadSafe()) {
+                running++;
+                QtConcurrent::run(this, &Document::_recomputeFeatureThreaded, *it);
+                it = ready.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        if (running == 0 && !ready.empty()) {
+            DocumentObject* Cur = ready.front();
+            ready.pop_front();
+            done.push_back(std::make_pair(Cur, _recomputeFeature(Cur)));
+        }
+
+        std::vector<std::pair<const DocumentObject*, const Property*> > changes;
+        {
+            QMutexLocker locker(&d->recomputeMutex);
+            while (running > 0 && done.empty() && d->finishedObjects.empty())
+                d->recomputeDone.wait(&d->recomputeMutex);
+            running -= d->finishedObjects.size();
+            done.insert(done.end(), d->finishedObjects.begin(), d->finishedObjects.end());
+            d->finishedObjects.clear();
+            changes.swap(d->pendingChanges);
+        }
+
+        for (std::vector<std::pair<const DocumentObject*, const Property*> >::iterator
+            it = changes.begin(); it != changes.end(); ++it)
+            signalChangedObject(*it->first, *it->second);
+
+        for (std::vector<std::pair<DocumentObject*, bool> >::iterator it = done.begin(); it != done.end(); ++it) {
+            if (it->second)
+                abort = true;
+            std::vector<DocumentObject*>& next = dependents[it->first];
+            for (std::vector<DocumentObject*>::iterator jt = next.begin(); jt != next.end(); ++jt) {
+                if (--pending[*jt] == 0)
+                    ready.push_back(*jt);
+            }
+        }
+    }
+    d->recomputeThread = 0;
+
+    return abort;
+}
+
+void Document::_recomputeFeatureThreaded(DocumentObject* Feat)
+{
+    // whatever happens the object must be reported as finished, otherwise
+    // _recomputeParallel() waits forever
+    bool abort = true;
+    try {
+        abort = _recomputeFeature(Feat);
+    }
+    catch (...) {
+        Base::Console().Error("App::Document::_recomputeFeatureThreaded(): Unknown exception in Feature \"%s\" thrown\n",Feat->getNameInDocument());
+        _addRecomputeLog(new DocumentObjectExecReturn("Unknown exeption!",Feat));
+        Feat->setError();
+    }
+
+    QMutexLocker locker(&d->recomputeMutex);
+    d->finishedObjects.push_back(std::make_pair(Feat, abort));
+    d->recomputeDone.wakeAll();
+}
+
+void Document::_addRecomputeLog(DocumentObjectExecReturn* returnCode)
+{
+    QMutexLocker locker(&d->recomputeMutex);
+    _RecomputeLog.push_back(returnCode);
+}
+
 const char * Document::getErrorDescription(const App::DocumentObject*Obj) const
 {
+    // objects may fail concurrently during a parallel recompute
+    QMutexLocker locker(&d->recomputeMutex);
     for (std::vector<App::DocumentObjectExecReturn*>::const_iterator it=_RecomputeLog.begin();it!=_RecomputeLog.end();++it)
         if ((*it)->Which == Obj)
             return (*it)->Why.c_str();
@@ -1836,13 +2115,14 @@ bool Document::_recomputeFeature(DocumentObject* Feat)
 #ifdef FC_LOGFEATUREUPDATE
     std::clog << "Solv: Executing Feature: " << Feat->getNameInDocument() << std::endl;;
 #endif
+    RecomputeMeasure measure(d->profiler, Feat);
 
     DocumentObjectExecReturn  *returnCode = 0;
     try {
         returnCode = Feat->ExpressionEngine.execute();
         if (returnCode != DocumentObject::StdReturn) {
             returnCode->Which = Feat;
-            _RecomputeLog.push_back(returnCode);
+            _addRecomputeLog(returnCode);
     #ifdef FC_DEBUG
             Base::Console().Error("%s\n",returnCode->Why.c_str());
     #endif
@@ -1854,32 +2134,32 @@ bool Document::_recomputeFeature(DocumentObject* Feat)
     }
     catch(Base::AbortException &e){
         e.ReportException();
-        _RecomputeLog.push_back(new DocumentObjectExecReturn("User abort",Feat));
+        _addRecomputeLog(new DocumentObjectExecReturn("User abort",Feat));
         Feat->setError();
         return true;
     }
     catch (const Base::MemoryException& e) {
         Base::Console().Error("Memory exception in feature '%s' thrown: %s\n",Feat->getNameInDocument(),e.what());
-        _RecomputeLog.push_back(new DocumentObjectExecReturn("Out of memory exception",Feat));
+        _addRecomputeLog(new DocumentObjectExecReturn("Out of memory exception",Feat));
         Feat->setError();
         return true;
     }
     catch (Base::Exception &e) {
         e.ReportException();
-        _RecomputeLog.push_back(new DocumentObjectExecReturn(e.what(),Feat));
+        _addRecomputeLog(new DocumentObjectExecReturn(e.what(),Feat));
         Feat->setError();
         return false;
     }
     catch (std::exception &e) {
         Base::Console().Warning("exception in Feature \"%s\" thrown: %s\n",Feat->getNameInDocument(),e.what());
-        _RecomputeLog.push_back(new DocumentObjectExecReturn(e.what(),Feat));
+        _addRecomputeLog(new DocumentObjectExecReturn(e.what(),Feat));
         Feat->setError();
         return false;
     }
 #ifndef FC_DEBUG
     catch (...) {
         Base::Console().Error("App::Document::_RecomputeFeature(): Unknown exception in Feature \"%s\" thrown\n",Feat->getNameInDocument());
-        _RecomputeLog.push_back(new DocumentObjectExecReturn("Unknown exeption!"));
+        _addRecomputeLog(new DocumentObjectExecReturn("Unknown exeption!"));
         Feat->setError();
         return true;
     }
@@ -1891,7 +2171,7 @@ bool Document::_recomputeFeature(DocumentObject* Feat)
     }
     else {
         returnCode->Which = Feat;
-        _RecomputeLog.push_back(returnCode);
+        _addRecomputeLog(returnCode);
 #ifdef FC_DEBUG
         Base::Console().Error("%s\n",returnCode->Why.c_str());
 #endif
@@ -1907,9 +2187,31 @@ void Document::recomputeFeature(DocumentObject* Feat)
         delete *it;
     _RecomputeLog.clear();
 
+    if (d->profiler.isEnabled())
+        d->profiler.start();
     _recomputeFeature(Feat);
 }
 
+void Document::setRecomputeProfiling(bool on)
+{
+    d->profiler.setEnabled(on);
+}
+
+bool Document::isRecomputeProfiling() const
+{
+    return d->profiler.isEnabled();
+}
+
+std::vector<RecomputeStat> Document::getRecomputeStats() const
+{
+    return d->profiler.getStats();
+}
+
+void Document::exportRecomputeTrace(std::ostream& out) const
+{
+    d->profiler.writeTrace(out);
+}
+
 DocumentObject * Document::addObject(const char* sType, const char* pObjectName)
 {
     Base::BaseClass* base = static_cast<Base::BaseClass*>(Base::Type::createInstanceByName(sType,true));
@@ -1948,6 +2250,7 @@ DocumentObject * Document::addObject(const char* sType, const char* pObjectName)
 
     // insert in the name map
     d->objectMap[ObjectName] = pcObject;
+    d->DepListValid = false;
     // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
     pcObject->pcNameInDocument = &(d->objectMap.find(ObjectName)->first);
     // insert in the vector
@@ -1970,6 +2273,7 @@ void Document::_addObject(DocumentObject* pcObject, const char* pObjectName)
 {
     std::string ObjectName = getUniqueObjectName(pObjectName);
     d->objectMap[ObjectName] = pcObject;
+    d->DepListValid = false;
     d->objectArray.push_back(pcObject);
     // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
     pcObject->pcNameInDocument = &(d->objectMap.find(ObjectName)->first);
@@ -2047,6 +2351,7 @@ void Document::remObject(const char* sName)
     //remove_vertex(_DepConMap[pos->second],_DepList);
     //_DepConMap.erase(pos->second);
     d->objectMap.erase(pos);
+    d->DepListValid = false;
 }
 
 /// Remove an object out of the document (internal)
@@ -2073,6 +2378,7 @@ void Document::_remObject(DocumentObject* pcObject)
     }
     // remove from map
     d->objectMap.erase(pos);
+    d->DepListValid = false;
     //// set name cache false
     //pcObject->pcNameInDocument = 0;
 
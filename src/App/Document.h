@@ -30,6 +30,7 @@
 
 #include "PropertyContainer.h"
 #include "PropertyStandard.h"
+#include "RecomputeProfiler.h"
 
 #include <map>
 #include <vector>
@@ -222,6 +223,18 @@ public:
     const char* getErrorDescription(const App::DocumentObject*) const;
     //@}
 
+    /** @name methods for recompute profiling */
+    //@{
+    /// enable or disable the recording of the execution time of each object
+    void setRecomputeProfiling(bool on);
+    /// check whether the recompute profiler is enabled
+    bool isRecomputeProfiling() const;
+    /// get the timing of the objects executed by the last profiled recompute
+    std::vector<RecomputeStat> getRecomputeStats() const;
+    /// write the timeline of the last profiled recompute in the Chrome trace format
+    void exportRecomputeTrace(std::ostream&) const;
+    //@}
+
 
     /** @name methods for the UNDO REDO and Transaction handling */
     //@{
@@ -310,11 +323,21 @@ protected:
     void onBeforeChangeProperty(const DocumentObject *Who, const Property *What);
     /// callback from the Document objects after property was changed
     void onChangedProperty(const DocumentObject *Who, const Property *What);
+    /// callback from the Document objects before a dynamic property is removed
+    void onRemoveProperty(const DocumentObject *Who, const Property *What);
     /// helper which Recompute only this feature
     bool _recomputeFeature(DocumentObject* Feat);
+    /// helper which recomputes a thread-safe feature on a worker thread
+    void _recomputeFeatureThreaded(DocumentObject* Feat);
+    /// helper which recomputes independent features concurrently
+    bool _recomputeParallel(const std::vector<DocumentObject*>& objs);
+    /// appends an entry to the recompute log
+    void _addRecomputeLog(DocumentObjectExecReturn* returnCode);
     void _clearRedos();
     /// refresh the internal dependency graph
     void _rebuildDependencyList(void);
+    /// refresh the dependency graph for objects with changed links only
+    void _updateDependencyList(void);
     std::string getTransientDirectoryName(const std::string& uuid, const std::string& filename) const;
 
 
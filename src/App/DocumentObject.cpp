@@ -100,6 +100,11 @@ short DocumentObject::mustExecute(void) const
     return (isTouched() ? 1 : 0);
 }
 
+bool DocumentObject::isExecuteThreadSafe(void) const
+{
+    return false;
+}
+
 const char* DocumentObject::getStatusString(void) const
 {
     if (isError()) {
@@ -215,6 +220,13 @@ void DocumentObject::onChanged(const Property* prop)
     StatusBits.set(0);
 }
 
+/// get called by the container before a dynamic property is removed
+void DocumentObject::onRemoveProperty(const Property* prop)
+{
+    if (_pDoc)
+        _pDoc->onRemoveProperty(this,prop);
+}
+
 PyObject *DocumentObject::getPyObject(void)
 {
     if (PythonObject.is(Py::_None())) {
@@ -140,6 +140,14 @@ public:
      * -1: the document examine all links of this object and if one is touched -> recompute
      */
     virtual short mustExecute(void) const;
+    /** isExecuteThreadSafe
+     *  We call this method to check if execute() may run on a worker thread
+     *  during a parallel recompute. Only return true if execute() reads nothing
+     *  but the objects linked to, writes nothing but own properties and never
+     *  calls into Python. By default the object is recomputed by the thread that
+     *  called Document::recompute().
+     */
+    virtual bool isExecuteThreadSafe(void) const;
 
     /// get the status Message
     const char *getStatusString(void) const;
@@ -209,6 +217,8 @@ protected:
     virtual void onBeforeChange(const Property* prop);
     /// get called by the container when a property was changed
     virtual void onChanged(const Property* prop);
+    /// get called before a dynamic property is removed
+    virtual void onRemoveProperty(const Property* prop);
     /// get called after a document has been fully restored
     virtual void onDocumentRestored() {}
     /// get called after setting the document
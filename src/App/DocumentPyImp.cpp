@@ -377,6 +377,57 @@ PyObject*  DocumentPy::recompute(PyObject * args)
     Py_Return;
 }
 
+PyObject*  DocumentPy::getRecomputeStats(PyObject * args)
+{
+    if (!PyArg_ParseTuple(args, ""))     // convert args: Python->C 
+        return NULL;                    // NULL triggers exception 
+
+    std::vector<RecomputeStat> stats = getDocumentPtr()->getRecomputeStats();
+    Py::List res;
+    for (std::vector<RecomputeStat>::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+        Py::Dict dict;
+        dict.setItem("Name", Py::String(it->Name));
+        dict.setItem("Label", Py::String(it->Label));
+        dict.setItem("Start", Py::Float(it->Start));
+        dict.setItem("WallTime", Py::Float(it->WallTime));
+        dict.setItem("CpuTime", Py::Float(it->CpuTime));
+        dict.setItem("MemDelta", Py::Int(it->MemDelta));
+        dict.setItem("Failed", Py::Boolean(it->Failed));
+        dict.setItem("Error", Py::String(it->Error));
+        dict.setItem("Thread", Py::Int(it->Thread));
+        res.append(dict);
+    }
+
+    return Py::new_reference_to(res);
+}
+
+PyObject*  DocumentPy::exportRecomputeTrace(PyObject * args)
+{
+    char* fn=0;
+    if (!PyArg_ParseTuple(args, "|s",&fn))     // convert args: Python->C 
+        return NULL;                    // NULL triggers exception 
+    if (fn) {
+        Base::FileInfo fi(fn);
+        Base::ofstream str(fi);
+        if (!str.is_open()) {
+            PyErr_Format(PyExc_IOError, "Cannot open file '%s' for writing", fn);
+            return NULL;
+        }
+        getDocumentPtr()->exportRecomputeTrace(str);
+        str.close();
+        if (str.fail()) {
+            PyErr_Format(PyExc_IOError, "Writing to file '%s' failed", fn);
+            return NULL;
+        }
+        Py_Return;
+    }
+    else {
+        std::stringstream str;
+        getDocumentPtr()->exportRecomputeTrace(str);
+        return PyString_FromString(str.str().c_str());
+    }
+}
+
 PyObject*  DocumentPy::getObject(PyObject *args)
 {
     char *sName;
@@ -489,6 +540,16 @@ void  DocumentPy::setUndoMode(Py::Int arg)
     getDocumentPtr()->setUndoMode(arg); 
 }
 
+Py::Boolean DocumentPy::getRecomputeProfiling(void) const
+{
+    return Py::Boolean(getDocumentPtr()->isRecomputeProfiling());
+}
+
+void  DocumentPy::setRecomputeProfiling(Py::Boolean arg)
+{
+    getDocumentPtr()->setRecomputeProfiling(arg);
+}
+
 Py::Int DocumentPy::getUndoRedoMemSize(void) const
 {
     return Py::Int((long)getDocumentPtr()->getUndoMemSize());
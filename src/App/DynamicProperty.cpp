@@ -249,6 +249,7 @@ bool DynamicProperty::removeDynamicProperty(const char* name)
 {
     std::map<std::string,PropData>::iterator it = props.find(name);
     if (it != props.end()) {
+        pc->onRemoveProperty(it->second.property);
         delete it->second.property;
         props.erase(it);
         return true;
@@ -86,6 +86,10 @@ public:
     virtual DocumentObjectExecReturn *execute(void) {
         return imp->execute();
     }
+    /// Python features are always recomputed serially, even if FeatureT is thread-safe
+    virtual bool isExecuteThreadSafe(void) const {
+        return false;
+    }
     /// returns the type name of the ViewProvider
     virtual const char* getViewProviderName(void) const {
         return FeatureT::getViewProviderName();
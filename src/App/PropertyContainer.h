@@ -155,6 +155,7 @@ public:
 
 
   friend class Property;
+  friend class DynamicProperty;
 
 
 protected: 
@@ -162,6 +163,8 @@ protected:
   virtual void onChanged(const Property* /*prop*/){}
   /// get called before the value is changed
   virtual void onBeforeChange(const Property* /*prop*/){}
+  /// get called before a dynamic property is removed
+  virtual void onRemoveProperty(const Property* /*prop*/){}
 
   //void hasChanged(Propterty* prop);
   static const  PropertyData * getPropertyDataPtr(void); 
@@ -564,6 +564,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
     
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
     
     virtual Property *Copy(void) const;
@@ -902,6 +903,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
     
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
     
     virtual Property *Copy(void) const;
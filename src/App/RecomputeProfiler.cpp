@@ -0,0 +1,204 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <ctime>
+# include <iomanip>
+# include <sstream>
+#endif
+
+#if defined(FC_OS_WIN32)
+# include <windows.h>
+#elif defined(FC_OS_MACOSX)
+# include <sys/time.h>
+#else
+# include <time.h>
+#endif
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include "RecomputeProfiler.h"
+#include "Document.h"
+#include "DocumentObject.h"
+
+using namespace App;
+
+RecomputeProfiler::RecomputeProfiler() : enabled(false), startTime(0.0)
+{
+}
+
+RecomputeProfiler::~RecomputeProfiler()
+{
+}
+
+void RecomputeProfiler::setEnabled(bool on)
+{
+    QMutexLocker locker(&mutex);
+    enabled = on;
+}
+
+bool RecomputeProfiler::isEnabled() const
+{
+    return enabled;
+}
+
+void RecomputeProfiler::start()
+{
+    QMutexLocker locker(&mutex);
+    stats.clear();
+    threads.clear();
+    threads[QThread::currentThread()] = 0;
+    startTime = wallTime();
+}
+
+std::vector<RecomputeStat> RecomputeProfiler::getStats() const
+{
+    QMutexLocker locker(&mutex);
+    return stats;
+}
+
+void RecomputeProfiler::add(RecomputeStat& stat)
+{
+    QMutexLocker locker(&mutex);
+    stat.Start -= startTime;
+    std::map<QThread*, int>::iterator it = threads.find(QThread::currentThread());
+    if (it == threads.end())
+        it = threads.insert(std::make_pair(QThread::currentThread(), (int)threads.size())).first;
+    stat.Thread = it->second;
+    stats.push_back(stat);
+}
+
+static std::string encodeJson(const std::string& str)
+{
+    std::stringstream out;
+    for (std::string::const_iterator it = str.begin(); it != str.end(); ++it) {
+        unsigned char c = static_cast<unsigned char>(*it);
+        if (c == '"' || c == '\\')
+            out << '\\' << *it;
+        else if (c < 0x20)
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec;
+        else
+            out << *it;
+    }
+    return out.str();
+}
+
+void RecomputeProfiler::writeTrace(std::ostream& out) const
+{
+    std::vector<RecomputeStat> list = getStats();
+    out << "{\"traceEvents\":[" << std::endl;
+    out << std::fixed << std::setprecision(3);
+    for (std::vector<RecomputeStat>::const_iterator it = list.begin(); it != list.end(); ++it) {
+        if (it != list.begin())
+            out << "," << std::endl;
+        // time stamps of the trace format are in micro seconds
+        out << "{\"name\":\"" << encodeJson(it->Label) << "\""
+            << ",\"cat\":\"recompute\",\"ph\":\"X\""
+            << ",\"ts\":" << it->Start * 1000.0
+            << ",\"dur\":" << it->WallTime * 1000.0
+            << ",\"pid\":1,\"tid\":" << it->Thread
+            << ",\"args\":{\"object\":\"" << encodeJson(it->Name) << "\""
+            << ",\"cpu_ms\":" << it->CpuTime
+            << ",\"mem_delta\":" << it->MemDelta
+            << ",\"failed\":" << (it->Failed ? "true" : "false");
+        if (it->Failed)
+            out << ",\"error\":\"" << encodeJson(it->Error) << "\"";
+        out << "}}";
+    }
+    out << std::endl << "]}" << std::endl;
+}
+
+double RecomputeProfiler::wallTime()
+{
+#if defined(FC_OS_WIN32)
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return 1000.0 * (double)count.QuadPart / (double)freq.QuadPart;
+#elif defined(FC_OS_MACOSX)
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return 1000.0 * tv.tv_sec + 0.001 * tv.tv_usec;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1000.0 * ts.tv_sec + 1.0e-6 * ts.tv_nsec;
+#endif
+}
+
+double RecomputeProfiler::threadCpuTime()
+{
+#if defined(FC_OS_WIN32)
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        return 0.0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+    // 100 ns units
+    return 1.0e-4 * (double)(k.QuadPart + u.QuadPart);
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return 1000.0 * ts.tv_sec + 1.0e-6 * ts.tv_nsec;
+#else
+    // no per-thread clock available, use the process time instead
+    return 1000.0 * (double)std::clock() / (double)CLOCKS_PER_SEC;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+RecomputeMeasure::RecomputeMeasure(RecomputeProfiler& p, const DocumentObject* obj)
+  : profiler(p), object(obj), active(p.isEnabled()), wall(0.0), cpu(0.0), memory(0)
+{
+    if (active) {
+        memory = object->getMemSize();
+        cpu = RecomputeProfiler::threadCpuTime();
+        wall = RecomputeProfiler::wallTime();
+    }
+}
+
+RecomputeMeasure::~RecomputeMeasure()
+{
+    if (!active)
+        return;
+
+    RecomputeStat stat;
+    stat.Start = wall;
+    stat.WallTime = RecomputeProfiler::wallTime() - wall;
+    stat.CpuTime = RecomputeProfiler::threadCpuTime() - cpu;
+    stat.MemDelta = (long)object->getMemSize() - (long)memory;
+    stat.Name = object->getNameInDocument() ? object->getNameInDocument() : "";
+    stat.Label = object->Label.getValue();
+    stat.Failed = object->isError();
+    if (stat.Failed) {
+        const char* why = object->getDocument()->getErrorDescription(object);
+        stat.Error = why ? why : "Error";
+    }
+    stat.Thread = 0;
+    profiler.add(stat);
+}
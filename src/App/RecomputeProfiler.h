@@ -0,0 +1,120 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef APP_RECOMPUTEPROFILER_H
+#define APP_RECOMPUTEPROFILER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+#include <QMutex>
+
+class QThread;
+
+namespace App
+{
+class DocumentObject;
+
+/** Timing information of a single object recompute
+ */
+struct AppExport RecomputeStat
+{
+    /// internal name of the object
+    std::string Name;
+    /// user name of the object
+    std::string Label;
+    /// start of the execution in ms relative to the start of the profiler
+    double Start;
+    /// elapsed wall clock time in ms
+    double WallTime;
+    /// CPU time in ms of the thread which executed the object
+    double CpuTime;
+    /// change of the memory consumption of the object in bytes
+    long MemDelta;
+    /// true if the execution has failed
+    bool Failed;
+    /// the error message if the execution has failed
+    std::string Error;
+    /// index of the thread which executed the object, 0 is the recomputing thread
+    int Thread;
+};
+
+/** Collects the timing of each DocumentObject executed by Document::recompute()
+ * The statistics are kept until the next profiled recompute starts. The
+ * profiler is thread-safe, i.e. it can be fed from a parallel recompute.
+ */
+class AppExport RecomputeProfiler
+{
+public:
+    RecomputeProfiler();
+    ~RecomputeProfiler();
+
+    void setEnabled(bool);
+    bool isEnabled() const;
+    /// Clears the statistics and restarts the clock.
+    void start();
+    /// Returns the statistics in the order the objects have finished.
+    std::vector<RecomputeStat> getStats() const;
+    /// Writes the statistics as Chrome trace (chrome://tracing) in JSON format.
+    void writeTrace(std::ostream&) const;
+
+    /// Returns a monotonic wall clock time in ms.
+    static double wallTime();
+    /// Returns the CPU time in ms consumed by the calling thread.
+    static double threadCpuTime();
+
+private:
+    friend class RecomputeMeasure;
+    void add(RecomputeStat&);
+
+private:
+    mutable QMutex mutex;
+    bool enabled;
+    double startTime;
+    std::vector<RecomputeStat> stats;
+    std::map<QThread*, int> threads;
+};
+
+/** Measures one object execution for the profiler for the lifetime of the
+ * instance.
+ */
+class AppExport RecomputeMeasure
+{
+public:
+    RecomputeMeasure(RecomputeProfiler&, const DocumentObject*);
+    ~RecomputeMeasure();
+
+private:
+    RecomputeProfiler& profiler;
+    const DocumentObject* object;
+    bool active;
+    double wall;
+    double cpu;
+    unsigned int memory;
+};
+
+} //namespace App
+
+#endif // APP_RECOMPUTEPROFILER_H
@@ -65,6 +65,21 @@ void Persistence::SaveDocFile (Writer &/*writer*/) const
 {
 }
 
+bool Persistence::isSaveDocFileThreadSafe (const Writer &/*writer*/) const
+{
+    return false;
+}
+
 void Persistence::RestoreDocFile(Reader &/*reader*/)
 {
 }
+
+bool Persistence::deferRestoreDocFile(DeferredFile* /*file*/)
+{
+    return false;
+}
+
+void Persistence::restoreDeferredDocFile(Reader &reader)
+{
+    RestoreDocFile(reader);
+}
@@ -36,6 +36,7 @@ namespace Base
 class Reader;
 class Writer;
 class XMLReader;
+class DeferredFile;
 
 /// Persistence class and root of the type system
 class BaseExport Persistence : public BaseClass
@@ -116,6 +117,12 @@ public:
      * In this method you can simply stream your content to the file (Base::Writer inheriting from ostream).
      */
     virtual void SaveDocFile (Writer &/*writer*/) const;
+    /** This method is used to check whether SaveDocFile() may run on a worker thread
+     * while other files of the document are written. Only re-implement it to return
+     * true if SaveDocFile() merely reads this object, doesn't add further files and
+     * neither calls into Python nor the GUI. The default implementation returns false.
+     */
+    virtual bool isSaveDocFileThreadSafe (const Writer &/*writer*/) const;
     /** This method is used to restore large amounts of data from a file
      * In this method you simply stream in your with SaveDocFile() saved data.
      * Again you have to apply for the call of this method in the Restore() call:
@@ -146,6 +153,21 @@ public:
      * @see Base::Reader,Base::XMLReader
      */
     virtual void RestoreDocFile(Reader &/*reader*/);
+    /** This method is used to postpone the restore of a file.
+     * If the XML reader is in lazy loading mode it offers the file to the object
+     * instead of calling RestoreDocFile(). An object that accepts it must keep
+     * a reference to \a file and call DeferredFile::restore() before it accesses
+     * its data for the first time.
+     * The default implementation returns false, i.e. the file is read immediately.
+     * @see Base::DeferredFile
+     */
+    virtual bool deferRestoreDocFile(DeferredFile* /*file*/);
+    /** This method is called by DeferredFile::restore() to read in the data.
+     * Unlike RestoreDocFile() it must not notify any observers because the
+     * object's state logically doesn't change. The default implementation calls
+     * RestoreDocFile().
+     */
+    virtual void restoreDeferredDocFile(Reader &reader);
 };
 
 } //namespace Base
@@ -31,6 +31,9 @@
 #endif
 
 #include <locale>
+#include <memory>
+#include <QMutex>
+#include <QMutexLocker>
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
 #include "Reader.h"
@@ -63,7 +66,7 @@ using namespace std;
 
 Base::XMLReader::XMLReader(const char* FileName, std::istream& str) 
   : DocumentSchema(0), ProgramVersion(""), FileVersion(0), Level(0),
-    _File(FileName), _valid(false), _verbose(true)
+    _File(FileName), _valid(false), _verbose(true), _lazyLoading(false), _lazyMinSize(0)
 {
 #ifdef _MSC_VER
     str.imbue(std::locale::empty());
@@ -319,8 +322,16 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
         // no file name for the current entry in the zip was registered.
         if (jt != FileList.end()) {
             try {
-                Base::Reader reader(zipstream, jt->FileName, DocumentSchema);
-                jt->Object->RestoreDocFile(reader);
+                bool deferred = false;
+                if (_lazyLoading && static_cast<unsigned long>(entry->getSize()) >= _lazyMinSize) {
+                    Base::Reference<DeferredFile> file(new DeferredFile
+                        (_File.filePath(), jt->FileName, DocumentSchema));
+                    deferred = jt->Object->deferRestoreDocFile(file);
+                }
+                if (!deferred) {
+                    Base::Reader reader(zipstream, jt->FileName, DocumentSchema);
+                    jt->Object->RestoreDocFile(reader);
+                }
             }
             catch(...) {
                 // For any exception we just continue with the next file.
@@ -347,6 +358,12 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
     }
 }
 
+void Base::XMLReader::setLazyLoading(bool on, unsigned long minSize)
+{
+    _lazyLoading = on;
+    _lazyMinSize = minSize;
+}
+
 const char *Base::XMLReader::addFile(const char* Name, Base::Persistence *Object)
 {
     FileEntry temp;
@@ -526,3 +543,82 @@ std::istream& Base::Reader::getStream()
     return this->_str;
 }
 
+// ----------------------------------------------------------------------------
+
+// Restoring a file may not be reentrant, e.g. for BRep files a temporary
+// file is used. So, all deferred files are read one after another.
+static QMutex deferredFileMutex(QMutex::Recursive);
+
+Base::DeferredFile::DeferredFile(const std::string& archive, const std::string& name, int version)
+  : _archive(archive), _name(name), _version(version), _restored(false)
+{
+    _modified = Base::FileInfo(archive).lastModified();
+}
+
+Base::DeferredFile::~DeferredFile()
+{
+}
+
+const std::string& Base::DeferredFile::getArchiveName() const
+{
+    return _archive;
+}
+
+const std::string& Base::DeferredFile::getFileName() const
+{
+    return _name;
+}
+
+bool Base::DeferredFile::isRestored() const
+{
+    QMutexLocker locker(&deferredFileMutex);
+    return _restored;
+}
+
+void Base::DeferredFile::restore(Base::Persistence* object)
+{
+    QMutexLocker locker(&deferredFileMutex);
+    if (_restored)
+        return;
+
+    // The data cannot be read any more. Stay unrestored so that any further
+    // access, especially saving the document, fails instead of silently
+    // working with empty data.
+    Base::FileInfo fi(_archive);
+    if (!fi.exists() || fi.lastModified() != _modified) {
+        std::string msg = "Cannot read embedded file '" + _name +
+            "' because the project file has been modified or removed since it was opened";
+        throw Base::FileException(msg.c_str(), fi);
+    }
+
+    // A failed or partial read must not mark the file as restored either
+    std::string error;
+    try {
+        zipios::ZipFile zip(fi.filePath());
+        std::auto_ptr<std::istream> str(zip.getInputStream(_name));
+        if (!str.get())
+            throw Base::FileException("Embedded file not found", _name.c_str());
+#ifdef _MSC_VER
+        str->imbue(std::locale::empty());
+#else
+        str->imbue(std::locale::classic());
+#endif
+        Base::Reader reader(*str, _name, _version);
+        object->restoreDeferredDocFile(reader);
+        _restored = true;
+        return;
+    }
+    catch (const Base::Exception& e) {
+        error = e.what();
+    }
+    catch (const std::exception& e) {
+        error = e.what();
+    }
+    catch (...) {
+        error = "unknown error";
+    }
+
+    std::string msg = "Reading failed from embedded file '" + _name + "': " + error;
+    throw Base::FileException(msg.c_str(), fi);
+}
+
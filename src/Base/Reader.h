@@ -32,6 +32,7 @@
 #include <xercesc/sax2/DefaultHandler.hpp>
 
 #include "FileInfo.h"
+#include "Handle.h"
 #include "Writer.h"
 
 namespace zipios {
@@ -158,6 +159,12 @@ public:
     const char *addFile(const char* Name, Base::Persistence *Object);
     /// process the requested file writes
     void readFiles(zipios::ZipInputStream &zipstream) const;
+    /** In lazy loading mode files of at least \a minSize bytes are not read by
+     * readFiles() but offered to the objects with Persistence::deferRestoreDocFile().
+     * This requires that the reader was created with the file name of the archive.
+     */
+    void setLazyLoading(bool on, unsigned long minSize = 0);
+    bool isLazyLoading() const { return _lazyLoading; }
     /// get all registered file names
     const std::vector<std::string>& getFilenames() const;
     bool isRegistered(Base::Persistence *Object) const;
@@ -245,6 +252,8 @@ protected:
     XERCES_CPP_NAMESPACE_QUALIFIER XMLPScanToken token;
     bool _valid;
     bool _verbose;
+    bool _lazyLoading;
+    unsigned long _lazyMinSize;
 
     struct FileEntry {
         std::string FileName;
@@ -268,6 +277,40 @@ private:
     int fileVersion;
 };
 
+/** The DeferredFile class
+ * This class refers to a file inside a project archive whose restore has been
+ * postponed by the XMLReader in lazy loading mode. When restore() is called the
+ * first time the archive is opened again and the file is passed to
+ * Persistence::restoreDeferredDocFile().
+ * If the archive has been modified in the meantime or the file cannot be read
+ * restore() throws a FileException and the file stays unrestored.
+ * \see Base::Persistence
+ */
+class BaseExport DeferredFile : public Handled
+{
+public:
+    DeferredFile(const std::string& archive, const std::string& name, int version);
+    ~DeferredFile();
+
+    const std::string& getArchiveName() const;
+    const std::string& getFileName() const;
+    /// check whether restore() has already been called
+    bool isRestored() const;
+    /** Reads in the file into \a object if this hasn't been done yet.
+     * This method can be called from any thread. It throws a FileException
+     * if the archive has been modified since the document was opened or if
+     * reading the file fails.
+     */
+    void restore(Base::Persistence* object);
+
+private:
+    std::string _archive;
+    std::string _name;
+    int _version;
+    TimeInfo _modified;
+    bool _restored;
+};
+
 }
 
 
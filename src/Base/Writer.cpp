@@ -36,7 +36,13 @@
 #include "Tools.h"
 
 #include <algorithm>
+#include <climits>
+#include <deque>
 #include <locale>
+#include <zlib.h>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 
 using namespace Base;
 using namespace std;
@@ -240,7 +246,7 @@ void Writer::decInd(void)
 // ----------------------------------------------------------------------------
 
 ZipWriter::ZipWriter(const char* FileName) 
-  : ZipStream(FileName)
+  : ZipStream(FileName), Level(Z_DEFAULT_COMPRESSION), Parallel(false)
 {
 #ifdef _MSC_VER
     ZipStream.imbue(std::locale::empty());
@@ -253,7 +259,7 @@ ZipWriter::ZipWriter(const char* FileName)
 }
 
 ZipWriter::ZipWriter(std::ostream& os) 
-  : ZipStream(os)
+  : ZipStream(os), Level(Z_DEFAULT_COMPRESSION), Parallel(false)
 {
 #ifdef _MSC_VER
     ZipStream.imbue(std::locale::empty());
@@ -267,6 +273,13 @@ ZipWriter::ZipWriter(std::ostream& os)
 
 void ZipWriter::writeFiles(void)
 {
+#if defined(ZIPIOS_HAVE_PUT_RAW_ENTRY)
+    if (Parallel && QThreadPool::globalInstance()->maxThreadCount() > 1) {
+        writeFilesParallel();
+        return;
+    }
+#endif
+
     // use a while loop because it is possible that while
     // processing the files new ones can be added
     size_t index = 0;
@@ -278,6 +291,213 @@ void ZipWriter::writeFiles(void)
     }
 }
 
+struct ZipEntryData {
+    ZipEntryData() : Size(0), Crc(0), Stored(false), TooLarge(false) {}
+    std::string Data;
+    uLong Size;
+    uLong Crc;
+    bool Stored;
+    bool TooLarge;
+    std::vector<std::string> Errors;
+    std::string Exception;
+};
+
+// entries of objects whose estimated size exceeds this limit are written by the serial path
+static const size_t ParallelEntryLimit = 256 * 1024 * 1024;
+// limit of the estimated size of all entries that are produced at the same time
+static const size_t ParallelWindowLimit = 1024 * 1024 * 1024;
+// zip archives without the zip64 extension can't hold larger entries
+static const size_t ZipEntryLimit = 0xffffffff;
+
+/* Computes the checksum of a buffer that may exceed the range of uInt. */
+static uLong crc32Buffer(const std::string& raw)
+{
+    uLong crc = crc32(0L, Z_NULL, 0);
+    const char* data = raw.data();
+    size_t left = raw.size();
+    while (left > 0) {
+        uInt chunk = static_cast<uInt>(std::min<size_t>(left, UINT_MAX));
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(data), chunk);
+        data += chunk;
+        left -= chunk;
+    }
+    return crc;
+}
+
+/* Compresses a buffer that may exceed the range of uInt to a raw deflate stream. */
+static void deflateBuffer(const std::string& raw, int level, std::string& out)
+{
+    z_stream zs;
+    zs.zalloc = Z_NULL;
+    zs.zfree = Z_NULL;
+    zs.opaque = Z_NULL;
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        throw Base::Exception("Failed to initialize the compressor");
+
+    const size_t outChunk = 1024 * 1024;
+    const char* data = raw.data();
+    size_t left = raw.size();
+    int ret = Z_OK;
+    out.clear();
+    do {
+        uInt chunk = static_cast<uInt>(std::min<size_t>(left, UINT_MAX));
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        zs.avail_in = chunk;
+        data += chunk;
+        left -= chunk;
+        int flush = left > 0 ? Z_NO_FLUSH : Z_FINISH;
+        do {
+            size_t pos = out.size();
+            out.resize(pos + outChunk);
+            zs.next_out = reinterpret_cast<Bytef*>(&out[pos]);
+            zs.avail_out = static_cast<uInt>(outChunk);
+            ret = deflate(&zs, flush);
+            out.resize(pos + outChunk - zs.avail_out);
+        } while (ret == Z_OK && (zs.avail_in > 0 || flush == Z_FINISH));
+    } while (left > 0 && ret == Z_OK);
+    deflateEnd(&zs);
+    if (ret != Z_STREAM_END)
+        throw Base::Exception("Failed to compress file");
+}
+
+/* Serializes and compresses the file of one object in a worker thread. */
+static ZipEntryData saveDocFileEntry(const Base::Persistence* object,
+                                     const std::set<std::string>& modes,
+                                     int version, std::string objectName, int level)
+{
+    ZipEntryData result;
+    try {
+        StringWriter writer;
+        writer.setModes(modes);
+        writer.setFileVersion(version);
+        writer.ObjectName = objectName;
+#ifdef _MSC_VER
+        writer.Stream().imbue(std::locale::empty());
+#else
+        writer.Stream().imbue(std::locale::classic());
+#endif
+        writer.Stream().precision(12);
+        writer.Stream().setf(ios::fixed,ios::floatfield);
+        object->SaveDocFile(writer);
+        if (!writer.getFilenames().empty())
+            throw Base::Exception("Cannot add files while writing a file in parallel");
+
+        std::string raw = writer.getString();
+        if (raw.size() > ZipEntryLimit) {
+            // the entry is written again by the serial path
+            result.TooLarge = true;
+            return result;
+        }
+
+        result.Errors = writer.getErrors();
+        result.Size = static_cast<uLong>(raw.size());
+        result.Crc = crc32Buffer(raw);
+
+        if (level == 0) {
+            result.Stored = true;
+            result.Data.swap(raw);
+            return result;
+        }
+
+        deflateBuffer(raw, level, result.Data);
+    }
+    catch (const Base::Exception& e) {
+        result.Exception = e.what();
+    }
+    catch (const std::exception& e) {
+        result.Exception = e.what();
+    }
+    catch (...) {
+        result.Exception = "Unknown exception";
+    }
+
+    return result;
+}
+
+struct ZipPendingEntry {
+    std::string FileName;
+    const Base::Persistence* Object;
+    size_t Estimate;
+    QFuture<ZipEntryData> Future;
+};
+
+void ZipWriter::writeFilesParallel(void)
+{
+#if defined(ZIPIOS_HAVE_PUT_RAW_ENTRY)
+    // Files of thread-safe objects are produced by the thread pool while the
+    // results are written strictly in the order of FileList because the reader
+    // expects them in this order. The number of pending entries and their
+    // estimated size are limited to keep the memory usage bounded, large
+    // objects are written by the serial path.
+    std::deque<ZipPendingEntry> pending;
+    const size_t window = static_cast<size_t>(QThreadPool::globalInstance()->maxThreadCount()) * 2;
+    size_t pendingBytes = 0;
+    std::string failure;
+
+    size_t index = 0;
+    for (;;) {
+        // submit as many thread-safe entries as the window allows
+        while (failure.empty() && index < FileList.size() && pending.size() < window) {
+            FileEntry entry = FileList[index];
+            if (!entry.Object->isSaveDocFileThreadSafe(*this))
+                break;
+            size_t estimate = static_cast<size_t>(entry.Object->getMemSize());
+            if (estimate > ParallelEntryLimit)
+                break;
+            if (!pending.empty() && pendingBytes + estimate > ParallelWindowLimit)
+                break;
+            ZipPendingEntry p;
+            p.FileName = entry.FileName;
+            p.Object = entry.Object;
+            p.Estimate = estimate;
+            p.Future = QtConcurrent::run(saveDocFileEntry, entry.Object, Modes,
+                                         fileVersion, ObjectName, Level);
+            pending.push_back(p);
+            pendingBytes += estimate;
+            index++;
+        }
+
+        if (!pending.empty()) {
+            ZipPendingEntry front = pending.front();
+            pending.pop_front();
+            pendingBytes -= front.Estimate;
+            ZipEntryData data = front.Future.result();
+            if (!data.Exception.empty()) {
+                if (failure.empty())
+                    failure = data.Exception;
+                continue;
+            }
+            if (!failure.empty())
+                continue;
+            if (data.TooLarge) {
+                ZipStream.putNextEntry(front.FileName);
+                front.Object->SaveDocFile(*this);
+                continue;
+            }
+            Errors.insert(Errors.end(), data.Errors.begin(), data.Errors.end());
+            ZipStream.putRawEntry(zipios::ZipCDirEntry(front.FileName),
+                data.Stored ? zipios::STORED : zipios::DEFLATED,
+                data.Data.c_str(), static_cast<uint32>(data.Data.size()),
+                static_cast<uint32>(data.Size), static_cast<uint32>(data.Crc));
+        }
+        else if (failure.empty() && index < FileList.size()) {
+            // objects that are not thread-safe are written directly into the
+            // stream, they may also add further files to the list
+            FileEntry entry = FileList[index];
+            ZipStream.putNextEntry(entry.FileName);
+            entry.Object->SaveDocFile(*this);
+            index++;
+        }
+        else {
+            break;
+        }
+    }
+
+    if (!failure.empty())
+        throw Base::Exception(failure);
+#endif
+}
+
 ZipWriter::~ZipWriter()
 {
     ZipStream.close();
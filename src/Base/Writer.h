@@ -155,11 +155,22 @@ public:
     virtual std::ostream &Stream(void){return ZipStream;}
 
     void setComment(const char* str){ZipStream.setComment(str);}
-    void setLevel(int level){ZipStream.setLevel( level );}
+    void setLevel(int level){ZipStream.setLevel( level ); Level = level;}
     void putNextEntry(const char* str){ZipStream.putNextEntry(str);}
+    /** If enabled the additional files of objects that report
+     * Persistence::isSaveDocFileThreadSafe() are serialized and compressed
+     * in parallel. The entries are still written in the order they were added.
+     * Objects with a large estimated size are written by the serial path.
+     */
+    void setParallel(bool on){Parallel = on;}
+
+private:
+    void writeFilesParallel(void);
 
 private:
     zipios::ZipOutputStream ZipStream;
+    int Level;
+    bool Parallel;
 };
 
 /** The StringWriter class 
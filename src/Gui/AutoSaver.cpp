@@ -186,6 +186,7 @@ void AutoSaver::saveDocument(const std::string& name, AutoSaveProperty& saver)
 
                     writer.setComment("AutoRecovery file");
                     writer.setLevel(1); // apparently the fastest compression
+                    writer.setParallel(hGrp->GetBool("ParallelSave",false));
                     writer.putNextEntry("Document.xml");
 
                     doc->Save(writer);
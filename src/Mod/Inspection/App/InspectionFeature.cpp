@@ -23,13 +23,29 @@
 
 #include "PreCompiled.h"
 #include <gp_Pnt.hxx>
-#include <BRepExtrema_DistShapeShape.hxx>
-#include <BRepBuilderAPI_MakeVertex.hxx>
+#include <gp_Pnt2d.hxx>
+#include <gp_Trsf.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepClass_FaceClassifier.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepTools.hxx>
+#include <GeomAPI_ProjectPointOnCurve.hxx>
+#include <GeomAPI_ProjectPointOnSurf.hxx>
+#include <Geom_Curve.hxx>
+#include <Geom_Surface.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Standard.hxx>
+#include <Standard_Version.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Face.hxx>
 #include <TopoDS_Vertex.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
 
-#include <QEventLoop>
-#include <QFuture>
-#include <QFutureWatcher>
+#include <QMutex>
 #include <QtConcurrentMap>
 
 #include <boost/signals.hpp>
@@ -37,7 +53,6 @@
 
 #include <Base/Console.h>
 #include <Base/Exception.h>
-#include <Base/FutureWatcherProgress.h>
 #include <Base/Parameter.h>
 #include <Base/Sequencer.h>
 #include <Base/Tools.h>
@@ -46,10 +61,11 @@
 #include <Mod/Mesh/App/MeshFeature.h>
 #include <Mod/Mesh/App/Core/Algorithm.h>
 #include <Mod/Mesh/App/Core/Grid.h>
+#include <Mod/Mesh/App/Core/Tree.h>
 #include <Mod/Mesh/App/Core/Iterator.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Points/App/PointsFeature.h>
-#include <Mod/Points/App/PointsGrid.h>
+#include <Mod/Points/App/PointsKdTree.h>
 #include <Mod/Part/App/PartFeature.h>
 
 #include "InspectionFeature.h"
@@ -176,38 +192,40 @@ namespace Inspection {
             assert((rulX < _ulCtGridsX) && (rulY < _ulCtGridsY) && (rulZ < _ulCtGridsZ));
         }
 
-        void AddFacet (const MeshCore::MeshGeomFacet &rclFacet, unsigned long ulFacetIndex)
+        void GetElementGrids (unsigned long ulElement, std::vector<unsigned long> &raulGrids) const
         {
+            MeshCore::MeshGeomFacet clFacet = _pclMesh->GetFacet(ulElement);
+            clFacet._aclPoints[0] = _transform * clFacet._aclPoints[0];
+            clFacet._aclPoints[1] = _transform * clFacet._aclPoints[1];
+            clFacet._aclPoints[2] = _transform * clFacet._aclPoints[2];
+
             unsigned long ulX, ulY, ulZ;
             unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
 
             Base::BoundBox3f clBB;
-            clBB &= rclFacet._aclPoints[0];
-            clBB &= rclFacet._aclPoints[1];
-            clBB &= rclFacet._aclPoints[2];
+            clBB &= clFacet._aclPoints[0];
+            clBB &= clFacet._aclPoints[1];
+            clBB &= clFacet._aclPoints[2];
 
             Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
             Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
-  
 
             if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2)) {
                 for (ulX = ulX1; ulX <= ulX2; ulX++) {
                     for (ulY = ulY1; ulY <= ulY2; ulY++) {
                         for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++) {
-                            if (rclFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
-                                _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+                            if (clFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
+                                raulGrids.push_back(GridIndex(ulX, ulY, ulZ));
                         }
                     }
                 }
             }
             else
-                _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
+                raulGrids.push_back(GridIndex(ulX1, ulY1, ulZ1));
         }
 
         void InitGrid (void)
         {
-            unsigned long i, j;
-
             Base::BoundBox3f clBBMesh = _pclMesh->GetBoundBox().Transformed(_transform);
 
             float fLengthX = clBBMesh.LengthX(); 
@@ -223,26 +241,14 @@ namespace Inspection {
             _fGridLenZ = (1.0f + fLengthZ) / float(_ulCtGridsZ);
             _fMinZ = clBBMesh.MinZ - 0.5f;
 
-            _aulGrid.clear();
-            _aulGrid.resize(_ulCtGridsX);
-            for (i = 0; i < _ulCtGridsX; i++) {
-                _aulGrid[i].resize(_ulCtGridsY);
-                for (j = 0; j < _ulCtGridsY; j++)
-                    _aulGrid[i][j].resize(_ulCtGridsZ);
-            }
+            AllocateGrid();
         }
 
         void RebuildGrid (void)
         {
             _ulCtElements = _pclMesh->CountFacets();
             InitGrid();
- 
-            unsigned long i = 0;
-            MeshCore::MeshFacetIterator clFIter(*_pclMesh);
-            clFIter.Transform(_transform);
-            for (clFIter.Init(); clFIter.More(); clFIter.Next()) {
-                AddFacet(*clFIter, i++);
-            }
+            FillGrid();
         }
 
     private:
@@ -250,14 +256,26 @@ namespace Inspection {
     };
 }
 
-InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offset) : _iter(rMesh.getKernel())
+InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offset)
+  : _iter(rMesh.getKernel()), _pGrid(0), _pTree(0)
 {
     const MeshCore::MeshKernel& kernel = rMesh.getKernel();
     _iter.Transform(rMesh.getTransform());
+    Base::BoundBox3f box = kernel.GetBoundBox().Transformed(rMesh.getTransform());
+    _box = box;
+    _box.Enlarge(offset);
+
+    // For meshes with very uneven facet density a bounding volume hierarchy
+    // performs much better than a uniform grid
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Inspection");
+    if (hGrp->GetBool("UseFacetTree", false)) {
+        _pTree = new MeshCore::MeshFacetTree(kernel, rMesh.getTransform());
+        return;
+    }
 
     // Max. limit of grid elements
     float fMaxGridElements=8000000.0f;
-    Base::BoundBox3f box = kernel.GetBoundBox().Transformed(rMesh.getTransform());
 
     // estimate the minimum allowed grid length
     float fMinGridLen = (float)pow((box.LengthX()*box.LengthY()*box.LengthZ()/fMaxGridElements), 0.3333f);
@@ -271,13 +289,12 @@ InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offs
 
     // build up grid structure to speed up algorithms
     _pGrid = new MeshInspectGrid(kernel, fGridLen, rMesh.getTransform());
-    _box = box;
-    _box.Enlarge(offset);
 }
 
 InspectNominalMesh::~InspectNominalMesh()
 {
     delete this->_pGrid;
+    delete this->_pTree;
 }
 
 float InspectNominalMesh::getDistance(const Base::Vector3f& point)
@@ -287,7 +304,12 @@ float InspectNominalMesh::getDistance(const Base::Vector3f& point)
 
     std::vector<unsigned long> indices;
     //_pGrid->GetElements(point, indices);
-    if (indices.empty()) {
+    if (_pTree) {
+        unsigned long index = _pTree->SearchNearestFromPoint(point);
+        if (index != ULONG_MAX)
+            indices.push_back(index);
+    }
+    else if (indices.empty()) {
         std::set<unsigned long> inds;
         _pGrid->MeshGrid::SearchNearestFromPoint(point, inds);
         indices.insert(indices.begin(), inds.begin(), inds.end());
@@ -384,62 +406,338 @@ float InspectNominalFastMesh::getDistance(const Base::Vector3f& point)
 
 // ----------------------------------------------------------------
 
-InspectNominalPoints::InspectNominalPoints(const Points::PointKernel& Kernel, float offset) : _rKernel(Kernel)
+InspectNominalPoints::InspectNominalPoints(const Points::PointKernel& Kernel, float offset)
+  : _rKernel(Kernel), _offset(offset)
 {
-    int uGridPerAxis = 50; // totally 125.000 grid elements 
-    this->_pGrid = new Points::PointsGrid (Kernel, uGridPerAxis);
+    this->_pTree = new Points::PointsKdTree(Kernel);
 }
 
 InspectNominalPoints::~InspectNominalPoints()
 {
-    delete this->_pGrid;
+    delete this->_pTree;
 }
 
 float InspectNominalPoints::getDistance(const Base::Vector3f& point)
 {
-    //TODO: Make faster
-    std::set<unsigned long> indices;
-    unsigned long x,y,z;
+    // points farther away than the offset are ignored anyway
+    double fMinDist;
     Base::Vector3d pointd(point.x,point.y,point.z);
-    _pGrid->Position(pointd, x, y, z);
-    _pGrid->GetElements(x,y,z,indices);
+    if (_pTree->SearchNearest(pointd, _offset, fMinDist) == ULONG_MAX)
+        return FLT_MAX;
+    return (float)fMinDist;
+}
 
-    double fMinDist=DBL_MAX;
-    for (std::set<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        Base::Vector3d pt = _rKernel.getPoint(*it);
-        double fDist = Base::Distance(pointd, pt);
-        if (fDist < fMinDist) {
-            fMinDist = fDist;
+// ----------------------------------------------------------------
+
+/**
+ * The projection algorithms for the faces and edges of the shape. They are created
+ * on demand because initializing them for free-form geometry is expensive.
+ */
+struct InspectNominalShape::Projector
+{
+    std::vector<GeomAPI_ProjectPointOnSurf*> surfaces;
+    std::vector<GeomAPI_ProjectPointOnCurve*> curves;
+    std::vector<bool> surfaceInit;
+    std::vector<bool> curveInit;
+
+    ~Projector()
+    {
+        for (std::vector<GeomAPI_ProjectPointOnSurf*>::iterator it = surfaces.begin(); it != surfaces.end(); ++it)
+            delete *it;
+        for (std::vector<GeomAPI_ProjectPointOnCurve*>::iterator it = curves.begin(); it != curves.end(); ++it)
+            delete *it;
+    }
+};
+
+InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float offset)
+  : _rShape(shape), _faces(new TopTools_IndexedMapOfShape()), _edges(new TopTools_IndexedMapOfShape())
+  , _pMesh(new MeshCore::MeshKernel()), _pTree(0), _offset(offset), _deflection(0.0f)
+  , _pMutex(new QMutex())
+{
+    if (_rShape.IsNull())
+        return;
+
+    // use the same deflection as for the tessellation of shapes to inspect
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part");
+    float deviation = hGrp->GetFloat("MeshDeviation",0.2);
+
+    Base::BoundBox3d bbox = Part::TopoShape(_rShape).getBoundBox();
+    _deflection = (float)((bbox.LengthX() + bbox.LengthY() + bbox.LengthZ())/300.0 * deviation);
+    _box = Base::BoundBox3f((float)bbox.MinX, (float)bbox.MinY, (float)bbox.MinZ,
+                            (float)bbox.MaxX, (float)bbox.MaxY, (float)bbox.MaxZ);
+    _box.Enlarge(_offset + _deflection);
+    if (_deflection > 0.0f) {
+        BRepMesh_IncrementalMesh mesher(_rShape, _deflection);
+    }
+
+    TopExp::MapShapes(_rShape, TopAbs_FACE, *_faces);
+    TopExp::MapShapes(_rShape, TopAbs_EDGE, *_edges);
+    _faceEdges.resize(_faces->Extent());
+
+    // edges without a face and vertices without an edge, e.g. of a wire
+    std::vector<bool> faceEdge(_edges->Extent(), false);
+    for (int i = 1; i <= _faces->Extent(); i++) {
+        std::vector<int>& edges = _faceEdges[i-1];
+        for (TopExp_Explorer xp(_faces->FindKey(i), TopAbs_EDGE); xp.More(); xp.Next()) {
+            int index = _edges->FindIndex(xp.Current());
+            if (index > 0 && std::find(edges.begin(), edges.end(), index) == edges.end()) {
+                edges.push_back(index);
+                faceEdge[index-1] = true;
+            }
         }
     }
 
-    return (float)fMinDist;
+    TopTools_IndexedMapOfShape vertices;
+    TopExp::MapShapes(_rShape, TopAbs_VERTEX, vertices);
+    std::vector<bool> edgeVertex(vertices.Extent(), false);
+    for (int i = 1; i <= _edges->Extent(); i++) {
+        for (TopExp_Explorer xp(_edges->FindKey(i), TopAbs_VERTEX); xp.More(); xp.Next()) {
+            int index = vertices.FindIndex(xp.Current());
+            if (index > 0)
+                edgeVertex[index-1] = true;
+        }
+        if (!faceEdge[i-1] && !BRep_Tool::Degenerated(TopoDS::Edge(_edges->FindKey(i)))) {
+            Base::BoundBox3d box = Part::TopoShape(_edges->FindKey(i)).getBoundBox();
+            box.Enlarge(_offset);
+            _freeEdges.push_back(std::make_pair(i, box));
+        }
+    }
+    for (int i = 1; i <= vertices.Extent(); i++) {
+        if (!edgeVertex[i-1]) {
+            gp_Pnt p = BRep_Tool::Pnt(TopoDS::Vertex(vertices.FindKey(i)));
+            _freeVertices.push_back(Base::Vector3d(p.X(), p.Y(), p.Z()));
+        }
+    }
+
+    MeshCore::MeshPointArray points;
+    MeshCore::MeshFacetArray facets;
+    for (int i = 1; i <= _faces->Extent(); i++) {
+        const TopoDS_Face& face = TopoDS::Face(_faces->FindKey(i));
+        TopLoc_Location loc;
+        Handle(Poly_Triangulation) mesh;
+        if (_deflection > 0.0f)
+            mesh = BRep_Tool::Triangulation(face, loc);
+        if (mesh.IsNull()) {
+            Base::BoundBox3d box = Part::TopoShape(face).getBoundBox();
+            box.Enlarge(_offset);
+            _otherFaces.push_back(std::make_pair(i, box));
+            continue;
+        }
+
+        // the faces don't share their points which doesn't matter for the search
+        gp_Trsf trsf = loc.Transformation();
+        const TColgp_Array1OfPnt& nodes = mesh->Nodes();
+        unsigned long base = points.size();
+        for (int j = nodes.Lower(); j <= nodes.Upper(); j++) {
+            gp_Pnt p = nodes(j).Transformed(trsf);
+            points.push_back(MeshCore::MeshPoint(Base::Vector3f((float)p.X(), (float)p.Y(), (float)p.Z())));
+        }
+
+        const Poly_Array1OfTriangle& triangles = mesh->Triangles();
+        for (int j = triangles.Lower(); j <= triangles.Upper(); j++) {
+            Standard_Integer n1, n2, n3;
+            triangles(j).Get(n1, n2, n3);
+            facets.push_back(MeshCore::MeshFacet(base + n1 - nodes.Lower(), base + n2 - nodes.Lower(),
+                                                 base + n3 - nodes.Lower()));
+            _facetFaces.push_back(i);
+        }
+    }
+
+    if (!_otherFaces.empty()) {
+        Base::Console().Warning("Inspection: %d of %d faces of the nominal shape could not be "
+            "tessellated and are checked without acceleration\n", (int)_otherFaces.size(), _faces->Extent());
+    }
+
+    _pMesh->Adopt(points, facets, false);
+    if (_pMesh->CountFacets() > 0)
+        _pTree = new MeshCore::MeshFacetTree(*_pMesh);
 }
 
-// ----------------------------------------------------------------
+InspectNominalShape::~InspectNominalShape()
+{
+    for (std::vector<Projector*>::iterator it = _projectors.begin(); it != _projectors.end(); ++it)
+        delete *it;
+    delete _pTree;
+    delete _pMesh;
+    delete _faces;
+    delete _edges;
+    delete _pMutex;
+}
+
+InspectNominalShape::Projector* InspectNominalShape::acquireProjector()
+{
+    {
+        QMutexLocker locker(_pMutex);
+        if (!_projectors.empty()) {
+            Projector* proj = _projectors.back();
+            _projectors.pop_back();
+            return proj;
+        }
+    }
 
-InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float radius) : _rShape(shape)
+    Projector* proj = new Projector();
+    proj->surfaces.resize(_faces->Extent(), 0);
+    proj->surfaceInit.resize(_faces->Extent(), false);
+    proj->curves.resize(_edges->Extent(), 0);
+    proj->curveInit.resize(_edges->Extent(), false);
+    return proj;
+}
+
+void InspectNominalShape::releaseProjector(Projector* proj)
 {
-    distss = new BRepExtrema_DistShapeShape();
-    distss->LoadS1(_rShape);
-    //distss->SetDeflection(radius);
+    QMutexLocker locker(_pMutex);
+    _projectors.push_back(proj);
 }
 
-InspectNominalShape::~InspectNominalShape()
+/**
+ * Returns the distance of \a point to the face with index \a face. If the projection onto
+ * the surface lies outside the face the nearest point is on one of its edges.
+ */
+double InspectNominalShape::getFaceDistance(Projector& proj, int face, const Base::Vector3d& point) const
 {
-    delete distss;
+    gp_Pnt pnt(point.x, point.y, point.z);
+    const TopoDS_Face& aFace = TopoDS::Face(_faces->FindKey(face));
+
+    if (!proj.surfaceInit[face-1]) {
+        proj.surfaceInit[face-1] = true;
+        Handle(Geom_Surface) surface = BRep_Tool::Surface(aFace);
+        if (!surface.IsNull()) {
+            Standard_Real u1, u2, v1, v2;
+            BRepTools::UVBounds(aFace, u1, u2, v1, v2);
+            proj.surfaces[face-1] = new GeomAPI_ProjectPointOnSurf();
+            proj.surfaces[face-1]->Init(surface, u1, u2, v1, v2);
+        }
+    }
+
+    // the nearest of the projections that lie inside the face
+    double fMinDist = DBL_MAX;
+    GeomAPI_ProjectPointOnSurf* surface = proj.surfaces[face-1];
+    if (surface) {
+        surface->Perform(pnt);
+        for (Standard_Integer i = 1; i <= surface->NbPoints(); i++) {
+            double fDist = surface->Distance(i);
+            if (fDist >= fMinDist)
+                continue;
+            Standard_Real u, v;
+            surface->Parameters(i, u, v);
+            BRepClass_FaceClassifier classifier(aFace, gp_Pnt2d(u, v), BRep_Tool::Tolerance(aFace));
+            TopAbs_State state = classifier.State();
+            if (state == TopAbs_IN || state == TopAbs_ON)
+                fMinDist = fDist;
+        }
+
+        // the nearest point of the whole surface lies inside the face
+        if (surface->NbPoints() > 0 && fMinDist <= surface->LowerDistance())
+            return fMinDist;
+    }
+
+    // otherwise the nearest point is one of the other projections or lies on the boundary
+    const std::vector<int>& edges = _faceEdges[face-1];
+    for (std::vector<int>::const_iterator it = edges.begin(); it != edges.end(); ++it)
+        fMinDist = std::min<double>(fMinDist, getEdgeDistance(proj, *it, point));
+
+    return fMinDist;
 }
 
-float InspectNominalShape::getDistance(const Base::Vector3f& point)
+/**
+ * Returns the distance of \a point to the edge with index \a edge, including its end points.
+ */
+double InspectNominalShape::getEdgeDistance(Projector& proj, int edge, const Base::Vector3d& point) const
 {
-    BRepBuilderAPI_MakeVertex mkVert(gp_Pnt(point.x,point.y,point.z));
-    distss->LoadS2(mkVert.Vertex());
-    float fMinDist=FLT_MAX;
-    if (distss->Perform() && distss->NbSolution() > 0)
-        fMinDist = (float)distss->Value();
+    gp_Pnt pnt(point.x, point.y, point.z);
+    const TopoDS_Edge& aEdge = TopoDS::Edge(_edges->FindKey(edge));
+    if (BRep_Tool::Degenerated(aEdge))
+        return DBL_MAX;
+
+    double fMinDist = DBL_MAX;
+    TopoDS_Vertex v1, v2;
+    TopExp::Vertices(aEdge, v1, v2);
+    if (!v1.IsNull())
+        fMinDist = std::min<double>(fMinDist, BRep_Tool::Pnt(v1).Distance(pnt));
+    if (!v2.IsNull())
+        fMinDist = std::min<double>(fMinDist, BRep_Tool::Pnt(v2).Distance(pnt));
+
+    if (!proj.curveInit[edge-1]) {
+        proj.curveInit[edge-1] = true;
+        Standard_Real first, last;
+        Handle(Geom_Curve) curve = BRep_Tool::Curve(aEdge, first, last);
+        if (!curve.IsNull()) {
+            proj.curves[edge-1] = new GeomAPI_ProjectPointOnCurve();
+            proj.curves[edge-1]->Init(curve, first, last);
+        }
+    }
+
+    GeomAPI_ProjectPointOnCurve* curve = proj.curves[edge-1];
+    if (curve) {
+        curve->Perform(pnt);
+        if (curve->NbPoints() > 0)
+            fMinDist = std::min<double>(fMinDist, curve->LowerDistance());
+    }
+
     return fMinDist;
 }
 
+float InspectNominalShape::getDistance(const Base::Vector3f& point)
+{
+    if (!_box.IsInBox(point))
+        return FLT_MAX; // must be inside bbox
+
+    Base::Vector3d pnt(point.x, point.y, point.z);
+    double fExactDist = DBL_MAX;
+    Projector* proj = acquireProjector();
+
+    // distance to the tessellation
+    Base::Vector3f res;
+    float fMinDist = FLT_MAX;
+    unsigned long index = ULONG_MAX;
+    if (_pTree)
+        index = _pTree->SearchNearestFromPoint(point, _offset + _deflection, res, fMinDist);
+    if (index != ULONG_MAX) {
+        // The faces deviate from their triangles by not more than the deflection. So, only
+        // faces with triangles that are at most twice the deflection farther away than the
+        // nearest triangle can contain the nearest point.
+        float fMaxDist = fMinDist + 2.0f * _deflection;
+        Base::BoundBox3f box(point.x - fMaxDist, point.y - fMaxDist, point.z - fMaxDist,
+                             point.x + fMaxDist, point.y + fMaxDist, point.z + fMaxDist);
+        std::vector<unsigned long> indices;
+        _pTree->Inside(box, indices);
+
+        std::vector<int> faces;
+        faces.push_back(_facetFaces[index]);
+        for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
+            if (_pMesh->GetFacet(*it).DistanceToPoint(point) <= fMaxDist)
+                faces.push_back(_facetFaces[*it]);
+        }
+        std::sort(faces.begin(), faces.end());
+        faces.erase(std::unique(faces.begin(), faces.end()), faces.end());
+
+        for (std::vector<int>::iterator it = faces.begin(); it != faces.end(); ++it)
+            fExactDist = std::min<double>(fExactDist, getFaceDistance(*proj, *it, pnt));
+
+        // if the projection fails keep the distance to the tessellation
+        if (fExactDist == DBL_MAX)
+            fExactDist = fMinDist;
+    }
+
+    // the geometry that is not part of the tessellation
+    for (std::vector<std::pair<int, Base::BoundBox3d> >::iterator it = _otherFaces.begin(); it != _otherFaces.end(); ++it) {
+        if (it->second.IsInBox(pnt))
+            fExactDist = std::min<double>(fExactDist, getFaceDistance(*proj, it->first, pnt));
+    }
+    for (std::vector<std::pair<int, Base::BoundBox3d> >::iterator it = _freeEdges.begin(); it != _freeEdges.end(); ++it) {
+        if (it->second.IsInBox(pnt))
+            fExactDist = std::min<double>(fExactDist, getEdgeDistance(*proj, it->first, pnt));
+    }
+    for (std::vector<Base::Vector3d>::iterator it = _freeVertices.begin(); it != _freeVertices.end(); ++it)
+        fExactDist = std::min<double>(fExactDist, Base::Distance(*it, pnt));
+    releaseProjector(proj);
+
+    if (fExactDist == DBL_MAX)
+        return FLT_MAX;
+    return (float)fExactDist;
+}
+
 // ----------------------------------------------------------------
 
 TYPESYSTEM_SOURCE(Inspection::PropertyDistanceList, App::PropertyLists);
@@ -591,17 +889,14 @@ unsigned int PropertyDistanceList::getMemSize (void) const
 struct DistanceInspection
 {
 
-    DistanceInspection(float radius, InspectActualGeometry*  a,
-                       std::vector<InspectNominalGeometry*> n)
-                    : radius(radius), actual(a), nominal(n)
+    DistanceInspection(float radius, std::vector<InspectNominalGeometry*> n)
+                    : radius(radius), nominal(n)
     {
     }
-    float mapped(unsigned long index)
+    float mapped(const Base::Vector3f& pnt) const
     {
-        Base::Vector3f pnt = actual->getPoint(index);
-
         float fMinDist=FLT_MAX;
-        for (std::vector<InspectNominalGeometry*>::iterator it = nominal.begin(); it != nominal.end(); ++it) {
+        for (std::vector<InspectNominalGeometry*>::const_iterator it = nominal.begin(); it != nominal.end(); ++it) {
             float fDist = (*it)->getDistance(pnt);
             if (fabs(fDist) < fabs(fMinDist))
                 fMinDist = fDist;
@@ -616,7 +911,6 @@ struct DistanceInspection
     }
 
     float radius;
-    InspectActualGeometry*  actual;
     std::vector<InspectNominalGeometry*> nominal;
 };
 
@@ -693,52 +987,48 @@ App::DocumentObjectExecReturn* Feature::execute(void)
             inspectNominal.push_back(nominal);
     }
 
-#if 0 // test with some huge data sets
-    Standard::SetReentrant(Standard_True);
-    std::vector<unsigned long> index(actual->countPoints());
-    std::generate(index.begin(), index.end(), Base::iotaGen<unsigned long>(0));
-    DistanceInspection check(this->SearchRadius.getValue(), actual, inspectNominal);
-    QFuture<float> future = QtConcurrent::mapped
-        (index, boost::bind(&DistanceInspection::mapped, &check, _1));
-    //future.waitForFinished(); // blocks the GUI
-    Base::FutureWatcherProgress progress("Inspecting...", actual->countPoints());
-    QFutureWatcher<float> watcher;
-    QObject::connect(&watcher, SIGNAL(progressValueChanged(int)),
-                     &progress, SLOT(progressValueChanged(int)));
-    watcher.setFuture(future);
-
-    // keep it responsive during computation
-    QEventLoop loop;
-    QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
-    loop.exec();
-
-    std::vector<float> vals;
-    vals.insert(vals.end(), future.begin(), future.end());
-#else
     unsigned long count = actual->countPoints();
     std::stringstream str;
     str << "Inspecting " << this->Label.getValue() << "...";
-    Base::SequencerLauncher seq(str.str().c_str(), count);
-
-    std::vector<float> vals(count);
-    for (unsigned long index = 0; index < count; index++) {
-        Base::Vector3f pnt = actual->getPoint(index);
 
-        float fMinDist=FLT_MAX;
-        for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it) {
-            float fDist = (*it)->getDistance(pnt);
-            if (fabs(fDist) < fabs(fMinDist))
-                fMinDist = fDist;
+    // the distances can be computed in parallel if all nominals support it
+    bool parallel = true;
+    for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it) {
+        if (!(*it)->isThreadSafe()) {
+            parallel = false;
+            break;
         }
-
-        if (fMinDist > this->SearchRadius.getValue())
-            fMinDist = FLT_MAX;
-        else if (-fMinDist > this->SearchRadius.getValue())
-            fMinDist = -FLT_MAX;
-        vals[index] = fMinDist;
-        seq.next();
     }
+
+    DistanceInspection check(this->SearchRadius.getValue(), inspectNominal);
+    std::vector<float> vals(count);
+    if (parallel) {
+#if OCC_VERSION_HEX < 0x070000
+        Standard::SetReentrant(Standard_True);
 #endif
+        // the actual geometry is accessed from the main thread only
+        const unsigned long blockSize = 10000;
+        Base::SequencerLauncher seq(str.str().c_str(), (count + blockSize - 1) / blockSize);
+        std::vector<Base::Vector3f> points;
+        for (unsigned long begin = 0; begin < count; begin += blockSize) {
+            unsigned long end = std::min<unsigned long>(begin + blockSize, count);
+            points.clear();
+            for (unsigned long index = begin; index < end; index++)
+                points.push_back(actual->getPoint(index));
+
+            std::vector<float> dist = QtConcurrent::blockingMapped<std::vector<float> >
+                (points, boost::bind(&DistanceInspection::mapped, &check, _1));
+            std::copy(dist.begin(), dist.end(), vals.begin() + begin);
+            seq.next();
+        }
+    }
+    else {
+        Base::SequencerLauncher seq(str.str().c_str(), count);
+        for (unsigned long index = 0; index < count; index++) {
+            vals[index] = check.mapped(actual->getPoint(index));
+            seq.next();
+        }
+    }
 
     Distances.setValues(vals);
 
@@ -32,15 +32,17 @@
 #include <Mod/Points/App/Points.h>
 
 class TopoDS_Shape;
-class BRepExtrema_DistShapeShape;
+class TopTools_IndexedMapOfShape;
+class QMutex;
 
 namespace MeshCore {
 class MeshKernel;
 class MeshGrid;
+class MeshFacetTree;
 }
 
 namespace Mesh   { class MeshObject; }
-namespace Points { class PointsGrid; }
+namespace Points { class PointsKdTree; }
 namespace Part   { class TopoShape;  }
 
 namespace Inspection
@@ -100,6 +102,8 @@ public:
     InspectNominalGeometry() {}
     virtual ~InspectNominalGeometry() {}
     virtual float getDistance(const Base::Vector3f&) = 0;
+    /// Returns true if getDistance() can be called from several threads at once
+    virtual bool isThreadSafe() const { return false; }
 };
 
 class InspectionExport InspectNominalMesh : public InspectNominalGeometry
@@ -112,6 +116,7 @@ public:
 private:
     MeshCore::MeshFacetIterator _iter;
     MeshCore::MeshGrid* _pGrid;
+    MeshCore::MeshFacetTree* _pTree;
     Base::BoundBox3f _box;
 };
 
@@ -135,22 +140,57 @@ public:
     InspectNominalPoints(const Points::PointKernel&, float offset);
     ~InspectNominalPoints();
     virtual float getDistance(const Base::Vector3f&);
+    virtual bool isThreadSafe() const { return true; }
 
 private:
     const Points::PointKernel& _rKernel;
-    Points::PointsGrid* _pGrid;
+    Points::PointsKdTree* _pTree;
+    float _offset;
 };
 
+/**
+ * Calculates the distance of a point to a shape.
+ *
+ * The shape is tessellated once and a bounding volume hierarchy over the triangles
+ * gives an approximate distance. Afterwards the point is projected onto the surfaces
+ * and edges of those faces whose triangles are within the deflection of the nearest
+ * one. Faces that cannot be tessellated, edges without a face and vertices without
+ * an edge are checked one by one if the point is near their bounding box. The
+ * projection algorithms are kept in a pool, so that every thread calling
+ * getDistance() works with its own instances.
+ */
 class InspectionExport InspectNominalShape : public InspectNominalGeometry
 {
 public:
     InspectNominalShape(const TopoDS_Shape&, float offset);
     ~InspectNominalShape();
     virtual float getDistance(const Base::Vector3f&);
+    virtual bool isThreadSafe() const { return true; }
+
+private:
+    struct Projector;
+
+    Projector* acquireProjector();
+    void releaseProjector(Projector*);
+    double getFaceDistance(Projector&, int face, const Base::Vector3d&) const;
+    double getEdgeDistance(Projector&, int edge, const Base::Vector3d&) const;
 
 private:
-    BRepExtrema_DistShapeShape* distss;
     const TopoDS_Shape& _rShape;
+    TopTools_IndexedMapOfShape* _faces;
+    TopTools_IndexedMapOfShape* _edges;
+    std::vector<std::vector<int> > _faceEdges;
+    MeshCore::MeshKernel* _pMesh;
+    MeshCore::MeshFacetTree* _pTree;
+    std::vector<int> _facetFaces;
+    std::vector<std::pair<int, Base::BoundBox3d> > _otherFaces;
+    std::vector<std::pair<int, Base::BoundBox3d> > _freeEdges;
+    std::vector<Base::Vector3d> _freeVertices;
+    Base::BoundBox3f _box;
+    float _offset;
+    float _deflection;
+    QMutex* _pMutex;
+    std::vector<Projector*> _projectors;
 };
 
 class InspectionExport PropertyDistanceList: public App::PropertyLists
@@ -193,6 +233,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
     
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
     
     virtual Property *Copy(void) const;
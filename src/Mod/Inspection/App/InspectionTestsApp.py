@@ -0,0 +1,63 @@
+#   (c) FreeCAD Developers 2016      LGPL
+
+import FreeCAD, math, unittest
+import Part, Points, Inspection
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD inspection module
+#---------------------------------------------------------------------------
+
+
+class InspectionShapeCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("InspectionTests")
+
+    def inspect(self, shape, points, radius=20.0):
+        nominal = self.doc.addObject("Part::Feature", "Nominal")
+        nominal.Shape = shape
+        actual = self.doc.addObject("Points::Feature", "Actual")
+        actual.Points = Points.Points(points)
+        feature = self.doc.addObject("Inspection::Feature", "Inspection")
+        feature.Actual = actual
+        feature.Nominals = [nominal]
+        feature.SearchRadius = radius
+        self.doc.recompute()
+        return feature.Distances
+
+    def assertDistances(self, distances, expected):
+        self.failUnless(len(distances) == len(expected))
+        for d, e in zip(distances, expected):
+            self.failUnless(abs(abs(d) - e) < 1e-3, "%g != %g" % (d, e))
+
+    def testBox(self):
+        shape = Part.makeBox(10, 10, 10)
+        points = [(5, 5, 12), (5, 5, 9), (12, 12, 5), (-1, -1, -1)]
+        self.assertDistances(self.inspect(shape, points), [2.0, 1.0, math.sqrt(8), math.sqrt(3)])
+
+    def testHalfCylinder(self):
+        # the nearest projection onto the surface lies outside the face, the
+        # other one inside but farther away than the straight edges
+        shape = Part.makeCylinder(5, 10, FreeCAD.Vector(), FreeCAD.Vector(0, 0, 1), 180).Faces[0]
+        points = [(0, 8, 5), (0, -8, 5)]
+        self.assertDistances(self.inspect(shape, points), [3.0, math.sqrt(89)])
+
+    def testOutsideRadius(self):
+        shape = Part.makeBox(10, 10, 10)
+        distances = self.inspect(shape, [(5, 5, 15), (5, 5, 50)], 10.0)
+        self.failUnless(abs(distances[0] - 5.0) < 1e-3)
+        self.failUnless(distances[1] > 1e30)
+
+    def testEdges(self):
+        line = Part.makeLine((0, 0, 0), (10, 0, 0))
+        circle = Part.makeCircle(2, FreeCAD.Vector(20, 0, 0))
+        shape = Part.Compound([line, circle])
+        points = [(5, 3, 0), (-3, 4, 0), (20, 0, 0), (20, 5, 0)]
+        self.assertDistances(self.inspect(shape, points), [3.0, 5.0, 2.0, 3.0])
+
+    def testVertex(self):
+        shape = Part.Vertex(1, 2, 3)
+        self.assertDistances(self.inspect(shape, [(1, 2, 5), (4, 6, 3)]), [2.0, 5.0])
+
+    def tearDown(self):
+        FreeCAD.closeDocument("InspectionTests")
@@ -40,6 +40,7 @@
 #include "FeatureMeshTransformDemolding.h"
 #include "FeatureMeshCurvature.h"
 #include "FeatureMeshSegmentByMesh.h"
+#include "FeatureMeshDecimation.h"
 #include "FeatureMeshSetOperations.h"
 #include "FeatureMeshDefects.h"
 #include "FeatureMeshSolid.h"
@@ -90,6 +91,7 @@ void MeshExport initMesh()
     Mesh::TransformDemolding    ::init();
     Mesh::Curvature             ::init();
     Mesh::SegmentByMesh         ::init();
+    Mesh::Decimation            ::init();
     Mesh::SetOperations         ::init();
     Mesh::FixDefects            ::init();
     Mesh::HarmonizeNormals      ::init();
@@ -35,11 +35,13 @@
 
 #include <CXX/Objects.hxx>
 #include <Base/VectorPy.h>
+#include <Base/GeometryPyCXX.h>
 
 #include "Core/MeshKernel.h"
 #include "Core/MeshIO.h"
 #include "Core/Evaluation.h"
 #include "Core/Iterator.h"
+#include "Core/OutOfCore.h"
 
 #include "MeshPy.h"
 #include "Mesh.h"
@@ -437,7 +439,128 @@ calculateEigenTransform(PyObject *self, PyObject *args)
 	Py_Return;
 }
 
+
+static PyObject *
+processOutOfCore(PyObject *self, PyObject *args)
+{
+    char* Input;
+    char* Output;
+    PyObject* ops;
+    int chunkSize = 1000000;
+    if (!PyArg_ParseTuple(args, "etetO|i","utf-8",&Input,"utf-8",&Output,&ops,&chunkSize))
+        return NULL;
+    std::string EncodedInput = std::string(Input);
+    PyMem_Free(Input);
+    std::string EncodedOutput = std::string(Output);
+    PyMem_Free(Output);
+    if (chunkSize <= 0) {
+        PyErr_SetString(PyExc_ValueError, "Chunk size must be positive");
+        return NULL;
+    }
+
+    PY_TRY {
+        MeshCore::MeshOutOfCore mesh(App::Application::getTempPath(), (unsigned long)chunkSize);
+        if (!mesh.Partition(EncodedInput)) {
+            PyErr_SetString(Base::BaseExceptionFreeCADError, "Input must be a binary STL file");
+            return NULL;
+        }
+
+        Py::Sequence list(ops);
+        for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+            Py::Object item(*it);
+            Py::Tuple op(1);
+            if (item.isString())
+                op.setItem(0, item);
+            else
+                op = item;
+            std::string name = (std::string)Py::String(op.getItem(0));
+            if (name == "removeDuplicatedPoints") {
+                mesh.RemoveDuplicatedPoints();
+            }
+            else if (name == "harmonizeNormals") {
+                mesh.HarmonizeNormals();
+            }
+            else if (name == "decimate" && op.size() > 1) {
+                long targetSize = (long)Py::Int(op.getItem(1));
+                float fTolerance = op.size() > 2 ? (float)Py::Float(op.getItem(2)) : FLOAT_MAX;
+                float fFeatureAngle = op.size() > 3 ? (float)Py::Float(op.getItem(3)) : 0.0f;
+                if (targetSize < 0)
+                    throw Py::ValueError("Target size must not be negative");
+                mesh.Decimate((unsigned long)targetSize, fTolerance, fFeatureAngle * F_PI / 180.0f);
+            }
+            else {
+                std::string msg = "Unknown operation: ";
+                msg += name;
+                throw Py::ValueError(msg);
+            }
+        }
+
+        if (!mesh.Write(EncodedOutput)) {
+            PyErr_SetString(Base::BaseExceptionFreeCADError, "Writing of mesh failed");
+            return NULL;
+        }
+    } PY_CATCH;
+
+    Py_Return;
+}
 
+static PyObject *
+crossSectionsOutOfCore(PyObject *self, PyObject *args)
+{
+    char* Input;
+    PyObject *obj;
+    PyObject *poly=Py_False;
+    float min_eps = 1.0e-2f;
+    int chunkSize = 1000000;
+    if (!PyArg_ParseTuple(args, "etO|fO!i","utf-8",&Input,&obj,&min_eps,&PyBool_Type,&poly,&chunkSize))
+        return NULL;
+    std::string EncodedInput = std::string(Input);
+    PyMem_Free(Input);
+    if (chunkSize <= 0) {
+        PyErr_SetString(PyExc_ValueError, "Chunk size must be positive");
+        return NULL;
+    }
+
+    PY_TRY {
+        Py::Sequence list(obj);
+        std::vector<MeshCore::MeshOutOfCore::TPlane> csPlanes;
+        for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+            Py::Tuple pair(*it);
+            Base::Vector3d b = Py::Vector(pair.getItem(0)).toVector();
+            Base::Vector3d n = Py::Vector(pair.getItem(1)).toVector();
+            MeshCore::MeshOutOfCore::TPlane plane;
+            plane.first.Set((float)b.x,(float)b.y,(float)b.z);
+            plane.second.Set((float)n.x,(float)n.y,(float)n.z);
+            csPlanes.push_back(plane);
+        }
+
+        MeshCore::MeshOutOfCore mesh(App::Application::getTempPath(), (unsigned long)chunkSize);
+        if (!mesh.Partition(EncodedInput)) {
+            PyErr_SetString(Base::BaseExceptionFreeCADError, "Input must be a binary STL file");
+            return NULL;
+        }
+
+        std::vector<MeshCore::MeshOutOfCore::TPolylines> sections;
+        mesh.CrossSections(csPlanes, sections, min_eps, PyObject_IsTrue(poly) ? true : false);
+
+        // convert to Python objects
+        Py::List crossSections;
+        for (std::vector<MeshCore::MeshOutOfCore::TPolylines>::iterator it = sections.begin(); it != sections.end(); ++it) {
+            Py::List section;
+            for (MeshCore::MeshOutOfCore::TPolylines::const_iterator jt = it->begin(); jt != it->end(); ++jt) {
+                Py::List polyline;
+                for (std::vector<Base::Vector3f>::const_iterator kt = jt->begin(); kt != jt->end(); ++kt) {
+                    polyline.append(Py::Object(new Base::VectorPy(*kt)));
+                }
+                section.append(polyline);
+            }
+            crossSections.append(section);
+        }
+
+        return Py::new_reference_to(crossSections);
+    } PY_CATCH;
+}
+
 PyDoc_STRVAR(open_doc,
 "open(string) -- Create a new document and a Mesh::Import feature to load the file into the document.");
 
@@ -455,6 +578,21 @@ PyDoc_STRVAR(calculateEigenTransform_doc,
 "The local coordinate system is right-handed.\n"
 );
 
+PyDoc_STRVAR(processOutOfCore_doc,
+"processOutOfCore(string,string,list,[int]) -- Process a binary STL file that is too big to be loaded.\n"
+"The mesh of the input file is split into chunks of at most the given number of\n"
+"facets (default 1000000) that are kept on disk and processed one after the other.\n"
+"The operations of the list are applied in order and the result is saved to the\n"
+"output file. Supported operations are 'removeDuplicatedPoints', 'harmonizeNormals'\n"
+"and ('decimate', targetSize, [tolerance, featureAngle]).\n"
+);
+
+PyDoc_STRVAR(crossSectionsOutOfCore_doc,
+"crossSectionsOutOfCore(string,list,[float,bool,int]) -- Cross-sections of a binary STL file that is too big to be loaded.\n"
+"The planes are given as pairs of base and normal and the result is the same as\n"
+"of Mesh.crossSections(). The last argument is the maximum number of facets per chunk.\n"
+);
+
 /* List of functions defined in the module */
 
 struct PyMethodDef Mesh_Import_methods[] = { 
@@ -471,5 +609,7 @@ struct PyMethodDef Mesh_Import_methods[] = {
     {"createCone",createCone, Py_NEWARGS,   "Create a tessellated cone"},
     {"createTorus",createTorus, Py_NEWARGS,   "Create a tessellated torus"},
     {"calculateEigenTransform",calculateEigenTransform, METH_VARARGS,   calculateEigenTransform_doc},
+    {"processOutOfCore",processOutOfCore, METH_VARARGS,   processOutOfCore_doc},
+    {"crossSectionsOutOfCore",crossSectionsOutOfCore, METH_VARARGS,   crossSectionsOutOfCore_doc},
     {NULL, NULL}  /* sentinel */
 };
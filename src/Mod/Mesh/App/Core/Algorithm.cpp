@@ -25,13 +25,18 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <iterator>
 #endif
 
+#include <QAtomicInt>
+#include <QtConcurrentMap>
+
 #include "Algorithm.h"
 #include "Approximation.h"
 #include "Elements.h"
 #include "Iterator.h"
 #include "Grid.h"
+#include "Tree.h"
 #include "Triangulation.h"
 
 #include <Base/Console.h>
@@ -143,6 +148,12 @@ bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::
     return false;
 }
 
+bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const MeshFacetTree &rclTree,
+                                       Base::Vector3f &rclRes, unsigned long &rulFacet) const
+{
+    return rclTree.NearestFacetOnRay(rclPt, rclDir, rclRes, rulFacet);
+}
+
 bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const std::vector<unsigned long> &raulFacets,
                                        Base::Vector3f &rclRes, unsigned long &rulFacet) const
 {
@@ -637,8 +648,8 @@ bool MeshAlgorithm::FillupHole(const std::vector<unsigned long>& boundary,
     unsigned long refPoint0 = *(boundary.begin());
     unsigned long refPoint1 = *(boundary.begin()+1);
     if (pP2FStructure) {
-        const std::set<unsigned long>& ring1 = (*pP2FStructure)[refPoint0];
-        const std::set<unsigned long>& ring2 = (*pP2FStructure)[refPoint1];
+        MeshIndexRange ring1 = (*pP2FStructure)[refPoint0];
+        MeshIndexRange ring2 = (*pP2FStructure)[refPoint1];
         std::vector<unsigned long> f_int;
         std::set_intersection(ring1.begin(), ring1.end(), ring2.begin(), ring2.end(),
             std::back_insert_iterator<std::vector<unsigned long> >(f_int));
@@ -750,8 +761,9 @@ bool MeshAlgorithm::FillupHole(const std::vector<unsigned long>& boundary,
 
         // in case the reference facet has not an open edge print a log message 
         if (ref_side == USHRT_MAX || tri_side == USHRT_MAX) {
-            Base::Console().Log("MeshAlgorithm::FillupHole: Expected open edge for facet <%d, %d, %d>\n", 
-                rFace._aulPoints[0], rFace._aulPoints[1], rFace._aulPoints[2]);
+            Base::Console().Log("MeshAlgorithm::FillupHole: Expected open edge for facet <%lu, %lu, %lu>\n", 
+                (unsigned long)rFace._aulPoints[0], (unsigned long)rFace._aulPoints[1],
+                (unsigned long)rFace._aulPoints[2]);
             rFaces.clear();
             rPoints.clear();
             cTria.Discard();
@@ -1401,6 +1413,25 @@ bool MeshAlgorithm::NearestPointFromPoint (const Base::Vector3f &rclPt, const Me
   return true;
 }
 
+bool MeshAlgorithm::NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetTree& rclTree, unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const
+{
+  return NearestPointFromPoint(rclPt, rclTree, FLOAT_MAX, rclResFacetIndex, rclResPoint);
+}
+
+bool MeshAlgorithm::NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetTree& rclTree, float fMaxSearchArea,
+                                           unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const
+{
+  float fDist;
+  unsigned long ulInd = rclTree.SearchNearestFromPoint(rclPt, fMaxSearchArea, rclResPoint, fDist);
+
+  if (ulInd == ULONG_MAX)
+    return false;  // no facets inside the search area
+
+  rclResFacetIndex = ulInd;
+
+  return true;
+}
+
 bool MeshAlgorithm::CutWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const MeshFacetGrid &rclGrid,
                                   std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps, bool bConnectPolygons) const
 {
@@ -1666,7 +1697,7 @@ bool MeshAlgorithm::Distance (const Base::Vector3f &rclPt, unsigned long ulFacet
 {
   const MeshFacetArray &rclFAry = _rclMesh._aclFacetArray;
   const MeshPointArray &rclPAry = _rclMesh._aclPointArray;
-  const unsigned long *pulIdx = rclFAry[ulFacetIdx]._aulPoints;
+  const MeshIndex *pulIdx = rclFAry[ulFacetIdx]._aulPoints;
 
   BoundBox3f clBB;
   clBB &= rclPAry[*(pulIdx++)];
@@ -1694,28 +1725,256 @@ float MeshAlgorithm::CalculateMinimumGridLength(float fLength, const Base::Bound
 
 // ----------------------------------------------------
 
-void MeshRefPointToFacets::Rebuild (void)
+namespace MeshCore {
+
+/**
+ * Helper class to build up the neighbourhood structures in compressed row
+ * storage: the entries of row i are _index[_offsets[i]] ... _index[_offsets[i+1]-1]
+ * in ascending order. The rows are filled and sorted in parallel.
+ */
+class MeshAdjacencyBuilder
 {
-    _map.clear();
+public:
+    MeshAdjacencyBuilder(const MeshFacetArray& facets, unsigned long ctRows,
+                         std::vector<unsigned long>& offsets,
+                         std::vector<unsigned long>& index)
+      : _facets(facets), _ctRows(ctRows), _offsets(offsets), _index(index), _search(0)
+    {
+    }
 
-    const MeshPointArray& rPoints = _rclMesh.GetPoints();
-    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
-    _map.resize(rPoints.size());
+    /// Collects for each point the facets indexing it.
+    void PointToFacets()
+    {
+        Fill(&MeshAdjacencyBuilder::CountPointFacets, &MeshAdjacencyBuilder::FillPointFacets);
+    }
+
+    /// Collects for each point the points sharing an edge with it.
+    void PointToPoints()
+    {
+        Fill(&MeshAdjacencyBuilder::CountPointPoints, &MeshAdjacencyBuilder::FillPointPoints);
+        Compress();
+    }
+
+    /// Collects for each facet the facets sharing at least one point with it.
+    void FacetToFacets(const MeshRefPointToFacets& search)
+    {
+        _search = &search;
+        _offsets.assign(_ctRows + 1, 0);
+        std::vector<Block> blocks;
+        SetupBlocks(blocks, _ctRows);
+        Run(blocks, &MeshAdjacencyBuilder::CountFacetFacets);
+        for (unsigned long i = 0; i < _ctRows; i++)
+            _offsets[i+1] += _offsets[i];
+        _index.resize(_offsets[_ctRows]);
+        Run(blocks, &MeshAdjacencyBuilder::FillFacetFacets);
+    }
+
+private:
+    struct Block
+    {
+        MeshAdjacencyBuilder* builder;
+        unsigned long begin, end;
+        std::vector<unsigned long> buffer;
+    };
+
+    void SetupBlocks(std::vector<Block>& blocks, unsigned long size)
+    {
+        const unsigned long blockSize = 65536;
+        unsigned long ctBlocks = (size + blockSize - 1) / blockSize;
+        blocks.resize(ctBlocks);
+        for (unsigned long i = 0; i < ctBlocks; i++) {
+            blocks[i].builder = this;
+            blocks[i].begin = i * blockSize;
+            blocks[i].end = std::min<unsigned long>(size, (i + 1) * blockSize);
+        }
+    }
+
+    void Run(std::vector<Block>& blocks, void (*func)(Block&))
+    {
+        if (blocks.size() > 1)
+            QtConcurrent::blockingMap(blocks, func);
+        else if (!blocks.empty())
+            func(blocks.front());
+    }
+
+    /**
+     * The rows are filled in two passes over the facets. The first pass counts the
+     * entries of each row, the second one puts them into place. As the facets are
+     * processed in parallel the order in a row is undefined and the rows get sorted
+     * afterwards.
+     */
+    void Fill(void (*count)(Block&), void (*fill)(Block&))
+    {
+        _counter.assign(_ctRows, QAtomicInt(0));
+        std::vector<Block> blocks;
+        SetupBlocks(blocks, _facets.size());
+        Run(blocks, count);
+
+        _offsets.resize(_ctRows + 1);
+        _offsets[0] = 0;
+        for (unsigned long i = 0; i < _ctRows; i++) {
+            _offsets[i+1] = _offsets[i] + (int)_counter[i];
+            _counter[i] = QAtomicInt(0);
+        }
+
+        _index.resize(_offsets[_ctRows]);
+        Run(blocks, fill);
+        std::vector<QAtomicInt>().swap(_counter);
+
+        SetupBlocks(blocks, _ctRows);
+        Run(blocks, &MeshAdjacencyBuilder::SortRows);
+    }
+
+    void Insert(unsigned long row, unsigned long value)
+    {
+        unsigned long pos = _offsets[row] + _counter[row].fetchAndAddRelaxed(1);
+        _index[pos] = value;
+    }
+
+    /// Removes duplicated entries of the sorted rows.
+    void Compress()
+    {
+        std::vector<unsigned long> offsets(_ctRows + 1);
+        offsets[0] = 0;
+        for (unsigned long i = 0; i < _ctRows; i++) {
+            std::vector<unsigned long>::iterator first = _index.begin() + _offsets[i];
+            std::vector<unsigned long>::iterator last = _index.begin() + _offsets[i+1];
+            offsets[i+1] = offsets[i] + (std::unique(first, last) - first);
+        }
+
+        std::vector<unsigned long> index(offsets[_ctRows]);
+        for (unsigned long i = 0; i < _ctRows; i++) {
+            std::copy(_index.begin() + _offsets[i],
+                      _index.begin() + _offsets[i] + (offsets[i+1] - offsets[i]),
+                      index.begin() + offsets[i]);
+        }
+
+        _offsets.swap(offsets);
+        _index.swap(index);
+    }
+
+    static void CountPointFacets(Block& b)
+    {
+        MeshAdjacencyBuilder& m = *b.builder;
+        for (unsigned long i = b.begin; i < b.end; i++) {
+            const MeshIndex* p = m._facets[i]._aulPoints;
+            m._counter[p[0]].fetchAndAddRelaxed(1);
+            if (p[1] != p[0])
+                m._counter[p[1]].fetchAndAddRelaxed(1);
+            if (p[2] != p[0] && p[2] != p[1])
+                m._counter[p[2]].fetchAndAddRelaxed(1);
+        }
+    }
+
+    static void FillPointFacets(Block& b)
+    {
+        MeshAdjacencyBuilder& m = *b.builder;
+        for (unsigned long i = b.begin; i < b.end; i++) {
+            const MeshIndex* p = m._facets[i]._aulPoints;
+            m.Insert(p[0], i);
+            if (p[1] != p[0])
+                m.Insert(p[1], i);
+            if (p[2] != p[0] && p[2] != p[1])
+                m.Insert(p[2], i);
+        }
+    }
+
+    static void CountPointPoints(Block& b)
+    {
+        MeshAdjacencyBuilder& m = *b.builder;
+        for (unsigned long i = b.begin; i < b.end; i++) {
+            const MeshIndex* p = m._facets[i]._aulPoints;
+            for (int j = 0; j < 3; j++)
+                m._counter[p[j]].fetchAndAddRelaxed(2);
+        }
+    }
+
+    static void FillPointPoints(Block& b)
+    {
+        MeshAdjacencyBuilder& m = *b.builder;
+        for (unsigned long i = b.begin; i < b.end; i++) {
+            const MeshIndex* p = m._facets[i]._aulPoints;
+            for (int j = 0; j < 3; j++) {
+                m.Insert(p[j], p[(j+1)%3]);
+                m.Insert(p[j], p[(j+2)%3]);
+            }
+        }
+    }
 
-    MeshFacetArray::_TConstIterator pFBegin = rFacets.begin();
-    for (MeshFacetArray::_TConstIterator pFIter = rFacets.begin(); pFIter != rFacets.end(); ++pFIter) {
-        _map[pFIter->_aulPoints[0]].insert(pFIter - pFBegin);
-        _map[pFIter->_aulPoints[1]].insert(pFIter - pFBegin);
-        _map[pFIter->_aulPoints[2]].insert(pFIter - pFBegin);
+    static void SortRows(Block& b)
+    {
+        MeshAdjacencyBuilder& m = *b.builder;
+        for (unsigned long i = b.begin; i < b.end; i++)
+            std::sort(m._index.begin() + m._offsets[i], m._index.begin() + m._offsets[i+1]);
     }
+
+    /// Merges the facets of the three points of facet \a pos into the buffer.
+    static void CollectFacetFacets(MeshAdjacencyBuilder& m, unsigned long pos, std::vector<unsigned long>& buffer)
+    {
+        const MeshIndex* p = m._facets[pos]._aulPoints;
+        MeshIndexRange r0 = (*m._search)[p[0]];
+        MeshIndexRange r1 = (*m._search)[p[1]];
+        MeshIndexRange r2 = (*m._search)[p[2]];
+
+        std::vector<unsigned long> tmp;
+        tmp.reserve(r0.size() + r1.size());
+        std::set_union(r0.begin(), r0.end(), r1.begin(), r1.end(), std::back_inserter(tmp));
+        buffer.clear();
+        std::set_union(tmp.begin(), tmp.end(), r2.begin(), r2.end(), std::back_inserter(buffer));
+    }
+
+    static void CountFacetFacets(Block& b)
+    {
+        MeshAdjacencyBuilder& m = *b.builder;
+        for (unsigned long i = b.begin; i < b.end; i++) {
+            CollectFacetFacets(m, i, b.buffer);
+            m._offsets[i+1] = b.buffer.size();
+        }
+    }
+
+    static void FillFacetFacets(Block& b)
+    {
+        MeshAdjacencyBuilder& m = *b.builder;
+        for (unsigned long i = b.begin; i < b.end; i++) {
+            CollectFacetFacets(m, i, b.buffer);
+            std::copy(b.buffer.begin(), b.buffer.end(), m._index.begin() + m._offsets[i]);
+        }
+    }
+
+private:
+    const MeshFacetArray& _facets;
+    unsigned long _ctRows;
+    std::vector<unsigned long>& _offsets;
+    std::vector<unsigned long>& _index;
+    std::vector<QAtomicInt> _counter;
+    const MeshRefPointToFacets* _search;
+};
+
+/// Returns the range of row \a pos of a neighbourhood structure.
+static inline MeshIndexRange GetIndexRange(const std::vector<unsigned long>& offsets,
+                                           const std::vector<unsigned long>& index,
+                                           unsigned long pos)
+{
+    if (index.empty())
+        return MeshIndexRange();
+    const unsigned long* data = &index[0];
+    return MeshIndexRange(data + offsets[pos], data + offsets[pos+1]);
+}
+
+}
+
+void MeshRefPointToFacets::Rebuild (void)
+{
+    MeshAdjacencyBuilder builder(_rclMesh.GetFacets(), _rclMesh.CountPoints(), _offsets, _index);
+    builder.PointToFacets();
 }
 
 Base::Vector3f MeshRefPointToFacets::GetNormal(unsigned long pos) const
 {
-    const std::set<unsigned long>& n = _map[pos];
+    MeshIndexRange n = (*this)[pos];
     Base::Vector3f normal;
     MeshGeomFacet f;
-    for (std::set<unsigned long>::const_iterator it = n.begin(); it != n.end(); ++it) {
+    for (MeshIndexRange::const_iterator it = n.begin(); it != n.end(); ++it) {
         f = _rclMesh.GetFacet(*it);
         normal += f.Area() * f.GetNormal();
     }
@@ -1733,8 +1992,8 @@ std::set<unsigned long> MeshRefPointToFacets::NeighbourPoints(const std::vector<
     for (int i=0; i < level; i++) {
         std::set<unsigned long> cur;
         for (std::set<unsigned long>::iterator it = lp.begin(); it != lp.end(); ++it) {
-            const std::set<unsigned long>& ft = (*this)[*it];
-            for (std::set<unsigned long>::const_iterator jt = ft.begin(); jt != ft.end(); ++jt) {
+            MeshIndexRange ft = (*this)[*it];
+            for (MeshIndexRange::const_iterator jt = ft.begin(); jt != ft.end(); ++jt) {
                 for (int j = 0; j < 3; j++) {
                     unsigned long index = f_it[*jt]._aulPoints[j];
                     if (cp.find(index) == cp.end() && nb.find(index) == nb.end()) {
@@ -1774,9 +2033,9 @@ void MeshRefPointToFacets::SearchNeighbours(const MeshFacetArray& rFacets, unsig
     visited.insert(index);
     collect.Append(_rclMesh, index);
     for (int i = 0; i < 3; i++) {
-        const std::set<unsigned long> &f = (*this)[face._aulPoints[i]];
+        MeshIndexRange f = (*this)[face._aulPoints[i]];
 
-        for (std::set<unsigned long>::const_iterator j = f.begin(); j != f.end(); ++j) {
+        for (MeshIndexRange::const_iterator j = f.begin(); j != f.end(); ++j) {
             SearchNeighbours(rFacets, *j, rclCenter, fMaxDist2, visited, collect);
         }
     }
@@ -1788,70 +2047,33 @@ MeshRefPointToFacets::GetFacet (unsigned long index) const
     return _rclMesh.GetFacets().begin() + index;
 }
 
-const std::set<unsigned long>&
+MeshIndexRange
 MeshRefPointToFacets::operator[] (unsigned long pos) const
 {
-    return _map[pos];
-}
-
-void MeshRefPointToFacets::AddNeighbour(unsigned long pos, unsigned long facet)
-{
-    _map[pos].insert(facet);
-}
-
-void MeshRefPointToFacets::RemoveNeighbour(unsigned long pos, unsigned long facet)
-{
-    _map[pos].erase(facet);
+    return GetIndexRange(_offsets, _index, pos);
 }
 
 //----------------------------------------------------------------------------
 
 void MeshRefFacetToFacets::Rebuild (void)
 {
-    _map.clear();
-
-    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
-    _map.resize(rFacets.size());
-
     MeshRefPointToFacets  vertexFace(_rclMesh);
-    MeshFacetArray::_TConstIterator pFBegin = rFacets.begin();
-    for (MeshFacetArray::_TConstIterator pFIter = pFBegin; pFIter != rFacets.end(); ++pFIter) {
-        for (int i = 0; i < 3; i++) {
-            const std::set<unsigned long>& faces = vertexFace[pFIter->_aulPoints[i]];
-            for (std::set<unsigned long>::const_iterator it = faces.begin(); it != faces.end(); ++it)
-                _map[pFIter - pFBegin].insert(*it);
-        }
-    }
+    MeshAdjacencyBuilder builder(_rclMesh.GetFacets(), _rclMesh.CountFacets(), _offsets, _index);
+    builder.FacetToFacets(vertexFace);
 }
 
-const std::set<unsigned long>&
+MeshIndexRange
 MeshRefFacetToFacets::operator[] (unsigned long pos) const
 {
-    return _map[pos];
+    return GetIndexRange(_offsets, _index, pos);
 }
 
 //----------------------------------------------------------------------------
 
 void MeshRefPointToPoints::Rebuild (void)
 {
-    _map.clear();
-
-    const MeshPointArray& rPoints = _rclMesh.GetPoints();
-    _map.resize(rPoints.size());
-
-    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
-    for (MeshFacetArray::_TConstIterator pFIter = rFacets.begin(); pFIter != rFacets.end(); ++pFIter) {
-        unsigned long ulP0 = pFIter->_aulPoints[0];
-        unsigned long ulP1 = pFIter->_aulPoints[1];
-        unsigned long ulP2 = pFIter->_aulPoints[2];
-
-        _map[ulP0].insert(ulP1);
-        _map[ulP0].insert(ulP2);
-        _map[ulP1].insert(ulP0);
-        _map[ulP1].insert(ulP2);
-        _map[ulP2].insert(ulP0);
-        _map[ulP2].insert(ulP1);
-    }
+    MeshAdjacencyBuilder builder(_rclMesh.GetFacets(), _rclMesh.CountPoints(), _offsets, _index);
+    builder.PointToPoints();
 }
 
 Base::Vector3f MeshRefPointToPoints::GetNormal(unsigned long pos) const
@@ -1860,8 +2082,8 @@ Base::Vector3f MeshRefPointToPoints::GetNormal(unsigned long pos) const
     MeshCore::PlaneFit pf;
     pf.AddPoint(rPoints[pos]);
     MeshCore::MeshPoint center = rPoints[pos];
-    const std::set<unsigned long>& cv = _map[pos];
-    for (std::set<unsigned long>::const_iterator cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
+    MeshIndexRange cv = (*this)[pos];
+    for (MeshIndexRange::const_iterator cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
         pf.AddPoint(rPoints[*cv_it]);
         center += rPoints[*cv_it];
     }
@@ -1877,28 +2099,18 @@ float MeshRefPointToPoints::GetAverageEdgeLength(unsigned long index) const
 {
     const MeshPointArray& rPoints = _rclMesh.GetPoints();
     float len=0.0f;
-    const std::set<unsigned long>& n = (*this)[index];
+    MeshIndexRange n = (*this)[index];
     const Base::Vector3f& p = rPoints[index];
-    for (std::set<unsigned long>::const_iterator it = n.begin(); it != n.end(); ++it) {
+    for (MeshIndexRange::const_iterator it = n.begin(); it != n.end(); ++it) {
         len += Base::Distance(p, rPoints[*it]);
     }
     return (len/n.size());
 }
 
-const std::set<unsigned long>&
+MeshIndexRange
 MeshRefPointToPoints::operator[] (unsigned long pos) const
 {
-    return _map[pos];
-}
-
-void MeshRefPointToPoints::AddNeighbour(unsigned long pos, unsigned long facet)
-{
-    _map[pos].insert(facet);
-}
-
-void MeshRefPointToPoints::RemoveNeighbour(unsigned long pos, unsigned long facet)
-{
-    _map[pos].erase(facet);
+    return GetIndexRange(_offsets, _index, pos);
 }
 
 //----------------------------------------------------------------------------
@@ -24,6 +24,7 @@
 #ifndef MESHALGORITHM_H
 #define MESHALGORITHM_H
 
+#include <algorithm>
 #include <set>
 #include <vector>
 #include <map>
@@ -45,6 +46,7 @@ class MeshGeomFacet;
 class MeshGeomEdge;
 class MeshKernel;
 class MeshFacetGrid;
+class MeshFacetTree;
 class MeshFacetArray;
 class MeshRefPointToFacets;
 class AbstractPolygonTriangulator;
@@ -100,6 +102,14 @@ public:
    */
   bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, float fMaxSearchArea,
                           const MeshFacetGrid &rclGrid, Base::Vector3f &rclRes, unsigned long &rulFacet) const;
+  /**
+   * Searches for the nearest facet to the ray defined by (\a rclPt, \a rclDir) using the bounding volume
+   * hierarchy \a rclTree. Only facets in direction of the ray are taken into account.
+   * \note Unlike the grid the tree adapts to the facet density, so this method should be preferred
+   * for meshes with very uneven facet sizes.
+   */
+  bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const MeshFacetTree &rclTree,
+                          Base::Vector3f &rclRes, unsigned long &rulFacet) const;
   /**
    * Searches for the first facet of the grid element (\a rclGrid) in that the point \a rclPt lies into which is a distance not
    * higher than \a fMaxDistance. Of no such facet is found \a rulFacet is undefined and false is returned, otherwise true.
@@ -276,6 +286,10 @@ public:
                               unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
   bool NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetGrid& rclGrid, float fMaxSearchArea,
                               unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
+  bool NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetTree& rclTree,
+                              unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
+  bool NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetTree& rclTree, float fMaxSearchArea,
+                              unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
   /** Cuts the mesh with a plane. The result is a list of polylines. */
   bool CutWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const MeshFacetGrid &rclGrid,
                      std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps = 1.0e-2f, bool bConnectPolygons = false) const;
@@ -295,13 +309,13 @@ public:
    * built up. The minimum grid length must be at least \a fLength.
    */
   float CalculateMinimumGridLength(float fLength, const Base::BoundBox3f& rBBox, unsigned long maxElements) const;
-   
-protected:
   /** Helper method to connect the intersection points to polylines. */
   bool ConnectLines (std::list<std::pair<Base::Vector3f, Base::Vector3f> > &rclLines, std::list<std::vector<Base::Vector3f> >&rclPolylines,
                     float fMinEps) const;
   bool ConnectPolygons(std::list<std::vector<Base::Vector3f> > &clPolyList, std::list<std::pair<Base::Vector3f,
                        Base::Vector3f> > &rclLines) const;
+   
+protected:
   /** Searches the nearest facet in \a raulFacets to the ray (\a rclPt, \a rclDir). */
   bool RayNearestField (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const std::vector<unsigned long> &raulFacets,
                         Base::Vector3f &rclRes, unsigned long &rulFacet, float fMaxAngle = F_PI) const;
@@ -354,6 +368,45 @@ private:
     std::vector<unsigned long>& indices;
 };
 
+/**
+ * The MeshIndexRange gives read access to the sorted indices of one entry of the
+ * neighbourhood structures below. It provides the part of the interface of
+ * std::set<unsigned long> that is needed to iterate over or to search for indices.
+ * \note The range becomes invalid if the structure it belongs to is rebuilt or destroyed.
+ */
+class MeshIndexRange
+{
+public:
+    typedef const unsigned long* const_iterator;
+    typedef const_iterator iterator;
+    typedef unsigned long value_type;
+
+    MeshIndexRange() : _begin(0), _end(0)
+    { }
+    MeshIndexRange(const_iterator first, const_iterator last) : _begin(first), _end(last)
+    { }
+
+    const_iterator begin() const
+    { return _begin; }
+    const_iterator end() const
+    { return _end; }
+    std::size_t size() const
+    { return _end - _begin; }
+    bool empty() const
+    { return _begin == _end; }
+    /// Returns the position of \a index or end() if it's not part of the range.
+    const_iterator find(unsigned long index) const
+    {
+        const_iterator it = std::lower_bound(_begin, _end, index);
+        return (it != _end && *it == index) ? it : _end;
+    }
+    std::size_t count(unsigned long index) const
+    { return find(index) != _end ? 1 : 0; }
+
+private:
+    const_iterator _begin, _end;
+};
+
 /**
  * The MeshRefPointToFacets builds up a structure to have access to all facets indexing
  * a point.
@@ -372,13 +425,12 @@ public:
 
     /// Rebuilds up data structure
     void Rebuild (void);
-    const std::set<unsigned long>& operator[] (unsigned long) const;
+    /// Returns the facets indexing the point in ascending order.
+    MeshIndexRange operator[] (unsigned long) const;
     MeshFacetArray::_TConstIterator GetFacet (unsigned long) const;
     std::set<unsigned long> NeighbourPoints(const std::vector<unsigned long>& , int level) const;
     void Neighbours (unsigned long ulFacetInd, float fMaxDist, MeshCollector& collect) const;
     Base::Vector3f GetNormal(unsigned long) const;
-    void AddNeighbour(unsigned long, unsigned long);
-    void RemoveNeighbour(unsigned long, unsigned long);
 
 protected:
     void SearchNeighbours(const MeshFacetArray& rFacets, unsigned long index, const Base::Vector3f &rclCenter, 
@@ -386,7 +438,8 @@ protected:
 
 protected:
     const MeshKernel  &_rclMesh; /**< The mesh kernel. */
-    std::vector<std::set<unsigned long> > _map;
+    std::vector<unsigned long> _offsets; /**< Start of the facets of each point in _index. */
+    std::vector<unsigned long> _index;   /**< The facets of all points. */
 };
 
 /**
@@ -409,11 +462,12 @@ public:
 
     /// Returns a set of facets sharing one or more points with the facet with
     /// index \a ulFacetIndex.
-    const std::set<unsigned long>& operator[] (unsigned long) const;
+    MeshIndexRange operator[] (unsigned long) const;
 
 protected:
     const MeshKernel  &_rclMesh; /**< The mesh kernel. */
-    std::vector<std::set<unsigned long> > _map;
+    std::vector<unsigned long> _offsets; /**< Start of the neighbours of each facet in _index. */
+    std::vector<unsigned long> _index;   /**< The neighbour facets of all facets. */
 };
 
 /**
@@ -434,15 +488,15 @@ public:
 
     /// Rebuilds up data structure
     void Rebuild (void);
-    const std::set<unsigned long>& operator[] (unsigned long) const;
+    /// Returns the neighbour points in ascending order.
+    MeshIndexRange operator[] (unsigned long) const;
     Base::Vector3f GetNormal(unsigned long) const;
     float GetAverageEdgeLength(unsigned long) const;
-    void AddNeighbour(unsigned long, unsigned long);
-    void RemoveNeighbour(unsigned long, unsigned long);
 
 protected:
     const MeshKernel  &_rclMesh; /**< The mesh kernel. */
-    std::vector<std::set<unsigned long> > _map;
+    std::vector<unsigned long> _offsets; /**< Start of the neighbours of each point in _index. */
+    std::vector<unsigned long> _index;   /**< The neighbour points of all points. */
 };
 
 /**
@@ -0,0 +1,1577 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <cfloat>
+# include <climits>
+# include <cmath>
+# include <map>
+#endif
+
+#include <QtConcurrentMap>
+
+#include "Boolean.h"
+#include "MeshKernel.h"
+#include "Elements.h"
+#include "Definitions.h"
+#include "Tree.h"
+
+using namespace MeshCore;
+
+namespace {
+
+// ----------------------------------------------------------------------------
+// Robust orientation predicates
+//
+// The predicates first evaluate the determinant in double precision and only if
+// the result is smaller than the error bound it's evaluated exactly with floating
+// point expansions. See J.R. Shewchuk: Adaptive Precision Floating-Point Arithmetic
+// and Fast Robust Geometric Predicates.
+// ----------------------------------------------------------------------------
+
+typedef std::vector<double> Expansion;
+
+inline void TwoSum(double a, double b, double& x, double& y)
+{
+    x = a + b;
+    double bv = x - a;
+    double av = x - bv;
+    y = (a - av) + (b - bv);
+}
+
+inline void FastTwoSum(double a, double b, double& x, double& y)
+{
+    x = a + b;
+    y = b - (x - a);
+}
+
+inline void TwoDiff(double a, double b, double& x, double& y)
+{
+    x = a - b;
+    double bv = a - x;
+    double av = x + bv;
+    y = (a - av) + (bv - b);
+}
+
+inline void Split(double a, double& hi, double& lo)
+{
+    const double splitter = 134217729.0; // 2^27 + 1
+    double c = splitter * a;
+    double abig = c - a;
+    hi = c - abig;
+    lo = a - hi;
+}
+
+inline void TwoProduct(double a, double b, double& x, double& y)
+{
+    x = a * b;
+    double ahi, alo, bhi, blo;
+    Split(a, ahi, alo);
+    Split(b, bhi, blo);
+    double err1 = x - (ahi * bhi);
+    double err2 = err1 - (alo * bhi);
+    double err3 = err2 - (ahi * blo);
+    y = (alo * blo) - err3;
+}
+
+// Adds a double to an expansion, zero components are eliminated
+Expansion Grow(const Expansion& e, double b)
+{
+    Expansion h;
+    h.reserve(e.size() + 1);
+    double q = b, qnew, hh;
+    for (Expansion::const_iterator it = e.begin(); it != e.end(); ++it) {
+        TwoSum(q, *it, qnew, hh);
+        q = qnew;
+        if (hh != 0.0)
+            h.push_back(hh);
+    }
+    if (q != 0.0 || h.empty())
+        h.push_back(q);
+    return h;
+}
+
+Expansion Sum(const Expansion& e, const Expansion& f)
+{
+    Expansion h = e;
+    for (Expansion::const_iterator it = f.begin(); it != f.end(); ++it)
+        h = Grow(h, *it);
+    return h;
+}
+
+Expansion Scale(const Expansion& e, double b)
+{
+    Expansion h;
+    if (e.empty())
+        return h;
+    h.reserve(2 * e.size());
+    double q, hh, sum, p0, p1;
+    TwoProduct(e[0], b, q, hh);
+    if (hh != 0.0)
+        h.push_back(hh);
+    for (std::size_t i = 1; i < e.size(); i++) {
+        TwoProduct(e[i], b, p1, p0);
+        TwoSum(q, p0, sum, hh);
+        if (hh != 0.0)
+            h.push_back(hh);
+        FastTwoSum(p1, sum, q, hh);
+        if (hh != 0.0)
+            h.push_back(hh);
+    }
+    if (q != 0.0 || h.empty())
+        h.push_back(q);
+    return h;
+}
+
+Expansion Product(const Expansion& e, const Expansion& f)
+{
+    Expansion h;
+    for (Expansion::const_iterator it = f.begin(); it != f.end(); ++it)
+        h = Sum(h, Scale(e, *it));
+    return h;
+}
+
+Expansion Negate(const Expansion& e)
+{
+    Expansion h(e);
+    for (Expansion::iterator it = h.begin(); it != h.end(); ++it)
+        *it = -*it;
+    return h;
+}
+
+Expansion Difference(double a, double b)
+{
+    double x, y;
+    TwoDiff(a, b, x, y);
+    Expansion e;
+    if (y != 0.0)
+        e.push_back(y);
+    if (x != 0.0)
+        e.push_back(x);
+    return e;
+}
+
+// The components are sorted by magnitude, so the sign is the one of the last component
+inline int Sign(const Expansion& e)
+{
+    if (e.empty() || e.back() == 0.0)
+        return 0;
+    return e.back() > 0.0 ? 1 : -1;
+}
+
+struct Point2d
+{
+    double x, y;
+};
+
+// Returns 1 if c lies left of the directed line a-b, -1 if it lies right of it and 0 if
+// the three points are collinear.
+int Orient2D(const Point2d& a, const Point2d& b, const Point2d& c)
+{
+    double detleft = (a.x - c.x) * (b.y - c.y);
+    double detright = (a.y - c.y) * (b.x - c.x);
+    double det = detleft - detright;
+    double errbound = 3.3306690738754716e-16 * (std::fabs(detleft) + std::fabs(detright));
+    if (det > errbound)
+        return 1;
+    if (-det > errbound)
+        return -1;
+
+    Expansion l = Product(Difference(a.x, c.x), Difference(b.y, c.y));
+    Expansion r = Product(Difference(a.y, c.y), Difference(b.x, c.x));
+    return Sign(Sum(l, Negate(r)));
+}
+
+// Returns 1 if d lies on the side of the plane through a, b, c the normal (b-a)x(c-a)
+// points to, -1 if it lies on the other side and 0 if the four points are coplanar.
+int Orient3D(const Base::Vector3d& a, const Base::Vector3d& b,
+             const Base::Vector3d& c, const Base::Vector3d& d)
+{
+    double adx = a.x - d.x, bdx = b.x - d.x, cdx = c.x - d.x;
+    double ady = a.y - d.y, bdy = b.y - d.y, cdy = c.y - d.y;
+    double adz = a.z - d.z, bdz = b.z - d.z, cdz = c.z - d.z;
+
+    double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady, adxcdy = adx * cdy;
+    double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+    double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * std::fabs(adz)
+                     + (std::fabs(cdxady) + std::fabs(adxcdy)) * std::fabs(bdz)
+                     + (std::fabs(adxbdy) + std::fabs(bdxady)) * std::fabs(cdz);
+    double errbound = 7.7715611723761027e-16 * permanent;
+    if (det > errbound)
+        return -1;
+    if (-det > errbound)
+        return 1;
+
+    Expansion eadx = Difference(a.x, d.x), ebdx = Difference(b.x, d.x), ecdx = Difference(c.x, d.x);
+    Expansion eady = Difference(a.y, d.y), ebdy = Difference(b.y, d.y), ecdy = Difference(c.y, d.y);
+    Expansion eadz = Difference(a.z, d.z), ebdz = Difference(b.z, d.z), ecdz = Difference(c.z, d.z);
+
+    Expansion bc = Sum(Product(ebdx, ecdy), Negate(Product(ecdx, ebdy)));
+    Expansion ca = Sum(Product(ecdx, eady), Negate(Product(eadx, ecdy)));
+    Expansion ab = Sum(Product(eadx, ebdy), Negate(Product(ebdx, eady)));
+    Expansion e = Sum(Sum(Product(bc, eadz), Product(ca, ebdz)), Product(ab, ecdz));
+    return -Sign(e);
+}
+
+// True if all values have the same sign and are not zero
+inline bool SameSide(const int o[3])
+{
+    return (o[0] > 0 && o[1] > 0 && o[2] > 0) || (o[0] < 0 && o[1] < 0 && o[2] < 0);
+}
+
+// True if no two values have opposite signs
+inline bool NoSignChange(const int s[3])
+{
+    return (s[0] >= 0 && s[1] >= 0 && s[2] >= 0) || (s[0] <= 0 && s[1] <= 0 && s[2] <= 0);
+}
+
+// Returns the index of the coordinate that is dropped to project a facet with
+// normal n onto a plane. Projecting is exact and keeps all orientations.
+inline int DominantAxis(const Base::Vector3d& n)
+{
+    double x = std::fabs(n.x), y = std::fabs(n.y), z = std::fabs(n.z);
+    if (x >= y && x >= z)
+        return 0;
+    if (y >= z)
+        return 1;
+    return 2;
+}
+
+inline Point2d Project(const Base::Vector3d& v, int axis)
+{
+    Point2d p;
+    switch (axis) {
+    case 0: p.x = v.y; p.y = v.z; break;
+    case 1: p.x = v.z; p.y = v.x; break;
+    default: p.x = v.x; p.y = v.y; break;
+    }
+    return p;
+}
+
+inline Base::Vector3d Normal(const Base::Vector3d& a, const Base::Vector3d& b, const Base::Vector3d& c)
+{
+    return (b - a) % (c - a);
+}
+
+// Tests if the point \a p lies in the triangle \a t which must be oriented counterclockwise
+// in 2D. Returns false if the point is outside. Otherwise \a edge is the index of the edge the
+// point lies on (or -1), \a vertex the index of the corner it coincides with (or -1).
+bool InTriangle(const Point2d t[3], const Point2d& p, int& edge, int& vertex)
+{
+    int o[3];
+    int zeros = 0;
+    for (int k = 0; k < 3; k++) {
+        o[k] = Orient2D(t[k], t[(k+1)%3], p);
+        if (o[k] < 0)
+            return false;
+        if (o[k] == 0)
+            zeros++;
+    }
+
+    edge = -1;
+    vertex = -1;
+    if (zeros == 1) {
+        for (int k = 0; k < 3; k++) {
+            if (o[k] == 0)
+                edge = k;
+        }
+    }
+    else if (zeros == 2) {
+        // the point is the common corner of the two edges
+        for (int k = 0; k < 3; k++) {
+            if (o[k] != 0)
+                vertex = (k+2)%3;
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ * Triangulation of the points of a facet in 2D that contains a set of segments
+ * as edges. The triangles are kept counterclockwise. The number of points of a
+ * facet is small so the triangles are searched linearly.
+ */
+class PlanarTriangulation
+{
+public:
+    struct Tri
+    {
+        int v[3];
+    };
+
+    std::vector<Point2d> points;
+    std::vector<Tri> tris;
+
+    void AddTriangle(int a, int b, int c)
+    {
+        Tri t;
+        t.v[0] = a; t.v[1] = b; t.v[2] = c;
+        tris.push_back(t);
+    }
+
+    /// Returns the triangle with the directed edge a-b and the position of a in it
+    int FindEdge(int a, int b, int& pos) const
+    {
+        for (std::size_t i = 0; i < tris.size(); i++) {
+            for (int k = 0; k < 3; k++) {
+                if (tris[i].v[k] == a && tris[i].v[(k+1)%3] == b) {
+                    pos = k;
+                    return (int)i;
+                }
+            }
+        }
+        return -1;
+    }
+
+    bool HasEdge(int a, int b) const
+    {
+        int pos;
+        return FindEdge(a, b, pos) >= 0 || FindEdge(b, a, pos) >= 0;
+    }
+
+    /// Splits the triangles at the edge a-b with the point p lying on it
+    void SplitEdge(int a, int b, int p)
+    {
+        for (int dir = 0; dir < 2; dir++) {
+            int pos;
+            int u = dir == 0 ? a : b;
+            int w = dir == 0 ? b : a;
+            int t = FindEdge(u, w, pos);
+            if (t < 0)
+                continue;
+            int x = tris[t].v[(pos+2)%3];
+            tris[t].v[0] = u; tris[t].v[1] = p; tris[t].v[2] = x;
+            AddTriangle(p, w, x);
+        }
+    }
+
+    /// Inserts the point p and returns p or the vertex it coincides with
+    int InsertPoint(int p)
+    {
+        const Point2d& pt = points[p];
+        for (std::size_t i = 0; i < tris.size(); i++) {
+            Tri t = tris[i];
+            int o[3];
+            o[0] = Orient2D(points[t.v[1]], points[t.v[2]], pt);
+            o[1] = Orient2D(points[t.v[2]], points[t.v[0]], pt);
+            o[2] = Orient2D(points[t.v[0]], points[t.v[1]], pt);
+            if (o[0] < 0 || o[1] < 0 || o[2] < 0)
+                continue;
+
+            int zeros = (o[0] == 0) + (o[1] == 0) + (o[2] == 0);
+            if (zeros == 2) {
+                for (int k = 0; k < 3; k++) {
+                    if (o[k] != 0)
+                        return t.v[k];
+                }
+            }
+            else if (zeros == 1) {
+                for (int k = 0; k < 3; k++) {
+                    if (o[k] == 0)
+                        SplitEdge(t.v[(k+1)%3], t.v[(k+2)%3], p);
+                }
+            }
+            else {
+                tris[i].v[2] = p;
+                AddTriangle(t.v[1], t.v[2], p);
+                AddTriangle(t.v[2], t.v[0], p);
+            }
+            return p;
+        }
+
+        // Due to rounding the point is slightly outside, so put it onto the nearest border edge
+        double minDist = DBL_MAX;
+        int ea = -1, eb = -1;
+        for (std::size_t i = 0; i < tris.size(); i++) {
+            for (int k = 0; k < 3; k++) {
+                int a = tris[i].v[k], b = tris[i].v[(k+1)%3], pos;
+                if (FindEdge(b, a, pos) >= 0)
+                    continue;
+                double dist = DistanceToSegment(pt, points[a], points[b]);
+                if (dist < minDist) {
+                    minDist = dist;
+                    ea = a;
+                    eb = b;
+                }
+            }
+        }
+        if (ea >= 0)
+            SplitEdge(ea, eb, p);
+        return p;
+    }
+
+    /// Makes the segment u-v to an edge of the triangulation by flipping edges
+    bool InsertSegment(int u, int v, const std::vector<bool>& used)
+    {
+        if (u == v || HasEdge(u, v))
+            return true;
+
+        // a vertex on the segment splits it into two parts
+        const Point2d& pu = points[u];
+        const Point2d& pv = points[v];
+        for (std::size_t w = 0; w < points.size(); w++) {
+            if ((int)w == u || (int)w == v || !used[w])
+                continue;
+            const Point2d& pw = points[w];
+            if (Orient2D(pu, pv, pw) != 0)
+                continue;
+            double d1 = (pw.x - pu.x) * (pv.x - pu.x) + (pw.y - pu.y) * (pv.y - pu.y);
+            double d2 = (pw.x - pv.x) * (pu.x - pv.x) + (pw.y - pv.y) * (pu.y - pv.y);
+            if (d1 > 0.0 && d2 > 0.0)
+                return InsertSegment(u, (int)w, used) && InsertSegment((int)w, v, used);
+        }
+
+        std::vector<std::pair<int, int> > crossing;
+        for (std::size_t i = 0; i < tris.size(); i++) {
+            for (int k = 0; k < 3; k++) {
+                int x = tris[i].v[k], y = tris[i].v[(k+1)%3];
+                if (x < y && Crosses(x, y, u, v))
+                    crossing.push_back(std::make_pair(x, y));
+            }
+        }
+
+        std::size_t iterations = 0;
+        std::size_t maxIterations = 10 * (crossing.size() + 1) * (crossing.size() + 1) + 100;
+        std::size_t front = 0;
+        while (front < crossing.size()) {
+            if (++iterations > maxIterations)
+                return false;
+            std::pair<int, int> e = crossing[front++];
+            int x = e.first, y = e.second, pos1, pos2;
+            int t1 = FindEdge(x, y, pos1);
+            int t2 = FindEdge(y, x, pos2);
+            if (t1 < 0 || t2 < 0)
+                return false;
+            int a = tris[t1].v[(pos1+2)%3];
+            int b = tris[t2].v[(pos2+2)%3];
+            if (Crosses(a, b, x, y)) {
+                // the quadrilateral x, b, y, a is convex
+                tris[t1].v[0] = a; tris[t1].v[1] = x; tris[t1].v[2] = b;
+                tris[t2].v[0] = b; tris[t2].v[1] = y; tris[t2].v[2] = a;
+                if (Crosses(a, b, u, v))
+                    crossing.push_back(std::make_pair(a, b));
+            }
+            else {
+                crossing.push_back(e);
+            }
+        }
+
+        return HasEdge(u, v);
+    }
+
+private:
+    // True if the open segments a-b and c-d properly cross each other
+    bool Crosses(int a, int b, int c, int d) const
+    {
+        if (a == c || a == d || b == c || b == d)
+            return false;
+        int o1 = Orient2D(points[c], points[d], points[a]);
+        int o2 = Orient2D(points[c], points[d], points[b]);
+        if (o1 * o2 >= 0)
+            return false;
+        int o3 = Orient2D(points[a], points[b], points[c]);
+        int o4 = Orient2D(points[a], points[b], points[d]);
+        return o3 * o4 < 0;
+    }
+
+    static double DistanceToSegment(const Point2d& p, const Point2d& a, const Point2d& b)
+    {
+        double dx = b.x - a.x, dy = b.y - a.y;
+        double len = dx * dx + dy * dy;
+        double t = len > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len : 0.0;
+        t = std::max<double>(0.0, std::min<double>(1.0, t));
+        double ex = a.x + t * dx - p.x, ey = a.y + t * dy - p.y;
+        return ex * ex + ey * ey;
+    }
+};
+
+const unsigned long BlockSize = 4096;
+
+}
+
+// ----------------------------------------------------------------------------
+
+namespace MeshCore {
+/** A point of the intersection of two facets. \a edge and \a vertex are the edge and
+ * corner of each facet the point lies on or -1. */
+struct MeshBoolean::Hit
+{
+    PointKey key;
+    int edge[2];
+    int vertex[2];
+};
+
+struct MeshBoolean::Range
+{
+    MeshBoolean* self;
+    unsigned long begin, end;
+    std::vector<PointRecord> points;
+    std::vector<SegmentRecord> segments;
+    std::vector<std::pair<unsigned long, unsigned long> > partners;
+    std::vector<std::pair<unsigned long, unsigned long> > aliases;
+};
+
+/** A region of facets of one mesh that is not cut by the other mesh. */
+struct MeshBoolean::Component
+{
+    const MeshBoolean* self;
+    int side;
+    Base::Vector3f point;
+    int state;
+};
+}
+
+bool MeshBoolean::PointKey::operator < (const PointKey& k) const
+{
+    if (type != k.type)
+        return type < k.type;
+    for (int i = 0; i < 4; i++) {
+        if (index[i] != k.index[i])
+            return index[i] < k.index[i];
+    }
+    return false;
+}
+
+bool MeshBoolean::PointKey::operator == (const PointKey& k) const
+{
+    return type == k.type && index[0] == k.index[0] && index[1] == k.index[1] &&
+           index[2] == k.index[2] && index[3] == k.index[3];
+}
+
+bool MeshBoolean::PointRecord::operator < (const PointRecord& r) const
+{
+    if (facet != r.facet)
+        return facet < r.facet;
+    return key < r.key;
+}
+
+bool MeshBoolean::PointRecord::operator == (const PointRecord& r) const
+{
+    return facet == r.facet && key == r.key;
+}
+
+namespace {
+typedef std::pair<unsigned long, unsigned long> IndexPair;
+
+inline IndexPair MakeEdge(unsigned long p, unsigned long q)
+{
+    return p < q ? IndexPair(p, q) : IndexPair(q, p);
+}
+}
+
+// ----------------------------------------------------------------------------
+
+MeshBoolean::MeshBoolean(const MeshKernel& cutMesh1, const MeshKernel& cutMesh2,
+                         MeshKernel& result, SetOperations::OperationType opType)
+  : _cutMesh0(cutMesh1)
+  , _cutMesh1(cutMesh2)
+  , _resultMesh(result)
+  , _operationType(opType)
+  , _ctPoints0(0)
+  , _ctFacets0(0)
+{
+    _trees[0] = 0;
+    _trees[1] = 0;
+}
+
+MeshBoolean::~MeshBoolean()
+{
+    delete _trees[0];
+    delete _trees[1];
+}
+
+unsigned long MeshBoolean::CountFailedFacets() const
+{
+    unsigned long count = 0;
+    for (std::vector<FacetCut>::const_iterator it = _cuts.begin(); it != _cuts.end(); ++it) {
+        if (it->failed)
+            count++;
+    }
+    return count;
+}
+
+void MeshBoolean::Do()
+{
+    Initialize();
+    Intersect();
+    Classify();
+    CreateResult();
+}
+
+void MeshBoolean::Initialize()
+{
+    const MeshPointArray& rPoints0 = _cutMesh0.GetPoints();
+    const MeshPointArray& rPoints1 = _cutMesh1.GetPoints();
+    _ctPoints0 = rPoints0.size();
+    _ctFacets0 = _cutMesh0.CountFacets();
+
+    _points.clear();
+    _points.reserve(rPoints0.size() + rPoints1.size());
+    for (MeshPointArray::_TConstIterator it = rPoints0.begin(); it != rPoints0.end(); ++it)
+        _points.push_back(Base::Vector3d(it->x, it->y, it->z));
+    for (MeshPointArray::_TConstIterator it = rPoints1.begin(); it != rPoints1.end(); ++it)
+        _points.push_back(Base::Vector3d(it->x, it->y, it->z));
+
+    _alias.resize(_points.size());
+    for (unsigned long i = 0; i < _alias.size(); i++)
+        _alias[i] = i;
+
+    unsigned long ctFacets = _ctFacets0 + _cutMesh1.CountFacets();
+    _degenerated.resize(ctFacets);
+    for (unsigned long i = 0; i < ctFacets; i++)
+        _degenerated[i] = IsDegenerated(i);
+
+    _cutKeys.clear();
+    _cuts.clear();
+    _cutIndex.assign(ctFacets, ULONG_MAX);
+    _barriers.clear();
+
+    delete _trees[0];
+    delete _trees[1];
+    _trees[0] = new MeshFacetTree(_cutMesh0);
+    _trees[1] = new MeshFacetTree(_cutMesh1);
+}
+
+void MeshBoolean::GetCorners(unsigned long ulFacet, unsigned long aulPoints[3]) const
+{
+    if (ulFacet < _ctFacets0) {
+        const MeshFacet& f = _cutMesh0.GetFacets()[ulFacet];
+        for (int i = 0; i < 3; i++)
+            aulPoints[i] = f._aulPoints[i];
+    }
+    else {
+        const MeshFacet& f = _cutMesh1.GetFacets()[ulFacet - _ctFacets0];
+        for (int i = 0; i < 3; i++)
+            aulPoints[i] = f._aulPoints[i] + _ctPoints0;
+    }
+}
+
+bool MeshBoolean::IsDegenerated(unsigned long ulFacet) const
+{
+    unsigned long c[3];
+    GetCorners(ulFacet, c);
+    for (int axis = 0; axis < 3; axis++) {
+        Point2d p0 = Project(_points[c[0]], axis);
+        Point2d p1 = Project(_points[c[1]], axis);
+        Point2d p2 = Project(_points[c[2]], axis);
+        if (Orient2D(p0, p1, p2) != 0)
+            return false;
+    }
+    return true;
+}
+
+Base::Vector3d MeshBoolean::GetPosition(const PointKey& key) const
+{
+    if (key.type == PointKey::Vertex)
+        return _points[key.index[0]];
+
+    const Base::Vector3d& p = _points[key.index[0]];
+    const Base::Vector3d& q = _points[key.index[1]];
+    double t = 0.5;
+    if (key.type == PointKey::EdgeFacet) {
+        unsigned long c[3];
+        GetCorners(key.index[2], c);
+        Base::Vector3d n = Normal(_points[c[0]], _points[c[1]], _points[c[2]]);
+        double dp = n * (p - _points[c[0]]);
+        double dq = n * (q - _points[c[0]]);
+        if (dp != dq)
+            t = dp / (dp - dq);
+    }
+    else {
+        const Base::Vector3d& r = _points[key.index[2]];
+        const Base::Vector3d& s = _points[key.index[3]];
+        Base::Vector3d d1 = q - p, d2 = s - r;
+        Base::Vector3d n = d1 % d2;
+        double len = n.Sqr();
+        if (len > 0.0)
+            t = ((r - p) % d2) * n / len;
+    }
+
+    t = std::max<double>(0.0, std::min<double>(1.0, t));
+    return p + (q - p) * t;
+}
+
+unsigned long MeshBoolean::FindAlias(unsigned long index) const
+{
+    return _alias[index];
+}
+
+unsigned long MeshBoolean::GetPointIndex(const PointKey& key) const
+{
+    if (key.type == PointKey::Vertex)
+        return _alias[key.index[0]];
+    std::vector<PointKey>::const_iterator it = std::lower_bound(_cutKeys.begin(), _cutKeys.end(), key);
+    return _alias.size() + (it - _cutKeys.begin());
+}
+
+// ----------------------------------------------------------------------------
+
+void MeshBoolean::Intersect()
+{
+    std::vector<Range> ranges;
+    for (unsigned long i = 0; i < _ctFacets0; i += BlockSize) {
+        Range r;
+        r.self = this;
+        r.begin = i;
+        r.end = std::min<unsigned long>(i + BlockSize, _ctFacets0);
+        ranges.push_back(r);
+    }
+
+    if (ranges.size() > 1)
+        QtConcurrent::blockingMap(ranges, &MeshBoolean::IntersectRange);
+    else
+        std::for_each(ranges.begin(), ranges.end(), &MeshBoolean::IntersectRange);
+
+    // merge the results in a fixed order
+    std::vector<PointRecord> points;
+    std::vector<SegmentRecord> segments;
+    std::vector<IndexPair> partners, aliases;
+    for (std::vector<Range>::iterator it = ranges.begin(); it != ranges.end(); ++it) {
+        points.insert(points.end(), it->points.begin(), it->points.end());
+        segments.insert(segments.end(), it->segments.begin(), it->segments.end());
+        partners.insert(partners.end(), it->partners.begin(), it->partners.end());
+        aliases.insert(aliases.end(), it->aliases.begin(), it->aliases.end());
+    }
+    ranges.clear();
+
+    CreatePoints(points, segments, partners, aliases);
+
+    // every cut facet is retriangulated independently
+    for (unsigned long i = 0; i < _cuts.size(); i += BlockSize / 16) {
+        Range r;
+        r.self = this;
+        r.begin = i;
+        r.end = std::min<unsigned long>(i + BlockSize / 16, _cuts.size());
+        ranges.push_back(r);
+    }
+
+    if (ranges.size() > 1)
+        QtConcurrent::blockingMap(ranges, &MeshBoolean::TriangulateRange);
+    else
+        std::for_each(ranges.begin(), ranges.end(), &MeshBoolean::TriangulateRange);
+}
+
+void MeshBoolean::IntersectRange(Range& r)
+{
+    const MeshBoolean& self = *r.self;
+    const MeshFacetArray& rFacets = self._cutMesh0.GetFacets();
+    const MeshPointArray& rPoints = self._cutMesh0.GetPoints();
+    const MeshFacetTree& tree = *self._trees[1];
+    float fEps = std::max<float>(1.0e-6f * self._cutMesh0.GetBoundBox().CalcDiagonalLength(), FLOAT_EPS);
+
+    std::vector<unsigned long> candidates;
+    for (unsigned long i = r.begin; i < r.end; i++) {
+        if (self._degenerated[i])
+            continue;
+        const MeshFacet& f = rFacets[i];
+        Base::BoundBox3f box;
+        for (int j = 0; j < 3; j++)
+            box.Add(rPoints[f._aulPoints[j]]);
+        box.Enlarge(fEps);
+
+        candidates.clear();
+        tree.Inside(box, candidates);
+        for (std::vector<unsigned long>::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+            unsigned long other = *it + self._ctFacets0;
+            if (!self._degenerated[other])
+                self.IntersectFacets(i, other, r);
+        }
+    }
+}
+
+void MeshBoolean::IntersectFacets(unsigned long ulFacet0, unsigned long ulFacet1, Range& r) const
+{
+    unsigned long c[2][3];
+    GetCorners(ulFacet0, c[0]);
+    GetCorners(ulFacet1, c[1]);
+    const std::vector<Base::Vector3d>& p = _points;
+
+    int o[2][3];
+    for (int i = 0; i < 3; i++)
+        o[0][i] = Orient3D(p[c[1][0]], p[c[1][1]], p[c[1][2]], p[c[0][i]]);
+    if (SameSide(o[0]))
+        return;
+    for (int i = 0; i < 3; i++)
+        o[1][i] = Orient3D(p[c[0][0]], p[c[0][1]], p[c[0][2]], p[c[1][i]]);
+    if (SameSide(o[1]))
+        return;
+    if (o[0][0] == 0 && o[0][1] == 0 && o[0][2] == 0) {
+        IntersectCoplanarFacets(ulFacet0, ulFacet1, r);
+        return;
+    }
+
+    unsigned long facet[2] = { ulFacet0, ulFacet1 };
+    std::vector<Hit> hits;
+
+    // edges of one facet that pass through the other facet
+    for (int side = 0; side < 2; side++) {
+        const unsigned long* e = c[side];
+        const unsigned long* f = c[1-side];
+        for (int i = 0; i < 3; i++) {
+            int j = (i+1)%3;
+            if (o[side][i] * o[side][j] >= 0)
+                continue;
+            int s[3], zeros = 0;
+            for (int k = 0; k < 3; k++) {
+                s[k] = Orient3D(p[e[i]], p[e[j]], p[f[k]], p[f[(k+1)%3]]);
+                if (s[k] == 0)
+                    zeros++;
+            }
+            if (!NoSignChange(s))
+                continue;
+
+            Hit h;
+            h.edge[side] = i;
+            h.vertex[side] = -1;
+            h.edge[1-side] = -1;
+            h.vertex[1-side] = -1;
+            h.key.type = PointKey::EdgeFacet;
+            if (zeros == 0) {
+                h.key.index[0] = std::min<unsigned long>(e[i], e[j]);
+                h.key.index[1] = std::max<unsigned long>(e[i], e[j]);
+                h.key.index[2] = facet[1-side];
+                h.key.index[3] = 0;
+            }
+            else if (zeros == 1) {
+                int k = s[0] == 0 ? 0 : (s[1] == 0 ? 1 : 2);
+                IndexPair ea = MakeEdge(e[i], e[j]);
+                IndexPair eb = MakeEdge(f[k], f[(k+1)%3]);
+                if (side == 1)
+                    std::swap(ea, eb);
+                h.edge[1-side] = k;
+                h.key.type = PointKey::EdgeEdge;
+                h.key.index[0] = ea.first;
+                h.key.index[1] = ea.second;
+                h.key.index[2] = eb.first;
+                h.key.index[3] = eb.second;
+            }
+            else {
+                int m = s[0] != 0 ? 2 : (s[1] != 0 ? 0 : 1);
+                h.vertex[1-side] = m;
+                h.key.type = PointKey::Vertex;
+                h.key.index[0] = f[m];
+                h.key.index[1] = h.key.index[2] = h.key.index[3] = 0;
+            }
+            AddHit(hits, h);
+        }
+    }
+
+    // edges of one facet that lie in the plane of the other facet and cross its edges
+    for (int side = 0; side < 2; side++) {
+        const unsigned long* e = c[side];
+        const unsigned long* f = c[1-side];
+        int axis = DominantAxis(Normal(p[f[0]], p[f[1]], p[f[2]]));
+        for (int i = 0; i < 3; i++) {
+            int j = (i+1)%3;
+            if (o[side][i] != 0 || o[side][j] != 0)
+                continue;
+            Point2d a0 = Project(p[e[i]], axis), a1 = Project(p[e[j]], axis);
+            for (int k = 0; k < 3; k++) {
+                Point2d b0 = Project(p[f[k]], axis), b1 = Project(p[f[(k+1)%3]], axis);
+                if (Orient2D(a0, a1, b0) * Orient2D(a0, a1, b1) >= 0)
+                    continue;
+                if (Orient2D(b0, b1, a0) * Orient2D(b0, b1, a1) >= 0)
+                    continue;
+                IndexPair ea = MakeEdge(e[i], e[j]);
+                IndexPair eb = MakeEdge(f[k], f[(k+1)%3]);
+                if (side == 1)
+                    std::swap(ea, eb);
+                Hit h;
+                h.edge[side] = i;
+                h.edge[1-side] = k;
+                h.vertex[0] = h.vertex[1] = -1;
+                h.key.type = PointKey::EdgeEdge;
+                h.key.index[0] = ea.first;
+                h.key.index[1] = ea.second;
+                h.key.index[2] = eb.first;
+                h.key.index[3] = eb.second;
+                AddHit(hits, h);
+            }
+        }
+    }
+
+    // corners of one facet that lie in the other facet
+    for (int side = 0; side < 2; side++) {
+        const unsigned long* e = c[side];
+        const unsigned long* f = c[1-side];
+        Base::Vector3d n = Normal(p[f[0]], p[f[1]], p[f[2]]);
+        int axis = DominantAxis(n);
+        Point2d t[3];
+        for (int k = 0; k < 3; k++)
+            t[k] = Project(p[f[k]], axis);
+        if (Orient2D(t[0], t[1], t[2]) < 0)
+            std::swap(t[1], t[2]);
+
+        for (int i = 0; i < 3; i++) {
+            if (o[side][i] != 0)
+                continue;
+            int edge, vertex;
+            if (!InTriangle(t, Project(p[e[i]], axis), edge, vertex))
+                continue;
+
+            // undo the swap of the corners
+            if (Orient2D(Project(p[f[0]], axis), Project(p[f[1]], axis), Project(p[f[2]], axis)) < 0) {
+                static const int edgeMap[3] = { 2, 1, 0 };
+                static const int vertexMap[3] = { 0, 2, 1 };
+                if (edge >= 0) edge = edgeMap[edge];
+                if (vertex >= 0) vertex = vertexMap[vertex];
+            }
+
+            Hit h;
+            h.edge[side] = -1;
+            h.vertex[side] = i;
+            h.edge[1-side] = edge;
+            h.vertex[1-side] = vertex;
+            h.key.type = PointKey::Vertex;
+            h.key.index[0] = e[i];
+            h.key.index[1] = h.key.index[2] = h.key.index[3] = 0;
+            if (vertex >= 0) {
+                // coincident corners are represented by the point of the first mesh
+                h.key.index[0] = side == 0 ? e[i] : f[vertex];
+                r.aliases.push_back(MakeEdge(e[i], f[vertex]));
+            }
+            AddHit(hits, h);
+        }
+    }
+
+    if (hits.empty())
+        return;
+
+    for (std::vector<Hit>::iterator it = hits.begin(); it != hits.end(); ++it) {
+        for (int side = 0; side < 2; side++) {
+            if (it->vertex[side] >= 0)
+                continue;
+            PointRecord rec;
+            rec.facet = facet[side];
+            rec.key = it->key;
+            rec.edge = it->edge[side];
+            r.points.push_back(rec);
+        }
+    }
+
+    // all points lie on the intersection line of the two planes
+    if (hits.size() < 2)
+        return;
+    Base::Vector3d dir = Normal(p[c[0][0]], p[c[0][1]], p[c[0][2]]) %
+                         Normal(p[c[1][0]], p[c[1][1]], p[c[1][2]]);
+    std::vector<std::pair<double, std::size_t> > order;
+    for (std::size_t i = 0; i < hits.size(); i++)
+        order.push_back(std::make_pair(GetPosition(hits[i].key) * dir, i));
+    std::sort(order.begin(), order.end());
+    for (std::size_t i = 1; i < order.size(); i++) {
+        for (int side = 0; side < 2; side++) {
+            SegmentRecord seg;
+            seg.facet = facet[side];
+            seg.key[0] = hits[order[i-1].second].key;
+            seg.key[1] = hits[order[i].second].key;
+            r.segments.push_back(seg);
+        }
+    }
+}
+
+void MeshBoolean::IntersectCoplanarFacets(unsigned long ulFacet0, unsigned long ulFacet1, Range& r) const
+{
+    unsigned long c[2][3];
+    GetCorners(ulFacet0, c[0]);
+    GetCorners(ulFacet1, c[1]);
+    const std::vector<Base::Vector3d>& p = _points;
+    unsigned long facet[2] = { ulFacet0, ulFacet1 };
+
+    int axis = DominantAxis(Normal(p[c[0][0]], p[c[0][1]], p[c[0][2]]));
+    Point2d t[2][3];
+    bool flipped[2];
+    for (int side = 0; side < 2; side++) {
+        for (int k = 0; k < 3; k++)
+            t[side][k] = Project(p[c[side][k]], axis);
+        flipped[side] = Orient2D(t[side][0], t[side][1], t[side][2]) < 0;
+        if (flipped[side])
+            std::swap(t[side][1], t[side][2]);
+    }
+
+    // maps edges and corners of the counterclockwise triangles back to the facets
+    static const int edgeMap[3] = { 2, 1, 0 };
+    static const int vertexMap[3] = { 0, 2, 1 };
+
+    std::vector<Hit> hits;
+    for (int side = 0; side < 2; side++) {
+        for (int i = 0; i < 3; i++) {
+            int edge, vertex;
+            if (!InTriangle(t[1-side], Project(p[c[side][i]], axis), edge, vertex))
+                continue;
+            if (flipped[1-side]) {
+                if (edge >= 0) edge = edgeMap[edge];
+                if (vertex >= 0) vertex = vertexMap[vertex];
+            }
+
+            Hit h;
+            h.edge[side] = -1;
+            h.vertex[side] = i;
+            h.edge[1-side] = edge;
+            h.vertex[1-side] = vertex;
+            h.key.type = PointKey::Vertex;
+            h.key.index[0] = c[side][i];
+            h.key.index[1] = h.key.index[2] = h.key.index[3] = 0;
+            if (vertex >= 0) {
+                h.key.index[0] = side == 0 ? c[0][i] : c[0][vertex];
+                r.aliases.push_back(MakeEdge(c[side][i], c[1-side][vertex]));
+            }
+            AddHit(hits, h);
+        }
+    }
+
+    // proper crossings of the edges
+    for (int i = 0; i < 3; i++) {
+        Point2d a0 = Project(p[c[0][i]], axis), a1 = Project(p[c[0][(i+1)%3]], axis);
+        for (int k = 0; k < 3; k++) {
+            Point2d b0 = Project(p[c[1][k]], axis), b1 = Project(p[c[1][(k+1)%3]], axis);
+            if (Orient2D(a0, a1, b0) * Orient2D(a0, a1, b1) >= 0)
+                continue;
+            if (Orient2D(b0, b1, a0) * Orient2D(b0, b1, a1) >= 0)
+                continue;
+            IndexPair ea = MakeEdge(c[0][i], c[0][(i+1)%3]);
+            IndexPair eb = MakeEdge(c[1][k], c[1][(k+1)%3]);
+            Hit h;
+            h.edge[0] = i;
+            h.edge[1] = k;
+            h.vertex[0] = h.vertex[1] = -1;
+            h.key.type = PointKey::EdgeEdge;
+            h.key.index[0] = ea.first;
+            h.key.index[1] = ea.second;
+            h.key.index[2] = eb.first;
+            h.key.index[3] = eb.second;
+            AddHit(hits, h);
+        }
+    }
+
+    if (hits.empty())
+        return;
+
+    for (std::vector<Hit>::iterator it = hits.begin(); it != hits.end(); ++it) {
+        for (int side = 0; side < 2; side++) {
+            if (it->vertex[side] >= 0)
+                continue;
+            PointRecord rec;
+            rec.facet = facet[side];
+            rec.key = it->key;
+            rec.edge = it->edge[side];
+            r.points.push_back(rec);
+        }
+    }
+
+    // the parts of the edges of one facet inside the other facet bound the overlapping area
+    for (int side = 0; side < 2; side++) {
+        for (int i = 0; i < 3; i++) {
+            int j = (i+1)%3;
+            const Base::Vector3d& e0 = p[c[side][i]];
+            Base::Vector3d dir = p[c[side][j]] - e0;
+            std::vector<std::pair<double, std::size_t> > order;
+            for (std::size_t k = 0; k < hits.size(); k++) {
+                const Hit& h = hits[k];
+                if (h.edge[side] == i || h.vertex[side] == i || h.vertex[side] == j)
+                    order.push_back(std::make_pair((GetPosition(h.key) - e0) * dir, k));
+            }
+            std::sort(order.begin(), order.end());
+            for (std::size_t k = 1; k < order.size(); k++) {
+                SegmentRecord seg;
+                seg.facet = facet[1-side];
+                seg.key[0] = hits[order[k-1].second].key;
+                seg.key[1] = hits[order[k].second].key;
+                r.segments.push_back(seg);
+            }
+        }
+    }
+
+    r.partners.push_back(IndexPair(ulFacet0, ulFacet1));
+    r.partners.push_back(IndexPair(ulFacet1, ulFacet0));
+}
+
+void MeshBoolean::AddHit(std::vector<Hit>& hits, const Hit& h)
+{
+    for (std::vector<Hit>::iterator it = hits.begin(); it != hits.end(); ++it) {
+        if (it->key == h.key) {
+            for (int side = 0; side < 2; side++) {
+                if (it->edge[side] < 0)
+                    it->edge[side] = h.edge[side];
+                if (it->vertex[side] < 0)
+                    it->vertex[side] = h.vertex[side];
+            }
+            return;
+        }
+    }
+    hits.push_back(h);
+}
+
+namespace {
+struct SegmentFacetLess
+{
+    template <class T>
+    bool operator()(const T& a, const T& b) const
+    { return a.facet < b.facet; }
+};
+}
+
+void MeshBoolean::CreatePoints(std::vector<PointRecord>& points, std::vector<SegmentRecord>& segments,
+                               std::vector<IndexPair>& partners, std::vector<IndexPair>& aliases)
+{
+    // merge coincident points of both meshes, the smaller index becomes the representative
+    for (std::vector<IndexPair>::iterator it = aliases.begin(); it != aliases.end(); ++it) {
+        unsigned long a = it->first, b = it->second;
+        while (_alias[a] != a)
+            a = _alias[a];
+        while (_alias[b] != b)
+            b = _alias[b];
+        if (a < b)
+            _alias[b] = a;
+        else if (b < a)
+            _alias[a] = b;
+    }
+    for (unsigned long i = 0; i < _alias.size(); i++)
+        _alias[i] = _alias[_alias[i]];
+
+    // the cut points are ordered by their keys, so their indices don't depend on the threads
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    for (std::vector<PointRecord>::iterator it = points.begin(); it != points.end(); ++it) {
+        if (it->key.type != PointKey::Vertex)
+            _cutKeys.push_back(it->key);
+    }
+    std::sort(_cutKeys.begin(), _cutKeys.end());
+    _cutKeys.erase(std::unique(_cutKeys.begin(), _cutKeys.end()), _cutKeys.end());
+    _points.reserve(_points.size() + _cutKeys.size());
+    for (std::vector<PointKey>::iterator it = _cutKeys.begin(); it != _cutKeys.end(); ++it)
+        _points.push_back(GetPosition(*it));
+
+    std::stable_sort(segments.begin(), segments.end(), SegmentFacetLess());
+    std::sort(partners.begin(), partners.end());
+    partners.erase(std::unique(partners.begin(), partners.end()), partners.end());
+
+    // collect the cut facets
+    std::vector<unsigned long> facets;
+    for (std::vector<PointRecord>::iterator it = points.begin(); it != points.end(); ++it)
+        facets.push_back(it->facet);
+    for (std::vector<SegmentRecord>::iterator it = segments.begin(); it != segments.end(); ++it)
+        facets.push_back(it->facet);
+    for (std::vector<IndexPair>::iterator it = partners.begin(); it != partners.end(); ++it)
+        facets.push_back(it->first);
+    std::sort(facets.begin(), facets.end());
+    facets.erase(std::unique(facets.begin(), facets.end()), facets.end());
+
+    _cuts.resize(facets.size());
+    for (std::size_t i = 0; i < facets.size(); i++) {
+        _cuts[i].facet = facets[i];
+        _cuts[i].failed = false;
+        _cutIndex[facets[i]] = i;
+    }
+
+    for (std::vector<PointRecord>::iterator it = points.begin(); it != points.end(); ++it) {
+        FacetCut& cut = _cuts[_cutIndex[it->facet]];
+        cut.points.push_back(std::make_pair(GetPointIndex(it->key), it->edge));
+    }
+    for (std::vector<SegmentRecord>::iterator it = segments.begin(); it != segments.end(); ++it) {
+        FacetCut& cut = _cuts[_cutIndex[it->facet]];
+        IndexPair seg = MakeEdge(GetPointIndex(it->key[0]), GetPointIndex(it->key[1]));
+        if (seg.first == seg.second)
+            continue;
+        cut.segments.push_back(seg);
+        _barriers.push_back(seg);
+    }
+    for (std::vector<IndexPair>::iterator it = partners.begin(); it != partners.end(); ++it) {
+        _cuts[_cutIndex[it->first]].coplanar.push_back(it->second);
+    }
+
+    std::sort(_barriers.begin(), _barriers.end());
+    _barriers.erase(std::unique(_barriers.begin(), _barriers.end()), _barriers.end());
+}
+
+void MeshBoolean::TriangulateRange(Range& r)
+{
+    for (unsigned long i = r.begin; i < r.end; i++)
+        r.self->Triangulate(r.self->_cuts[i]);
+}
+
+void MeshBoolean::Triangulate(FacetCut& cut) const
+{
+    unsigned long c[3];
+    GetCorners(cut.facet, c);
+    Base::Vector3d n = Normal(_points[c[0]], _points[c[1]], _points[c[2]]);
+    int axis = DominantAxis(n);
+
+    // the corners get the local indices 0, 1 and 2
+    PlanarTriangulation tria;
+    std::vector<unsigned long> global;
+    std::map<unsigned long, int> local;
+    for (int i = 0; i < 3; i++) {
+        unsigned long index = FindAlias(c[i]);
+        global.push_back(index);
+        local[index] = i;
+        tria.points.push_back(Project(_points[c[i]], axis));
+    }
+
+    // mirror the points to get a counterclockwise triangle
+    bool mirror = Orient2D(tria.points[0], tria.points[1], tria.points[2]) < 0;
+    if (mirror) {
+        for (int i = 0; i < 3; i++)
+            tria.points[i].x = -tria.points[i].x;
+    }
+
+    std::vector<std::pair<double, int> > border[3];
+    std::vector<int> inner;
+    for (std::vector<std::pair<unsigned long, int> >::iterator it = cut.points.begin(); it != cut.points.end(); ++it) {
+        if (local.find(it->first) != local.end())
+            continue;
+        int index = (int)global.size();
+        local[it->first] = index;
+        global.push_back(it->first);
+        Point2d pt = Project(_points[it->first], axis);
+        if (mirror)
+            pt.x = -pt.x;
+        tria.points.push_back(pt);
+
+        if (it->second >= 0) {
+            int k = it->second;
+            const Base::Vector3d& p0 = _points[c[k]];
+            Base::Vector3d dir = _points[c[(k+1)%3]] - p0;
+            border[k].push_back(std::make_pair((_points[it->first] - p0) * dir, index));
+        }
+        else {
+            inner.push_back(index);
+        }
+    }
+
+    // insert the points on the edges first and then the inner points
+    tria.AddTriangle(0, 1, 2);
+    for (int k = 0; k < 3; k++) {
+        std::sort(border[k].begin(), border[k].end());
+        int prev = k;
+        int next = (k+1)%3;
+        for (std::vector<std::pair<double, int> >::iterator it = border[k].begin(); it != border[k].end(); ++it) {
+            tria.SplitEdge(prev, next, it->second);
+            prev = it->second;
+        }
+    }
+
+    std::vector<int> remap(global.size());
+    std::vector<bool> used(global.size(), true);
+    for (std::size_t i = 0; i < remap.size(); i++)
+        remap[i] = (int)i;
+    for (std::vector<int>::iterator it = inner.begin(); it != inner.end(); ++it) {
+        remap[*it] = tria.InsertPoint(*it);
+        if (remap[*it] != *it)
+            used[*it] = false;
+    }
+
+    for (std::vector<IndexPair>::iterator it = cut.segments.begin(); it != cut.segments.end(); ++it) {
+        std::map<unsigned long, int>::iterator u = local.find(it->first);
+        std::map<unsigned long, int>::iterator v = local.find(it->second);
+        if (u == local.end() || v == local.end()) {
+            cut.failed = true;
+            continue;
+        }
+        if (!tria.InsertSegment(remap[u->second], remap[v->second], used))
+            cut.failed = true;
+    }
+
+    // project the coplanar facets of the other mesh the same way
+    std::vector<std::vector<Point2d> > partners;
+    std::vector<bool> sameOrientation;
+    for (std::vector<unsigned long>::iterator it = cut.coplanar.begin(); it != cut.coplanar.end(); ++it) {
+        unsigned long o[3];
+        GetCorners(*it, o);
+        std::vector<Point2d> pts(3);
+        for (int i = 0; i < 3; i++) {
+            pts[i] = Project(_points[o[i]], axis);
+            if (mirror)
+                pts[i].x = -pts[i].x;
+        }
+        if (Orient2D(pts[0], pts[1], pts[2]) < 0)
+            std::swap(pts[1], pts[2]);
+        partners.push_back(pts);
+        sameOrientation.push_back(Normal(_points[o[0]], _points[o[1]], _points[o[2]]) * n > 0.0);
+    }
+
+    cut.triangles.clear();
+    for (std::vector<PlanarTriangulation::Tri>::iterator it = tria.tris.begin(); it != tria.tris.end(); ++it) {
+        Triangle t;
+        t.state = Triangle::Unknown;
+        for (int i = 0; i < 3; i++)
+            t.point[i] = global[it->v[i]];
+
+        Point2d center;
+        center.x = (tria.points[it->v[0]].x + tria.points[it->v[1]].x + tria.points[it->v[2]].x) / 3.0;
+        center.y = (tria.points[it->v[0]].y + tria.points[it->v[1]].y + tria.points[it->v[2]].y) / 3.0;
+        for (std::size_t i = 0; i < partners.size(); i++) {
+            int edge, vertex;
+            if (InTriangle(&partners[i][0], center, edge, vertex)) {
+                t.state = sameOrientation[i] ? Triangle::OnSame : Triangle::OnOpposite;
+                break;
+            }
+        }
+        cut.triangles.push_back(t);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+struct EdgeRef
+{
+    unsigned long p0, p1, triangle;
+
+    bool operator < (const EdgeRef& e) const
+    {
+        if (p0 != e.p0)
+            return p0 < e.p0;
+        if (p1 != e.p1)
+            return p1 < e.p1;
+        return triangle < e.triangle;
+    }
+};
+
+unsigned long FindRoot(std::vector<unsigned long>& parent, unsigned long i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+}
+
+void MeshBoolean::Classify()
+{
+    std::vector<Component> components;
+    std::vector<std::vector<unsigned long> > members;
+
+    for (int side = 0; side < 2; side++) {
+        std::vector<Triangle>& triangles = _triangles[side];
+        triangles.clear();
+        unsigned long begin = side == 0 ? 0 : _ctFacets0;
+        unsigned long end = side == 0 ? _ctFacets0 : _cutIndex.size();
+        for (unsigned long f = begin; f < end; f++) {
+            if (_degenerated[f])
+                continue;
+            if (_cutIndex[f] != ULONG_MAX) {
+                const std::vector<Triangle>& t = _cuts[_cutIndex[f]].triangles;
+                triangles.insert(triangles.end(), t.begin(), t.end());
+            }
+            else {
+                unsigned long c[3];
+                GetCorners(f, c);
+                Triangle t;
+                t.state = Triangle::Unknown;
+                for (int i = 0; i < 3; i++)
+                    t.point[i] = FindAlias(c[i]);
+                triangles.push_back(t);
+            }
+        }
+
+        // regions are bounded by the cut segments
+        std::vector<EdgeRef> edges;
+        edges.reserve(3 * triangles.size());
+        for (unsigned long i = 0; i < triangles.size(); i++) {
+            if (triangles[i].state != Triangle::Unknown)
+                continue;
+            for (int j = 0; j < 3; j++) {
+                IndexPair e = MakeEdge(triangles[i].point[j], triangles[i].point[(j+1)%3]);
+                EdgeRef ref;
+                ref.p0 = e.first;
+                ref.p1 = e.second;
+                ref.triangle = i;
+                edges.push_back(ref);
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        std::vector<unsigned long> parent(triangles.size());
+        for (unsigned long i = 0; i < parent.size(); i++)
+            parent[i] = i;
+        for (std::size_t i = 0; i < edges.size(); ) {
+            std::size_t j = i + 1;
+            while (j < edges.size() && edges[j].p0 == edges[i].p0 && edges[j].p1 == edges[i].p1)
+                j++;
+            if (!std::binary_search(_barriers.begin(), _barriers.end(), IndexPair(edges[i].p0, edges[i].p1))) {
+                for (std::size_t k = i + 1; k < j; k++) {
+                    unsigned long a = FindRoot(parent, edges[i].triangle);
+                    unsigned long b = FindRoot(parent, edges[k].triangle);
+                    parent[std::max<unsigned long>(a, b)] = std::min<unsigned long>(a, b);
+                }
+            }
+            i = j;
+        }
+
+        // use the largest facet of a region to classify it
+        std::vector<unsigned long> representative(triangles.size(), ULONG_MAX);
+        std::vector<double> area(triangles.size(), 0.0);
+        for (unsigned long i = 0; i < triangles.size(); i++) {
+            if (triangles[i].state != Triangle::Unknown)
+                continue;
+            const Triangle& t = triangles[i];
+            double a = Normal(_points[t.point[0]], _points[t.point[1]], _points[t.point[2]]).Length();
+            unsigned long root = FindRoot(parent, i);
+            if (representative[root] == ULONG_MAX || a > area[root]) {
+                representative[root] = i;
+                area[root] = a;
+            }
+        }
+
+        std::vector<unsigned long> componentIndex(triangles.size(), ULONG_MAX);
+        for (unsigned long i = 0; i < triangles.size(); i++) {
+            if (representative[i] == ULONG_MAX)
+                continue;
+            const Triangle& t = triangles[representative[i]];
+            Base::Vector3d center = (_points[t.point[0]] + _points[t.point[1]] + _points[t.point[2]]) * (1.0 / 3.0);
+            Component comp;
+            comp.self = this;
+            comp.side = side;
+            comp.point.Set((float)center.x, (float)center.y, (float)center.z);
+            comp.state = Triangle::Unknown;
+            componentIndex[i] = components.size();
+            components.push_back(comp);
+            members.push_back(std::vector<unsigned long>());
+        }
+        for (unsigned long i = 0; i < triangles.size(); i++) {
+            if (triangles[i].state != Triangle::Unknown)
+                continue;
+            unsigned long index = componentIndex[FindRoot(parent, i)];
+            members[index].push_back(i);
+        }
+    }
+
+    if (components.size() > 1)
+        QtConcurrent::blockingMap(components, &MeshBoolean::ClassifyComponent);
+    else
+        std::for_each(components.begin(), components.end(), &MeshBoolean::ClassifyComponent);
+
+    for (std::size_t i = 0; i < components.size(); i++) {
+        std::vector<Triangle>& triangles = _triangles[components[i].side];
+        for (std::vector<unsigned long>::iterator it = members[i].begin(); it != members[i].end(); ++it)
+            triangles[*it].state = components[i].state;
+    }
+}
+
+void MeshBoolean::ClassifyComponent(Component& c)
+{
+    c.state = c.self->IsInside(c.point, c.side) ? Triangle::Inside : Triangle::Outside;
+}
+
+bool MeshBoolean::IsInside(const Base::Vector3f& rclPt, int side) const
+{
+    // A ray leaving the other mesh hits the back side of a facet. Rays that hit a facet
+    // almost tangentially are ignored and the remaining rays vote.
+    static const float directions[3][3] = {
+        { 0.5377f,  0.7313f,  0.4193f},
+        {-0.6171f,  0.2218f,  0.7550f},
+        { 0.3322f, -0.8643f,  0.3776f}
+    };
+
+    const MeshKernel& mesh = side == 0 ? _cutMesh1 : _cutMesh0;
+    const MeshFacetTree& tree = *_trees[1-side];
+    int inside = 0, outside = 0;
+    for (int i = 0; i < 3; i++) {
+        Base::Vector3f dir(directions[i][0], directions[i][1], directions[i][2]);
+        dir.Normalize();
+        Base::Vector3f res;
+        unsigned long facet;
+        if (!tree.NearestFacetOnRay(rclPt, dir, res, facet)) {
+            outside++;
+        }
+        else {
+            float cosine = mesh.GetFacet(facet).GetNormal() * dir;
+            if (std::fabs(cosine) < 1.0e-3f)
+                continue;
+            if (cosine > 0.0f)
+                inside++;
+            else
+                outside++;
+        }
+
+        if (inside >= 2 || outside >= 2)
+            break;
+    }
+
+    return inside > outside;
+}
+
+void MeshBoolean::CreateResult()
+{
+    // the states of the facets of each mesh that are part of the result
+    int keep[2][2] = { { Triangle::Unknown, Triangle::Unknown },
+                       { Triangle::Unknown, Triangle::Unknown } };
+    bool flip = false;
+    switch (_operationType) {
+    case SetOperations::Union:
+        keep[0][0] = Triangle::Outside; keep[0][1] = Triangle::OnSame;
+        keep[1][0] = Triangle::Outside;
+        break;
+    case SetOperations::Intersect:
+        keep[0][0] = Triangle::Inside; keep[0][1] = Triangle::OnSame;
+        keep[1][0] = Triangle::Inside;
+        break;
+    case SetOperations::Difference:
+        keep[0][0] = Triangle::Outside; keep[0][1] = Triangle::OnOpposite;
+        keep[1][0] = Triangle::Inside;
+        flip = true;
+        break;
+    case SetOperations::Inner:
+        keep[0][0] = Triangle::Inside;
+        break;
+    case SetOperations::Outer:
+        keep[0][0] = Triangle::Outside;
+        break;
+    }
+
+    std::vector<unsigned long> index(_points.size(), ULONG_MAX);
+    MeshPointArray points;
+    MeshFacetArray facets;
+    for (int side = 0; side < 2; side++) {
+        for (std::vector<Triangle>::iterator it = _triangles[side].begin(); it != _triangles[side].end(); ++it) {
+            if (it->state == Triangle::Unknown)
+                continue;
+            if (it->state != keep[side][0] && it->state != keep[side][1])
+                continue;
+
+            unsigned long p[3];
+            for (int i = 0; i < 3; i++) {
+                unsigned long& pos = index[it->point[i]];
+                if (pos == ULONG_MAX) {
+                    const Base::Vector3d& v = _points[it->point[i]];
+                    pos = points.size();
+                    points.push_back(MeshPoint(Base::Vector3f((float)v.x, (float)v.y, (float)v.z)));
+                }
+                p[i] = pos;
+            }
+            if (side == 1 && flip)
+                std::swap(p[1], p[2]);
+            facets.push_back(MeshFacet(p[0], p[1], p[2]));
+        }
+    }
+
+    _resultMesh.Adopt(points, facets, true);
+}
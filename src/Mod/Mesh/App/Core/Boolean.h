@@ -0,0 +1,166 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_BOOLEAN_H
+#define MESH_BOOLEAN_H
+
+#include <vector>
+#include <utility>
+
+#include "SetOperations.h"
+#include <Base/Vector3D.h>
+
+namespace MeshCore
+{
+class MeshKernel;
+class MeshFacetTree;
+
+/**
+ * The MeshBoolean class computes the union, intersection or difference of two
+ * closed meshes. It is meant as a more reliable replacement of SetOperations
+ * and supports the same operation types.
+ *
+ * All topological decisions are made with exact orientation predicates that only
+ * fall back to exact arithmetic if the floating point result is uncertain. Every
+ * cut point is identified by the mesh elements it is created from (an edge of one
+ * mesh and a facet or edge of the other one), so neighbouring facets always share
+ * the same points and the result is closed. Coplanar overlapping facets are cut
+ * against each other, too.
+ *
+ * The facet pairs are intersected in parallel. Afterwards each cut facet is
+ * retriangulated on its own so that the cut segments become edges of the new
+ * facets. The order of all steps is independent of the thread scheduling, so
+ * the result is the same for every run.
+ * Finally the facets are grouped into regions bounded by the intersection curve and
+ * every region is classified as inside or outside of the other mesh by casting rays.
+ */
+class MeshExport MeshBoolean
+{
+public:
+    MeshBoolean(const MeshKernel& cutMesh1, const MeshKernel& cutMesh2,
+                MeshKernel& result, SetOperations::OperationType opType);
+    ~MeshBoolean();
+
+    /// Performs the operation and writes the result mesh.
+    void Do();
+    /** Returns the number of facets where not all cut segments could be inserted
+     * when retriangulating them. This can only happen for self-intersecting input. */
+    unsigned long CountFailedFacets() const;
+
+private:
+    /** Identifies a point of the result. It's either a point of the input meshes,
+     * the intersection of an edge with a facet or the intersection of two edges. */
+    struct PointKey
+    {
+        enum Type { Vertex, EdgeFacet, EdgeEdge };
+        int type;
+        unsigned long index[4];
+
+        bool operator < (const PointKey&) const;
+        bool operator == (const PointKey&) const;
+    };
+    /** Point \a key must be inserted into facet \a facet. \a edge is the index of the
+     * facet edge the point lies on or -1 if it's in the interior. */
+    struct PointRecord
+    {
+        unsigned long facet;
+        PointKey key;
+        int edge;
+
+        bool operator < (const PointRecord&) const;
+        bool operator == (const PointRecord&) const;
+    };
+    /** The segment \a key[0]-\a key[1] must become an edge of the triangulation of \a facet. */
+    struct SegmentRecord
+    {
+        unsigned long facet;
+        PointKey key[2];
+    };
+    struct Triangle
+    {
+        enum State { Unknown, Inside, Outside, OnSame, OnOpposite };
+        unsigned long point[3];
+        int state;
+    };
+    /** All information about a facet that is cut by the other mesh. */
+    struct FacetCut
+    {
+        unsigned long facet;
+        std::vector<std::pair<unsigned long, int> > points;
+        std::vector<std::pair<unsigned long, unsigned long> > segments;
+        std::vector<unsigned long> coplanar;
+        std::vector<Triangle> triangles;
+        bool failed;
+    };
+    struct Hit;
+    struct Range;
+    struct Component;
+
+    MeshBoolean(const MeshBoolean&);
+    void operator = (const MeshBoolean&);
+
+    void Initialize();
+    void Intersect();
+    void CreatePoints(std::vector<PointRecord>&, std::vector<SegmentRecord>&,
+                      std::vector<std::pair<unsigned long, unsigned long> >&,
+                      std::vector<std::pair<unsigned long, unsigned long> >&);
+    void Classify();
+    void CreateResult();
+
+    static void IntersectRange(Range&);
+    static void TriangulateRange(Range&);
+    static void ClassifyComponent(Component&);
+    static void AddHit(std::vector<Hit>&, const Hit&);
+
+    void IntersectFacets(unsigned long ulFacet0, unsigned long ulFacet1, Range&) const;
+    void IntersectCoplanarFacets(unsigned long ulFacet0, unsigned long ulFacet1, Range&) const;
+    void Triangulate(FacetCut&) const;
+    bool IsInside(const Base::Vector3f& rclPt, int side) const;
+
+    void GetCorners(unsigned long ulFacet, unsigned long aulPoints[3]) const;
+    Base::Vector3d GetPosition(const PointKey&) const;
+    bool IsDegenerated(unsigned long ulFacet) const;
+    unsigned long GetPointIndex(const PointKey&) const;
+    unsigned long FindAlias(unsigned long) const;
+
+private:
+    const MeshKernel& _cutMesh0;
+    const MeshKernel& _cutMesh1;
+    MeshKernel& _resultMesh;
+    SetOperations::OperationType _operationType;
+
+    unsigned long _ctPoints0, _ctFacets0;
+    std::vector<Base::Vector3d> _points;               /**< Input points followed by the cut points. */
+    std::vector<unsigned long> _alias;                 /**< Coincident input points are merged. */
+    std::vector<bool> _degenerated;                    /**< Facets without area. */
+    std::vector<PointKey> _cutKeys;                    /**< Sorted keys of the cut points. */
+    std::vector<FacetCut> _cuts;                       /**< Cut facets sorted by index. */
+    std::vector<unsigned long> _cutIndex;              /**< Facet index to position in _cuts. */
+    std::vector<std::pair<unsigned long, unsigned long> > _barriers; /**< Sorted cut segments. */
+    std::vector<Triangle> _triangles[2];
+    MeshFacetTree* _trees[2];
+};
+
+} // namespace MeshCore
+
+#endif // MESH_BOOLEAN_H
@@ -125,7 +125,7 @@ void MeshBuilder::AddFacet (Base::Vector3f* facetPoints, unsigned char flag, uns
 
     MeshFacet mf;
     mf._ucFlag = flag;
-    mf._ulProp = prop;
+    mf._ulProp = (unsigned int)prop;
 
     int i = 0;
     for (i = 0; i < 3; i++)
@@ -135,7 +135,7 @@ void MeshBuilder::AddFacet (Base::Vector3f* facetPoints, unsigned char flag, uns
         if (p == _points.end())
         {
             mf._aulPoints[i] = _ptIdx;
-            pt._ulProp = _ptIdx++;
+            pt._ulProp = (unsigned int)_ptIdx++;
             // keep an iterator to the right vertex
             MeshPointIterator it = _points.insert(pt);			
             _pointsIterator.push_back(it);
@@ -153,48 +153,8 @@ void MeshBuilder::AddFacet (Base::Vector3f* facetPoints, unsigned char flag, uns
 
 void MeshBuilder::SetNeighbourhood ()
 {
-    std::set<Edge> edges;
-    int facetIdx = 0;
-
-    for (MeshFacetArray::_TIterator it = _meshKernel._aclFacetArray.begin(); it != _meshKernel._aclFacetArray.end(); it++)
-    {
-        this->_seq->next(true); // allow to cancel
-        MeshFacet& mf = *it;
-
-        for (int i = 0; i < 3; i++)
-        {
-            Edge edge(mf._aulPoints[i], mf._aulPoints[(i+1)%3], facetIdx);
-            std::set<Edge>::iterator e = edges.find(edge);
-            if (e != edges.end())
-            { // edge exists, set neighbourhood
-                MeshFacet& mf1 = _meshKernel._aclFacetArray[e->facetIdx];
-                if (mf1._aulPoints[0] == edge.pt1)
-                {
-                    if (mf1._aulPoints[1] == edge.pt2)
-                        mf1._aulNeighbours[0] = facetIdx;
-                    else
-                        mf1._aulNeighbours[2] = facetIdx;
-                }
-                else if (mf1._aulPoints[0] == edge.pt2)
-                {
-                    if (mf1._aulPoints[1] == edge.pt1)
-                        mf1._aulNeighbours[0] = facetIdx;
-                    else
-                        mf1._aulNeighbours[2] = facetIdx;
-                }
-                else
-                    mf1._aulNeighbours[1] = facetIdx;
-
-                mf._aulNeighbours[i] = e->facetIdx;
-            }
-            else
-            {  // new edge
-                edges.insert(edge);
-            }
-        }
-
-        facetIdx++;
-    }
+    // the second half of the progress, non-manifold edges are linked as before
+    _meshKernel.RebuildNeighbours(0, this->_seq, true);
 }
 
 void MeshBuilder::RemoveUnreferencedPoints()
@@ -31,6 +31,8 @@
 #include <boost/bind.hpp>
 
 #include <Mod/Mesh/App/WildMagic4/Wm4Vector3.h>
+#include <Mod/Mesh/App/WildMagic4/Wm4Matrix2.h>
+#include <Mod/Mesh/App/WildMagic4/Wm4Matrix3.h>
 #include <Mod/Mesh/App/WildMagic4/Wm4MeshCurvature.h>
 
 #include "Curvature.h"
@@ -84,10 +86,215 @@ void MeshCurvature::ComputePerFace(bool parallel)
     }
 }
 
-void MeshCurvature::ComputePerVertex()
+namespace MeshCore {
+
+/**
+ * Helper class to compute the curvature per vertex with the same algorithm as
+ * Wm4::MeshCurvature. Instead of adding the contributions of each facet to its
+ * three vertices every vertex collects them from its adjacent facets in the order
+ * of increasing facet index. This is the same order in which the sums are built up
+ * in Wm4::MeshCurvature, so the results are identical but the vertices can be
+ * processed in independent ranges.
+ */
+class VertexCurvature
+{
+public:
+    struct Range
+    {
+        VertexCurvature* curv;
+        unsigned long begin, end;
+    };
+
+    VertexCurvature(const MeshKernel& kernel, std::vector<CurvatureInfo>& curvature)
+      : myKernel(kernel), mySearch(kernel), myCurvature(curvature)
+    {
+    }
+
+    void Compute()
+    {
+        const MeshPointArray& rPoints = myKernel.GetPoints();
+        unsigned long ctPoints = rPoints.size();
+        myPoints.resize(ctPoints);
+        for (unsigned long i = 0; i < ctPoints; i++)
+            myPoints[i] = Wm4::Vector3<double>(rPoints[i].x, rPoints[i].y, rPoints[i].z);
+        myNormals.resize(ctPoints);
+        myCurvature.resize(ctPoints);
+
+        std::vector<Range> ranges;
+        const unsigned long blockSize = 4096;
+        for (unsigned long i = 0; i < ctPoints; i += blockSize) {
+            Range r;
+            r.curv = this;
+            r.begin = i;
+            r.end = std::min<unsigned long>(i + blockSize, ctPoints);
+            ranges.push_back(r);
+        }
+
+        // all normals must be known before the derivatives can be computed
+        if (ranges.size() > 1) {
+            QtConcurrent::blockingMap(ranges, &VertexCurvature::ComputeNormals);
+            QtConcurrent::blockingMap(ranges, &VertexCurvature::ComputeCurvature);
+        }
+        else {
+            std::for_each(ranges.begin(), ranges.end(), &VertexCurvature::ComputeNormals);
+            std::for_each(ranges.begin(), ranges.end(), &VertexCurvature::ComputeCurvature);
+        }
+    }
+
+private:
+    static void ComputeNormals(Range& r)
+    {
+        VertexCurvature& c = *r.curv;
+        const MeshFacetArray& rFacets = c.myKernel.GetFacets();
+        for (unsigned long v = r.begin; v < r.end; v++) {
+            Wm4::Vector3<double> kSum(0.0, 0.0, 0.0);
+            MeshIndexRange faces = c.mySearch[v];
+            for (MeshIndexRange::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+                const MeshFacet& rFace = rFacets[*it];
+                const Wm4::Vector3<double>& rV0 = c.myPoints[rFace._aulPoints[0]];
+                Wm4::Vector3<double> kEdge1 = c.myPoints[rFace._aulPoints[1]] - rV0;
+                Wm4::Vector3<double> kEdge2 = c.myPoints[rFace._aulPoints[2]] - rV0;
+                Wm4::Vector3<double> kNormal = kEdge1.Cross(kEdge2);
+                for (int j = 0; j < 3; j++) {
+                    if (rFace._aulPoints[j] == v)
+                        kSum += kNormal;
+                }
+            }
+            kSum.Normalize();
+            c.myNormals[v] = kSum;
+        }
+    }
+
+    static void ComputeCurvature(Range& r)
+    {
+        VertexCurvature& c = *r.curv;
+        const MeshFacetArray& rFacets = c.myKernel.GetFacets();
+        const std::vector< Wm4::Vector3<double> >& akVertex = c.myPoints;
+        const std::vector< Wm4::Vector3<double> >& akNormal = c.myNormals;
+
+        int iRow, iCol;
+        for (unsigned long v = r.begin; v < r.end; v++) {
+            Wm4::Matrix3<double> kWWTrn(true);
+            Wm4::Matrix3<double> kDWTrn(true);
+
+            MeshIndexRange faces = c.mySearch[v];
+            for (MeshIndexRange::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+                const MeshFacet& rFace = rFacets[*it];
+                for (int j = 0; j < 3; j++) {
+                    if (rFace._aulPoints[j] != v)
+                        continue;
+                    unsigned long iV0 = rFace._aulPoints[j];
+                    unsigned long iV1 = rFace._aulPoints[(j+1)%3];
+                    unsigned long iV2 = rFace._aulPoints[(j+2)%3];
+
+                    Wm4::Vector3<double> kE = akVertex[iV1] - akVertex[iV0];
+                    Wm4::Vector3<double> kW = kE - (kE.Dot(akNormal[iV0]))*akNormal[iV0];
+                    Wm4::Vector3<double> kD = akNormal[iV1] - akNormal[iV0];
+                    for (iRow = 0; iRow < 3; iRow++) {
+                        for (iCol = 0; iCol < 3; iCol++) {
+                            kWWTrn[iRow][iCol] += kW[iRow]*kW[iCol];
+                            kDWTrn[iRow][iCol] += kD[iRow]*kW[iCol];
+                        }
+                    }
+
+                    kE = akVertex[iV2] - akVertex[iV0];
+                    kW = kE - (kE.Dot(akNormal[iV0]))*akNormal[iV0];
+                    kD = akNormal[iV2] - akNormal[iV0];
+                    for (iRow = 0; iRow < 3; iRow++) {
+                        for (iCol = 0; iCol < 3; iCol++) {
+                            kWWTrn[iRow][iCol] += kW[iRow]*kW[iCol];
+                            kDWTrn[iRow][iCol] += kD[iRow]*kW[iCol];
+                        }
+                    }
+                }
+            }
+
+            const Wm4::Vector3<double>& rkNormal = akNormal[v];
+            for (iRow = 0; iRow < 3; iRow++) {
+                for (iCol = 0; iCol < 3; iCol++) {
+                    kWWTrn[iRow][iCol] = 0.5*kWWTrn[iRow][iCol] +
+                        rkNormal[iRow]*rkNormal[iCol];
+                    kDWTrn[iRow][iCol] *= 0.5;
+                }
+            }
+
+            Wm4::Matrix3<double> kDNormal = kDWTrn*kWWTrn.Inverse();
+
+            // see Wm4::MeshCurvature for the details
+            Wm4::Vector3<double> kU, kV;
+            Wm4::Vector3<double>::GenerateComplementBasis(kU,kV,rkNormal);
+
+            double fS01 = kU.Dot(kDNormal*kV);
+            double fS10 = kV.Dot(kDNormal*kU);
+            double fSAvr = 0.5*(fS01+fS10);
+            Wm4::Matrix2<double> kS
+            (
+                kU.Dot(kDNormal*kU), fSAvr,
+                fSAvr, kV.Dot(kDNormal*kV)
+            );
+
+            double fTrace = kS[0][0] + kS[1][1];
+            double fDet = kS[0][0]*kS[1][1] - kS[0][1]*kS[1][0];
+            double fDiscr = fTrace*fTrace - 4.0*fDet;
+            double fRootDiscr = Wm4::Math<double>::Sqrt(Wm4::Math<double>::FAbs(fDiscr));
+            double fMinCurvature = 0.5*(fTrace - fRootDiscr);
+            double fMaxCurvature = 0.5*(fTrace + fRootDiscr);
+
+            Wm4::Vector3<double> kMinDirection, kMaxDirection;
+            Wm4::Vector2<double> kW0(kS[0][1],fMinCurvature-kS[0][0]);
+            Wm4::Vector2<double> kW1(fMinCurvature-kS[1][1],kS[1][0]);
+            if (kW0.SquaredLength() >= kW1.SquaredLength()) {
+                kW0.Normalize();
+                kMinDirection = kW0.X()*kU + kW0.Y()*kV;
+            }
+            else {
+                kW1.Normalize();
+                kMinDirection = kW1.X()*kU + kW1.Y()*kV;
+            }
+
+            kW0 = Wm4::Vector2<double>(kS[0][1],fMaxCurvature-kS[0][0]);
+            kW1 = Wm4::Vector2<double>(fMaxCurvature-kS[1][1],kS[1][0]);
+            if (kW0.SquaredLength() >= kW1.SquaredLength()) {
+                kW0.Normalize();
+                kMaxDirection = kW0.X()*kU + kW0.Y()*kV;
+            }
+            else {
+                kW1.Normalize();
+                kMaxDirection = kW1.X()*kU + kW1.Y()*kV;
+            }
+
+            CurvatureInfo& ci = c.myCurvature[v];
+            ci.cMaxCurvDir = Base::Vector3f((float)kMaxDirection.X(), (float)kMaxDirection.Y(), (float)kMaxDirection.Z());
+            ci.cMinCurvDir = Base::Vector3f((float)kMinDirection.X(), (float)kMinDirection.Y(), (float)kMinDirection.Z());
+            ci.fMaxCurvature = (float)fMaxCurvature;
+            ci.fMinCurvature = (float)fMinCurvature;
+        }
+    }
+
+private:
+    const MeshKernel& myKernel;
+    MeshRefPointToFacets mySearch;
+    std::vector< Wm4::Vector3<double> > myPoints;
+    std::vector< Wm4::Vector3<double> > myNormals;
+    std::vector<CurvatureInfo>& myCurvature;
+};
+
+}
+
+void MeshCurvature::ComputePerVertex(bool parallel)
 {
     myCurvature.clear();
 
+    // in case of an empty mesh no curvature can be calculated
+    if (myKernel.CountPoints() == 0 || myKernel.CountFacets() == 0)
+        return;
+
+    if (parallel) {
+        VertexCurvature curv(myKernel, myCurvature);
+        curv.Compute();
+        return;
+    }
+
     // get all points
     std::vector< Wm4::Vector3<double> > aPnts;
     aPnts.reserve(myKernel.CountPoints());
@@ -107,10 +314,6 @@ void MeshCurvature::ComputePerVertex()
         }
     }
 
-    // in case of an empty mesh no curvature can be calculated
-    if (myKernel.CountPoints() == 0 || myKernel.CountFacets() == 0)
-        return;
-
     // compute vertex based curvatures
     Wm4::MeshCurvature<double> meshCurv(myKernel.CountPoints(), &(aPnts[0]), myKernel.CountFacets(), &(aIdx[0]));
 
@@ -59,7 +59,10 @@ public:
     float GetRadius() const { return myRadius; }
     void SetRadius(float r) { myRadius = r; }
     void ComputePerFace(bool parallel);
-    void ComputePerVertex();
+    /** Computes the curvature per vertex. The parallel and the serial computation
+     * give identical results.
+     */
+    void ComputePerVertex(bool parallel = true);
     const std::vector<CurvatureInfo>& GetCurvature() const { return myCurvature; }
 
 private:
@@ -0,0 +1,592 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <climits>
+# include <cmath>
+# include <iterator>
+#endif
+
+#include "Decimation.h"
+#include "Elements.h"
+#include "MeshKernel.h"
+#include "TopoAlgorithm.h"
+
+
+using namespace MeshCore;
+
+MeshSimplify::Quadric::Quadric()
+{
+    for (int i=0; i<10; i++)
+        m[i] = 0.0;
+}
+
+void MeshSimplify::Quadric::AddPlane(double a, double b, double c, double d)
+{
+    m[0] += a*a; m[1] += a*b; m[2] += a*c; m[3] += a*d;
+    m[4] += b*b; m[5] += b*c; m[6] += b*d;
+    m[7] += c*c; m[8] += c*d;
+    m[9] += d*d;
+}
+
+MeshSimplify::Quadric& MeshSimplify::Quadric::operator += (const Quadric& q)
+{
+    for (int i=0; i<10; i++)
+        m[i] += q.m[i];
+    return *this;
+}
+
+double MeshSimplify::Quadric::Evaluate(const Base::Vector3f& v) const
+{
+    double x = v.x, y = v.y, z = v.z;
+    return m[0]*x*x + 2.0*m[1]*x*y + 2.0*m[2]*x*z + 2.0*m[3]*x
+         + m[4]*y*y + 2.0*m[5]*y*z + 2.0*m[6]*y
+         + m[7]*z*z + 2.0*m[8]*z
+         + m[9];
+}
+
+bool MeshSimplify::Quadric::Optimize(Base::Vector3f& v) const
+{
+    // solve the symmetric 3x3 system with the adjugate matrix
+    double c00 = m[4]*m[7] - m[5]*m[5];
+    double c01 = m[2]*m[5] - m[1]*m[7];
+    double c02 = m[1]*m[5] - m[2]*m[4];
+    double det = m[0]*c00 + m[1]*c01 + m[2]*c02;
+    double trace = m[0] + m[4] + m[7];
+
+    // in flat or cylindrical regions the minimum is not unique
+    if (fabs(det) <= 1.0e-6 * trace * trace * trace)
+        return false;
+
+    double c11 = m[0]*m[7] - m[2]*m[2];
+    double c12 = m[1]*m[2] - m[0]*m[5];
+    double c22 = m[0]*m[4] - m[1]*m[1];
+
+    double x = -(c00*m[3] + c01*m[6] + c02*m[8]) / det;
+    double y = -(c01*m[3] + c11*m[6] + c12*m[8]) / det;
+    double z = -(c02*m[3] + c12*m[6] + c22*m[8]) / det;
+    v.Set((float)x, (float)y, (float)z);
+    return true;
+}
+
+// --------------------------------------------------------------
+
+MeshSimplify::MeshSimplify(MeshKernel& rclM)
+  : _rclMesh(rclM), _fFeatureAngle(0.0f)
+{
+}
+
+MeshSimplify::~MeshSimplify()
+{
+}
+
+void MeshSimplify::SetFeatureAngle(float fAngle)
+{
+    _fFeatureAngle = fAngle;
+}
+
+void MeshSimplify::Initialize()
+{
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    unsigned long ulCtPts = rPoints.size();
+    unsigned long ulCtFacets = rFacets.size();
+
+    _quadrics.assign(ulCtPts, Quadric());
+    _locked.assign(ulCtPts, false);
+    _version.assign(ulCtPts, 0);
+    _pointFacets.assign(ulCtPts, std::vector<unsigned long>());
+    _heap.clear();
+
+    // sum up the planes of the adjacent facets for each point
+    std::vector<Base::Vector3f> normals(ulCtFacets);
+    for (unsigned long i = 0; i < ulCtFacets; i++) {
+        const MeshFacet& rFace = rFacets[i];
+        if (!rFace.IsValid())
+            continue;
+        const Base::Vector3f& p0 = rPoints[rFace._aulPoints[0]];
+        const Base::Vector3f& p1 = rPoints[rFace._aulPoints[1]];
+        const Base::Vector3f& p2 = rPoints[rFace._aulPoints[2]];
+        Base::Vector3f n = (p1 - p0) % (p2 - p0);
+        float fLength = n.Length();
+
+        Quadric q;
+        if (fLength > 0.0f) {
+            n = n / fLength;
+            q.AddPlane(n.x, n.y, n.z, -(n * p0));
+        }
+
+        normals[i] = n;
+        for (int j = 0; j < 3; j++) {
+            _pointFacets[rFace._aulPoints[j]].push_back(i);
+            _quadrics[rFace._aulPoints[j]] += q;
+        }
+    }
+
+    // points at the border and optionally at sharp edges are kept
+    float fCosAngle = (float)cos(_fFeatureAngle);
+    for (unsigned long i = 0; i < ulCtFacets; i++) {
+        const MeshFacet& rFace = rFacets[i];
+        if (!rFace.IsValid())
+            continue;
+        for (int j = 0; j < 3; j++) {
+            unsigned long ulNeighbour = rFace._aulNeighbours[j];
+            bool lock = false;
+            if (ulNeighbour == ULONG_MAX)
+                lock = true;
+            else if (_fFeatureAngle > 0.0f && ulNeighbour > i)
+                lock = normals[i] * normals[ulNeighbour] < fCosAngle;
+            if (lock) {
+                _locked[rFace._aulPoints[j]] = true;
+                _locked[rFace._aulPoints[(j+1)%3]] = true;
+            }
+        }
+    }
+
+    // a point with several fans of facets is non-manifold and is kept, too
+    for (unsigned long i = 0; i < ulCtPts; i++) {
+        const std::vector<unsigned long>& rFaces = _pointFacets[i];
+        if (_locked[i] || rFaces.empty())
+            continue;
+        unsigned long ulStart = rFaces.front();
+        unsigned long ulCurr = ulStart;
+        std::size_t ctFan = 0;
+        do {
+            const MeshFacet& rFace = rFacets[ulCurr];
+            int j = 0;
+            while (j < 3 && rFace._aulPoints[j] != i)
+                j++;
+            ulCurr = (j < 3 ? rFace._aulNeighbours[j] : ULONG_MAX);
+            ctFan++;
+        }
+        while (ulCurr != ULONG_MAX && ulCurr != ulStart && ctFan <= rFaces.size());
+        if (ulCurr != ulStart || ctFan != rFaces.size())
+            _locked[i] = true;
+    }
+
+    // every inner edge is a candidate
+    for (unsigned long i = 0; i < ulCtFacets; i++) {
+        const MeshFacet& rFace = rFacets[i];
+        if (!rFace.IsValid())
+            continue;
+        for (int j = 0; j < 3; j++) {
+            unsigned long ulNeighbour = rFace._aulNeighbours[j];
+            if (ulNeighbour != ULONG_MAX && ulNeighbour > i)
+                AddCollapse(rFace._aulPoints[j], rFace._aulPoints[(j+1)%3]);
+        }
+    }
+}
+
+void MeshSimplify::AddCollapse(unsigned long ulP0, unsigned long ulP1)
+{
+    if (_locked[ulP0] && _locked[ulP1])
+        return;
+
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    const Base::Vector3f& p0 = rPoints[ulP0];
+    const Base::Vector3f& p1 = rPoints[ulP1];
+
+    Quadric q = _quadrics[ulP0];
+    q += _quadrics[ulP1];
+
+    Collapse c;
+    if (_locked[ulP0]) {
+        c.ulRemove = ulP1;
+        c.ulKeep = ulP0;
+        c.cPosition = p0;
+    }
+    else if (_locked[ulP1]) {
+        c.ulRemove = ulP0;
+        c.ulKeep = ulP1;
+        c.cPosition = p1;
+    }
+    else {
+        c.ulRemove = ulP0;
+        c.ulKeep = ulP1;
+
+        // an almost singular system may give a point far off the edge
+        Base::Vector3f mid = (p0 + p1) * 0.5f;
+        if (!q.Optimize(c.cPosition) || Base::Distance(c.cPosition, mid) > Base::Distance(p0, p1)) {
+            c.cPosition = mid;
+            double fCost = q.Evaluate(mid);
+            if (q.Evaluate(p0) < fCost) {
+                c.cPosition = p0;
+                fCost = q.Evaluate(p0);
+            }
+            if (q.Evaluate(p1) < fCost) {
+                c.cPosition = p1;
+            }
+        }
+    }
+
+    c.fCost = std::max<double>(0.0, q.Evaluate(c.cPosition));
+    c.ulRemoveVersion = _version[c.ulRemove];
+    c.ulKeepVersion = _version[c.ulKeep];
+    _heap.push_back(c);
+    std::push_heap(_heap.begin(), _heap.end());
+}
+
+bool MeshSimplify::CheckCollapse(const Collapse& c, unsigned long& ulFacet,
+                                 unsigned long& ulNeighbour) const
+{
+    // one of the points has changed since the collapse was computed
+    if (_version[c.ulRemove] != c.ulRemoveVersion || _version[c.ulKeep] != c.ulKeepVersion)
+        return false;
+
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    const std::vector<unsigned long>& rRemove = _pointFacets[c.ulRemove];
+    const std::vector<unsigned long>& rKeep = _pointFacets[c.ulKeep];
+    std::vector<unsigned long>::const_iterator it;
+
+    // the edge must be shared by exactly two facets with consistent orientation
+    ulFacet = ULONG_MAX;
+    ulNeighbour = ULONG_MAX;
+    int ctEdgeFacets = 0;
+    for (it = rRemove.begin(); it != rRemove.end(); ++it) {
+        const MeshFacet& rFace = rFacets[*it];
+        for (int j = 0; j < 3; j++) {
+            if (rFace._aulPoints[j] == c.ulKeep) {
+                ctEdgeFacets++;
+                if (rFace._aulPoints[(j+2)%3] == c.ulRemove)
+                    ulFacet = *it;
+                else
+                    ulNeighbour = *it;
+            }
+        }
+    }
+    if (ctEdgeFacets != 2 || ulFacet == ULONG_MAX || ulNeighbour == ULONG_MAX)
+        return false;
+
+    const MeshFacet& rFace = rFacets[ulFacet];
+    const MeshFacet& rNeighbour = rFacets[ulNeighbour];
+    unsigned short uSide = rFace.Side(rNeighbour);
+    if (uSide == USHRT_MAX || rFace._aulPoints[uSide] != c.ulRemove)
+        return false;
+
+    // a point with only three facets would become degenerated
+    unsigned long ulOppFacet = rFace._aulPoints[(uSide+2)%3];
+    unsigned long ulOppNeighbour = rNeighbour._aulPoints[(rNeighbour.Side(rFace)+2)%3];
+    if (ulOppFacet == ulOppNeighbour)
+        return false;
+    if (_pointFacets[ulOppFacet].size() <= 3 || _pointFacets[ulOppNeighbour].size() <= 3)
+        return false;
+
+    // the only common neighbours of both points must be the two opposite points,
+    // otherwise the mesh gets non-manifold
+    std::vector<unsigned long> ringRemove, ringKeep, common;
+    for (it = rRemove.begin(); it != rRemove.end(); ++it) {
+        for (int j = 0; j < 3; j++) {
+            unsigned long ulPt = rFacets[*it]._aulPoints[j];
+            if (ulPt != c.ulRemove)
+                ringRemove.push_back(ulPt);
+        }
+    }
+    for (it = rKeep.begin(); it != rKeep.end(); ++it) {
+        for (int j = 0; j < 3; j++) {
+            unsigned long ulPt = rFacets[*it]._aulPoints[j];
+            if (ulPt != c.ulKeep)
+                ringKeep.push_back(ulPt);
+        }
+    }
+    std::sort(ringRemove.begin(), ringRemove.end());
+    ringRemove.erase(std::unique(ringRemove.begin(), ringRemove.end()), ringRemove.end());
+    std::sort(ringKeep.begin(), ringKeep.end());
+    ringKeep.erase(std::unique(ringKeep.begin(), ringKeep.end()), ringKeep.end());
+    std::set_intersection(ringRemove.begin(), ringRemove.end(),
+                          ringKeep.begin(), ringKeep.end(),
+                          std::back_inserter(common));
+    if (common.size() != 2)
+        return false;
+
+    // the remaining facets must neither flip nor degenerate
+    for (int k = 0; k < 2; k++) {
+        const std::vector<unsigned long>& rFaces = (k == 0 ? rRemove : rKeep);
+        for (it = rFaces.begin(); it != rFaces.end(); ++it) {
+            if (*it == ulFacet || *it == ulNeighbour)
+                continue;
+            const MeshFacet& rAdj = rFacets[*it];
+            Base::Vector3f pOld[3], pNew[3];
+            for (int j = 0; j < 3; j++) {
+                unsigned long ulPt = rAdj._aulPoints[j];
+                pOld[j] = rPoints[ulPt];
+                if (ulPt == c.ulRemove || ulPt == c.ulKeep)
+                    pNew[j] = c.cPosition;
+                else
+                    pNew[j] = pOld[j];
+            }
+            Base::Vector3f nOld = (pOld[1] - pOld[0]) % (pOld[2] - pOld[0]);
+            Base::Vector3f nNew = (pNew[1] - pNew[0]) % (pNew[2] - pNew[0]);
+            if (nOld * nNew <= 0.1f * nOld.Length() * nNew.Length())
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void MeshSimplify::RemoveFacet(unsigned long ulPoint, unsigned long ulFacet)
+{
+    std::vector<unsigned long>& rFaces = _pointFacets[ulPoint];
+    std::vector<unsigned long>::iterator it = std::find(rFaces.begin(), rFaces.end(), ulFacet);
+    if (it != rFaces.end())
+        rFaces.erase(it);
+}
+
+bool MeshSimplify::ApplyCollapse(MeshTopoAlgorithm& topalg, const Collapse& c,
+                                 unsigned long ulFacet, unsigned long ulNeighbour)
+{
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    unsigned long ulOppFacet = ULONG_MAX, ulOppNeighbour = ULONG_MAX;
+    for (int j = 0; j < 3; j++) {
+        unsigned long ulPt = rFacets[ulFacet]._aulPoints[j];
+        if (ulPt != c.ulRemove && ulPt != c.ulKeep)
+            ulOppFacet = ulPt;
+        ulPt = rFacets[ulNeighbour]._aulPoints[j];
+        if (ulPt != c.ulRemove && ulPt != c.ulKeep)
+            ulOppNeighbour = ulPt;
+    }
+
+    if (!topalg.CollapseEdge(ulFacet, ulNeighbour))
+        return false;
+
+    const Base::Vector3f& v = c.cPosition;
+    _rclMesh.SetPoint(c.ulKeep, v.x, v.y, v.z);
+    _quadrics[c.ulKeep] += _quadrics[c.ulRemove];
+
+    // update the point to facet relation
+    RemoveFacet(ulOppFacet, ulFacet);
+    RemoveFacet(ulOppNeighbour, ulNeighbour);
+    RemoveFacet(c.ulKeep, ulFacet);
+    RemoveFacet(c.ulKeep, ulNeighbour);
+
+    std::vector<unsigned long>& rKeep = _pointFacets[c.ulKeep];
+    const std::vector<unsigned long>& rRemove = _pointFacets[c.ulRemove];
+    for (std::vector<unsigned long>::const_iterator it = rRemove.begin(); it != rRemove.end(); ++it) {
+        if (*it != ulFacet && *it != ulNeighbour)
+            rKeep.push_back(*it);
+    }
+    std::vector<unsigned long>().swap(_pointFacets[c.ulRemove]);
+
+    // invalidate all queued collapses of both points
+    _version[c.ulRemove]++;
+    _version[c.ulKeep]++;
+
+    // and compute the new costs for the edges around the remaining point
+    std::vector<unsigned long> ring;
+    for (std::vector<unsigned long>::const_iterator it = rKeep.begin(); it != rKeep.end(); ++it) {
+        for (int j = 0; j < 3; j++) {
+            unsigned long ulPt = rFacets[*it]._aulPoints[j];
+            if (ulPt != c.ulKeep)
+                ring.push_back(ulPt);
+        }
+    }
+    std::sort(ring.begin(), ring.end());
+    ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+    for (std::vector<unsigned long>::iterator it = ring.begin(); it != ring.end(); ++it)
+        AddCollapse(c.ulKeep, *it);
+
+    return true;
+}
+
+unsigned long MeshSimplify::Simplify(unsigned long ulTargetSize, float fTolerance)
+{
+    Initialize();
+
+    MeshTopoAlgorithm topalg(_rclMesh);
+    unsigned long ulCtFacets = _rclMesh.CountFacets();
+    unsigned long ulCollapsed = 0;
+    double fMaxCost = (double)fTolerance * (double)fTolerance;
+
+    while (!_heap.empty()) {
+        if (ulTargetSize > 0 && ulCtFacets <= ulTargetSize)
+            break;
+
+        std::pop_heap(_heap.begin(), _heap.end());
+        Collapse c = _heap.back();
+        _heap.pop_back();
+
+        // all further collapses are even more expensive
+        if (c.fCost > fMaxCost)
+            break;
+
+        unsigned long ulFacet, ulNeighbour;
+        if (!CheckCollapse(c, ulFacet, ulNeighbour))
+            continue;
+        if (ApplyCollapse(topalg, c, ulFacet, ulNeighbour)) {
+            ulCtFacets -= 2;
+            ulCollapsed++;
+        }
+    }
+
+    // release the memory of the helper structures
+    std::vector<Quadric>().swap(_quadrics);
+    std::vector<bool>().swap(_locked);
+    std::vector<unsigned long>().swap(_version);
+    std::vector<std::vector<unsigned long> >().swap(_pointFacets);
+    std::vector<Collapse>().swap(_heap);
+
+    if (ulCollapsed > 0) {
+        topalg.Cleanup();
+        _rclMesh.RecalcBoundBox();
+    }
+
+    return ulCollapsed;
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+
+/** The cell of a point. */
+struct PointCell
+{
+    unsigned long cell[3];
+    unsigned long point;
+
+    bool operator < (const PointCell& c) const
+    {
+        if (cell[0] != c.cell[0])
+            return cell[0] < c.cell[0];
+        if (cell[1] != c.cell[1])
+            return cell[1] < c.cell[1];
+        if (cell[2] != c.cell[2])
+            return cell[2] < c.cell[2];
+        return point < c.point;
+    }
+    bool SameCell(const PointCell& c) const
+    {
+        return cell[0] == c.cell[0] && cell[1] == c.cell[1] && cell[2] == c.cell[2];
+    }
+};
+
+/** A facet with its sorted point indices. */
+struct SortedFacet
+{
+    unsigned long points[3];
+    unsigned long facet;
+
+    bool operator < (const SortedFacet& f) const
+    {
+        if (points[0] != f.points[0])
+            return points[0] < f.points[0];
+        if (points[1] != f.points[1])
+            return points[1] < f.points[1];
+        if (points[2] != f.points[2])
+            return points[2] < f.points[2];
+        return facet < f.facet;
+    }
+    bool SamePoints(const SortedFacet& f) const
+    {
+        return points[0] == f.points[0] && points[1] == f.points[1] && points[2] == f.points[2];
+    }
+};
+
+}
+
+MeshVertexClustering::MeshVertexClustering(const MeshPointArray& rPoints, const MeshFacetArray& rFacets)
+  : _rclPoints(rPoints), _rclFacets(rFacets)
+{
+}
+
+void MeshVertexClustering::Simplify(float fCellSize, MeshPointArray& rPoints, MeshFacetArray& rFacets) const
+{
+    rPoints.clear();
+    rFacets.clear();
+    if (_rclPoints.empty() || fCellSize <= 0.0f)
+        return;
+
+    Base::BoundBox3f clBox;
+    for (MeshPointArray::_TConstIterator it = _rclPoints.begin(); it != _rclPoints.end(); ++it)
+        clBox.Add(*it);
+
+    // sort the points by their cells
+    std::vector<PointCell> cells(_rclPoints.size());
+    for (unsigned long i = 0; i < _rclPoints.size(); i++) {
+        const MeshPoint& rPoint = _rclPoints[i];
+        cells[i].cell[0] = (unsigned long)((rPoint.x - clBox.MinX) / fCellSize);
+        cells[i].cell[1] = (unsigned long)((rPoint.y - clBox.MinY) / fCellSize);
+        cells[i].cell[2] = (unsigned long)((rPoint.z - clBox.MinZ) / fCellSize);
+        cells[i].point = i;
+    }
+    std::sort(cells.begin(), cells.end());
+
+    // every cell becomes a point at the average of its points
+    std::vector<unsigned long> cluster(_rclPoints.size());
+    std::vector<PointCell>::iterator it = cells.begin();
+    while (it != cells.end()) {
+        std::vector<PointCell>::iterator jt = it;
+        double sum[3] = { 0.0, 0.0, 0.0 };
+        for (; jt != cells.end() && it->SameCell(*jt); ++jt) {
+            const MeshPoint& rPoint = _rclPoints[jt->point];
+            sum[0] += rPoint.x;
+            sum[1] += rPoint.y;
+            sum[2] += rPoint.z;
+            cluster[jt->point] = rPoints.size();
+        }
+
+        double count = (double)(jt - it);
+        rPoints.push_back(MeshPoint(Base::Vector3f((float)(sum[0] / count),
+                                                   (float)(sum[1] / count),
+                                                   (float)(sum[2] / count))));
+        it = jt;
+    }
+
+    std::vector<PointCell>().swap(cells);
+
+    // keep the facets whose points are in three different cells
+    std::vector<SortedFacet> facets;
+    for (MeshFacetArray::_TConstIterator jt = _rclFacets.begin(); jt != _rclFacets.end(); ++jt) {
+        SortedFacet facet;
+        for (int i = 0; i < 3; i++)
+            facet.points[i] = cluster[jt->_aulPoints[i]];
+        if (facet.points[0] == facet.points[1] || facet.points[1] == facet.points[2] ||
+            facet.points[2] == facet.points[0])
+            continue;
+        std::sort(facet.points, facet.points + 3);
+        facet.facet = jt - _rclFacets.begin();
+        facets.push_back(facet);
+    }
+
+    // remove duplicates but keep the order of the facets
+    std::sort(facets.begin(), facets.end());
+    std::vector<unsigned long> keep;
+    keep.reserve(facets.size());
+    for (std::vector<SortedFacet>::iterator jt = facets.begin(); jt != facets.end(); ++jt) {
+        if (jt == facets.begin() || !jt->SamePoints(*(jt - 1)))
+            keep.push_back(jt->facet);
+    }
+    std::vector<SortedFacet>().swap(facets);
+    std::sort(keep.begin(), keep.end());
+
+    rFacets.reserve(keep.size());
+    for (std::vector<unsigned long>::iterator jt = keep.begin(); jt != keep.end(); ++jt) {
+        const MeshFacet& rFace = _rclFacets[*jt];
+        rFacets.push_back(MeshFacet(cluster[rFace._aulPoints[0]],
+                                    cluster[rFace._aulPoints[1]],
+                                    cluster[rFace._aulPoints[2]]));
+    }
+}
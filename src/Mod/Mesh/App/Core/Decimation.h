@@ -0,0 +1,143 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef MESH_DECIMATION_H
+#define MESH_DECIMATION_H
+
+#include <vector>
+#include <Base/Vector3D.h>
+
+namespace MeshCore
+{
+class MeshKernel;
+class MeshTopoAlgorithm;
+class MeshPointArray;
+class MeshFacetArray;
+
+/**
+ * The MeshSimplify class reduces the number of facets of a mesh with the
+ * quadric error metric of Garland and Heckbert.
+ * Every point gets a quadric that sums up the squared distances to the planes of
+ * its adjacent facets. The edges are collapsed in the order of the error they
+ * would introduce and the remaining point of a collapsed edge is moved to the
+ * position that minimizes the summed up quadrics.
+ *
+ * Points at the border of the mesh are never removed or moved, so open borders keep
+ * their shape. Optionally the same is done for points at sharp edges.
+ * Collapses that would fold over facets or make the mesh non-manifold are rejected.
+ */
+class MeshExport MeshSimplify
+{
+public:
+    MeshSimplify(MeshKernel&);
+    ~MeshSimplify();
+
+    /**
+     * Points that are adjacent to an edge whose facets enclose an angle greater
+     * than \a fAngle (in radians) are kept untouched. A value less or equal to
+     * zero disables this check which is the default.
+     */
+    void SetFeatureAngle(float fAngle);
+    /**
+     * Simplifies the mesh until it has at most \a ulTargetSize facets or the
+     * error of the next collapse exceeds \a fTolerance. The error is the root of
+     * the summed up squared distances of the new point to the planes of the
+     * original facets around it. If \a ulTargetSize is 0 only the tolerance is
+     * taken into account.
+     * Returns the number of collapsed edges.
+     */
+    unsigned long Simplify(unsigned long ulTargetSize, float fTolerance);
+
+private:
+    /** Symmetric 4x4 matrix of the quadric error metric. */
+    struct Quadric
+    {
+        double m[10];
+
+        Quadric();
+        void AddPlane(double a, double b, double c, double d);
+        Quadric& operator += (const Quadric&);
+        double Evaluate(const Base::Vector3f&) const;
+        bool Optimize(Base::Vector3f&) const;
+    };
+
+    /** Collapse of the edge \a ulRemove-\a ulKeep into the point \a ulKeep. */
+    struct Collapse
+    {
+        unsigned long ulRemove, ulKeep;
+        unsigned long ulRemoveVersion, ulKeepVersion;
+        double fCost;
+        Base::Vector3f cPosition;
+
+        bool operator < (const Collapse& c) const
+        { return fCost > c.fCost; }
+    };
+
+    void Initialize();
+    void AddCollapse(unsigned long ulP0, unsigned long ulP1);
+    bool CheckCollapse(const Collapse&, unsigned long& ulFacet,
+                       unsigned long& ulNeighbour) const;
+    bool ApplyCollapse(MeshTopoAlgorithm&, const Collapse&,
+                       unsigned long ulFacet, unsigned long ulNeighbour);
+    void RemoveFacet(unsigned long ulPoint, unsigned long ulFacet);
+
+private:
+    MeshKernel& _rclMesh;
+    float _fFeatureAngle;
+    std::vector<Quadric> _quadrics;
+    std::vector<bool> _locked;
+    std::vector<unsigned long> _version;
+    std::vector<std::vector<unsigned long> > _pointFacets;
+    std::vector<Collapse> _heap;
+};
+
+/**
+ * The MeshVertexClustering class creates a coarse approximation of a mesh by vertex
+ * clustering. The bounding box is split into cubic cells and all points of a cell are
+ * replaced by their average. Facets whose points fall into less than three different
+ * cells are removed as well as facets that become duplicates.
+ *
+ * Unlike MeshSimplify it doesn't keep the topology of the mesh but it is very fast and
+ * every point moves by at most the diagonal of a cell. This makes it suitable to create
+ * levels of detail for rendering huge meshes.
+ */
+class MeshExport MeshVertexClustering
+{
+public:
+    MeshVertexClustering(const MeshPointArray& rPoints, const MeshFacetArray& rFacets);
+
+    /** Clusters the points with cells of length \a fCellSize and writes the
+     * simplified mesh to \a rPoints and \a rFacets. The neighbourhood of the
+     * facets is not set.
+     */
+    void Simplify(float fCellSize, MeshPointArray& rPoints, MeshFacetArray& rFacets) const;
+
+private:
+    const MeshPointArray& _rclPoints;
+    const MeshFacetArray& _rclFacets;
+};
+
+} // namespace MeshCore
+
+#endif // MESH_DECIMATION_H
@@ -92,7 +92,8 @@ MeshPointArray& MeshPointArray::operator = (const MeshPointArray &rclPAry)
 
 void MeshFacetArray::Erase (_TIterator pIter)
 {
-  unsigned long i, *pulN;
+  unsigned long i;
+  MeshIndex *pulN;
   _TIterator  pPass, pEnd;
   unsigned long ulInd = pIter - begin();
   erase(pIter);
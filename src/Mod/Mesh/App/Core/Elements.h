@@ -122,7 +122,7 @@ public:
   bool IsValid (void) const
   { return !IsFlag(INVALID); }
   void SetProperty(unsigned long uP) const
-  { const_cast<MeshPoint*>(this)->_ulProp = uP; }
+  { const_cast<MeshPoint*>(this)->_ulProp = (unsigned int)uP; }
   //@}
 
   // Assignment
@@ -135,7 +135,9 @@ public:
 
 public:
   unsigned char _ucFlag; /**< Flag member */
-  unsigned long _ulProp; /**< Free usable property */
+  /** Free usable property. Only 32 bits wide so that a point takes 20 instead
+   * of 24 bytes on 64-bit platforms. */
+  unsigned int  _ulProp;
 };
 
 /**
@@ -159,6 +161,42 @@ public:
   bool     _bBorder;       /**< Set to true if border edge */
 };
 
+/**
+ * The MeshIndex class holds a point or facet index of a MeshFacet in 32 bits. It converts
+ * implicitly to and from unsigned long so that it can be used like the former unsigned long
+ * members. ULONG_MAX, the value for a missing neighbour or an undefined point, is stored as
+ * UINT_MAX and converted back. Thus a mesh can have up to UINT_MAX-1 points and facets.
+ * A default constructed index is undefined, i.e. ULONG_MAX.
+ */
+class MeshIndex
+{
+public:
+  MeshIndex (void) : _uiIndex(UINT_MAX) { }
+  explicit MeshIndex (unsigned long ulIndex)
+  { *this = ulIndex; }
+
+  MeshIndex& operator = (unsigned long ulIndex)
+  { _uiIndex = (ulIndex == ULONG_MAX ? UINT_MAX : (unsigned int)ulIndex); return *this; }
+  operator unsigned long () const
+  { return (_uiIndex == UINT_MAX ? ULONG_MAX : (unsigned long)_uiIndex); }
+
+  MeshIndex& operator ++ ()
+  { ++_uiIndex; return *this; }
+  MeshIndex& operator -- ()
+  { --_uiIndex; return *this; }
+  unsigned long operator ++ (int)
+  { unsigned long ul = *this; ++_uiIndex; return ul; }
+  unsigned long operator -- (int)
+  { unsigned long ul = *this; --_uiIndex; return ul; }
+  MeshIndex& operator += (unsigned long ul)
+  { return *this = (unsigned long)*this + ul; }
+  MeshIndex& operator -= (unsigned long ul)
+  { return *this = (unsigned long)*this - ul; }
+
+private:
+  unsigned int _uiIndex;
+};
+
 /**
  * The MeshFacet class represent a triangle facet in the mesh data.structure. A facet indexes
  * three neighbour facets and also three corner points.
@@ -203,7 +241,7 @@ public:
   void ResetInvalid (void) const
   { ResetFlag(INVALID); }
   void SetProperty(unsigned long uP) const
-  { const_cast<MeshFacet*>(this)->_ulProp = uP; }
+  { const_cast<MeshFacet*>(this)->_ulProp = (unsigned int)uP; }
   /**
    * Marks a facet as invalid. Should be used only temporary from within an algorithm
    * (e.g. deletion of several facets) but must not be set permanently.
@@ -292,9 +330,11 @@ public:
 
 public:
   unsigned char _ucFlag; /**< Flag member. */
-  unsigned long _ulProp; /**< Free usable property. */
-  unsigned long _aulPoints[3];     /**< Indices of corner points. */
-  unsigned long _aulNeighbours[3]; /**< Indices of neighbour facets. */
+  /** Free usable property. Like the indices only 32 bits wide so that a facet
+   * takes 32 instead of 64 bytes on 64-bit platforms. */
+  unsigned int  _ulProp;
+  MeshIndex _aulPoints[3];     /**< Indices of corner points. */
+  MeshIndex _aulNeighbours[3]; /**< Indices of neighbour facets. */
 };
 
 /**
@@ -749,8 +789,8 @@ inline MeshFacet::MeshFacet (void)
 : _ucFlag(0),
   _ulProp(0)
 {
-    memset(_aulNeighbours, 0xff, sizeof(ULONG_MAX) * 3);
-    memset(_aulPoints, 0xff, sizeof(ULONG_MAX) * 3);
+    memset(_aulNeighbours, 0xff, sizeof(_aulNeighbours));
+    memset(_aulPoints, 0xff, sizeof(_aulPoints));
 }
 
 inline MeshFacet::MeshFacet(const MeshFacet &rclF)
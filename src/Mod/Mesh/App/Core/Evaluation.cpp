@@ -28,6 +28,12 @@
 # include <vector>
 #endif
 
+#include <QAtomicInt>
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
+
 #include <Mod/Mesh/App/WildMagic4/Wm4Matrix3.h>
 #include <Mod/Mesh/App/WildMagic4/Wm4Vector3.h>
 
@@ -39,6 +45,7 @@
 #include "Helpers.h"
 #include "Grid.h"
 #include "TopoAlgorithm.h"
+#include <Base/Exception.h>
 #include <Base/Matrix.h>
 
 #include <Base/Sequencer.h>
@@ -469,8 +476,8 @@ bool MeshEvalPointManifolds::Evaluate ()
     unsigned long ctPoints = _rclMesh.CountPoints();
     for (unsigned long index=0; index < ctPoints; index++) {
         // get the local neighbourhood of the point
-        const std::set<unsigned long>& nf = vf_it[index];
-        const std::set<unsigned long>& np = vv_it[index];
+        MeshIndexRange nf = vf_it[index];
+        MeshIndexRange np = vv_it[index];
 
         std::set<unsigned long>::size_type sp, sf;
         sp = np.size();
@@ -586,44 +593,92 @@ bool MeshFixSingleFacet::Fixup ()
 
 // ----------------------------------------------------------------
 
-bool MeshEvalSelfIntersection::Evaluate ()
+namespace MeshCore {
+/**
+ * Helper class to search for self-intersections. Each facet is only tested against
+ * facets with a higher index that lie in one of its grid elements so that every
+ * pair is tested exactly once and no duplicates must be removed afterwards.
+ * Blocks of facets are processed in parallel.
+ */
+class MeshSelfIntersectionSearch
 {
-    // Contains bounding boxes for every facet 
-    std::vector<Base::BoundBox3f> boxes;
-
-    // Splits the mesh using grid for speeding up the calculation
-    MeshFacetGrid cMeshFacetGrid(_rclMesh);
-    const MeshFacetArray& rFaces = _rclMesh.GetFacets();
-    MeshGridIterator clGridIter(cMeshFacetGrid);
-    unsigned long ulGridX, ulGridY, ulGridZ;
-    cMeshFacetGrid.GetCtGrids(ulGridX, ulGridY, ulGridZ);
+public:
+    typedef std::pair<unsigned long, unsigned long> FacetPair;
+    typedef std::pair<unsigned long, unsigned long> FacetRange;
 
-    MeshFacetIterator cMFI(_rclMesh);
-    for (cMFI.Begin(); cMFI.More(); cMFI.Next()) {
-        boxes.push_back((*cMFI).GetBoundBox());
+    MeshSelfIntersectionSearch(const MeshKernel& mesh, bool stopAtFirst)
+      : mesh(mesh), grid(mesh), stopAtFirst(stopAtFirst), found(0)
+    {
+        boxes.reserve(mesh.CountFacets());
+        MeshFacetIterator cMFI(mesh);
+        for (cMFI.Begin(); cMFI.More(); cMFI.Next()) {
+            boxes.push_back((*cMFI).GetBoundBox());
+        }
     }
 
-    // Calculates the intersections
-    Base::SequencerLauncher seq("Checking for self-intersections...", ulGridX*ulGridY*ulGridZ);
-    for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
-        //Get the facet indices, belonging to the current grid unit
-        std::vector<unsigned long> aulGridElements;
-        clGridIter.GetElements(aulGridElements);
+    /** If \a canAbort is true the user can cancel the search and an AbortException
+     * is thrown then. */
+    void Search(std::vector<FacetPair>& intersection, bool canAbort)
+    {
+        const unsigned long blockSize = 4096;
+        unsigned long countFacets = mesh.CountFacets();
+        std::vector<FacetRange> blocks;
+        for (unsigned long i = 0; i < countFacets; i += blockSize)
+            blocks.push_back(std::make_pair(i, std::min<unsigned long>(i + blockSize, countFacets)));
+
+        Base::SequencerLauncher seq("Checking for self-intersections...", blocks.size());
+        if (blocks.size() > 1 && QThread::idealThreadCount() > 1) {
+            QFuture<std::vector<FacetPair> > future = QtConcurrent::mapped
+                (blocks, boost::bind(&MeshSelfIntersectionSearch::SearchBlock, this, _1));
+            try {
+                // the blocks are collected in order on this thread, which reports
+                // the progress and, if allowed, lets the user cancel the search
+                for (int i = 0; i < (int)blocks.size(); i++) {
+                    const std::vector<FacetPair>& pairs = future.resultAt(i);
+                    intersection.insert(intersection.end(), pairs.begin(), pairs.end());
+                    if (stopAtFirst && !intersection.empty())
+                        break;
+                    seq.next(canAbort);
+                }
+            }
+            catch (...) {
+                future.cancel();
+                future.waitForFinished();
+                throw;
+            }
+            future.cancel();
+            future.waitForFinished();
+        }
+        else {
+            for (std::vector<FacetRange>::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+                std::vector<FacetPair> pairs = SearchBlock(*it);
+                intersection.insert(intersection.end(), pairs.begin(), pairs.end());
+                if (stopAtFirst && !intersection.empty())
+                    break;
+                seq.next(canAbort);
+            }
+        }
+    }
 
-        seq.next();
-        if (aulGridElements.size()==0)
-            continue;
+    std::vector<FacetPair> SearchBlock(const FacetRange& range)
+    {
+        std::vector<FacetPair> pairs;
+        std::vector<unsigned long> elements;
+        const MeshFacetArray& rFaces = mesh.GetFacets();
 
         MeshGeomFacet facet1, facet2;
         Base::Vector3f pt1, pt2;
-        for (std::vector<unsigned long>::iterator it = aulGridElements.begin(); it != aulGridElements.end(); ++it) {
-            const Base::BoundBox3f& box1 = boxes[*it];
-            cMFI.Set(*it);
-            facet1 = *cMFI;
-            const MeshFacet& rface1 = rFaces[*it];
-            for (std::vector<unsigned long>::iterator jt = it; jt != aulGridElements.end(); ++jt) {
-                if (jt == it) // the identical facet
-                    continue;
+        for (unsigned long i = range.first; i < range.second; i++) {
+            if (stopAtFirst && found)
+                break;
+
+            const Base::BoundBox3f& box1 = boxes[i];
+            grid.Inside(box1, elements, true);
+
+            facet1 = mesh.GetFacet(i);
+            const MeshFacet& rface1 = rFaces[i];
+            std::vector<unsigned long>::iterator jt = std::upper_bound(elements.begin(), elements.end(), i);
+            for (; jt != elements.end(); ++jt) {
                 // If the facets share a common vertex we do not check for self-intersections because they 
                 // could but usually do not intersect each other and the algorithm below would detect false-positives,
                 // otherwise
@@ -643,19 +698,38 @@ bool MeshEvalSelfIntersection::Evaluate ()
 
                 const Base::BoundBox3f& box2 = boxes[*jt];
                 if (box1 && box2) {
-                    cMFI.Set(*jt);
-                    facet2 = *cMFI;
+                    facet2 = mesh.GetFacet(*jt);
                     int ret = facet1.IntersectWithFacet(facet2, pt1, pt2);
                     if (ret == 2) {
-                        // abort after the first detected self-intersection
-                        return false;
+                        pairs.push_back(std::make_pair(i, *jt));
+                        if (stopAtFirst) {
+                            found.fetchAndStoreRelaxed(1);
+                            return pairs;
+                        }
                     }
                 }
             }
         }
+
+        return pairs;
     }
 
-    return true;
+private:
+    const MeshKernel& mesh;
+    MeshFacetGrid grid;
+    std::vector<Base::BoundBox3f> boxes;
+    bool stopAtFirst;
+    QAtomicInt found;
+};
+}
+
+bool MeshEvalSelfIntersection::Evaluate ()
+{
+    // abort after the first detected self-intersection
+    std::vector<std::pair<unsigned long, unsigned long> > intersection;
+    MeshSelfIntersectionSearch search(_rclMesh, true);
+    search.Search(intersection, false);
+    return intersection.empty();
 }
 
 void MeshEvalSelfIntersection::GetIntersections(const std::vector<std::pair<unsigned long, unsigned long> >& indices,
@@ -684,72 +758,8 @@ void MeshEvalSelfIntersection::GetIntersections(const std::vector<std::pair<unsi
 
 void MeshEvalSelfIntersection::GetIntersections(std::vector<std::pair<unsigned long, unsigned long> >& intersection) const
 {
-    // Contains bounding boxes for every facet 
-    std::vector<Base::BoundBox3f> boxes;
-    //intersection.clear();
-
-    // Splits the mesh using grid for speeding up the calculation
-    MeshFacetGrid cMeshFacetGrid(_rclMesh);
-    const MeshFacetArray& rFaces = _rclMesh.GetFacets();
-    MeshGridIterator clGridIter(cMeshFacetGrid);
-    unsigned long ulGridX, ulGridY, ulGridZ;
-    cMeshFacetGrid.GetCtGrids(ulGridX, ulGridY, ulGridZ);
-
-    MeshFacetIterator cMFI(_rclMesh);
-    for(cMFI.Begin(); cMFI.More(); cMFI.Next()) {
-        boxes.push_back((*cMFI).GetBoundBox());
-    }
-
-    // Calculates the intersections
-    Base::SequencerLauncher seq("Checking for self-intersections...", ulGridX*ulGridY*ulGridZ);
-    for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
-        //Get the facet indices, belonging to the current grid unit
-        std::vector<unsigned long> aulGridElements;
-        clGridIter.GetElements(aulGridElements);
-
-        seq.next(true);
-        if (aulGridElements.size()==0)
-            continue;
-
-        MeshGeomFacet facet1, facet2;
-        Base::Vector3f pt1, pt2;
-        for (std::vector<unsigned long>::iterator it = aulGridElements.begin(); it != aulGridElements.end(); ++it) {
-            const Base::BoundBox3f& box1 = boxes[*it];
-            cMFI.Set(*it);
-            facet1 = *cMFI;
-            const MeshFacet& rface1 = rFaces[*it];
-            for (std::vector<unsigned long>::iterator jt = it; jt != aulGridElements.end(); ++jt) {
-                if (jt == it) // the identical facet
-                    continue;
-                // If the facets share a common vertex we do not check for self-intersections because they 
-                // could but usually do not intersect each other and the algorithm below would detect false-positives,
-                // otherwise
-                const MeshFacet& rface2 = rFaces[*jt];
-                if (rface1._aulPoints[0] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[0] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[0] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[1] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[1] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[1] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[2] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[2] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[2] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-
-                const Base::BoundBox3f& box2 = boxes[*jt];
-                if (box1 && box2) {
-                    cMFI.Set(*jt);
-                    facet2 = *cMFI;
-                    int ret = facet1.IntersectWithFacet(facet2, pt1, pt2);
-                    if (ret == 2) {
-                        intersection.push_back(std::make_pair (*it,*jt));
-                    }
-                }
-            }
-        }
-    }
+    MeshSelfIntersectionSearch search(_rclMesh, false);
+    search.Search(intersection, true); // allow to cancel
 }
 
 std::vector<unsigned long> MeshFixSelfIntersection::GetFacets() const
@@ -943,75 +953,248 @@ bool MeshFixNeighbourhood::Fixup()
     return true;
 }
 
-void MeshKernel::RebuildNeighbours (unsigned long index)
+namespace MeshCore {
+
+/**
+ * Helper class to compute the neighbourhood of facets. The edges are stored as
+ * 64-bit keys with the lower point index in the upper and the higher point
+ * index in the lower 32 bits, so that equal edges become equal keys. The keys
+ * are sorted with a LSD radix sort whose passes are split into blocks that are
+ * counted and scattered in parallel. Afterwards the runs of equal keys are
+ * processed in parallel, too.
+ * If a sequencer is given it advances by one step per facet. This is done on
+ * the calling thread between the phases, so that cancelling the sequencer
+ * never leaves a worker thread behind.
+ */
+class MeshEdgeSort
 {
-    std::vector<Edge_Index> edges;
-    edges.reserve(3 * (this->_aclFacetArray.size() - index));
+public:
+    MeshEdgeSort(MeshFacetArray& facets, unsigned long index, unsigned long ctPoints,
+                 Base::SequencerLauncher* seq, bool nonManifolds)
+      : _facets(facets), _index(index), _ctPoints(ctPoints), _seq(seq)
+      , _nonManifolds(nonManifolds), _ctFacets(0), _progress(0)
+    {
+    }
 
-    // build up an array of edges
-    MeshFacetArray::_TConstIterator pI;
-    MeshFacetArray::_TConstIterator pB = this->_aclFacetArray.begin();
-    for (pI = pB + index; pI != this->_aclFacetArray.end(); pI++) {
-        for (int i = 0; i < 3; i++) {
-            Edge_Index item;
-            item.p0 = std::min<unsigned long>(pI->_aulPoints[i], pI->_aulPoints[(i+1)%3]);
-            item.p1 = std::max<unsigned long>(pI->_aulPoints[i], pI->_aulPoints[(i+1)%3]);
-            item.f  = pI - pB;
-            edges.push_back(item);
+    void Perform()
+    {
+        unsigned long ctFacets = _facets.size() - _index;
+        std::size_t ctEdges = 3 * ctFacets;
+        _ctFacets = ctFacets;
+        _progress = 0;
+        if (ctEdges == 0)
+            return;
+
+        // Every point index must fit into 32 bits. A mesh with more points
+        // wouldn't fit into memory anyway.
+        if ((uint64_t)_ctPoints > (uint64_t)0xffffffffu)
+            throw Base::MemoryException();
+
+        _keys.resize(ctEdges);
+        _values.resize(ctEdges);
+        _tmpKeys.resize(ctEdges);
+        _tmpValues.resize(ctEdges);
+
+        std::size_t ctThreads = (std::size_t)std::max<int>(1, QThread::idealThreadCount());
+        std::size_t ctBlocks = std::min<std::size_t>(ctThreads, ctEdges / 65536 + 1);
+
+        // build up the keys, the value holds the facet index and the side
+        std::vector<Block> blocks(ctBlocks);
+        SetupBlocks(blocks, ctFacets, 0);
+        Run(blocks, &MeshEdgeSort::FillKeys);
+
+        // only sort by the bytes that are used at all
+        uint64_t mask = 0;
+        for (std::size_t i = 0; i < ctBlocks; i++)
+            mask |= blocks[i].bits;
+
+        // the phases are filling the keys, the sort passes and the assignment
+        int ctPhases = 2, phase = 1;
+        for (int shift = 0; shift < 64; shift += 8) {
+            if (((mask >> shift) & 0xff) != 0)
+                ctPhases++;
+        }
+        Advance(phase++, ctPhases);
+
+        SetupBlocks(blocks, ctEdges, 0);
+        for (int shift = 0; shift < 64; shift += 8) {
+            if (((mask >> shift) & 0xff) == 0)
+                continue;
+            for (std::size_t i = 0; i < ctBlocks; i++)
+                blocks[i].shift = shift;
+            Run(blocks, &MeshEdgeSort::Count);
+
+            // offset of each digit in each block, for a stable sort the
+            // blocks are ordered within a digit
+            std::size_t offset = 0;
+            for (int d = 0; d < 256; d++) {
+                for (std::size_t i = 0; i < ctBlocks; i++) {
+                    std::size_t count = blocks[i].count[d];
+                    blocks[i].count[d] = offset;
+                    offset += count;
+                }
+            }
+
+            Run(blocks, &MeshEdgeSort::Scatter);
+            _keys.swap(_tmpKeys);
+            _values.swap(_tmpValues);
+            Advance(phase++, ctPhases);
         }
+
+        std::vector<uint64_t>().swap(_tmpKeys);
+        std::vector<uint64_t>().swap(_tmpValues);
+
+        // equal edges must not be split over two blocks
+        SetupBlocks(blocks, ctEdges, 0);
+        for (std::size_t i = 1; i < ctBlocks; i++) {
+            std::size_t pos = std::max(blocks[i].begin, blocks[i-1].begin);
+            while (pos > 0 && pos < ctEdges && _keys[pos] == _keys[pos-1])
+                pos++;
+            blocks[i].begin = pos;
+            blocks[i-1].end = pos;
+        }
+        Run(blocks, &MeshEdgeSort::SetNeighbours);
+        Advance(phase++, ctPhases);
     }
 
-    // sort the edges
-    std::sort(edges.begin(), edges.end(), Edge_Less());
+private:
+    struct Block
+    {
+        MeshEdgeSort* sort;
+        std::size_t begin, end;
+        int shift;
+        uint64_t bits;
+        std::size_t count[256];
+    };
+
+    void SetupBlocks(std::vector<Block>& blocks, std::size_t size, int shift)
+    {
+        std::size_t ctBlocks = blocks.size();
+        for (std::size_t i = 0; i < ctBlocks; i++) {
+            blocks[i].sort = this;
+            blocks[i].begin = size * i / ctBlocks;
+            blocks[i].end = size * (i + 1) / ctBlocks;
+            blocks[i].shift = shift;
+            blocks[i].bits = 0;
+        }
+    }
 
-    unsigned long p0 = ULONG_MAX, p1 = ULONG_MAX;
-    unsigned long f0 = ULONG_MAX, f1 = ULONG_MAX;
-    int count = 0;
-    std::vector<Edge_Index>::iterator pE;
-    for (pE = edges.begin(); pE != edges.end(); pE++) {
-        if (p0 == pE->p0 && p1 == pE->p1) {
-            f1 = pE->f;
-            count++;
+    void Advance(int phase, int ctPhases)
+    {
+        if (!_seq)
+            return;
+        unsigned long step = (unsigned long)((uint64_t)_ctFacets * phase / ctPhases);
+        while (_progress < step) {
+            _seq->next(true); // allow to cancel
+            _progress++;
         }
-        else {
+    }
+
+    void Run(std::vector<Block>& blocks, void (*func)(Block&))
+    {
+        if (blocks.size() > 1)
+            QtConcurrent::blockingMap(blocks, func);
+        else
+            func(blocks.front());
+    }
+
+    static void FillKeys(Block& b)
+    {
+        MeshEdgeSort& s = *b.sort;
+        for (std::size_t i = b.begin; i < b.end; i++) {
+            unsigned long index = s._index + i;
+            const MeshFacet& rFace = s._facets[index];
+            for (int j = 0; j < 3; j++) {
+                uint64_t p0 = rFace._aulPoints[j];
+                uint64_t p1 = rFace._aulPoints[(j+1)%3];
+                if (p0 > p1)
+                    std::swap(p0, p1);
+                s._keys[3*i+j] = (p0 << 32) | p1;
+                b.bits |= s._keys[3*i+j];
+                s._values[3*i+j] = ((uint64_t)index << 2) | j;
+            }
+        }
+    }
+
+    static void Count(Block& b)
+    {
+        MeshEdgeSort& s = *b.sort;
+        std::fill(b.count, b.count + 256, 0);
+        for (std::size_t i = b.begin; i < b.end; i++)
+            b.count[(s._keys[i] >> b.shift) & 0xff]++;
+    }
+
+    static void Scatter(Block& b)
+    {
+        MeshEdgeSort& s = *b.sort;
+        for (std::size_t i = b.begin; i < b.end; i++) {
+            std::size_t pos = b.count[(s._keys[i] >> b.shift) & 0xff]++;
+            s._tmpKeys[pos] = s._keys[i];
+            s._tmpValues[pos] = s._values[i];
+        }
+    }
+
+    static void SetNeighbours(Block& b)
+    {
+        MeshEdgeSort& s = *b.sort;
+        std::size_t i = b.begin;
+        while (i < b.end) {
+            std::size_t j = i + 1;
+            while (j < b.end && s._keys[j] == s._keys[i])
+                j++;
+
             // we handle only the cases for 1 and 2, for all higher
             // values we have a non-manifold that is ignorned here
-            if (count == 2) {
-                MeshFacet& rFace0 = this->_aclFacetArray[f0];
-                MeshFacet& rFace1 = this->_aclFacetArray[f1];
-                unsigned short side0 = rFace0.Side(p0,p1);
-                unsigned short side1 = rFace1.Side(p0,p1);
-                rFace0._aulNeighbours[side0] = f1;
-                rFace1._aulNeighbours[side1] = f0;
+            unsigned long f0 = (unsigned long)(s._values[i] >> 2);
+            int side0 = (int)(s._values[i] & 3);
+            if (j - i == 2) {
+                unsigned long f1 = (unsigned long)(s._values[i+1] >> 2);
+                int side1 = (int)(s._values[i+1] & 3);
+                s._facets[f0]._aulNeighbours[side0] = f1;
+                s._facets[f1]._aulNeighbours[side1] = f0;
             }
-            else if (count == 1) {
-                MeshFacet& rFace = this->_aclFacetArray[f0];
-                unsigned short side = rFace.Side(p0,p1);
-                rFace._aulNeighbours[side] = ULONG_MAX;
+            else if (j - i == 1) {
+                s._facets[f0]._aulNeighbours[side0] = ULONG_MAX;
+            }
+            else if (s._nonManifolds) {
+                // the sort is stable, so the facets of a run are in ascending
+                // order: all facets point to the first one and the first one
+                // points to the last one
+                for (std::size_t k = i + 1; k < j; k++) {
+                    unsigned long f1 = (unsigned long)(s._values[k] >> 2);
+                    int side1 = (int)(s._values[k] & 3);
+                    s._facets[f1]._aulNeighbours[side1] = f0;
+                }
+                s._facets[f0]._aulNeighbours[side0] = (unsigned long)(s._values[j-1] >> 2);
             }
 
-            p0 = pE->p0;
-            p1 = pE->p1;
-            f0 = pE->f;
-            count = 1;
+            i = j;
         }
     }
 
-    // we handle only the cases for 1 and 2, for all higher
-    // values we have a non-manifold that is ignorned here
-    if (count == 2) {
-        MeshFacet& rFace0 = this->_aclFacetArray[f0];
-        MeshFacet& rFace1 = this->_aclFacetArray[f1];
-        unsigned short side0 = rFace0.Side(p0,p1);
-        unsigned short side1 = rFace1.Side(p0,p1);
-        rFace0._aulNeighbours[side0] = f1;
-        rFace1._aulNeighbours[side1] = f0;
-    }
-    else if (count == 1) {
-        MeshFacet& rFace = this->_aclFacetArray[f0];
-        unsigned short side = rFace.Side(p0,p1);
-        rFace._aulNeighbours[side] = ULONG_MAX;
-    }
+private:
+    MeshFacetArray& _facets;
+    unsigned long _index;
+    unsigned long _ctPoints;
+    Base::SequencerLauncher* _seq;
+    bool _nonManifolds;
+    unsigned long _ctFacets, _progress;
+    std::vector<uint64_t> _keys, _values;
+    std::vector<uint64_t> _tmpKeys, _tmpValues;
+};
+
+}
+
+void MeshKernel::RebuildNeighbours (unsigned long index)
+{
+    MeshEdgeSort sort(this->_aclFacetArray, index, this->_aclPointArray.size(), 0, false);
+    sort.Perform();
+}
+
+void MeshKernel::RebuildNeighbours (unsigned long index, Base::SequencerLauncher* seq, bool nonManifolds)
+{
+    MeshEdgeSort sort(this->_aclFacetArray, index, this->_aclPointArray.size(), seq, nonManifolds);
+    sort.Perform();
 }
 
 void MeshKernel::RebuildNeighbours (void)
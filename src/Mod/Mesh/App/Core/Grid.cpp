@@ -27,6 +27,10 @@
 # include <algorithm>
 #endif
 
+#include <QThread>
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
+
 #include "Grid.h"
 #include "Iterator.h"
 
@@ -62,7 +66,8 @@ void MeshGrid::Attach (const MeshKernel &rclM)
 
 void MeshGrid::Clear (void)
 {
-  _aulGrid.clear();
+  _aulGridOffsets.clear();
+  _aulGridElements.clear();
   _pclMesh = NULL;  
 }
 
@@ -93,8 +98,6 @@ void MeshGrid::InitGrid (void)
 {
   assert(_pclMesh != NULL);
 
-  unsigned long i, j;
-
   // Grid Laengen berechnen wenn nicht initialisiert
   //
   if ((_ulCtGridsX == 0) || (_ulCtGridsY == 0) || (_ulCtGridsZ == 0))
@@ -128,13 +131,72 @@ void MeshGrid::InitGrid (void)
   }
 
   // Daten-Struktur anlegen
-  _aulGrid.clear();
-  _aulGrid.resize(_ulCtGridsX);
-  for (i = 0; i < _ulCtGridsX; i++)
+  AllocateGrid();
+}
+
+void MeshGrid::AllocateGrid (void)
+{
+  _aulGridOffsets.clear();
+  _aulGridOffsets.resize(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+  _aulGridElements.clear();
+}
+
+void MeshGrid::CollectGridEntries (GridBlock &block) const
+{
+  block.entries.reserve(block.ulEnd - block.ulBegin);
+
+  std::vector<unsigned long> grids;
+  for (unsigned long i = block.ulBegin; i < block.ulEnd; i++)
   {
-    _aulGrid[i].resize(_ulCtGridsY);
-    for (j = 0; j < _ulCtGridsY; j++)
-      _aulGrid[i][j].resize(_ulCtGridsZ);
+    grids.clear();
+    GetElementGrids(i, grids);
+    for (std::vector<unsigned long>::iterator it = grids.begin(); it != grids.end(); ++it)
+      block.entries.push_back(std::make_pair(*it, i));
+  }
+}
+
+void MeshGrid::FillGrid (void)
+{
+  // The expensive part is to find the grids of each element. This is done for blocks of
+  // consecutive elements in parallel, afterwards the (grid, element) pairs are distributed
+  // into the flat data structure with a counting sort. Because the blocks are processed in
+  // their original order each grid keeps its elements in ascending order.
+  const unsigned long ulBlockSize = 16384;
+  unsigned long ulCtElements = HasElements();
+  unsigned long ulCtGrids = _aulGridOffsets.size() - 1;
+
+  std::vector<GridBlock> blocks;
+  for (unsigned long i = 0; i < ulCtElements; i += ulBlockSize) {
+    GridBlock block;
+    block.ulBegin = i;
+    block.ulEnd = std::min<unsigned long>(i + ulBlockSize, ulCtElements);
+    blocks.push_back(block);
+  }
+
+  if (blocks.size() > 1 && QThread::idealThreadCount() > 1) {
+    QtConcurrent::blockingMap(blocks, boost::bind(&MeshGrid::CollectGridEntries, this, _1));
+  }
+  else {
+    for (std::vector<GridBlock>::iterator it = blocks.begin(); it != blocks.end(); ++it)
+      CollectGridEntries(*it);
+  }
+
+  // count the elements per grid
+  std::vector<GridBlock>::const_iterator jt;
+  std::vector<std::pair<unsigned long, unsigned long> >::const_iterator kt;
+  for (jt = blocks.begin(); jt != blocks.end(); ++jt) {
+    for (kt = jt->entries.begin(); kt != jt->entries.end(); ++kt)
+      _aulGridOffsets[kt->first + 1]++;
+  }
+  for (unsigned long i = 0; i < ulCtGrids; i++)
+    _aulGridOffsets[i + 1] += _aulGridOffsets[i];
+
+  // and move them to their place
+  _aulGridElements.resize(_aulGridOffsets.back());
+  std::vector<unsigned long> aulNext(_aulGridOffsets.begin(), _aulGridOffsets.end() - 1);
+  for (jt = blocks.begin(); jt != blocks.end(); ++jt) {
+    for (kt = jt->entries.begin(); kt != jt->entries.end(); ++kt)
+      _aulGridElements[aulNext[kt->first]++] = kt->second;
   }
 }
 
@@ -155,7 +217,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(raulElements.end(), GridBegin(i, j, k), GridEnd(i, j, k));
       }
     }
   }  
@@ -190,7 +252,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
         if (Base::DistanceP2(GetBoundBox(i, j, k).CalcCenter(), rclOrg) < fMinDistP2)
-          raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+          raulElements.insert(raulElements.end(), GridBegin(i, j, k), GridEnd(i, j, k));
       }
     }
   }  
@@ -221,7 +283,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::set<unsigned
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(_aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(GridBegin(i, j, k), GridEnd(i, j, k));
       }
     }
   }  
@@ -451,7 +513,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(GridBegin(nX, i, j), GridEnd(nX, i, j));
           }
           nX++;
         }
@@ -465,7 +527,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(GridBegin(nX, i, j), GridEnd(nX, i, j));
           }
           nX++;
         }
@@ -479,7 +541,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(GridBegin(i, nY, j), GridEnd(i, nY, j));
           }
           nY++;
         }
@@ -493,7 +555,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(GridBegin(i, nY, j), GridEnd(i, nY, j));
           }
           nY--;
         }
@@ -507,7 +569,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(GridBegin(i, j, nZ), GridEnd(i, j, nZ));
           }
           nZ++;
         }
@@ -521,7 +583,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(GridBegin(i, j, nZ), GridEnd(i, j, nZ));
           }
           nZ--;
         }
@@ -587,11 +649,11 @@ void MeshGrid::GetHull (unsigned long ulX, unsigned long ulY, unsigned long ulZ,
 unsigned long MeshGrid::GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  
                                      std::set<unsigned long> &raclInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  if (rclSet.size() > 0)
+  unsigned long ulCount = GetCtElements(ulX, ulY, ulZ);
+  if (ulCount > 0)
   {
-    raclInd.insert(rclSet.begin(), rclSet.end());
-    return rclSet.size();
+    raclInd.insert(GridBegin(ulX, ulY, ulZ), GridEnd(ulX, ulY, ulZ));
+    return ulCount;
   }
 
   return 0;
@@ -603,9 +665,7 @@ unsigned long MeshGrid::GetElements(const Base::Vector3f &rclPoint, std::vector<
   if (!CheckPosition(rclPoint, ulX, ulY, ulZ))
     return 0;
 
-  aulFacets.resize(_aulGrid[ulX][ulY][ulZ].size());
-
-  std::copy(_aulGrid[ulX][ulY][ulZ].begin(), _aulGrid[ulX][ulY][ulZ].end(), aulFacets.begin());
+  aulFacets.assign(GridBegin(ulX, ulY, ulZ), GridEnd(ulX, ulY, ulZ));
   return aulFacets.size();
 }
 
@@ -710,15 +770,12 @@ void MeshFacetGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-  MeshFacetIterator clFIter(*_pclMesh);
-
-  unsigned long i = 0;
-  for (clFIter.Init(); clFIter.More(); clFIter.Next())
-  {
-//    AddFacet(*clFIter, i++, 2.0f);
-    AddFacet(*clFIter, i++);
-  }
+  FillGrid();
+}
 
+void MeshFacetGrid::GetElementGrids (unsigned long ulElement, std::vector<unsigned long> &raulGrids) const
+{
+  GetFacetGrids(_pclMesh->GetFacet(ulElement), raulGrids);
 }
 
 unsigned long MeshFacetGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt) const
@@ -919,8 +976,8 @@ void MeshFacetGrid::SearchNearestFacetInGrid(unsigned long ulX, unsigned long ul
                                              const Base::Vector3f &rclPt, float &rfMinDist,
                                              unsigned long &rulFacetInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  for (std::set<unsigned long>::const_iterator pI = rclSet.begin(); pI != rclSet.end(); pI++)
+  std::vector<unsigned long>::const_iterator pE = GridEnd(ulX, ulY, ulZ);
+  for (std::vector<unsigned long>::const_iterator pI = GridBegin(ulX, ulY, ulZ); pI != pE; pI++)
   {
     float fDist = _pclMesh->GetFacet(*pI).DistanceToPoint(rclPt);
     if (fDist < rfMinDist)
@@ -965,12 +1022,13 @@ MeshPointGrid::MeshPointGrid (const MeshKernel &rclM, float fGridLen)
           std::max<unsigned long>((unsigned long)(clBBMesh.LengthZ() / fGridLen), 1));
 }
 
-void MeshPointGrid::AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon)
+void MeshPointGrid::GetElementGrids (unsigned long ulElement, std::vector<unsigned long> &raulGrids) const
 {
   unsigned long ulX, ulY, ulZ;
-  Pos(Base::Vector3f(rclPt.x, rclPt.y, rclPt.z), ulX, ulY, ulZ);
+  MeshPoint clPt = _pclMesh->GetPoint(ulElement);
+  Pos(Base::Vector3f(clPt.x, clPt.y, clPt.z), ulX, ulY, ulZ);
   if ( (ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ) )
-    _aulGrid[ulX][ulY][ulZ].insert(ulPtIndex);
+    raulGrids.push_back(GridIndex(ulX, ulY, ulZ));
 }
 
 void MeshPointGrid::Validate (const MeshKernel &rclMesh)
@@ -1021,14 +1079,7 @@ void MeshPointGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-
-  MeshPointIterator cPIter(*_pclMesh);
-
-  unsigned long i = 0;
-  for (cPIter.Init(); cPIter.More(); cPIter.Next())
-  {
-    AddPoint(*cPIter, i++);
-  }
+  FillGrid();
 }
 
 void MeshPointGrid::Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const
@@ -1090,7 +1141,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
   if ((_rclGrid.GetBoundBox().IsInBox(rclPt)) == true)
   {  // Voxel bestimmen, indem der Startpunkt liegt
     _rclGrid.Position(rclPt, _ulX, _ulY, _ulZ);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
     _bValidRay = true;
   }
   else
@@ -1103,7 +1154,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
       else
         _rclGrid.Position(cP1, _ulX, _ulY, _ulZ);
 
-      raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+      raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
       _bValidRay = true;
     }
   }
@@ -1154,7 +1205,7 @@ bool MeshGridIterator::NextOnRay (std::vector<unsigned long> &raulElements)
   if ((_bValidRay == true) && (_rclGrid.CheckPos(_ulX, _ulY, _ulZ) == true))
   {
     GridElement pos(_ulX, _ulY, _ulZ); _cSearchPositions.insert(pos);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end()); 
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ)); 
   }
   else
     _bValidRay = false;  // Strahl ausgetreten
@@ -25,6 +25,7 @@
 #define MESH_GRID_H
 
 #include <set>
+#include <vector>
 
 #include "MeshKernel.h"
 #include <Base/Vector3D.h>
@@ -125,7 +126,7 @@ public:
   bool GetPositionToIndex(unsigned long id, unsigned long& ulX, unsigned long& ulY, unsigned long& ulZ) const;
   /** Returns the number of elements in a given grid. */
   unsigned long GetCtElements(unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
-  { return _aulGrid[ulX][ulY][ulZ].size(); }
+  { unsigned long ulGrid = GridIndex(ulX, ulY, ulZ); return _aulGridOffsets[ulGrid+1] - _aulGridOffsets[ulGrid]; }
   /** Validates the grid structure and rebuilds it if needed. Must be implemented in sub-classes. */
   virtual void Validate (const MeshKernel &rclM) = 0;
   /** Verifies the grid structure and returns false if inconsistencies are found. */
@@ -145,6 +146,11 @@ public:
 protected:
   /** Initializes the size of the internal structure. */
   virtual void InitGrid (void);
+  /** Creates an empty data structure for the current number of grids. */
+  void AllocateGrid (void);
+  /** Fills the data structure with all elements of the attached mesh. The elements are distributed to
+   * the grids by GetElementGrids() which for large meshes is called from several threads at once. */
+  void FillGrid (void);
   /** Deletes the grid structure. */
   virtual void Clear (void);
   /** Calculates the grid length dependent on maximum number of grids. */
@@ -155,9 +161,34 @@ protected:
   virtual void RebuildGrid (void) = 0;
   /** Returns the number of stored elements. Must be implemented in sub-classes. */
   virtual unsigned long HasElements (void) const = 0;
+  /** Appends the indices of all grids the element \a ulElement belongs to. Must be implemented in sub-classes.
+   * The method is called from several threads at once and therefore must not modify the grid. */
+  virtual void GetElementGrids (unsigned long ulElement, std::vector<unsigned long> &raulGrids) const = 0;
+  /** Returns the index of the grid in the data structure. The position is not checked. */
+  unsigned long GridIndex (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return (ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX; }
+  /** Returns the first element of the given grid. */
+  std::vector<unsigned long>::const_iterator GridBegin (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return _aulGridElements.begin() + _aulGridOffsets[GridIndex(ulX, ulY, ulZ)]; }
+  /** Returns the position after the last element of the given grid. */
+  std::vector<unsigned long>::const_iterator GridEnd (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return _aulGridElements.begin() + _aulGridOffsets[GridIndex(ulX, ulY, ulZ)+1]; }
+
+private:
+  /** A block of consecutive elements and the (grid, element) pairs found for them in FillGrid(). */
+  struct GridBlock
+  {
+    unsigned long ulBegin, ulEnd;
+    std::vector<std::pair<unsigned long, unsigned long> > entries;
+  };
+  void CollectGridEntries (GridBlock &block) const;
 
 protected:
-  std::vector<std::vector<std::vector<std::set<unsigned long> > > >  _aulGrid;   /**< Grid data structure. */
+  /** Grid data structure. The elements of all grids are stored in one array sorted by the grid index
+   * (see GridIndex()) and inside each grid in ascending order. The elements of grid \a i are in the range
+   * [_aulGridOffsets[i], _aulGridOffsets[i+1]) of \a _aulGridElements. */
+  std::vector<unsigned long> _aulGridOffsets;
+  std::vector<unsigned long> _aulGridElements;
   const MeshKernel* _pclMesh;     /**< The mesh kernel. */
   unsigned long     _ulCtElements;/**< Number of grid elements for validation issues. */
   unsigned long     _ulCtGridsX;  /**< Number of grid elements in z. */
@@ -224,10 +255,11 @@ protected:
   inline void Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
   /** Returns the grid numbers to the given point \a rclPoint. */
   inline void PosWithCheck (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
-  /** Adds a new facet element to the grid structure. \a rclFacet is the geometric facet and \a ulFacetIndex 
-   * the corresponding index in the mesh kernel. The facet is added to each grid element that intersects 
-   * the facet. */
-  inline void AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, float fEpsilon = 0.0f);
+  /** Appends the indices of all grids the facet \a rclFacet must be stored in. These are the grid elements
+   * that intersect the facet. */
+  inline void GetFacetGrids (const MeshGeomFacet &rclFacet, std::vector<unsigned long> &raulGrids) const;
+  /** Appends the indices of all grids the facet with index \a ulElement must be stored in. */
+  virtual void GetElementGrids (unsigned long ulElement, std::vector<unsigned long> &raulGrids) const;
   /** Returns the number of stored elements. */
   unsigned long HasElements (void) const
   { return _pclMesh->CountFacets(); }
@@ -268,9 +300,8 @@ public:
   virtual bool Verify() const;
 
 protected:
-  /** Adds a new point element to the grid structure. \a rclPt is the geometric point and \a ulPtIndex 
-   * the corresponding index in the mesh kernel. */
-  void AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon = 0.0f);
+  /** Appends the index of the grid the point with index \a ulElement lies in. */
+  virtual void GetElementGrids (unsigned long ulElement, std::vector<unsigned long> &raulGrids) const;
   /** Returns the grid numbers to the given point \a rclPoint. */
   void Pos(const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
   /** Returns the number of stored elements. */
@@ -295,7 +326,7 @@ public:
   /** Returns indices of the elements in the current grid. */
   void GetElements (std::vector<unsigned long> &raulElements) const
   {
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
   }
   /** Returns the number of elements in the current grid. */
   unsigned long GetCtElements() const
@@ -434,38 +465,8 @@ inline void MeshFacetGrid::PosWithCheck (const Base::Vector3f &rclPoint, unsigne
   assert((rulX < _ulCtGridsX) && (rulY < _ulCtGridsY) && (rulZ < _ulCtGridsZ));
 }
 
-inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, float fEpsilon)
+inline void MeshFacetGrid::GetFacetGrids (const MeshGeomFacet &rclFacet, std::vector<unsigned long> &raulGrids) const
 {
-#if 0
-  unsigned long  i, ulX, ulY, ulZ, ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
-  
-  ulX1 = ulY1 = ulZ1 = ULONG_MAX;
-  ulX2 = ulY2 = ulZ2 = 0;
-
-  for (i = 0; i < 3; i++)
-  {
-    Pos(rclFacet._aclPoints[i], ulX, ulY, ulZ);
-    _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
-    ulX1 = RSmin<unsigned long>(ulX1, ulX); ulY1 = RSmin<unsigned long>(ulY1, ulY); ulZ1 = RSmin<unsigned long>(ulZ1, ulZ);
-    ulX2 = RSmax<unsigned long>(ulX2, ulX); ulY2 = RSmax<unsigned long>(ulY2, ulY); ulZ2 = RSmax<unsigned long>(ulZ2, ulZ);
-  }
-  
-  // falls Facet ueber mehrere BB reicht
-  if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
-  {
-    for (ulX = ulX1; ulX <= ulX2; ulX++)
-    {
-      for (ulY = ulY1; ulY <= ulY2; ulY++)
-      {
-        for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
-        {
-          if (CMeshFacetFunc::BBoxContainFacet(GetBoundBox(ulX, ulY, ulZ), rclFacet) == TRUE)
-            _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
-        }
-      }
-    }
-  }
-#else
   unsigned long ulX, ulY, ulZ;
 
   unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
@@ -476,42 +477,26 @@ inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned lon
   clBB &= rclFacet._aclPoints[1];
   clBB &= rclFacet._aclPoints[2];
 
-  //float fDiagonalLength = clBB.CalcDiagonalLength();
-
-  //clBB.Enlarge(fEpsilon*fDiagonalLength);
-
   Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
   Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
-  
-  /*
-  if (ulX1 > 0) ulX1--;
-  if (ulY1 > 0) ulY1--;
-  if (ulZ1 > 0) ulZ1--;
-  
-  if (ulX2 < (_ulCtGridsX-1)) ulX2++;
-  if (ulY2 < (_ulCtGridsY-1)) ulY2++;
-  if (ulZ2 < (_ulCtGridsZ-1)) ulZ2++;
-  */
 
   // falls Facet ueber mehrere BB reicht
   if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
   {
-    for (ulX = ulX1; ulX <= ulX2; ulX++)
+    for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
     {
       for (ulY = ulY1; ulY <= ulY2; ulY++)
       {
-        for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
+        for (ulX = ulX1; ulX <= ulX2; ulX++)
         {
           if ( rclFacet.IntersectBoundingBox( GetBoundBox(ulX, ulY, ulZ) ) )
-            _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+            raulGrids.push_back(GridIndex(ulX, ulY, ulZ));
         }
       }
     }
   }
   else
-    _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
-
-#endif
+    raulGrids.push_back(GridIndex(ulX1, ulY1, ulZ1));
 }
 
 } // namespace MeshCore
@@ -46,6 +46,12 @@
 #include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+#include <QFile>
+#include <QThread>
+#include <QtConcurrentMap>
 
 
 using namespace MeshCore;
@@ -109,6 +115,287 @@ int numDigits(int number)
     return digits;
 }
 
+/** Checks the upper case text after the header of an STL file for keywords of the ASCII format. */
+bool hasAsciiSTLKeywords(const char* szBuf)
+{
+    return (strstr(szBuf, "SOLID") != NULL)  || (strstr(szBuf, "FACET") != NULL)    || (strstr(szBuf, "NORMAL") != NULL) ||
+           (strstr(szBuf, "VERTEX") != NULL) || (strstr(szBuf, "ENDFACET") != NULL) || (strstr(szBuf, "ENDLOOP") != NULL);
+}
+
+namespace {
+/* Locale independent parsing of ASCII data. The functions work on a range of
+ * characters and advance the start pointer behind the parsed token. */
+
+inline const char* SkipSpace(const char* p, const char* end)
+{
+    while (p != end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+    return p;
+}
+
+inline bool IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/** Checks case-insensitively for the keyword \a kw followed by a space or the end of the line. */
+bool MatchKeyword(const char*& p, const char* end, const char* kw)
+{
+    const char* s = SkipSpace(p, end);
+    for (; *kw; ++kw, ++s) {
+        if (s == end || tolower(*s) != *kw)
+            return false;
+    }
+    if (s != end && *s != ' ' && *s != '\t' && *s != '\r')
+        return false;
+    p = s;
+    return true;
+}
+
+double Power10(int exponent)
+{
+    static const double table[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    if (exponent <= 22)
+        return table[exponent];
+    return std::pow(10.0, exponent);
+}
+
+/** Parses a decimal floating point number like strtod() in the C locale. Up to 19
+ * significant digits are used, which is far more than a float can hold.
+ * The result is correctly rounded if the digits fit into 53 bits (up to 15 digits) and
+ * the decimal exponent is within +-22, as then only the last operation rounds. Otherwise
+ * the mantissa and the power of ten are rounded before they are combined and the result
+ * may be off by up to three units in the last place of a double. All callers convert the
+ * value to float, for which this error is far too small to show. */
+bool ParseDouble(const char*& p, const char* end, double& value)
+{
+    const char* s = SkipSpace(p, end);
+    bool negative = false;
+    if (s != end && (*s == '-' || *s == '+')) {
+        negative = (*s == '-');
+        ++s;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool valid = false;
+    for (; s != end && IsDigit(*s); ++s) {
+        valid = true;
+        if (digits < 19) {
+            mantissa = 10 * mantissa + (*s - '0');
+            if (mantissa > 0)
+                digits++;
+        }
+        else {
+            exponent++;
+        }
+    }
+    if (s != end && *s == '.') {
+        for (++s; s != end && IsDigit(*s); ++s) {
+            valid = true;
+            if (digits < 19) {
+                mantissa = 10 * mantissa + (*s - '0');
+                if (mantissa > 0)
+                    digits++;
+                exponent--;
+            }
+        }
+    }
+    if (!valid)
+        return false;
+
+    if (s != end && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1;
+        bool negExp = false;
+        if (e != end && (*e == '-' || *e == '+')) {
+            negExp = (*e == '-');
+            ++e;
+        }
+        if (e != end && IsDigit(*e)) {
+            int exp = 0;
+            for (; e != end && IsDigit(*e); ++e) {
+                if (exp < 10000)
+                    exp = 10 * exp + (*e - '0');
+            }
+            exponent += negExp ? -exp : exp;
+            s = e;
+        }
+    }
+
+    double v = static_cast<double>(mantissa);
+    if (mantissa == 0) {
+        v = 0.0; // 0e400 must not become 0*inf
+    }
+    else if (exponent < 0) {
+        // 10^-exponent alone overflows for results near the smallest doubles
+        if (exponent < -300) {
+            v /= Power10(300);
+            exponent += 300;
+        }
+        v /= Power10(-exponent);
+    }
+    else if (exponent > 0) {
+        v *= Power10(exponent);
+    }
+    value = negative ? -v : v;
+    p = s;
+    return true;
+}
+
+inline bool ParseFloat(const char*& p, const char* end, float& value)
+{
+    double v;
+    if (!ParseDouble(p, end, v))
+        return false;
+    value = static_cast<float>(v);
+    return true;
+}
+
+bool ParseVector(const char*& p, const char* end, Base::Vector3f& v)
+{
+    return ParseFloat(p, end, v.x) && ParseFloat(p, end, v.y) && ParseFloat(p, end, v.z);
+}
+
+bool ParseLong(const char*& p, const char* end, long& value)
+{
+    const char* s = SkipSpace(p, end);
+    bool negative = false;
+    if (s != end && (*s == '-' || *s == '+')) {
+        negative = (*s == '-');
+        ++s;
+    }
+    if (s == end || !IsDigit(*s))
+        return false;
+    long v = 0;
+    for (; s != end && IsDigit(*s); ++s)
+        v = 10 * v + (*s - '0');
+    value = negative ? -v : v;
+    p = s;
+    return true;
+}
+
+/** Returns the start of the first line behind \a p that begins with the keyword 'facet'. */
+const char* FindNextFacet(const char* p, const char* end)
+{
+    while (p != end) {
+        const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+        p = nl ? nl + 1 : end;
+        const char* s = p;
+        if (MatchKeyword(s, end, "facet"))
+            break;
+    }
+    return p;
+}
+}
+
+namespace MeshCore {
+/**
+ * Reads a stream in large blocks and splits it into lines without copying them.
+ * This avoids the overhead of std::getline() for every line of big ASCII files.
+ */
+class AsciiLineReader
+{
+public:
+    explicit AsciiLineReader(std::istream& str, std::size_t blockSize = 1 << 20)
+      : str(str), buffer(blockSize), begin(0), end(0), eof(false)
+    {
+    }
+
+    /** Sets [\a lineBegin, \a lineEnd) to the next line without the line break. The range is
+     * valid until the next call. Returns false at the end of the stream. */
+    bool GetLine(const char*& lineBegin, const char*& lineEnd)
+    {
+        for (;;) {
+            const char* data = &buffer[0];
+            const char* nl = static_cast<const char*>(memchr(data + begin, '\n', end - begin));
+            if (nl || (eof && begin < end)) {
+                lineBegin = data + begin;
+                lineEnd = nl ? nl : data + end;
+                begin = nl ? (nl - data) + 1 : end;
+                if (lineEnd != lineBegin && *(lineEnd - 1) == '\r')
+                    --lineEnd;
+                return true;
+            }
+            if (eof)
+                return false;
+
+            // move the incomplete line to the front and read the next block
+            std::size_t rest = end - begin;
+            if (rest > 0 && begin > 0)
+                memmove(&buffer[0], &buffer[begin], rest);
+            begin = 0;
+            end = rest;
+            if (end == buffer.size())
+                buffer.resize(2 * buffer.size());
+            str.read(&buffer[end], buffer.size() - end);
+            std::streamsize read = str.gcount();
+            end += static_cast<std::size_t>(read);
+            if (read == 0 || !str)
+                eof = true;
+        }
+    }
+
+private:
+    std::istream& str;
+    std::vector<char> buffer;
+    std::size_t begin, end;
+    bool eof;
+};
+
+/**
+ * Collects the facets of an ASCII STL file line by line. Each facet is stored as its
+ * three vertices with the circulation direction adjusted to the given normal.
+ */
+class AsciiSTLParser
+{
+public:
+    explicit AsciiSTLParser(std::vector<Base::Vector3f>& vertices)
+      : vertices(vertices), count(0)
+    {
+    }
+
+    void ParseLine(const char* p, const char* end)
+    {
+        if (MatchKeyword(p, end, "vertex")) {
+            Base::Vector3f v;
+            if (count < 3 && ParseVector(p, end, v)) {
+                points[count++] = v;
+                if (count == 3) {
+                    if ((((points[1] - points[0]) % (points[2] - points[0])) * normal) < 0.0f)
+                        std::swap(points[1], points[2]);
+                    vertices.insert(vertices.end(), points, points + 3);
+                }
+            }
+        }
+        else if (MatchKeyword(p, end, "facet")) {
+            count = 0;
+            normal.Set(0.0f, 0.0f, 0.0f);
+            if (MatchKeyword(p, end, "normal"))
+                ParseVector(p, end, normal);
+        }
+    }
+
+    /** Parses the lines of a memory block. */
+    void ParseBlock(const char* p, const char* end)
+    {
+        while (p != end) {
+            const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+            ParseLine(p, nl ? nl : end);
+            p = nl ? nl + 1 : end;
+        }
+    }
+
+private:
+    std::vector<Base::Vector3f>& vertices;
+    Base::Vector3f normal;
+    Base::Vector3f points[3];
+    int count;
+};
+}
+
 /* Usage by CMeshNastran, CMeshCadmouldFE. Added by Sergey Sukhov (26.04.2002)*/
 struct NODE {float x, y, z;};
 struct TRIA {int iV[3];};
@@ -135,7 +422,8 @@ bool MeshInput::LoadAny(const char* FileName)
         // read file
         bool ok = false;
         if (fi.hasExtension("stl") || fi.hasExtension("ast")) {
-            ok = LoadSTL(str);
+            // binary files are mapped into memory which is much faster than reading the stream
+            ok = LoadMappedSTL(FileName) || LoadSTL(str);
         }
         else if (fi.hasExtension("iv")) {
             ok = LoadInventor( str );
@@ -192,8 +480,7 @@ bool MeshInput::LoadSTL (std::istream &rstrIn)
     upper(szBuf);
 
     try {
-        if ((strstr(szBuf, "SOLID") == NULL)  && (strstr(szBuf, "FACET") == NULL)    && (strstr(szBuf, "NORMAL") == NULL) &&
-            (strstr(szBuf, "VERTEX") == NULL) && (strstr(szBuf, "ENDFACET") == NULL) && (strstr(szBuf, "ENDLOOP") == NULL)) {
+        if (!hasAsciiSTLKeywords(szBuf)) {
             // probably binary STL
             buf->pubseekoff(0, std::ios::beg, std::ios::in);
             return LoadBinarySTL(rstrIn);
@@ -227,26 +514,9 @@ bool MeshInput::LoadSTL (std::istream &rstrIn)
 /** Loads an OBJ file. */
 bool MeshInput::LoadOBJ (std::istream &rstrIn)
 {
-    boost::regex rx_p("^v\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::regex rx_f3("^f\\s+([0-9]+)/?[0-9]*/?[0-9]*"
-                         "\\s+([0-9]+)/?[0-9]*/?[0-9]*"
-                         "\\s+([0-9]+)/?[0-9]*/?[0-9]*\\s*$");
-    boost::regex rx_f4("^f\\s+([0-9]+)/?[0-9]*/?[0-9]*"
-                         "\\s+([0-9]+)/?[0-9]*/?[0-9]*"
-                         "\\s+([0-9]+)/?[0-9]*/?[0-9]*"
-                         "\\s+([0-9]+)/?[0-9]*/?[0-9]*\\s*$");
-    boost::cmatch what;
-
     unsigned long segment=0;
     MeshPointArray meshPoints;
     MeshFacetArray meshFacets;
-
-    std::string line;
-    float fX, fY, fZ;
-    unsigned int  i1=1,i2=1,i3=1,i4=1;
-    MeshGeomFacet clFacet;
     MeshFacet item;
 
     if (!rstrIn || rstrIn.bad() == true)
@@ -256,52 +526,50 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
     if (!buf)
         return false;
 
+    AsciiLineReader reader(rstrIn);
+    const char *begin, *end;
+    std::vector<unsigned long> face;
     bool readvertices=false;
-    while (std::getline(rstrIn, line)) {
-        for (std::string::iterator it = line.begin(); it != line.end(); ++it)
-            *it = tolower(*it);
-        if (boost::regex_match(line.c_str(), what, rx_p)) {
-            readvertices = true;
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
+    while (reader.GetLine(begin, end)) {
+        const char* p = begin;
+        if (MatchKeyword(p, end, "v")) {
+            Base::Vector3f pt;
+            if (ParseVector(p, end, pt)) {
+                readvertices = true;
+                meshPoints.push_back(MeshPoint(pt));
+            }
         }
-        else if (boost::regex_match(line.c_str(), what, rx_f3)) {
-            // starts a new segment
-            if (readvertices) {
-                readvertices = false;
-                segment++;
+        else if (MatchKeyword(p, end, "f")) {
+            // the vertex indices may be followed by texture and normal indices
+            // and negative values refer to the last read vertices
+            face.clear();
+            long index;
+            while (ParseLong(p, end, index)) {
+                long count = static_cast<long>(meshPoints.size());
+                if (index > 0)
+                    face.push_back(static_cast<unsigned long>(index - 1));
+                else if (index < 0 && count + index >= 0)
+                    face.push_back(static_cast<unsigned long>(count + index));
+                else
+                    face.push_back(ULONG_MAX);
+                while (p != end && *p != ' ' && *p != '\t')
+                    ++p;
             }
+            if (face.size() < 3)
+                continue;
 
-            // 3-vertex face
-            i1 = std::atoi(what[1].first);
-            i2 = std::atoi(what[2].first);
-            i3 = std::atoi(what[3].first);
-            item.SetVertices(i1-1,i2-1,i3-1);
-            item.SetProperty(segment);
-            meshFacets.push_back(item);
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_f4)) {
             // starts a new segment
             if (readvertices) {
                 readvertices = false;
                 segment++;
             }
 
-            // 4-vertex face
-            i1 = std::atoi(what[1].first);
-            i2 = std::atoi(what[2].first);
-            i3 = std::atoi(what[3].first);
-            i4 = std::atoi(what[4].first);
-
-            item.SetVertices(i1-1,i2-1,i3-1);
-            item.SetProperty(segment);
-            meshFacets.push_back(item);
-
-            item.SetVertices(i3-1,i4-1,i1-1);
-            item.SetProperty(segment);
-            meshFacets.push_back(item);
+            // split polygons into a triangle fan
+            for (std::size_t i = 2; i < face.size(); i++) {
+                item.SetVertices(face[0],face[i-1],face[i]);
+                item.SetProperty(segment);
+                meshFacets.push_back(item);
+            }
         }
     }
 
@@ -314,7 +582,7 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
         bool ok = true;
         for (int i=0;i<3;i++) {
             if (it->_aulPoints[i] >= ct) {
-                Base::Console().Warning("Face index %lu out of range\n", it->_aulPoints[i]);
+                Base::Console().Warning("Face index %lu out of range\n", (unsigned long)it->_aulPoints[i]);
                 ok = false;
             }
         }
@@ -476,7 +744,7 @@ bool MeshInput::LoadOFF (std::istream &rstrIn)
         bool ok = true;
         for (int i=0;i<3;i++) {
             if (it->_aulPoints[i] >= ct) {
-                Base::Console().Warning("Face index %lu out of range\n", it->_aulPoints[i]);
+                Base::Console().Warning("Face index %lu out of range\n", (unsigned long)it->_aulPoints[i]);
                 ok = false;
             }
         }
@@ -740,84 +1008,64 @@ bool MeshInput::LoadPLY (std::istream &inp)
     }
 
     if (format == ascii) {
-        boost::regex rx_d("(([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?))\\s*");
-        boost::regex rx_s("\\b([-+]?[0-9]+)\\s*");
-        boost::regex rx_u("\\b([0-9]+)\\s*");
-        boost::regex rx_f("^\\s*3\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s*");
-        boost::smatch what;
-
-        for (std::size_t i = 0; i < v_count && std::getline(inp, line); i++) {
-            // go through the vertex properties
-            std::map<std::string, float> prop_values;
-            for (std::vector<std::pair<std::string, Number> >::iterator it = vertex_props.begin(); it != vertex_props.end(); ++it) {
-                switch (it->second) {
-                case int8:
-                case int16:
-                case int32:
-                    {
-                        if (boost::regex_search(line, what, rx_s)) {
-                            int v;
-                            v = boost::lexical_cast<int>(what[1]);
-                            prop_values[it->first] = static_cast<float>(v);
-                            line = line.substr(what[0].length());
-                        }
-                        else {
-                            return false;
-                        }
-                    } break;
-                case uint8:
-                case uint16:
-                case uint32:
-                    {
-                        if (boost::regex_search(line, what, rx_u)) {
-                            int v;
-                            v = boost::lexical_cast<int>(what[1]);
-                            prop_values[it->first] = static_cast<float>(v);
-                            line = line.substr(what[0].length());
-                        }
-                        else {
-                            return false;
-                        }
-                    } break;
-                case float32:
-                case float64:
-                    {
-                        if (boost::regex_search(line, what, rx_d)) {
-                            double v;
-                            v = boost::lexical_cast<double>(what[1]);
-                            prop_values[it->first] = static_cast<float>(v);
-                            line = line.substr(what[0].length());
-                        }
-                        else {
-                            return false;
-                        }
-                    } break;
-                default:
+        // the positions of the coordinates and colors in a vertex line
+        int index_x = -1, index_y = -1, index_z = -1;
+        int index_r = -1, index_g = -1, index_b = -1;
+        for (std::size_t i = 0; i < vertex_props.size(); i++) {
+            const std::string& name = vertex_props[i].first;
+            if (name == "x")
+                index_x = static_cast<int>(i);
+            else if (name == "y")
+                index_y = static_cast<int>(i);
+            else if (name == "z")
+                index_z = static_cast<int>(i);
+            else if (name == "red")
+                index_r = static_cast<int>(i);
+            else if (name == "green")
+                index_g = static_cast<int>(i);
+            else if (name == "blue")
+                index_b = static_cast<int>(i);
+        }
+
+        AsciiLineReader reader(inp);
+        const char *begin, *end;
+        std::vector<float> prop_values(vertex_props.size());
+        for (std::size_t i = 0; i < v_count && reader.GetLine(begin, end); ) {
+            const char* p = SkipSpace(begin, end);
+            if (p == end)
+                continue; // empty line
+
+            // all property types can be parsed as floating point numbers
+            for (std::size_t j = 0; j < prop_values.size(); j++) {
+                if (!ParseFloat(p, end, prop_values[j]))
                     return false;
-                }
             }
 
-            Base::Vector3f pt;
-            pt.x = (prop_values["x"]);
-            pt.y = (prop_values["y"]);
-            pt.z = (prop_values["z"]);
-            meshPoints.push_back(pt);
+            meshPoints.push_back(Base::Vector3f(prop_values[index_x],
+                                                prop_values[index_y],
+                                                prop_values[index_z]));
 
             if (_material && (rgb_value == MeshIO::PER_VERTEX)) {
-                float r = (prop_values["red"]) / 255.0f;
-                float g = (prop_values["green"]) / 255.0f;
-                float b = (prop_values["blue"]) / 255.0f;
+                float r = prop_values[index_r] / 255.0f;
+                float g = prop_values[index_g] / 255.0f;
+                float b = prop_values[index_b] / 255.0f;
                 _material->diffuseColor.push_back(App::Color(r, g, b));
             }
-        }
-
-        int f1, f2, f3;
-        for (std::size_t i = 0; i < f_count && std::getline(inp, line); i++) {
-            if (boost::regex_search(line, what, rx_f)) {
-                f1 = boost::lexical_cast<int>(what[1]);
-                f2 = boost::lexical_cast<int>(what[2]);
-                f3 = boost::lexical_cast<int>(what[3]);
-                meshFacets.push_back(MeshFacet(f1,f2,f3));
+            i++;
+        }
+
+        long n, f1, f2, f3;
+        for (std::size_t i = 0; i < f_count && reader.GetLine(begin, end); ) {
+            const char* p = SkipSpace(begin, end);
+            if (p == end)
+                continue; // empty line
+            i++;
+            if (!ParseLong(p, end, n) || n != 3)
+                continue;
+            if (ParseLong(p, end, f1) && ParseLong(p, end, f2) && ParseLong(p, end, f3)) {
+                long count = static_cast<long>(v_count);
+                if (f1 >= 0 && f2 >= 0 && f3 >= 0 && f1 < count && f2 < count && f3 < count)
+                    meshFacets.push_back(MeshFacet(f1,f2,f3));
             }
         }
     }
@@ -1016,67 +1264,26 @@ bool MeshInput::LoadMeshNode (std::istream &rstrIn)
 /** Loads an ASCII STL file. */
 bool MeshInput::LoadAsciiSTL (std::istream &rstrIn)
 {
-    boost::regex rx_p("^\\s*VERTEX\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::regex rx_f("^\\s*FACET\\s+NORMAL\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::cmatch what;
-
-    std::string line;
-    float fX, fY, fZ;
-    unsigned long ulVertexCt, ulFacetCt=0;
-    MeshGeomFacet clFacet;
-
     if (!rstrIn || rstrIn.bad() == true)
         return false;
 
-    std::streamoff ulSize = 0;
-    std::streambuf* buf = rstrIn.rdbuf();
-    ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-    buf->pubseekoff(0, std::ios::beg, std::ios::in);
-    ulSize -= 20;
-
-    // count facets
-    while (std::getline(rstrIn, line)) {
-        for (std::string::iterator it = line.begin(); it != line.end(); ++it)
-            *it = toupper(*it);
-        if (line.find("ENDFACET") != std::string::npos)
-            ulFacetCt++;
-        // prevent from reading EOF (as I don't know how to reread the file then)
-        if (rstrIn.tellg() > ulSize)
-            break;
-        else if (line.find("ENDSOLID") != std::string::npos)
-            break;
-    }
-
-    // restart from the beginning
-    buf->pubseekoff(0, std::ios::beg, std::ios::in);
+    std::vector<Base::Vector3f> vertices;
+    AsciiSTLParser parser(vertices);
+    AsciiLineReader reader(rstrIn);
+    const char *begin, *end;
+    while (reader.GetLine(begin, end))
+        parser.ParseLine(begin, end);
 
+    // the parser has already adjusted the circulation direction to the normals
     MeshBuilder builder(this->_rclMesh);
-    builder.Initialize(ulFacetCt);
-
-    ulVertexCt = 0;
-    while (std::getline(rstrIn, line)) {
-        for (std::string::iterator it = line.begin(); it != line.end(); ++it)
-            *it = toupper(*it);
-        if (boost::regex_match(line.c_str(), what, rx_f)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            clFacet.SetNormal(Base::Vector3f(fX, fY, fZ));
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_p)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            clFacet._aclPoints[ulVertexCt++].Set(fX, fY, fZ);
-            if (ulVertexCt == 3) {
-                ulVertexCt = 0;
-                builder.AddFacet(clFacet);
-            }
-        }
+    builder.Initialize(vertices.size() / 3);
+    Base::Vector3f facetPoints[4];
+    for (std::size_t i = 0; i + 2 < vertices.size(); i += 3) {
+        facetPoints[0] = vertices[i];
+        facetPoints[1] = vertices[i+1];
+        facetPoints[2] = vertices[i+2];
+        facetPoints[3] = (facetPoints[1] - facetPoints[0]) % (facetPoints[2] - facetPoints[0]);
+        builder.AddFacet(facetPoints);
     }
 
     builder.Finish();
@@ -1138,6 +1345,308 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
     return true;
 }
 
+namespace MeshCore {
+/**
+ * Builds the mesh structure from the memory mapped data of a binary STL file or
+ * from the already parsed facets of an ASCII STL file.
+ * Vertices with identical coordinates are merged with a hash table. To do this
+ * in parallel the vertices are distributed to buckets by their hash value and
+ * each bucket is handled by its own thread.
+ */
+class MappedSTLReader
+{
+public:
+    typedef std::pair<unsigned long, unsigned long> FacetRange;
+
+    MappedSTLReader(const unsigned char* data, unsigned long count)
+      : data(data), count(count)
+    {
+    }
+
+    /** Takes over the vertices of decoded facets, three per facet. */
+    explicit MappedSTLReader(std::vector<Base::Vector3f>& decoded)
+      : data(0), count(decoded.size() / 3)
+    {
+        vertices.swap(decoded);
+    }
+
+    void Read(MeshPointArray& rPoints, MeshFacetArray& rFacets)
+    {
+        const unsigned long blockSize = 65536;
+        bool parallel = QThread::idealThreadCount() > 1;
+
+        vertices.resize(3 * count);
+        bucketOfVertex.resize(3 * count);
+        std::vector<FacetRange> blocks;
+        for (unsigned long i = 0; i < count; i += blockSize)
+            blocks.push_back(std::make_pair(i, std::min<unsigned long>(i + blockSize, count)));
+        // the vertices of ASCII files are already decoded and only need their buckets
+        void (MappedSTLReader::*decode)(const FacetRange&) = data ?
+            &MappedSTLReader::DecodeFacets : &MappedSTLReader::HashVertices;
+        if (parallel)
+            QtConcurrent::blockingMap(blocks, boost::bind(decode, this, _1));
+        else
+            std::for_each(blocks.begin(), blocks.end(), boost::bind(decode, this, _1));
+
+        // sort the vertices into their buckets, inside a bucket they keep their ascending order
+        bucketOffset.resize(NumBuckets + 1, 0);
+        for (std::vector<unsigned char>::iterator it = bucketOfVertex.begin(); it != bucketOfVertex.end(); ++it)
+            bucketOffset[*it + 1]++;
+        for (unsigned long i = 0; i < NumBuckets; i++)
+            bucketOffset[i + 1] += bucketOffset[i];
+        bucketVertices.resize(3 * count);
+        std::vector<unsigned long> next(bucketOffset.begin(), bucketOffset.end() - 1);
+        for (unsigned long i = 0; i < 3 * count; i++)
+            bucketVertices[next[bucketOfVertex[i]]++] = i;
+        std::vector<unsigned char>().swap(bucketOfVertex);
+
+        // each vertex gets the index of the first vertex with the same coordinates
+        representative.resize(3 * count);
+        std::vector<unsigned long> buckets(NumBuckets);
+        for (unsigned long i = 0; i < NumBuckets; i++)
+            buckets[i] = i;
+        if (parallel)
+            QtConcurrent::blockingMap(buckets, boost::bind(&MappedSTLReader::MergeBucket, this, _1));
+        else
+            std::for_each(buckets.begin(), buckets.end(), boost::bind(&MappedSTLReader::MergeBucket, this, _1));
+        std::vector<unsigned long>().swap(bucketVertices);
+
+        // Facets with two identical points are skipped, points only referenced by
+        // such facets are removed. This is the same what MeshBuilder does.
+        std::vector<bool> used(3 * count, false);
+        unsigned long validFacets = 0;
+        for (unsigned long i = 0; i < count; i++) {
+            unsigned long p0 = representative[3*i], p1 = representative[3*i+1], p2 = representative[3*i+2];
+            if (p0 == p1 || p0 == p2 || p1 == p2)
+                continue;
+            used[p0] = used[p1] = used[p2] = true;
+            validFacets++;
+        }
+
+        // number the points in the order of their first occurrence, a representative
+        // always has a lower index than the vertices it stands for
+        unsigned long numPoints = 0;
+        for (unsigned long i = 0; i < 3 * count; i++) {
+            unsigned long rep = representative[i];
+            if (rep == i)
+                representative[i] = used[i] ? numPoints++ : ULONG_MAX;
+            else
+                representative[i] = representative[rep];
+        }
+
+        MeshPointArray points(numPoints);
+        MeshFacetArray facets;
+        facets.reserve(validFacets);
+        MeshFacet face;
+        for (unsigned long i = 0; i < count; i++) {
+            unsigned long p0 = representative[3*i], p1 = representative[3*i+1], p2 = representative[3*i+2];
+            if (p0 == p1 || p0 == p2 || p1 == p2)
+                continue;
+            face._aulPoints[0] = p0;
+            face._aulPoints[1] = p1;
+            face._aulPoints[2] = p2;
+            facets.push_back(face);
+            points[p0] = vertices[3*i];
+            points[p1] = vertices[3*i+1];
+            points[p2] = vertices[3*i+2];
+        }
+
+        rPoints.swap(points);
+        rFacets.swap(facets);
+    }
+
+private:
+    void DecodeFacets(const FacetRange& range)
+    {
+        // each record consists of the normal, three points and two bytes attribute
+        float f[12];
+        for (unsigned long i = range.first; i < range.second; i++) {
+            memcpy(f, data + 84 + 50 * i, sizeof(f));
+            Base::Vector3f n(f[0], f[1], f[2]);
+            Base::Vector3f p0(f[3], f[4], f[5]);
+            Base::Vector3f p1(f[6], f[7], f[8]);
+            Base::Vector3f p2(f[9], f[10], f[11]);
+
+            // adjust circulation direction
+            if ((((p1 - p0) % (p2 - p0)) * n) < 0.0f)
+                std::swap(p1, p2);
+
+            vertices[3*i] = p0;
+            vertices[3*i+1] = p1;
+            vertices[3*i+2] = p2;
+            for (int j = 0; j < 3; j++)
+                bucketOfVertex[3*i+j] = (unsigned char)(hash_value(Key(vertices[3*i+j])) % NumBuckets);
+        }
+    }
+
+    void HashVertices(const FacetRange& range)
+    {
+        for (unsigned long i = 3 * range.first; i < 3 * range.second; i++)
+            bucketOfVertex[i] = (unsigned char)(hash_value(Key(vertices[i])) % NumBuckets);
+    }
+
+    void MergeBucket(const unsigned long& bucket)
+    {
+        boost::unordered_map<Key, unsigned long> firstVertex;
+        for (unsigned long i = bucketOffset[bucket]; i < bucketOffset[bucket+1]; i++) {
+            unsigned long index = bucketVertices[i];
+            std::pair<boost::unordered_map<Key, unsigned long>::iterator, bool> it =
+                firstVertex.insert(std::make_pair(Key(vertices[index]), index));
+            representative[index] = it.first->second;
+        }
+    }
+
+    /** The bit patterns of the coordinates, -0 is treated like 0. */
+    struct Key
+    {
+        uint32_t v[3];
+        explicit Key(const Base::Vector3f& p)
+        {
+            float c[3] = { p.x, p.y, p.z };
+            for (int i = 0; i < 3; i++) {
+                if (c[i] == 0.0f)
+                    c[i] = 0.0f;
+                memcpy(&v[i], &c[i], sizeof(uint32_t));
+            }
+        }
+        bool operator == (const Key& k) const
+        {
+            return v[0] == k.v[0] && v[1] == k.v[1] && v[2] == k.v[2];
+        }
+        friend std::size_t hash_value(const Key& k)
+        {
+            std::size_t seed = 0;
+            boost::hash_combine(seed, k.v[0]);
+            boost::hash_combine(seed, k.v[1]);
+            boost::hash_combine(seed, k.v[2]);
+            return seed;
+        }
+    };
+
+    static const unsigned long NumBuckets = 256;
+    const unsigned char* data;
+    unsigned long count;
+    std::vector<Base::Vector3f> vertices;
+    std::vector<unsigned char> bucketOfVertex;
+    std::vector<unsigned long> bucketOffset;
+    std::vector<unsigned long> bucketVertices;
+    std::vector<unsigned long> representative;
+};
+
+/**
+ * Parses the memory mapped data of an ASCII STL file. The data is split into blocks
+ * that start with a facet and the blocks are parsed in parallel. The vertices are
+ * merged by MappedSTLReader afterwards.
+ */
+class MappedAsciiSTLReader
+{
+public:
+    MappedAsciiSTLReader(const char* data, qint64 size)
+      : data(data), size(size)
+    {
+    }
+
+    void Read(MeshPointArray& rPoints, MeshFacetArray& rFacets)
+    {
+        const qint64 blockSize = 1 << 24;
+        const char* end = data + size;
+        std::vector<Block> blocks;
+        for (const char* p = data; p != end; p = blocks.back().end) {
+            Block block;
+            block.begin = p;
+            block.end = (end - p > blockSize) ? FindNextFacet(p + blockSize, end) : end;
+            blocks.push_back(block);
+        }
+
+        if (blocks.size() > 1 && QThread::idealThreadCount() > 1)
+            QtConcurrent::blockingMap(blocks, &MappedAsciiSTLReader::ParseBlock);
+        else
+            std::for_each(blocks.begin(), blocks.end(), &MappedAsciiSTLReader::ParseBlock);
+
+        std::size_t count = 0;
+        for (std::vector<Block>::iterator it = blocks.begin(); it != blocks.end(); ++it)
+            count += it->vertices.size();
+        std::vector<Base::Vector3f> vertices;
+        vertices.reserve(count);
+        for (std::vector<Block>::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+            vertices.insert(vertices.end(), it->vertices.begin(), it->vertices.end());
+            std::vector<Base::Vector3f>().swap(it->vertices);
+        }
+
+        MappedSTLReader reader(vertices);
+        reader.Read(rPoints, rFacets);
+    }
+
+private:
+    struct Block
+    {
+        const char* begin;
+        const char* end;
+        std::vector<Base::Vector3f> vertices;
+    };
+
+    static void ParseBlock(Block& block)
+    {
+        AsciiSTLParser parser(block.vertices);
+        parser.ParseBlock(block.begin, block.end);
+    }
+
+    const char* data;
+    qint64 size;
+};
+}
+
+/** Loads an STL file by mapping it into memory. */
+bool MeshInput::LoadMappedSTL (const char* FileName)
+{
+    QFile file(QString::fromUtf8(FileName));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    qint64 size = file.size();
+    if (size < 84)
+        return false;
+    const unsigned char* data = file.map(0, size);
+    if (!data)
+        return false;
+
+    // the same check for ASCII keywords as in LoadSTL()
+    uint32_t ulCt;
+    memcpy(&ulCt, data + 80, sizeof(ulCt));
+    qint64 ulBytes = ulCt > 1 ? 100 : 50;
+    ulBytes = std::min<qint64>(ulBytes, size - 84);
+    char szBuf[101];
+    memcpy(szBuf, data + 84, ulBytes);
+    szBuf[ulBytes] = 0;
+    upper(szBuf);
+
+    bool ascii = hasAsciiSTLKeywords(szBuf);
+    if (!ascii && 84 + 50 * qint64(ulCt) > size) {
+        file.unmap(const_cast<unsigned char*>(data));
+        return false;
+    }
+
+    MeshPointArray points;
+    MeshFacetArray facets;
+    try {
+        if (ascii) {
+            MappedAsciiSTLReader reader(reinterpret_cast<const char*>(data), size);
+            reader.Read(points, facets);
+        }
+        else {
+            MappedSTLReader reader(data, ulCt);
+            reader.Read(points, facets);
+        }
+    }
+    catch (const std::bad_alloc&) {
+        file.unmap(const_cast<unsigned char*>(data));
+        throw Base::MemoryException();
+    }
+
+    file.unmap(const_cast<unsigned char*>(data));
+    _rclMesh.Adopt(points, facets, true);
+    return true;
+}
+
 /** Loads the mesh object from an XML file. */
 void MeshInput::LoadXML (Base::XMLReader &reader)
 {
@@ -92,6 +92,12 @@ public:
     bool LoadAsciiSTL (std::istream &rstrIn);
     /** Loads a binary STL file. */
     bool LoadBinarySTL (std::istream &rstrIn);
+    /** Loads an STL file by mapping it into memory. Binary files are decoded and ASCII files
+     * are parsed in parallel blocks, vertices with identical coordinates are merged in parallel.
+     * If the file cannot be mapped or is not a valid binary STL file false is returned and the
+     * mesh is left unchanged.
+     */
+    bool LoadMappedSTL (const char* FileName);
     /** Loads an OBJ Mesh file. */
     bool LoadOBJ (std::istream &rstrIn);
     /** Loads an OFF Mesh file. */
@@ -25,6 +25,8 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <cstring>
+# include <iterator>
 # include <stdexcept>
 # include <map>
 # include <queue>
@@ -796,6 +798,195 @@ void MeshKernel::Write (std::ostream &rclOut) const
     str << _clBoundBox.MinZ << _clBoundBox.MaxZ;
 }
 
+namespace MeshCore {
+namespace CompactFormat {
+// Variable-length integers with 7 bits per byte and zig-zag encoded deltas
+// as used by the compact binary format. This makes the data independent of
+// the byte order.
+inline void putVarInt(std::vector<unsigned char>& buf, uint32_t value)
+{
+    while (value >= 0x80) {
+        buf.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    buf.push_back(static_cast<unsigned char>(value));
+}
+
+inline uint32_t getVarInt(const unsigned char*& it, const unsigned char* end)
+{
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (it == end)
+            throw std::out_of_range("Unexpected end of data");
+        unsigned char byte = *it++;
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+    throw std::out_of_range("Invalid variable-length integer");
+}
+
+inline uint32_t encodeDelta(uint32_t value, uint32_t prev)
+{
+    uint32_t delta = value - prev;
+    return (delta << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(delta) >> 31);
+}
+
+inline uint32_t decodeDelta(uint32_t code, uint32_t prev)
+{
+    uint32_t delta = (code >> 1) ^ (0u - (code & 1));
+    return prev + delta;
+}
+
+inline void readBlock(std::istream& in, Base::InputStream& str, std::vector<unsigned char>& buf)
+{
+    uint32_t size = 0;
+    str >> size;
+    buf.resize(size);
+    if (size > 0) {
+        in.read(reinterpret_cast<char*>(&buf[0]), size);
+        if (static_cast<uint32_t>(in.gcount()) != size)
+            throw std::out_of_range("Unexpected end of stream");
+    }
+}
+}
+
+namespace LegacyFormat {
+// The old, unversioned format holds the raw MeshPoint and MeshFacet structs
+// of the writing platform. Their layout depends on whether an 'unsigned long'
+// had 32 or 64 bits there, which is detected from the size of the data.
+struct Layout {
+    std::size_t pointSize;
+    std::size_t facetSize;
+    std::size_t ulongSize;
+};
+
+static const Layout layout32 = {20, 32, 4};
+static const Layout layout64 = {24, 64, 8};
+
+inline unsigned long getULong(const char* data, std::size_t size)
+{
+    if (size == 8) {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        return value >= 0xffffffff ? ULONG_MAX : static_cast<unsigned long>(value);
+    }
+    else {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        return value == 0xffffffff ? ULONG_MAX : static_cast<unsigned long>(value);
+    }
+}
+
+inline void read(std::istream& in, uint32_t uCtPts, uint32_t uCtFts,
+                 MeshPointArray& pointArray, MeshFacetArray& facetArray,
+                 Base::BoundBox3f& boundBox)
+{
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const std::size_t boxSize = 6 * sizeof(float);
+    const uint64_t size32 = uint64_t(uCtPts) * layout32.pointSize + uint64_t(uCtFts) * layout32.facetSize + boxSize;
+    const uint64_t size64 = uint64_t(uCtPts) * layout64.pointSize + uint64_t(uCtFts) * layout64.facetSize + boxSize;
+
+    // prefer an exact match and otherwise accept trailing data
+    const Layout* layout = 0;
+    if (data.size() == size32)
+        layout = &layout32;
+    else if (data.size() == size64)
+        layout = &layout64;
+    else if (data.size() > size64)
+        layout = &layout64;
+    else if (data.size() > size32)
+        layout = &layout32;
+    else
+        throw std::out_of_range("Unexpected end of stream");
+
+    const char* pos = data.data();
+    pointArray.resize(uCtPts);
+    for (MeshPointArray::_TIterator it = pointArray.begin(); it != pointArray.end(); ++it) {
+        float coords[3];
+        memcpy(coords, pos, sizeof(coords));
+        it->Set(coords[0], coords[1], coords[2]);
+        it->_ucFlag = static_cast<unsigned char>(pos[12]);
+        it->_ulProp = static_cast<unsigned int>(getULong(pos + 16, layout->ulongSize));
+        pos += layout->pointSize;
+    }
+
+    // flag, padding, property, three point and three neighbour indices
+    const std::size_t ul = layout->ulongSize;
+    facetArray.resize(uCtFts);
+    for (MeshFacetArray::_TIterator it = facetArray.begin(); it != facetArray.end(); ++it) {
+        it->_ucFlag = static_cast<unsigned char>(pos[0]);
+        it->_ulProp = static_cast<unsigned int>(getULong(pos + ul, ul));
+        for (int i = 0; i < 3; i++) {
+            unsigned long p = getULong(pos + (2 + i) * ul, ul);
+            if (p >= uCtPts)
+                throw std::out_of_range("Point index out of range");
+            it->_aulPoints[i] = p;
+            it->_aulNeighbours[i] = getULong(pos + (5 + i) * ul, ul);
+        }
+        pos += layout->facetSize;
+    }
+
+    float box[6];
+    memcpy(box, pos, sizeof(box));
+    boundBox = Base::BoundBox3f(box[0], box[1], box[2], box[3], box[4], box[5]);
+}
+}
+}
+
+void MeshKernel::WriteCompact (std::ostream &rclOut) const
+{
+    if (!rclOut || rclOut.bad())
+        return;
+
+    Base::OutputStream str(rclOut);
+
+    // Write a header with a "magic number" and a version
+    str << (uint32_t)0xA0B0C0D0;
+    str << (uint32_t)0x020000;
+
+    // write the number of points and facets
+    str << (uint32_t)CountPoints() << (uint32_t)CountFacets();
+
+    // The points are stored as the difference of the bit pattern to the
+    // previous point. This is lossless and gives small numbers for points
+    // that are close to each other.
+    std::vector<unsigned char> buf;
+    buf.reserve(CountPoints() * 6);
+    uint32_t prev[3] = {0, 0, 0};
+    for (MeshPointArray::_TConstIterator it = _aclPointArray.begin(); it != _aclPointArray.end(); ++it) {
+        const float coords[3] = {it->x, it->y, it->z};
+        for (int i=0; i<3; i++) {
+            uint32_t bits;
+            memcpy(&bits, &coords[i], sizeof(uint32_t));
+            CompactFormat::putVarInt(buf, CompactFormat::encodeDelta(bits, prev[i]));
+            prev[i] = bits;
+        }
+    }
+
+    str << (uint32_t)buf.size();
+    if (!buf.empty())
+        rclOut.write(reinterpret_cast<const char*>(&buf[0]), buf.size());
+
+    // The first point index is stored relative to the first index of the
+    // previous facet and the other two relative to the first one. The
+    // neighbourhood is not stored at all.
+    buf.clear();
+    buf.reserve(CountFacets() * 4);
+    uint32_t last = 0;
+    for (MeshFacetArray::_TConstIterator it = _aclFacetArray.begin(); it != _aclFacetArray.end(); ++it) {
+        uint32_t p0 = (uint32_t)it->_aulPoints[0];
+        CompactFormat::putVarInt(buf, CompactFormat::encodeDelta(p0, last));
+        CompactFormat::putVarInt(buf, CompactFormat::encodeDelta((uint32_t)it->_aulPoints[1], p0));
+        CompactFormat::putVarInt(buf, CompactFormat::encodeDelta((uint32_t)it->_aulPoints[2], p0));
+        last = p0;
+    }
+
+    str << (uint32_t)buf.size();
+    if (!buf.empty())
+        rclOut.write(reinterpret_cast<const char*>(&buf[0]), buf.size());
+}
+
 void MeshKernel::Read (std::istream &rclIn)
 {
     if (!rclIn || rclIn.bad())
@@ -813,6 +1004,7 @@ void MeshKernel::Read (std::istream &rclIn)
 
     // is it the new or old format?
     bool new_format = false;
+    bool compact_format = false;
     if (magic == 0xA0B0C0D0 && version == 0x010000) {
         new_format = true;
     }
@@ -820,8 +1012,70 @@ void MeshKernel::Read (std::istream &rclIn)
         new_format = true;
         str.setByteOrder(Base::Stream::BigEndian);
     }
+    else if (magic == 0xA0B0C0D0 && version == 0x020000) {
+        compact_format = true;
+    }
+    else if (swap_magic == 0xA0B0C0D0 && swap_version == 0x020000) {
+        compact_format = true;
+        str.setByteOrder(Base::Stream::BigEndian);
+    }
+
+    if (compact_format) {
+        // read the number of points and facets
+        uint32_t uCtPts=0, uCtFts=0;
+        str >> uCtPts >> uCtFts;
 
-    if (new_format) {
+        try {
+            std::vector<unsigned char> buf;
+            CompactFormat::readBlock(rclIn, str, buf);
+            const unsigned char* pos = buf.empty() ? 0 : &buf[0];
+            const unsigned char* end = pos + buf.size();
+
+            MeshPointArray pointArray;
+            pointArray.resize(uCtPts);
+            uint32_t prev[3] = {0, 0, 0};
+            for (MeshPointArray::_TIterator it = pointArray.begin(); it != pointArray.end(); ++it) {
+                float coords[3];
+                for (int i=0; i<3; i++) {
+                    prev[i] = CompactFormat::decodeDelta(CompactFormat::getVarInt(pos, end), prev[i]);
+                    memcpy(&coords[i], &prev[i], sizeof(float));
+                }
+                it->Set(coords[0], coords[1], coords[2]);
+            }
+
+            CompactFormat::readBlock(rclIn, str, buf);
+            pos = buf.empty() ? 0 : &buf[0];
+            end = pos + buf.size();
+
+            MeshFacetArray facetArray;
+            facetArray.resize(uCtFts);
+            uint32_t last = 0;
+            for (MeshFacetArray::_TIterator it = facetArray.begin(); it != facetArray.end(); ++it) {
+                uint32_t p0 = CompactFormat::decodeDelta(CompactFormat::getVarInt(pos, end), last);
+                uint32_t p1 = CompactFormat::decodeDelta(CompactFormat::getVarInt(pos, end), p0);
+                uint32_t p2 = CompactFormat::decodeDelta(CompactFormat::getVarInt(pos, end), p0);
+                if (p0 >= uCtPts || p1 >= uCtPts || p2 >= uCtPts)
+                    throw std::out_of_range("Point index out of range");
+                it->_aulPoints[0] = p0;
+                it->_aulPoints[1] = p1;
+                it->_aulPoints[2] = p2;
+                last = p0;
+            }
+
+            // If we reach this block no exception occurred and we can safely assign the mesh
+            _aclPointArray.swap(pointArray);
+            _aclFacetArray.swap(facetArray);
+        }
+        catch (std::exception&) {
+            // Special handling of std::length_error
+            throw Base::Exception("Reading from stream failed");
+        }
+
+        // the neighbourhood and bounding box are not stored
+        RebuildNeighbours();
+        RecalcBoundBox();
+    }
+    else if (new_format) {
         char szInfo[256];
         rclIn.read(szInfo, 256);
 
@@ -883,18 +1137,23 @@ void MeshKernel::Read (std::istream &rclIn)
     }
     else {
         // The old format
-        unsigned long uCtPts=magic, uCtFts=version;
+        uint32_t uCtPts=magic, uCtFts=version;
+
+        try {
+            MeshPointArray pointArray;
+            MeshFacetArray facetArray;
+            Base::BoundBox3f boundBox;
+            LegacyFormat::read(rclIn, uCtPts, uCtFts, pointArray, facetArray, boundBox);
 
-        // the stored mesh kernel might be empty
-        if ( uCtPts > 0 ) {
-          _aclPointArray.resize(uCtPts);
-          rclIn.read((char*)&(_aclPointArray[0]), uCtPts*sizeof(MeshPoint));
+            // If we reach this block no exception occurred and we can safely assign the mesh
+            _aclPointArray.swap(pointArray);
+            _aclFacetArray.swap(facetArray);
+            _clBoundBox = boundBox;
         }
-        if ( uCtFts > 0 ) {
-          _aclFacetArray.resize(uCtFts);
-          rclIn.read((char*)&(_aclFacetArray[0]), uCtFts*sizeof(MeshFacet));
+        catch (std::exception&) {
+            // Special handling of std::length_error
+            throw Base::Exception("Reading from stream failed");
         }
-        rclIn.read((char*)&_clBoundBox, sizeof(Base::BoundBox3f));
     }
 }
 
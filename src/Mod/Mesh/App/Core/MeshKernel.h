@@ -37,6 +37,7 @@
 namespace Base{
   class Polygon2D;
   class ViewProjMethod;
+  class SequencerLauncher;
 }
 
 namespace MeshCore {
@@ -76,6 +77,12 @@ public:
     //@{
     /// Binary streaming of data
     void Write (std::ostream &rclOut) const;
+    /** Binary streaming of data in a compact form. The coordinates are delta-encoded
+     * without loss of precision and the point indices are stored as variable-length
+     * deltas. Neighbourhood and bounding box are not stored but rebuilt by Read().
+     */
+    void WriteCompact (std::ostream &rclOut) const;
+    /// Reads in data written by Write() or WriteCompact()
     void Read (std::istream &rclIn);
     //@}
 
@@ -405,6 +412,11 @@ public:
 protected:
     /** Rebuilds the neighbour indices for subset of all facets from index \a index on. */
     void RebuildNeighbours (unsigned long);
+    /** Does the same as the method above but advances \a seq by one step per facet.
+     * If \a nonManifolds is true the facets at a non-manifold edge point to the first
+     * of them and the first one points to the last one, otherwise they are left untouched.
+     */
+    void RebuildNeighbours (unsigned long, Base::SequencerLauncher* seq, bool nonManifolds);
     /** Removes all as INVALID marked points and facets from the structure. */
     void RemoveInvalids ();
     /** Checks if this point is associated to no other facet and deletes if so.
@@ -0,0 +1,903 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <climits>
+# include <cmath>
+# include <cstring>
+# include <deque>
+#endif
+
+#include "OutOfCore.h"
+#include "MeshKernel.h"
+#include "Algorithm.h"
+#include "Decimation.h"
+#include "Definitions.h"
+#include "TopoAlgorithm.h"
+
+#include <Base/Exception.h>
+#include <Base/FileInfo.h>
+#include <Base/Sequencer.h>
+#include <Base/Stream.h>
+
+using namespace MeshCore;
+
+namespace {
+
+/** Number of cells per axis of the histogram used for the partitioning. */
+const unsigned long CellsPerAxis = 64;
+/** Number of facets that are buffered per chunk before they are written. */
+const unsigned long BufferFacets = 1024;
+/** Number of facets that are read at once from an STL file. */
+const unsigned long BlockFacets = 8192;
+
+/** Orders points by their exact coordinates. */
+struct Vertex_Less
+{
+    bool operator()(const Base::Vector3f& x, const Base::Vector3f& y) const
+    {
+        if (x.x != y.x)
+            return x.x < y.x;
+        if (x.y != y.y)
+            return x.y < y.y;
+        return x.z < y.z;
+    }
+};
+
+/** Compares the exact coordinates of two points. */
+struct Vertex_EqualTo
+{
+    bool operator()(const Base::Vector3f& x, const Base::Vector3f& y) const
+    {
+        return x.x == y.x && x.y == y.y && x.z == y.z;
+    }
+};
+
+/** The index of a grid cell. */
+struct Cell
+{
+    long long c[3];
+
+    bool operator < (const Cell& x) const
+    {
+        if (c[0] != x.c[0])
+            return c[0] < x.c[0];
+        if (c[1] != x.c[1])
+            return c[1] < x.c[1];
+        return c[2] < x.c[2];
+    }
+    bool operator != (const Cell& x) const
+    {
+        return c[0] != x.c[0] || c[1] != x.c[1] || c[2] != x.c[2];
+    }
+};
+
+/** Orders the pairs of original and merged point by the original point. */
+struct SnapLess
+{
+    bool operator()(const std::pair<Base::Vector3f, Base::Vector3f>& x,
+                    const std::pair<Base::Vector3f, Base::Vector3f>& y) const
+    {
+        return Vertex_Less()(x.first, y.first);
+    }
+};
+
+/** Orders point indices by the coordinates of the points they refer to. */
+struct Corner_Less
+{
+    Corner_Less(const std::vector<float>& soup) : _soup(soup) { }
+    bool operator()(unsigned long x, unsigned long y) const
+    {
+        const float* a = &_soup[3 * x];
+        const float* b = &_soup[3 * y];
+        if (a[0] != b[0])
+            return a[0] < b[0];
+        if (a[1] != b[1])
+            return a[1] < b[1];
+        if (a[2] != b[2])
+            return a[2] < b[2];
+        return x < y;
+    }
+    const std::vector<float>& _soup;
+};
+
+/** Orders point indices by the cell of a grid and then by the exact coordinates. */
+struct Cell_Less
+{
+    Cell_Less(const std::vector<Base::Vector3f>& points, const std::vector<Cell>& cells)
+      : _points(points), _cells(cells) { }
+    bool operator()(unsigned long x, unsigned long y) const
+    {
+        if (_cells[x] != _cells[y])
+            return _cells[x] < _cells[y];
+        return Vertex_Less()(_points[x], _points[y]);
+    }
+    bool operator()(unsigned long x, const Cell& y) const
+    {
+        return _cells[x] < y;
+    }
+    bool operator()(const Cell& x, unsigned long y) const
+    {
+        return x < _cells[y];
+    }
+    const std::vector<Base::Vector3f>& _points;
+    const std::vector<Cell>& _cells;
+};
+
+/**
+ * Maps every point to the nearest point within the minimum point distance that is
+ * kept. The points are processed in the order of their coordinates and a point is
+ * kept if there is no kept point near to it. Points with the  fixed flag set are
+ * always kept. Unlike sorting with a tolerance this gives the same result for any
+ * order of the input points.
+ */
+void MergePoints(const std::vector<Base::Vector3f>& points, const std::vector<bool>& fixed,
+                 std::vector<unsigned long>& mapping)
+{
+    const double fCellSize = MeshDefinitions::_fMinPointDistance;
+    const float fMaxDist2 = MeshDefinitions::_fMinPointDistanceP2;
+
+    std::vector<Cell> cells(points.size());
+    for (std::size_t i = 0; i < points.size(); i++) {
+        cells[i].c[0] = (long long)floor(points[i].x / fCellSize);
+        cells[i].c[1] = (long long)floor(points[i].y / fCellSize);
+        cells[i].c[2] = (long long)floor(points[i].z / fCellSize);
+    }
+
+    Cell_Less less(points, cells);
+    std::vector<unsigned long> order(points.size());
+    for (std::size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), less);
+
+    mapping.assign(points.size(), ULONG_MAX);
+    for (std::size_t i = 0; i < points.size(); i++) {
+        if (fixed[i])
+            mapping[i] = i;
+    }
+
+    for (std::vector<unsigned long>::iterator it = order.begin(); it != order.end(); ++it) {
+        unsigned long ulIndex = *it;
+        if (mapping[ulIndex] != ULONG_MAX)
+            continue;
+
+        // search the neighbour cells for the nearest kept point
+        unsigned long ulNearest = ulIndex;
+        float fMinDist2 = fMaxDist2;
+        Cell cell;
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dz = -1; dz <= 1; dz++) {
+                    cell.c[0] = cells[ulIndex].c[0] + dx;
+                    cell.c[1] = cells[ulIndex].c[1] + dy;
+                    cell.c[2] = cells[ulIndex].c[2] + dz;
+                    std::pair<std::vector<unsigned long>::iterator, std::vector<unsigned long>::iterator> range =
+                        std::equal_range(order.begin(), order.end(), cell, less);
+                    for (std::vector<unsigned long>::iterator jt = range.first; jt != range.second; ++jt) {
+                        if (mapping[*jt] != *jt)
+                            continue;
+                        float fDist2 = Base::DistanceP2(points[ulIndex], points[*jt]);
+                        if (fDist2 < fMinDist2) {
+                            fMinDist2 = fDist2;
+                            ulNearest = *jt;
+                        }
+                    }
+                }
+            }
+        }
+
+        mapping[ulIndex] = ulNearest;
+    }
+}
+
+/** Reads the facets of a binary STL file block by block. */
+class BinarySTLStream
+{
+public:
+    BinarySTLStream(std::istream& str, unsigned long ulCount)
+      : _str(str), _ulLeft(ulCount), _ulPos(0), _ulSize(0), _failed(false)
+      , _buffer(50 * BlockFacets)
+    {
+    }
+    /** Reads the next facet into \a corners. Returns false if there is none. */
+    bool Next(float corners[9])
+    {
+        if (_ulPos == _ulSize) {
+            if (_ulLeft == 0)
+                return false;
+            unsigned long ulRead = std::min<unsigned long>(_ulLeft, BlockFacets);
+            if (!_str.read(&_buffer[0], 50 * ulRead)) {
+                _failed = true;
+                return false;
+            }
+            _ulLeft -= ulRead;
+            _ulSize = ulRead;
+            _ulPos = 0;
+        }
+
+        memcpy(corners, &_buffer[50 * _ulPos + 12], 9 * sizeof(float));
+        _ulPos++;
+        return true;
+    }
+    /** Returns true if the file is shorter than expected. */
+    bool Failed() const
+    {
+        return _failed;
+    }
+
+private:
+    std::istream& _str;
+    unsigned long _ulLeft, _ulPos, _ulSize;
+    bool _failed;
+    std::vector<char> _buffer;
+};
+
+inline unsigned long CellIndex(float fValue, float fMin, float fLength)
+{
+    if (fLength <= 0.0f)
+        return 0;
+    float fCell = (fValue - fMin) / fLength * (float)CellsPerAxis;
+    if (fCell <= 0.0f)
+        return 0;
+    return std::min<unsigned long>((unsigned long)fCell, CellsPerAxis - 1);
+}
+
+/** A box of histogram cells. */
+struct Region
+{
+    unsigned long lo[3], hi[3];
+};
+
+}
+
+/** An edge that is open inside its chunk. */
+struct MeshOutOfCore::BorderEdge
+{
+    Base::Vector3f pt[2];   /**< The sorted end points. */
+    bool reversed;          /**< True if the facet runs from pt[1] to pt[0]. */
+    unsigned long node;     /**< The component of the facet. */
+
+    bool operator < (const BorderEdge& e) const
+    {
+        Vertex_Less less;
+        if (less(pt[0], e.pt[0]))
+            return true;
+        if (less(e.pt[0], pt[0]))
+            return false;
+        return less(pt[1], e.pt[1]);
+    }
+    bool SameEdge(const BorderEdge& e) const
+    {
+        Vertex_EqualTo equal;
+        return equal(pt[0], e.pt[0]) && equal(pt[1], e.pt[1]);
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+MeshOutOfCore::MeshOutOfCore(const std::string& workDir, unsigned long ulMaxFacets)
+  : _workDir(workDir), _ulMaxFacets(std::max<unsigned long>(ulMaxFacets, 1))
+{
+}
+
+MeshOutOfCore::~MeshOutOfCore()
+{
+    Clear();
+}
+
+void MeshOutOfCore::Clear()
+{
+    for (std::vector<Chunk>::iterator it = _chunks.begin(); it != _chunks.end(); ++it) {
+        Base::FileInfo fi(it->file.c_str());
+        fi.deleteFile();
+    }
+    _chunks.clear();
+}
+
+unsigned long MeshOutOfCore::CountChunks() const
+{
+    return _chunks.size();
+}
+
+unsigned long MeshOutOfCore::CountFacets() const
+{
+    unsigned long ulCount = 0;
+    for (std::vector<Chunk>::const_iterator it = _chunks.begin(); it != _chunks.end(); ++it)
+        ulCount += it->ctFacets;
+    return ulCount;
+}
+
+const Base::BoundBox3f& MeshOutOfCore::GetBoundBox(unsigned long ulChunk) const
+{
+    return _chunks[ulChunk].box;
+}
+
+bool MeshOutOfCore::Partition(const std::string& file)
+{
+    Clear();
+
+    Base::FileInfo fi(file.c_str());
+    Base::ifstream str(fi, std::ios::in | std::ios::binary);
+    if (!str)
+        return false;
+
+    // the size must match with the number of facets, this also rejects ASCII files
+    str.seekg(0, std::ios::end);
+    std::streamoff ulSize = str.tellg();
+    str.seekg(80, std::ios::beg);
+    uint32_t ulCount = 0;
+    if (!str.read(reinterpret_cast<char*>(&ulCount), sizeof(ulCount)))
+        return false;
+    if (ulCount == 0 || ulSize != 84 + 50 * (std::streamoff)ulCount)
+        return false;
+
+    float corners[9];
+    Base::SequencerLauncher seq("Partition mesh...", 3 * (unsigned long)ulCount);
+
+    // 1st pass: the bounding box of the facet centres
+    Base::BoundBox3f box;
+    {
+        BinarySTLStream facets(str, ulCount);
+        while (facets.Next(corners)) {
+            box.Add(Base::Vector3f((corners[0] + corners[3] + corners[6]) / 3.0f,
+                                   (corners[1] + corners[4] + corners[7]) / 3.0f,
+                                   (corners[2] + corners[5] + corners[8]) / 3.0f));
+            seq.next(true); // allow to cancel
+        }
+        if (facets.Failed())
+            return false;
+    }
+
+    float fMin[3] = { box.MinX, box.MinY, box.MinZ };
+    float fLen[3] = { box.LengthX(), box.LengthY(), box.LengthZ() };
+
+    // 2nd pass: count the facet centres per cell
+    std::vector<unsigned long> cellOfFacet;
+    std::vector<unsigned long> histogram(CellsPerAxis * CellsPerAxis * CellsPerAxis, 0);
+    str.clear();
+    str.seekg(84, std::ios::beg);
+    {
+        BinarySTLStream facets(str, ulCount);
+        while (facets.Next(corners)) {
+            unsigned long c[3];
+            for (int i = 0; i < 3; i++) {
+                float fCenter = (corners[i] + corners[i + 3] + corners[i + 6]) / 3.0f;
+                c[i] = CellIndex(fCenter, fMin[i], fLen[i]);
+            }
+            histogram[(c[0] * CellsPerAxis + c[1]) * CellsPerAxis + c[2]]++;
+            seq.next(true); // allow to cancel
+        }
+    }
+
+    // split the cells recursively at the median of the longest side until every
+    // region has at most the maximum number of facets
+    std::vector<unsigned long> chunkOfCell(histogram.size(), 0);
+    std::vector<Region> regions;
+    Region all;
+    for (int i = 0; i < 3; i++) {
+        all.lo[i] = 0;
+        all.hi[i] = CellsPerAxis;
+    }
+    regions.push_back(all);
+
+    while (!regions.empty()) {
+        Region r = regions.back();
+        regions.pop_back();
+
+        // choose the longest side that can still be split
+        int axis = -1;
+        float fMaxLen = -1.0f;
+        for (int i = 0; i < 3; i++) {
+            float fSideLen = fLen[i] * (float)(r.hi[i] - r.lo[i]);
+            if (r.hi[i] - r.lo[i] > 1 && fSideLen > fMaxLen) {
+                fMaxLen = fSideLen;
+                axis = i;
+            }
+        }
+
+        unsigned long ulTotal = 0;
+        std::vector<unsigned long> slabs(axis >= 0 ? r.hi[axis] - r.lo[axis] : 1, 0);
+        unsigned long c[3];
+        for (c[0] = r.lo[0]; c[0] < r.hi[0]; c[0]++) {
+            for (c[1] = r.lo[1]; c[1] < r.hi[1]; c[1]++) {
+                for (c[2] = r.lo[2]; c[2] < r.hi[2]; c[2]++) {
+                    unsigned long ulCt = histogram[(c[0] * CellsPerAxis + c[1]) * CellsPerAxis + c[2]];
+                    ulTotal += ulCt;
+                    if (axis >= 0)
+                        slabs[c[axis] - r.lo[axis]] += ulCt;
+                }
+            }
+        }
+
+        if (ulTotal == 0)
+            continue;
+
+        // a region that is small enough or cannot be split becomes a chunk
+        if (ulTotal <= _ulMaxFacets || axis < 0) {
+            Chunk chunk;
+            chunk.file = Base::FileInfo::getTempFileName("MeshChunk", _workDir.c_str());
+            chunk.ctFacets = 0;
+            for (c[0] = r.lo[0]; c[0] < r.hi[0]; c[0]++) {
+                for (c[1] = r.lo[1]; c[1] < r.hi[1]; c[1]++) {
+                    for (c[2] = r.lo[2]; c[2] < r.hi[2]; c[2]++)
+                        chunkOfCell[(c[0] * CellsPerAxis + c[1]) * CellsPerAxis + c[2]] = _chunks.size();
+                }
+            }
+            _chunks.push_back(chunk);
+            continue;
+        }
+
+        unsigned long ulSplit = 1, ulSum = slabs[0];
+        while (ulSplit < slabs.size() - 1 && 2 * (ulSum + slabs[ulSplit]) <= ulTotal)
+            ulSum += slabs[ulSplit++];
+
+        Region left = r, right = r;
+        left.hi[axis] = r.lo[axis] + ulSplit;
+        right.lo[axis] = r.lo[axis] + ulSplit;
+        regions.push_back(right);
+        regions.push_back(left);
+    }
+
+    // 3rd pass: distribute the facets to the chunk files
+    std::vector<std::vector<float> > buffers(_chunks.size());
+    str.clear();
+    str.seekg(84, std::ios::beg);
+    BinarySTLStream facets(str, ulCount);
+    while (facets.Next(corners)) {
+        unsigned long c[3];
+        for (int i = 0; i < 3; i++) {
+            float fCenter = (corners[i] + corners[i + 3] + corners[i + 6]) / 3.0f;
+            c[i] = CellIndex(fCenter, fMin[i], fLen[i]);
+        }
+
+        unsigned long ulChunk = chunkOfCell[(c[0] * CellsPerAxis + c[1]) * CellsPerAxis + c[2]];
+        Chunk& chunk = _chunks[ulChunk];
+        std::vector<float>& buffer = buffers[ulChunk];
+        buffer.insert(buffer.end(), corners, corners + 9);
+        for (int i = 0; i < 9; i += 3)
+            chunk.box.Add(Base::Vector3f(corners[i], corners[i + 1], corners[i + 2]));
+        chunk.ctFacets++;
+
+        if (buffer.size() == 9 * BufferFacets) {
+            if (!AppendSoup(chunk.file, buffer)) {
+                Clear();
+                return false;
+            }
+            buffer.clear();
+        }
+        seq.next(true); // allow to cancel
+    }
+
+    for (std::size_t i = 0; i < _chunks.size(); i++) {
+        if (!buffers[i].empty() && !AppendSoup(_chunks[i].file, buffers[i])) {
+            Clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool MeshOutOfCore::Write(const std::string& file) const
+{
+    Base::FileInfo fi(file.c_str());
+    Base::ofstream str(fi, std::ios::out | std::ios::binary);
+    if (!str)
+        return false;
+
+    char header[80];
+    memset(header, 0, sizeof(header));
+    strncpy(header, "MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-",
+            sizeof(header));
+    str.write(header, sizeof(header));
+    uint32_t ulCount = (uint32_t)CountFacets();
+    str.write(reinterpret_cast<const char*>(&ulCount), sizeof(ulCount));
+
+    std::vector<float> soup;
+    std::vector<char> record(50, 0);
+    for (unsigned long i = 0; i < _chunks.size(); i++) {
+        ReadSoup(i, soup);
+        for (std::size_t j = 0; j < soup.size(); j += 9) {
+            MeshGeomFacet facet(Base::Vector3f(soup[j    ], soup[j + 1], soup[j + 2]),
+                                Base::Vector3f(soup[j + 3], soup[j + 4], soup[j + 5]),
+                                Base::Vector3f(soup[j + 6], soup[j + 7], soup[j + 8]));
+            Base::Vector3f normal = facet.GetNormal();
+            float n[3] = { normal.x, normal.y, normal.z };
+            memcpy(&record[0], n, sizeof(n));
+            memcpy(&record[12], &soup[j], 9 * sizeof(float));
+            str.write(&record[0], record.size());
+        }
+    }
+
+    return str.good();
+}
+
+void MeshOutOfCore::ReadSoup(unsigned long ulChunk, std::vector<float>& soup) const
+{
+    const Chunk& chunk = _chunks[ulChunk];
+    soup.resize(9 * chunk.ctFacets);
+    if (soup.empty())
+        return;
+
+    Base::FileInfo fi(chunk.file.c_str());
+    Base::ifstream str(fi, std::ios::in | std::ios::binary);
+    if (!str.read(reinterpret_cast<char*>(&soup[0]), soup.size() * sizeof(float)))
+        throw Base::FileException("Cannot read mesh chunk", chunk.file.c_str());
+}
+
+void MeshOutOfCore::WriteSoup(unsigned long ulChunk, const std::vector<float>& soup)
+{
+    Chunk& chunk = _chunks[ulChunk];
+    chunk.ctFacets = soup.size() / 9;
+    chunk.box = Base::BoundBox3f();
+    for (std::size_t i = 0; i < soup.size(); i += 3)
+        chunk.box.Add(Base::Vector3f(soup[i], soup[i + 1], soup[i + 2]));
+
+    Base::FileInfo fi(chunk.file.c_str());
+    Base::ofstream str(fi, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!soup.empty())
+        str.write(reinterpret_cast<const char*>(&soup[0]), soup.size() * sizeof(float));
+    if (!str)
+        throw Base::FileException("Cannot write mesh chunk", chunk.file.c_str());
+}
+
+bool MeshOutOfCore::AppendSoup(const std::string& file, const std::vector<float>& soup)
+{
+    Base::FileInfo fi(file.c_str());
+    Base::ofstream str(fi, std::ios::out | std::ios::binary | std::ios::app);
+    str.write(reinterpret_cast<const char*>(&soup[0]), soup.size() * sizeof(float));
+    return str.good();
+}
+
+void MeshOutOfCore::BuildMesh(const std::vector<float>& soup, MeshPointArray& rPoints,
+                              MeshFacetArray& rFacets)
+{
+    // points with exactly the same coordinates become one point
+    unsigned long ulCorners = soup.size() / 3;
+    std::vector<unsigned long> corners(ulCorners);
+    for (unsigned long i = 0; i < ulCorners; i++)
+        corners[i] = i;
+    std::sort(corners.begin(), corners.end(), Corner_Less(soup));
+
+    rPoints.clear();
+    rFacets.clear();
+    rFacets.resize(ulCorners / 3);
+    for (unsigned long i = 0; i < ulCorners; i++) {
+        unsigned long ulCorner = corners[i];
+        const float* v = &soup[3 * ulCorner];
+        if (i == 0 || memcmp(v, &soup[3 * corners[i - 1]], 3 * sizeof(float)) != 0)
+            rPoints.push_back(MeshPoint(Base::Vector3f(v[0], v[1], v[2])));
+        rFacets[ulCorner / 3]._aulPoints[ulCorner % 3] = rPoints.size() - 1;
+    }
+}
+
+void MeshOutOfCore::BuildSoup(const MeshPointArray& rPoints, const MeshFacetArray& rFacets,
+                              std::vector<float>& soup)
+{
+    soup.clear();
+    soup.reserve(9 * rFacets.size());
+    for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+        if (!it->IsValid())
+            continue;
+        for (int i = 0; i < 3; i++) {
+            const MeshPoint& p = rPoints[it->_aulPoints[i]];
+            soup.push_back(p.x);
+            soup.push_back(p.y);
+            soup.push_back(p.z);
+        }
+    }
+}
+
+void MeshOutOfCore::LoadChunk(unsigned long ulChunk, MeshKernel& rclMesh) const
+{
+    std::vector<float> soup;
+    ReadSoup(ulChunk, soup);
+
+    MeshPointArray points;
+    MeshFacetArray facets;
+    BuildMesh(soup, points, facets);
+    rclMesh.Adopt(points, facets, true);
+}
+
+void MeshOutOfCore::SaveChunk(unsigned long ulChunk, const MeshKernel& rclMesh)
+{
+    std::vector<float> soup;
+    BuildSoup(rclMesh.GetPoints(), rclMesh.GetFacets(), soup);
+    WriteSoup(ulChunk, soup);
+}
+
+void MeshOutOfCore::RemoveDuplicatedPoints()
+{
+    // Points of different chunks can only be merged if they lie on the borders
+    // of the chunks. So, at first all border points are merged globally.
+    std::vector<Base::Vector3f> border;
+    for (unsigned long i = 0; i < _chunks.size(); i++) {
+        MeshKernel kernel;
+        LoadChunk(i, kernel);
+        const MeshPointArray& rPoints = kernel.GetPoints();
+        const MeshFacetArray& rFacets = kernel.GetFacets();
+        std::size_t ulStart = border.size();
+        for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+            for (int j = 0; j < 3; j++) {
+                if (it->_aulNeighbours[j] == ULONG_MAX) {
+                    border.push_back(rPoints[it->_aulPoints[j]]);
+                    border.push_back(rPoints[it->_aulPoints[(j + 1) % 3]]);
+                }
+            }
+        }
+        std::sort(border.begin() + ulStart, border.end(), Vertex_Less());
+        border.erase(std::unique(border.begin() + ulStart, border.end(), Vertex_EqualTo()), border.end());
+    }
+
+    std::sort(border.begin(), border.end(), Vertex_Less());
+    border.erase(std::unique(border.begin(), border.end(), Vertex_EqualTo()), border.end());
+
+    // each border point is either kept (anchor) or snapped to an anchor
+    std::vector<unsigned long> mapping;
+    MergePoints(border, std::vector<bool>(border.size(), false), mapping);
+
+    std::vector<std::pair<Base::Vector3f, Base::Vector3f> > snap;
+    std::vector<Base::Vector3f> anchors;
+    for (std::size_t i = 0; i < border.size(); i++) {
+        if (mapping[i] == i)
+            anchors.push_back(border[i]);
+        else
+            snap.push_back(std::make_pair(border[i], border[mapping[i]]));
+    }
+
+    std::vector<Base::Vector3f>().swap(border);
+    std::vector<unsigned long>().swap(mapping);
+    std::sort(anchors.begin(), anchors.end(), Vertex_Less());
+    std::sort(snap.begin(), snap.end(), SnapLess());
+
+    // now merge the points of each chunk
+    std::vector<float> soup;
+    for (unsigned long i = 0; i < _chunks.size(); i++) {
+        ReadSoup(i, soup);
+        for (std::size_t j = 0; j < soup.size(); j += 3) {
+            std::pair<Base::Vector3f, Base::Vector3f> key;
+            key.first.Set(soup[j], soup[j + 1], soup[j + 2]);
+            std::vector<std::pair<Base::Vector3f, Base::Vector3f> >::iterator it =
+                std::lower_bound(snap.begin(), snap.end(), key, SnapLess());
+            if (it != snap.end() && Vertex_EqualTo()(it->first, key.first)) {
+                soup[j    ] = it->second.x;
+                soup[j + 1] = it->second.y;
+                soup[j + 2] = it->second.z;
+            }
+        }
+
+        MeshPointArray points;
+        MeshFacetArray facets;
+        BuildMesh(soup, points, facets);
+
+        // Border points were already merged globally and two of them must not
+        // be merged here, otherwise the seam would differ from the neighbour chunk.
+        std::vector<Base::Vector3f> coords(points.begin(), points.end());
+        std::vector<bool> isAnchor(points.size());
+        for (std::size_t j = 0; j < points.size(); j++)
+            isAnchor[j] = std::binary_search(anchors.begin(), anchors.end(), coords[j], Vertex_Less());
+        std::vector<unsigned long> mapPointIndex;
+        MergePoints(coords, isAnchor, mapPointIndex);
+
+        // remove the facets that become degenerated
+        for (MeshFacetArray::_TIterator it = facets.begin(); it != facets.end(); ++it) {
+            for (int j = 0; j < 3; j++)
+                it->_aulPoints[j] = mapPointIndex[it->_aulPoints[j]];
+            if (it->_aulPoints[0] == it->_aulPoints[1] ||
+                it->_aulPoints[1] == it->_aulPoints[2] ||
+                it->_aulPoints[2] == it->_aulPoints[0])
+                it->SetInvalid();
+        }
+
+        BuildSoup(points, facets, soup);
+        WriteSoup(i, soup);
+    }
+}
+
+void MeshOutOfCore::HarmonizeNormals()
+{
+    // Harmonize each chunk on its own and collect the open edges of the components.
+    // Every component becomes a node of a graph whose edges are the seams.
+    std::vector<unsigned long> nodeWeights;
+    std::vector<unsigned long> firstNode(_chunks.size() + 1, 0);
+    std::vector<BorderEdge> edges;
+    for (unsigned long i = 0; i < _chunks.size(); i++) {
+        MeshKernel kernel;
+        LoadChunk(i, kernel);
+        MeshTopoAlgorithm(kernel).HarmonizeNormals();
+        SaveChunk(i, kernel);
+
+        std::vector<std::vector<unsigned long> > comps;
+        MeshComponents(kernel).SearchForComponents(MeshComponents::OverEdge, comps);
+
+        const MeshPointArray& rPoints = kernel.GetPoints();
+        const MeshFacetArray& rFacets = kernel.GetFacets();
+        firstNode[i] = nodeWeights.size();
+        for (std::vector<std::vector<unsigned long> >::iterator it = comps.begin(); it != comps.end(); ++it) {
+            unsigned long ulNode = nodeWeights.size();
+            nodeWeights.push_back(it->size());
+            for (std::vector<unsigned long>::iterator jt = it->begin(); jt != it->end(); ++jt) {
+                const MeshFacet& rFace = rFacets[*jt];
+                for (int j = 0; j < 3; j++) {
+                    if (rFace._aulNeighbours[j] != ULONG_MAX)
+                        continue;
+                    BorderEdge edge;
+                    edge.pt[0] = rPoints[rFace._aulPoints[j]];
+                    edge.pt[1] = rPoints[rFace._aulPoints[(j + 1) % 3]];
+                    edge.reversed = Vertex_Less()(edge.pt[1], edge.pt[0]);
+                    if (edge.reversed)
+                        std::swap(edge.pt[0], edge.pt[1]);
+                    edge.node = ulNode;
+                    edges.push_back(edge);
+                }
+            }
+        }
+    }
+    firstNode[_chunks.size()] = nodeWeights.size();
+
+    // Two facets sharing a seam are consistently oriented if they run over the edge
+    // in opposite directions. Otherwise exactly one of their components must be flipped.
+    std::sort(edges.begin(), edges.end());
+    std::vector<std::vector<std::pair<unsigned long, bool> > > links(nodeWeights.size());
+    std::size_t next = 0;
+    while (next < edges.size()) {
+        std::size_t first = next++;
+        while (next < edges.size() && edges[first].SameEdge(edges[next]))
+            next++;
+        // ignore open and non-manifold edges
+        if (next - first != 2)
+            continue;
+        const BorderEdge& e0 = edges[first];
+        const BorderEdge& e1 = edges[first + 1];
+        if (e0.node == e1.node)
+            continue;
+        bool flip = (e0.reversed == e1.reversed);
+        links[e0.node].push_back(std::make_pair(e1.node, flip));
+        links[e1.node].push_back(std::make_pair(e0.node, flip));
+    }
+    std::vector<BorderEdge>().swap(edges);
+
+    // Split every connected set of components into the ones that must be flipped
+    // and the others. Flip the smaller side, measured in facets.
+    std::vector<int> side(nodeWeights.size(), -1);
+    std::vector<bool> flipNode(nodeWeights.size(), false);
+    for (unsigned long i = 0; i < nodeWeights.size(); i++) {
+        if (side[i] >= 0)
+            continue;
+        std::vector<unsigned long> group;
+        std::deque<unsigned long> queue;
+        unsigned long weights[2] = { 0, 0 };
+        side[i] = 0;
+        queue.push_back(i);
+        while (!queue.empty()) {
+            unsigned long ulNode = queue.front();
+            queue.pop_front();
+            group.push_back(ulNode);
+            weights[side[ulNode]] += nodeWeights[ulNode];
+            for (std::vector<std::pair<unsigned long, bool> >::iterator it = links[ulNode].begin(); it != links[ulNode].end(); ++it) {
+                if (side[it->first] < 0) {
+                    side[it->first] = it->second ? 1 - side[ulNode] : side[ulNode];
+                    queue.push_back(it->first);
+                }
+            }
+        }
+
+        int flipSide = weights[1] <= weights[0] ? 1 : 0;
+        for (std::vector<unsigned long>::iterator it = group.begin(); it != group.end(); ++it)
+            flipNode[*it] = (side[*it] == flipSide);
+    }
+
+    for (unsigned long i = 0; i < _chunks.size(); i++) {
+        unsigned long ulFirst = firstNode[i];
+        unsigned long ulLast = firstNode[i + 1];
+        if (std::find(flipNode.begin() + ulFirst, flipNode.begin() + ulLast, true) == flipNode.begin() + ulLast)
+            continue;
+
+        // loading a saved chunk results into the same facet order and thus into the same components
+        MeshKernel kernel;
+        LoadChunk(i, kernel);
+        std::vector<std::vector<unsigned long> > comps;
+        MeshComponents(kernel).SearchForComponents(MeshComponents::OverEdge, comps);
+
+        MeshFacetArray facets(kernel.GetFacets());
+        for (std::size_t j = 0; j < comps.size(); j++) {
+            if (!flipNode[ulFirst + j])
+                continue;
+            for (std::vector<unsigned long>::iterator it = comps[j].begin(); it != comps[j].end(); ++it)
+                facets[*it].FlipNormal();
+        }
+
+        std::vector<float> soup;
+        BuildSoup(kernel.GetPoints(), facets, soup);
+        WriteSoup(i, soup);
+    }
+}
+
+void MeshOutOfCore::Decimate(unsigned long ulTargetSize, float fTolerance, float fFeatureAngle)
+{
+    // MeshSimplify keeps the border points and thus the seams between the chunks
+    double fRatio = (double)ulTargetSize / (double)std::max<unsigned long>(CountFacets(), 1);
+    for (unsigned long i = 0; i < _chunks.size(); i++) {
+        unsigned long ulChunkTarget = 0;
+        if (ulTargetSize > 0)
+            ulChunkTarget = std::max<unsigned long>((unsigned long)(fRatio * _chunks[i].ctFacets + 0.5), 1);
+
+        MeshKernel kernel;
+        LoadChunk(i, kernel);
+        MeshSimplify simplify(kernel);
+        simplify.SetFeatureAngle(fFeatureAngle);
+        if (simplify.Simplify(ulChunkTarget, fTolerance) > 0)
+            SaveChunk(i, kernel);
+    }
+}
+
+void MeshOutOfCore::CrossSections(const std::vector<TPlane>& planes, std::vector<TPolylines>& sections,
+                                  float fMinEps, bool bConnectPolygons) const
+{
+    // collect the cut lines of all chunks
+    std::vector<std::list<std::pair<Base::Vector3f, Base::Vector3f> > > lines(planes.size());
+    std::vector<float> soup;
+    for (unsigned long i = 0; i < _chunks.size(); i++) {
+        std::vector<std::size_t> cutPlanes;
+        for (std::size_t j = 0; j < planes.size(); j++) {
+            if (_chunks[i].box.IsCutPlane(planes[j].first, planes[j].second))
+                cutPlanes.push_back(j);
+        }
+        if (cutPlanes.empty())
+            continue;
+
+        ReadSoup(i, soup);
+        for (std::size_t k = 0; k < soup.size(); k += 9) {
+            MeshGeomFacet facet(Base::Vector3f(soup[k    ], soup[k + 1], soup[k + 2]),
+                                Base::Vector3f(soup[k + 3], soup[k + 4], soup[k + 5]),
+                                Base::Vector3f(soup[k + 6], soup[k + 7], soup[k + 8]));
+            for (std::vector<std::size_t>::iterator it = cutPlanes.begin(); it != cutPlanes.end(); ++it) {
+                Base::Vector3f clE1, clE2;
+                if (facet.IntersectWithPlane(planes[*it].first, planes[*it].second, clE1, clE2))
+                    lines[*it].push_back(std::make_pair(clE1, clE2));
+            }
+        }
+    }
+
+    // connect the lines like MeshAlgorithm::CutWithPlane does
+    MeshKernel kernel;
+    MeshAlgorithm algo(kernel);
+    sections.resize(planes.size());
+    for (std::size_t i = 0; i < planes.size(); i++) {
+        std::list<std::pair<Base::Vector3f, Base::Vector3f> >& tempPoly = lines[i];
+        if (bConnectPolygons) {
+            std::list<std::pair<Base::Vector3f, Base::Vector3f> > resultLines(tempPoly.begin(), tempPoly.end());
+            std::list<std::vector<Base::Vector3f> > tempList;
+            algo.ConnectLines(tempPoly, tempList, fMinEps);
+            algo.ConnectPolygons(tempList, tempPoly);
+            for (std::list<std::pair<Base::Vector3f, Base::Vector3f> >::iterator it = tempPoly.begin(); it != tempPoly.end(); ++it)
+                resultLines.push_front(*it);
+            algo.ConnectLines(resultLines, sections[i], fMinEps);
+        }
+        else {
+            algo.ConnectLines(tempPoly, sections[i], fMinEps);
+        }
+    }
+}
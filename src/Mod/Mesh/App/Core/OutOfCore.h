@@ -0,0 +1,124 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_OUTOFCORE_H
+#define MESH_OUTOFCORE_H
+
+#include <list>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "Elements.h"
+#include <Base/BoundBox.h>
+#include <Base/Vector3D.h>
+
+namespace MeshCore
+{
+class MeshKernel;
+
+/**
+ * The MeshOutOfCore class processes meshes that do not fit into memory.
+ *
+ * The facets of a binary STL file are spatially partitioned into chunks with a
+ * limited number of facets and every chunk is stored as a file in a working
+ * directory. The operations then load one chunk after the other, so that only
+ * a single chunk and some data along the chunk borders is kept in memory.
+ *
+ * Every facet belongs to exactly one chunk, i.e. neighbouring chunks are connected
+ * over seams. These are edges that are open inside a chunk and that are shared with
+ * a facet of another chunk. The operations take care that the seams stay consistent:
+ * points at the chunk borders are only merged by a global step, orientation conflicts
+ * across seams are resolved for the whole mesh and decimation keeps the borders of
+ * the chunks untouched.
+ */
+class MeshExport MeshOutOfCore
+{
+public:
+    typedef std::pair<Base::Vector3f, Base::Vector3f> TPlane;
+    typedef std::list<std::vector<Base::Vector3f> > TPolylines;
+
+    /** The chunk files are created in \a workDir and every chunk has at most
+     * \a ulMaxFacets facets. The files are removed by the destructor. */
+    MeshOutOfCore(const std::string& workDir, unsigned long ulMaxFacets);
+    ~MeshOutOfCore();
+
+    /** Partitions the binary STL file \a file into chunks. Returns false if the
+     * file cannot be read. */
+    bool Partition(const std::string& file);
+    /** Writes all chunks to the binary STL file \a file. */
+    bool Write(const std::string& file) const;
+    /** Removes all chunk files. */
+    void Clear();
+
+    unsigned long CountChunks() const;
+    unsigned long CountFacets() const;
+    /** Returns the bounding box of chunk \a ulChunk. */
+    const Base::BoundBox3f& GetBoundBox(unsigned long ulChunk) const;
+    /** Loads chunk \a ulChunk into \a rclMesh. Points with the same coordinates are merged. */
+    void LoadChunk(unsigned long ulChunk, MeshKernel& rclMesh) const;
+    /** Replaces chunk \a ulChunk with the facets of \a rclMesh. */
+    void SaveChunk(unsigned long ulChunk, const MeshKernel& rclMesh);
+
+    /** Merges points that are closer than MeshDefinitions::_fMinPointDistance and
+     * removes the facets that become degenerated. */
+    void RemoveDuplicatedPoints();
+    /** Makes the orientation of all connected facets consistent. */
+    void HarmonizeNormals();
+    /** Decimates the mesh like MeshSimplify does. The target size is distributed
+     * over the chunks according to their number of facets. */
+    void Decimate(unsigned long ulTargetSize, float fTolerance, float fFeatureAngle);
+    /** Computes the cross-sections of the mesh with the given planes. The result
+     * is the same as of MeshObject::crossSections for the whole mesh. */
+    void CrossSections(const std::vector<TPlane>& planes, std::vector<TPolylines>& sections,
+                       float fMinEps = 1.0e-2f, bool bConnectPolygons = false) const;
+
+private:
+    struct Chunk
+    {
+        std::string file;
+        unsigned long ctFacets;
+        Base::BoundBox3f box;
+    };
+    struct BorderEdge;
+
+    MeshOutOfCore(const MeshOutOfCore&);
+    void operator = (const MeshOutOfCore&);
+
+    void ReadSoup(unsigned long ulChunk, std::vector<float>& soup) const;
+    void WriteSoup(unsigned long ulChunk, const std::vector<float>& soup);
+    static bool AppendSoup(const std::string& file, const std::vector<float>& soup);
+    static void BuildMesh(const std::vector<float>& soup, MeshPointArray& rPoints,
+                          MeshFacetArray& rFacets);
+    static void BuildSoup(const MeshPointArray& rPoints, const MeshFacetArray& rFacets,
+                          std::vector<float>& soup);
+
+private:
+    std::string _workDir;
+    unsigned long _ulMaxFacets;
+    std::vector<Chunk> _chunks;
+};
+
+} // namespace MeshCore
+
+#endif // MESH_OUTOFCORE_H
@@ -23,8 +23,11 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
 #endif
 
+#include <QtConcurrentMap>
+
 #include "Smoothing.h"
 #include "MeshKernel.h"
 #include "Algorithm.h"
@@ -74,11 +77,11 @@ void PlaneFitSmoothing::Smooth(unsigned int iterations)
             MeshCore::PlaneFit pf;
             pf.AddPoint(*v_it);
             center = *v_it;
-            const std::set<unsigned long>& cv = vv_it[v_it.Position()];
+            MeshIndexRange cv = vv_it[v_it.Position()];
             if (cv.size() < 3)
                 continue;
 
-            std::set<unsigned long>::const_iterator cv_it;
+            MeshIndexRange::const_iterator cv_it;
             for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
                 pf.AddPoint(v_beg[*cv_it]);
                 center += v_beg[*cv_it];
@@ -128,11 +131,11 @@ void PlaneFitSmoothing::SmoothPoints(unsigned int iterations, const std::vector<
             MeshCore::PlaneFit pf;
             pf.AddPoint(*v_it);
             center = *v_it;
-            const std::set<unsigned long>& cv = vv_it[v_it.Position()];
+            MeshIndexRange cv = vv_it[v_it.Position()];
             if (cv.size() < 3)
                 continue;
 
-            std::set<unsigned long>::const_iterator cv_it;
+            MeshIndexRange::const_iterator cv_it;
             for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
                 pf.AddPoint(v_beg[*cv_it]);
                 center += v_beg[*cv_it];
@@ -167,7 +170,7 @@ void PlaneFitSmoothing::SmoothPoints(unsigned int iterations, const std::vector<
 }
 
 LaplaceSmoothing::LaplaceSmoothing(MeshKernel& m)
-  : AbstractSmoothing(m), lambda(0.6307)
+  : AbstractSmoothing(m), lambda(0.6307), parallel(true)
 {
 }
 
@@ -175,95 +178,152 @@ LaplaceSmoothing::~LaplaceSmoothing()
 {
 }
 
-void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
-                                const MeshRefPointToFacets& vf_it, double stepsize)
+namespace MeshCore {
+
+/**
+ * Helper class that applies the umbrella operator to a set of points. The
+ * neighbourhood of the points to be moved is stored in flat arrays and the new
+ * positions are written into a second buffer so that all points of one step
+ * can be processed independently of each other.
+ */
+class UmbrellaOperator
 {
-    const MeshCore::MeshPointArray& points = kernel.GetPoints();
-    MeshCore::MeshPointArray::_TConstIterator v_it,
-    v_beg = points.begin(), v_end = points.end();
-
-    unsigned long pos = 0;
-    for (v_it = points.begin(); v_it != v_end; ++v_it,++pos) {
-        const std::set<unsigned long>& cv = vv_it[pos];
-        if (cv.size() < 3)
-            continue;
-        if (cv.size() != vf_it[pos].size()) {
-            // do nothing for border points
-            continue;
+public:
+    UmbrellaOperator(const MeshKernel& kernel, const std::vector<unsigned long>* point_indices)
+      : current(0)
+    {
+        std::vector<unsigned long> indices;
+        if (point_indices) {
+            indices = *point_indices;
+            std::sort(indices.begin(), indices.end());
+            indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+        }
+        else {
+            indices.resize(kernel.CountPoints());
+            for (unsigned long i = 0; i < indices.size(); i++)
+                indices[i] = i;
         }
 
-        unsigned int n_count = cv.size();
-        double w;
-        w=1.0/double(n_count);
+        MeshRefPointToPoints vv_it(kernel);
+        MeshRefPointToFacets vf_it(kernel);
 
-        double delx=0.0,dely=0.0,delz=0.0;
-        std::set<unsigned long>::const_iterator cv_it;
-        for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
-            delx += w*((v_beg[*cv_it]).x-v_it->x);
-            dely += w*((v_beg[*cv_it]).y-v_it->y);
-            delz += w*((v_beg[*cv_it]).z-v_it->z);
+        offsets.push_back(0);
+        for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
+            MeshIndexRange cv = vv_it[*it];
+            if (cv.size() < 3)
+                continue;
+            if (cv.size() != vf_it[*it].size()) {
+                // do nothing for border points
+                continue;
+            }
+
+            active.push_back(*it);
+            neighbours.insert(neighbours.end(), cv.begin(), cv.end());
+            offsets.push_back(neighbours.size());
         }
 
-        float x = (float)(v_it->x+stepsize*delx);
-        float y = (float)(v_it->y+stepsize*dely);
-        float z = (float)(v_it->z+stepsize*delz);
-        kernel.SetPoint(pos,x,y,z);
+        const MeshPointArray& points = kernel.GetPoints();
+        buffer[0].assign(points.begin(), points.end());
+        buffer[1] = buffer[0];
     }
-}
 
-void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
-                                const MeshRefPointToFacets& vf_it, double stepsize,
-                                const std::vector<unsigned long>& point_indices)
-{
-    const MeshCore::MeshPointArray& points = kernel.GetPoints();
-    MeshCore::MeshPointArray::_TConstIterator v_beg = points.begin();
-
-    for (std::vector<unsigned long>::const_iterator pos = point_indices.begin(); pos != point_indices.end(); ++pos) {
-        const std::set<unsigned long>& cv = vv_it[*pos];
-        if (cv.size() < 3)
-            continue;
-        if (cv.size() != vf_it[*pos].size()) {
-            // do nothing for border points
-            continue;
+    void Apply(double stepsize, bool parallel)
+    {
+        std::vector<Range> ranges;
+        const unsigned long blockSize = 4096;
+        for (unsigned long i = 0; i < active.size(); i += blockSize) {
+            Range r;
+            r.op = this;
+            r.begin = i;
+            r.end = std::min<unsigned long>(i + blockSize, active.size());
+            r.stepsize = stepsize;
+            ranges.push_back(r);
         }
 
-        unsigned int n_count = cv.size();
-        double w;
-        w=1.0/double(n_count);
+        if (parallel && ranges.size() > 1)
+            QtConcurrent::blockingMap(ranges, &UmbrellaOperator::ApplyRange);
+        else
+            std::for_each(ranges.begin(), ranges.end(), &UmbrellaOperator::ApplyRange);
 
-        double delx=0.0,dely=0.0,delz=0.0;
-        std::set<unsigned long>::const_iterator cv_it;
-        for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
-            delx += w*((v_beg[*cv_it]).x-(v_beg[*pos]).x);
-            dely += w*((v_beg[*cv_it]).y-(v_beg[*pos]).y);
-            delz += w*((v_beg[*cv_it]).z-(v_beg[*pos]).z);
-        }
+        // points that are not moved have the same position in both buffers
+        current = 1 - current;
+    }
 
-        float x = (float)((v_beg[*pos]).x+stepsize*delx);
-        float y = (float)((v_beg[*pos]).y+stepsize*dely);
-        float z = (float)((v_beg[*pos]).z+stepsize*delz);
-        kernel.SetPoint(*pos,x,y,z);
+    void Commit(MeshKernel& kernel) const
+    {
+        const std::vector<Base::Vector3f>& points = buffer[current];
+        for (std::vector<unsigned long>::const_iterator it = active.begin(); it != active.end(); ++it)
+            kernel.SetPoint(*it, points[*it]);
     }
+
+private:
+    struct Range
+    {
+        UmbrellaOperator* op;
+        unsigned long begin, end;
+        double stepsize;
+    };
+
+    static void ApplyRange(Range& r)
+    {
+        UmbrellaOperator& op = *r.op;
+        const std::vector<Base::Vector3f>& src = op.buffer[op.current];
+        std::vector<Base::Vector3f>& dst = op.buffer[1 - op.current];
+        const unsigned long* nb = op.neighbours.empty() ? 0 : &op.neighbours[0];
+
+        for (unsigned long i = r.begin; i < r.end; i++) {
+            unsigned long pos = op.active[i];
+            unsigned long first = op.offsets[i], last = op.offsets[i+1];
+
+            double sumx=0.0,sumy=0.0,sumz=0.0;
+            for (unsigned long j = first; j < last; j++) {
+                const Base::Vector3f& n = src[nb[j]];
+                sumx += n.x;
+                sumy += n.y;
+                sumz += n.z;
+            }
+
+            const Base::Vector3f& p = src[pos];
+            double w = 1.0/double(last - first);
+            dst[pos].Set((float)(p.x + r.stepsize*(w*sumx - p.x)),
+                         (float)(p.y + r.stepsize*(w*sumy - p.y)),
+                         (float)(p.z + r.stepsize*(w*sumz - p.z)));
+        }
+    }
+
+private:
+    std::vector<unsigned long> active;
+    std::vector<unsigned long> offsets;
+    std::vector<unsigned long> neighbours;
+    std::vector<Base::Vector3f> buffer[2];
+    int current;
+};
+
 }
 
-void LaplaceSmoothing::Smooth(unsigned int iterations)
+void LaplaceSmoothing::Umbrella(unsigned int steps, const std::vector<double>& stepsize,
+                                const std::vector<unsigned long>* point_indices)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    if (steps == 0 || stepsize.empty())
+        return;
 
-    for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda);
+    UmbrellaOperator op(kernel, point_indices);
+    for (unsigned int i=0; i<steps; i++) {
+        op.Apply(stepsize[i % stepsize.size()], parallel);
     }
+    op.Commit(kernel);
 }
 
-void LaplaceSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
+void LaplaceSmoothing::Smooth(unsigned int iterations)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    std::vector<double> stepsize(1, lambda);
+    Umbrella(iterations, stepsize, 0);
+}
 
-    for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda, point_indices);
-    }
+void LaplaceSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
+{
+    std::vector<double> stepsize(1, lambda);
+    Umbrella(iterations, stepsize, &point_indices);
 }
 
 TaubinSmoothing::TaubinSmoothing(MeshKernel& m)
@@ -277,28 +337,22 @@ TaubinSmoothing::~TaubinSmoothing()
 
 void TaubinSmoothing::Smooth(unsigned int iterations)
 {
-    MeshCore::MeshPointArray::_TConstIterator v_it;
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    std::vector<double> stepsize;
+    stepsize.push_back(lambda);
+    stepsize.push_back(-(lambda+micro));
 
     // Theoretically Taubin does not shrink the surface
     iterations = (iterations+1)/2; // two steps per iteration
-    for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda);
-        Umbrella(vv_it, vf_it, -(lambda+micro));
-    }
+    Umbrella(2*iterations, stepsize, 0);
 }
 
 void TaubinSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
 {
-    MeshCore::MeshPointArray::_TConstIterator v_it;
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    std::vector<double> stepsize;
+    stepsize.push_back(lambda);
+    stepsize.push_back(-(lambda+micro));
 
     // Theoretically Taubin does not shrink the surface
     iterations = (iterations+1)/2; // two steps per iteration
-    for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda, point_indices);
-        Umbrella(vv_it, vf_it, -(lambda+micro), point_indices);
-    }
+    Umbrella(2*iterations, stepsize, &point_indices);
 }
@@ -81,16 +81,20 @@ public:
     void Smooth(unsigned int);
     void SmoothPoints(unsigned int, const std::vector<unsigned long>&);
     void SetLambda(double l) { lambda = l;}
+    /// Distributes the points of each step over several threads, on by default
+    void SetParallel(bool on) { parallel = on;}
 
 protected:
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double);
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double,
-                  const std::vector<unsigned long>&);
+    /** Applies the umbrella operator \a steps times where the step sizes are taken
+     * cyclically from \a stepsize. If \a point_indices is null all points are smoothed,
+     * otherwise only the given points are moved. Border points are never moved.
+     */
+    void Umbrella(unsigned int steps, const std::vector<double>& stepsize,
+                  const std::vector<unsigned long>* point_indices);
 
 protected:
     double lambda;
+    bool parallel;
 };
 
 class MeshExport TaubinSmoothing : public LaplaceSmoothing
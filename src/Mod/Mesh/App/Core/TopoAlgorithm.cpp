@@ -1334,8 +1334,9 @@ void MeshTopoAlgorithm::FillupHoles(int level, AbstractPolygonTriangulator& cTri
             if (it->_aulPoints[0] >= ctPoints || 
                 it->_aulPoints[1] >= ctPoints || 
                 it->_aulPoints[2] >= ctPoints) {
-                Base::Console().Log("Ignore invalid face <%d, %d, %d> (%d vertices)\n", 
-                    it->_aulPoints[0], it->_aulPoints[1], it->_aulPoints[2], ctPoints);
+                Base::Console().Log("Ignore invalid face <%lu, %lu, %lu> (%d vertices)\n", 
+                    (unsigned long)it->_aulPoints[0], (unsigned long)it->_aulPoints[1],
+                    (unsigned long)it->_aulPoints[2], ctPoints);
             }
             else {
                 addFacets.push_back(*it);
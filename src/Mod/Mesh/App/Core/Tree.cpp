@@ -0,0 +1,500 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+#endif
+
+#include "Tree.h"
+#include "MeshKernel.h"
+#include "Iterator.h"
+
+using namespace MeshCore;
+
+namespace MeshCore {
+struct MeshFacetTree::BuildItem
+{
+  Base::BoundBox3f box;
+  Base::Vector3f center;
+  unsigned long index;
+};
+}
+
+namespace {
+  const unsigned long MaxLeafSize = 4;
+  const int NumBins = 16;
+
+  // Half of the surface area of a box which is sufficient for the SAH
+  inline float HalfArea (const Base::BoundBox3f &rclBox)
+  {
+    float x = rclBox.LengthX(), y = rclBox.LengthY(), z = rclBox.LengthZ();
+    return x * y + y * z + z * x;
+  }
+
+  inline float Component (const Base::Vector3f &rclPt, int axis)
+  {
+    return axis == 0 ? rclPt.x : (axis == 1 ? rclPt.y : rclPt.z);
+  }
+
+  inline float DistanceP2 (const Base::BoundBox3f &rclBox, const Base::Vector3f &rclPt)
+  {
+    float dx = std::max<float>(std::max<float>(rclBox.MinX - rclPt.x, 0.0f), rclPt.x - rclBox.MaxX);
+    float dy = std::max<float>(std::max<float>(rclBox.MinY - rclPt.y, 0.0f), rclPt.y - rclBox.MaxY);
+    float dz = std::max<float>(std::max<float>(rclBox.MinZ - rclPt.z, 0.0f), rclPt.z - rclBox.MaxZ);
+    return dx * dx + dy * dy + dz * dz;
+  }
+
+  // Slab test of the ray (rclPt, 1/rclDir) with the box. Returns true if the ray hits the box
+  // with an entry parameter less than fMaxT. The entry parameter is returned with rfT.
+  inline bool IntersectRay (const Base::BoundBox3f &rclBox, const Base::Vector3f &rclPt,
+                            const Base::Vector3f &rclInvDir, float fMaxT, float &rfT)
+  {
+    float t1 = (rclBox.MinX - rclPt.x) * rclInvDir.x;
+    float t2 = (rclBox.MaxX - rclPt.x) * rclInvDir.x;
+    float tmin = std::min<float>(t1, t2);
+    float tmax = std::max<float>(t1, t2);
+
+    t1 = (rclBox.MinY - rclPt.y) * rclInvDir.y;
+    t2 = (rclBox.MaxY - rclPt.y) * rclInvDir.y;
+    tmin = std::max<float>(tmin, std::min<float>(t1, t2));
+    tmax = std::min<float>(tmax, std::max<float>(t1, t2));
+
+    t1 = (rclBox.MinZ - rclPt.z) * rclInvDir.z;
+    t2 = (rclBox.MaxZ - rclPt.z) * rclInvDir.z;
+    tmin = std::max<float>(tmin, std::min<float>(t1, t2));
+    tmax = std::min<float>(tmax, std::max<float>(t1, t2));
+
+    tmin = std::max<float>(tmin, 0.0f);
+    rfT = tmin;
+    return (tmin <= tmax) && (tmin <= fMaxT);
+  }
+
+  inline float Inverse (float f)
+  {
+    return f != 0.0f ? 1.0f / f : FLOAT_MAX;
+  }
+}
+
+MeshFacetTree::MeshFacetTree (void)
+  : _pclMesh(0), _bTransform(false), _ulCtElements(0)
+{
+}
+
+MeshFacetTree::MeshFacetTree (const MeshKernel &rclM)
+  : _pclMesh(&rclM), _bTransform(false), _ulCtElements(0)
+{
+  Rebuild();
+}
+
+MeshFacetTree::MeshFacetTree (const MeshKernel &rclM, const Base::Matrix4D &rclMat)
+  : _pclMesh(&rclM), _clTransform(rclMat), _ulCtElements(0)
+{
+  Base::Matrix4D unit;
+  _bTransform = (_clTransform != unit);
+  Rebuild();
+}
+
+MeshFacetTree::~MeshFacetTree (void)
+{
+}
+
+void MeshFacetTree::Attach (const MeshKernel &rclM)
+{
+  _pclMesh = &rclM;
+  Rebuild();
+}
+
+void MeshFacetTree::Validate (const MeshKernel &rclM)
+{
+  if (_pclMesh != &rclM)
+    Attach(rclM);
+  else if (rclM.CountFacets() != _ulCtElements)
+    Rebuild();
+}
+
+void MeshFacetTree::Clear (void)
+{
+  _aclNodes.clear();
+  _aclFacets.clear();
+  _aulFacets.clear();
+  _ulCtElements = 0;
+}
+
+Base::BoundBox3f MeshFacetTree::GetBoundBox (void) const
+{
+  if (_aclNodes.empty())
+    return Base::BoundBox3f();
+  return _aclNodes.front().box;
+}
+
+void MeshFacetTree::Rebuild (void)
+{
+  Clear();
+  if (!_pclMesh)
+    return;
+
+  _ulCtElements = _pclMesh->CountFacets();
+  if (_ulCtElements == 0)
+    return;
+
+  std::vector<BuildItem> aclItems(_ulCtElements);
+  _aclFacets.reserve(_ulCtElements);
+  _aulFacets.reserve(_ulCtElements);
+  // a binary tree with at least one facet per leaf has less than 2n nodes
+  _aclNodes.reserve(2 * (_ulCtElements / MaxLeafSize + 1));
+
+  MeshFacetIterator clFIter(*_pclMesh);
+  if (_bTransform)
+    clFIter.Transform(_clTransform);
+  unsigned long i = 0;
+  for (clFIter.Init(); clFIter.More(); clFIter.Next(), i++)
+  {
+    const MeshGeomFacet& rclFacet = *clFIter;
+    aclItems[i].box = rclFacet.GetBoundBox();
+    aclItems[i].center = aclItems[i].box.CalcCenter();
+    aclItems[i].index = i;
+  }
+
+  BuildNode(aclItems, 0, _ulCtElements);
+
+  // now copy the facets in the order of the leaves
+  for (std::vector<unsigned long>::iterator it = _aulFacets.begin(); it != _aulFacets.end(); ++it)
+  {
+    clFIter.Set(*it);
+    _aclFacets.push_back(*clFIter);
+    _aclFacets.back().CalcNormal();
+  }
+}
+
+void MeshFacetTree::CreateLeaf (std::vector<BuildItem> &raclItems, unsigned long ulBegin, unsigned long ulEnd,
+                                const Base::BoundBox3f &rclBox)
+{
+  Node node;
+  node.box = rclBox;
+  node.ulIndex = _aulFacets.size();
+  node.ulCount = ulEnd - ulBegin;
+  _aclNodes.push_back(node);
+  for (unsigned long i = ulBegin; i < ulEnd; i++)
+    _aulFacets.push_back(raclItems[i].index);
+}
+
+void MeshFacetTree::BuildNode (std::vector<BuildItem> &raclItems, unsigned long ulBegin, unsigned long ulEnd)
+{
+  Base::BoundBox3f clBox, clCenters;
+  for (unsigned long i = ulBegin; i < ulEnd; i++)
+  {
+    clBox.Add(raclItems[i].box);
+    clCenters.Add(raclItems[i].center);
+  }
+
+  unsigned long ulCount = ulEnd - ulBegin;
+  if (ulCount <= MaxLeafSize)
+  {
+    CreateLeaf(raclItems, ulBegin, ulEnd, clBox);
+    return;
+  }
+
+  // split along the axis with the largest extent of the centers
+  int axis = 0;
+  float fExtent = clCenters.LengthX();
+  if (clCenters.LengthY() > fExtent) { axis = 1; fExtent = clCenters.LengthY(); }
+  if (clCenters.LengthZ() > fExtent) { axis = 2; fExtent = clCenters.LengthZ(); }
+  if (fExtent <= 0.0f)
+  {
+    // all centers coincide, no split possible
+    CreateLeaf(raclItems, ulBegin, ulEnd, clBox);
+    return;
+  }
+
+  // put the facets into bins and evaluate the SAH for the bin boundaries
+  float fMin = Component(Base::Vector3f(clCenters.MinX, clCenters.MinY, clCenters.MinZ), axis);
+  float fScale = float(NumBins) / fExtent;
+  unsigned long aulCount[NumBins] = {0};
+  Base::BoundBox3f aclBins[NumBins];
+  for (unsigned long i = ulBegin; i < ulEnd; i++)
+  {
+    int bin = std::min<int>(NumBins - 1, int((Component(raclItems[i].center, axis) - fMin) * fScale));
+    aulCount[bin]++;
+    aclBins[bin].Add(raclItems[i].box);
+  }
+
+  float afCostRight[NumBins];
+  Base::BoundBox3f clRight;
+  unsigned long ulRight = 0;
+  for (int i = NumBins - 1; i > 0; i--)
+  {
+    ulRight += aulCount[i];
+    if (aulCount[i] > 0)
+      clRight.Add(aclBins[i]);
+    afCostRight[i] = ulRight > 0 ? HalfArea(clRight) * float(ulRight) : 0.0f;
+  }
+
+  int iBestSplit = -1;
+  float fBestCost = FLOAT_MAX;
+  Base::BoundBox3f clLeft;
+  unsigned long ulLeft = 0;
+  for (int i = 1; i < NumBins; i++)
+  {
+    ulLeft += aulCount[i - 1];
+    if (aulCount[i - 1] > 0)
+      clLeft.Add(aclBins[i - 1]);
+    if (ulLeft == 0 || ulLeft == ulCount)
+      continue;
+    float fCost = HalfArea(clLeft) * float(ulLeft) + afCostRight[i];
+    if (fCost < fBestCost)
+    {
+      fBestCost = fCost;
+      iBestSplit = i;
+    }
+  }
+
+  unsigned long ulMid;
+  if (iBestSplit > 0)
+  {
+    ulMid = ulBegin;
+    for (unsigned long i = ulBegin; i < ulEnd; i++)
+    {
+      int bin = std::min<int>(NumBins - 1, int((Component(raclItems[i].center, axis) - fMin) * fScale));
+      if (bin < iBestSplit)
+        std::swap(raclItems[i], raclItems[ulMid++]);
+    }
+  }
+  else
+  {
+    ulMid = ulBegin + ulCount / 2;
+  }
+
+  // a parent node with two children
+  unsigned long ulNode = _aclNodes.size();
+  Node node;
+  node.box = clBox;
+  node.ulIndex = 0;
+  node.ulCount = 0;
+  _aclNodes.push_back(node);
+  BuildNode(raclItems, ulBegin, ulMid);
+  _aclNodes[ulNode].ulIndex = _aclNodes.size();
+  BuildNode(raclItems, ulMid, ulEnd);
+}
+
+bool MeshFacetTree::Verify (void) const
+{
+  if (!_pclMesh)
+    return false; // no mesh attached
+  if (_pclMesh->CountFacets() != _ulCtElements)
+    return false; // not up-to-date
+  if (_aulFacets.size() != _ulCtElements)
+    return false;
+
+  for (std::vector<Node>::const_iterator it = _aclNodes.begin(); it != _aclNodes.end(); ++it)
+  {
+    if (it->ulCount == 0)
+      continue;
+    for (unsigned long i = it->ulIndex; i < it->ulIndex + it->ulCount; i++)
+    {
+      // BoundBox3::IsInBox() excludes the maximum but the leaf box is the union of
+      // the facet boxes, so compare directly
+      Base::BoundBox3f clBox = _aclFacets[i].GetBoundBox();
+      if (clBox.MinX < it->box.MinX || clBox.MaxX > it->box.MaxX ||
+          clBox.MinY < it->box.MinY || clBox.MaxY > it->box.MaxY ||
+          clBox.MinZ < it->box.MinZ || clBox.MaxZ > it->box.MaxZ)
+        return false; // facet not inside the box of its leaf
+    }
+  }
+
+  return true;
+}
+
+bool MeshFacetTree::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, Base::Vector3f &rclRes,
+                                       unsigned long &rulFacet) const
+{
+  return NearestFacetOnRay(rclPt, rclDir, FLOAT_MAX, rclRes, rulFacet);
+}
+
+bool MeshFacetTree::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, float fMaxDist,
+                                       Base::Vector3f &rclRes, unsigned long &rulFacet) const
+{
+  if (_aclNodes.empty())
+    return false;
+
+  Base::Vector3f clDir(rclDir);
+  clDir.Normalize();
+  Base::Vector3f clInvDir(Inverse(clDir.x), Inverse(clDir.y), Inverse(clDir.z));
+
+  bool bSol = false;
+  float fBest = fMaxDist;
+  Base::Vector3f clRes;
+
+  std::vector<unsigned long> aulStack;
+  aulStack.reserve(64);
+  aulStack.push_back(0);
+  float fT;
+  while (!aulStack.empty())
+  {
+    unsigned long ulNode = aulStack.back();
+    aulStack.pop_back();
+    const Node& rclNode = _aclNodes[ulNode];
+    if (!IntersectRay(rclNode.box, rclPt, clInvDir, fBest, fT))
+      continue;
+
+    if (rclNode.ulCount > 0)
+    {
+      for (unsigned long i = rclNode.ulIndex; i < rclNode.ulIndex + rclNode.ulCount; i++)
+      {
+        if (_aclFacets[i].Foraminate(rclPt, clDir, clRes))
+        {
+          float fDist = (clRes - rclPt) * clDir;
+          if (fDist >= 0.0f && fDist <= fBest)
+          {
+            fBest    = fDist;
+            rclRes   = clRes;
+            rulFacet = _aulFacets[i];
+            bSol     = true;
+          }
+        }
+      }
+    }
+    else
+    {
+      // visit the nearer child first
+      unsigned long ulLeft = ulNode + 1, ulRight = rclNode.ulIndex;
+      float fLeft = FLOAT_MAX, fRight = FLOAT_MAX;
+      bool bLeft = IntersectRay(_aclNodes[ulLeft].box, rclPt, clInvDir, fBest, fLeft);
+      bool bRight = IntersectRay(_aclNodes[ulRight].box, rclPt, clInvDir, fBest, fRight);
+      if (bLeft && bRight)
+      {
+        if (fLeft < fRight)
+          std::swap(ulLeft, ulRight);
+        aulStack.push_back(ulLeft);
+        aulStack.push_back(ulRight);
+      }
+      else if (bLeft)
+        aulStack.push_back(ulLeft);
+      else if (bRight)
+        aulStack.push_back(ulRight);
+    }
+  }
+
+  return bSol;
+}
+
+unsigned long MeshFacetTree::SearchNearestFromPoint (const Base::Vector3f &rclPt) const
+{
+  Base::Vector3f clRes;
+  float fDist;
+  return SearchNearestFromPoint(rclPt, FLOAT_MAX, clRes, fDist);
+}
+
+unsigned long MeshFacetTree::SearchNearestFromPoint (const Base::Vector3f &rclPt, float fMaxDist) const
+{
+  Base::Vector3f clRes;
+  float fDist;
+  return SearchNearestFromPoint(rclPt, fMaxDist, clRes, fDist);
+}
+
+unsigned long MeshFacetTree::SearchNearestFromPoint (const Base::Vector3f &rclPt, float fMaxDist,
+                                                     Base::Vector3f &rclRes, float &rfDist) const
+{
+  unsigned long ulFacet = ULONG_MAX;
+  if (_aclNodes.empty())
+    return ulFacet;
+
+  float fBest = fMaxDist;
+  Base::Vector3f clRes;
+
+  std::vector<unsigned long> aulStack;
+  aulStack.reserve(64);
+  aulStack.push_back(0);
+  while (!aulStack.empty())
+  {
+    unsigned long ulNode = aulStack.back();
+    aulStack.pop_back();
+    const Node& rclNode = _aclNodes[ulNode];
+    if (fBest < FLOAT_MAX && DistanceP2(rclNode.box, rclPt) > fBest * fBest)
+      continue;
+
+    if (rclNode.ulCount > 0)
+    {
+      for (unsigned long i = rclNode.ulIndex; i < rclNode.ulIndex + rclNode.ulCount; i++)
+      {
+        float fDist = _aclFacets[i].DistanceToPoint(rclPt, clRes);
+        if (fDist <= fBest)
+        {
+          fBest   = fDist;
+          rclRes  = clRes;
+          ulFacet = _aulFacets[i];
+        }
+      }
+    }
+    else
+    {
+      // visit the nearer child first
+      unsigned long ulLeft = ulNode + 1, ulRight = rclNode.ulIndex;
+      if (DistanceP2(_aclNodes[ulLeft].box, rclPt) < DistanceP2(_aclNodes[ulRight].box, rclPt))
+        std::swap(ulLeft, ulRight);
+      aulStack.push_back(ulLeft);
+      aulStack.push_back(ulRight);
+    }
+  }
+
+  if (ulFacet != ULONG_MAX)
+    rfDist = fBest;
+  return ulFacet;
+}
+
+unsigned long MeshFacetTree::Inside (const Base::BoundBox3f &rclBB, std::vector<unsigned long> &raulElements) const
+{
+  raulElements.clear();
+  if (_aclNodes.empty())
+    return 0;
+
+  std::vector<unsigned long> aulStack;
+  aulStack.reserve(64);
+  aulStack.push_back(0);
+  while (!aulStack.empty())
+  {
+    unsigned long ulNode = aulStack.back();
+    aulStack.pop_back();
+    const Node& rclNode = _aclNodes[ulNode];
+    if (!(rclNode.box && rclBB))
+      continue;
+
+    if (rclNode.ulCount > 0)
+    {
+      for (unsigned long i = rclNode.ulIndex; i < rclNode.ulIndex + rclNode.ulCount; i++)
+      {
+        if (_aclFacets[i].GetBoundBox() && rclBB)
+          raulElements.push_back(_aulFacets[i]);
+      }
+    }
+    else
+    {
+      aulStack.push_back(rclNode.ulIndex);
+      aulStack.push_back(ulNode + 1);
+    }
+  }
+
+  std::sort(raulElements.begin(), raulElements.end());
+  return raulElements.size();
+}
@@ -0,0 +1,135 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_TREE_H
+#define MESH_TREE_H
+
+#include <vector>
+
+#include "Elements.h"
+#include <Base/BoundBox.h>
+#include <Base/Matrix.h>
+#include <Base/Vector3D.h>
+
+namespace MeshCore {
+
+class MeshKernel;
+
+/**
+ * The MeshFacetTree is a bounding volume hierarchy over the facets of a mesh.
+ * In contrast to the MeshFacetGrid with its uniform grid elements the tree adapts
+ * to the distribution of the facets because it is built with the surface area
+ * heuristic (SAH). So it is the better choice for meshes with very uneven facet
+ * density where a grid either gets too many elements or degrades to testing
+ * almost all facets.
+ *
+ * The tree keeps its own copy of the facet geometry, so a transformation can be
+ * applied to the facets when building the tree. All search methods are const and
+ * can be used from several threads at once.
+ */
+class MeshExport MeshFacetTree
+{
+public:
+  /** @name Construction */
+  //@{
+  /// Construction
+  MeshFacetTree (void);
+  /// Construction
+  MeshFacetTree (const MeshKernel &rclM);
+  /// Construction with a transformation that is applied to all facets
+  MeshFacetTree (const MeshKernel &rclM, const Base::Matrix4D &rclMat);
+  /// Destruction
+  ~MeshFacetTree (void);
+  //@}
+
+  /** Attaches the mesh kernel to this tree, an already attached mesh gets detached. The tree gets rebuilt 
+   * automatically. */
+  void Attach (const MeshKernel &rclM);
+  /** Rebuilds the tree structure. */
+  void Rebuild (void);
+  /** Validates the tree structure and rebuilds it if needed. */
+  void Validate (const MeshKernel &rclM);
+  /** Verifies the tree structure and returns false if inconsistencies are found. */
+  bool Verify (void) const;
+  /** Returns the bounding box of all facets. */
+  Base::BoundBox3f GetBoundBox (void) const;
+
+  /** @name Search */
+  //@{
+  /** Searches for the nearest facet hit by the ray starting at \a rclPt in direction \a rclDir. In contrast to
+   * MeshGeomFacet::Foraminate() only intersections in direction of the ray are taken into account.
+   * The point \a rclRes holds the intersection point and \a rulFacet the index of the facet.
+   */
+  bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, Base::Vector3f &rclRes,
+                          unsigned long &rulFacet) const;
+  /** Does basically the same as the method above unless that only intersection points not farther away than 
+   * \a fMaxDist from \a rclPt are taken into account. */
+  bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, float fMaxDist,
+                          Base::Vector3f &rclRes, unsigned long &rulFacet) const;
+  /** Searches for the nearest facet from a point. If the tree is empty ULONG_MAX is returned. */
+  unsigned long SearchNearestFromPoint (const Base::Vector3f &rclPt) const;
+  /** Searches for the nearest facet from a point that is not farther away than \a fMaxDist.
+   * If there is no such facet ULONG_MAX is returned. */
+  unsigned long SearchNearestFromPoint (const Base::Vector3f &rclPt, float fMaxDist) const;
+  /** Does basically the same as the method above and additionally returns the nearest point \a rclRes
+   * on the facet and its distance \a rfDist to \a rclPt. */
+  unsigned long SearchNearestFromPoint (const Base::Vector3f &rclPt, float fMaxDist,
+                                        Base::Vector3f &rclRes, float &rfDist) const;
+  /** Searches for all facets whose bounding boxes intersect with \a rclBB. The indices are
+   * sorted in ascending order. */
+  unsigned long Inside (const Base::BoundBox3f &rclBB, std::vector<unsigned long> &raulElements) const;
+  //@}
+
+private:
+  /** A node of the tree. For inner nodes the left child directly follows its parent and
+   * \a ulIndex is the index of the right child. For leaves \a ulIndex is the position of
+   * the first facet in _aclFacets and \a ulCount the number of facets. */
+  struct Node
+  {
+    Base::BoundBox3f box;
+    unsigned long ulIndex;
+    unsigned long ulCount;
+  };
+  struct BuildItem;
+
+  MeshFacetTree (const MeshFacetTree&);
+  void operator = (const MeshFacetTree&);
+
+  void Clear (void);
+  void BuildNode (std::vector<BuildItem> &raclItems, unsigned long ulBegin, unsigned long ulEnd);
+  void CreateLeaf (std::vector<BuildItem> &raclItems, unsigned long ulBegin, unsigned long ulEnd,
+                   const Base::BoundBox3f &rclBox);
+
+private:
+  const MeshKernel*          _pclMesh;      /**< The mesh kernel. */
+  Base::Matrix4D             _clTransform;  /**< Transformation applied to the facets. */
+  bool                       _bTransform;   /**< Apply the transformation? */
+  unsigned long              _ulCtElements; /**< Number of facets for validation issues. */
+  std::vector<Node>          _aclNodes;     /**< Nodes of the tree in depth-first order. */
+  std::vector<MeshGeomFacet> _aclFacets;    /**< Facet geometry in the order of the leaves. */
+  std::vector<unsigned long> _aulFacets;    /**< Mesh indices of the facets in _aclFacets. */
+};
+
+} // namespace MeshCore
+
+#endif // MESH_TREE_H
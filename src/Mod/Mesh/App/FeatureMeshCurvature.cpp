@@ -58,6 +58,11 @@ short Curvature::mustExecute() const
     return 0;
 }
 
+bool Curvature::isExecuteThreadSafe(void) const
+{
+    return true;
+}
+
 App::DocumentObjectExecReturn *Curvature::execute(void)
 {
     Mesh::Feature *pcFeat  = dynamic_cast<Mesh::Feature*>(Source.getValue());
@@ -53,6 +53,8 @@ public:
     /// recalculate the Feature
     App::DocumentObjectExecReturn *execute(void);
     short mustExecute() const;
+    /// Safe to recompute on a worker thread
+    bool isExecuteThreadSafe(void) const;
     /// returns the type name of the ViewProvider
     const char* getViewProviderName(void) const { 
         return "MeshGui::ViewProviderMeshCurvature"; 
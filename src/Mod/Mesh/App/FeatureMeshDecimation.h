@@ -0,0 +1,73 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef FEATURE_MESH_DECIMATION_H
+#define FEATURE_MESH_DECIMATION_H
+
+#include <App/PropertyStandard.h>
+#include <App/PropertyLinks.h>
+
+#include "MeshFeature.h"
+
+
+namespace Mesh
+{
+
+/**
+ * The Decimation class reduces the number of facets of the linked mesh.
+ * The mesh is simplified until it has \a TargetSize facets or the error of the
+ * next edge collapse exceeds \a Tolerance. A value of zero for one of them
+ * means that only the other one is taken into account.
+ * Points at the borders of the mesh are kept and if \a FeatureAngle (in degree)
+ * is set also the points at sharp edges.
+ */
+class MeshExport Decimation : public Mesh::Feature
+{
+    PROPERTY_HEADER(Mesh::Decimation);
+
+public:
+    Decimation();
+    virtual ~Decimation();
+
+    /** @name Properties */
+    //@{
+    App::PropertyLink Source;
+    App::PropertyInteger TargetSize;
+    App::PropertyFloat Tolerance;
+    App::PropertyFloat FeatureAngle;
+    //@}
+
+    /** @name methods override Feature */
+    //@{
+    /// recalculate the Feature
+    App::DocumentObjectExecReturn *execute(void);
+    short mustExecute() const;
+    /// Decimates a copy of the source mesh, thus thread-safe
+    bool isExecuteThreadSafe(void) const;
+    //@}
+};
+
+}
+
+#endif // FEATURE_MESH_DECIMATION_H
@@ -57,6 +57,11 @@ short FixDefects::mustExecute() const
     return 0;
 }
 
+bool FixDefects::isExecuteThreadSafe(void) const
+{
+    return true;
+}
+
 App::DocumentObjectExecReturn *FixDefects::execute(void)
 {
   return App::DocumentObject::StdReturn;
@@ -53,6 +53,8 @@ public:
   /// recalculate the Feature
   virtual App::DocumentObjectExecReturn *execute(void);
   short mustExecute() const;
+  /// All fixes work on a copy of the source mesh, thus thread-safe
+  bool isExecuteThreadSafe(void) const;
   //@}
 
   /// returns the type name of the ViewProvider
@@ -62,6 +62,11 @@ short SegmentByMesh::mustExecute() const
     return 0;
 }
 
+bool SegmentByMesh::isExecuteThreadSafe(void) const
+{
+    return true;
+}
+
 App::DocumentObjectExecReturn *SegmentByMesh::execute(void)
 {
     Mesh::PropertyMeshKernel *kernel=0;
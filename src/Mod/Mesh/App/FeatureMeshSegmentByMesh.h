@@ -58,6 +58,8 @@ public:
   /// recalculate the Feature
   App::DocumentObjectExecReturn *execute(void);
   short mustExecute() const;
+  /// execute() reads nothing but the source and the tool mesh
+  bool isExecuteThreadSafe(void) const;
   //@}
 };
 
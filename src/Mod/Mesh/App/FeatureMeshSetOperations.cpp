@@ -36,6 +36,7 @@
 #include "Core/Visitor.h"
 
 #include "Core/SetOperations.h"
+#include "Core/Boolean.h"
 
 #include "FeatureMeshSetOperations.h"
 
@@ -43,6 +44,8 @@
 using namespace Mesh;
 using namespace std;
 
+const char* SetOperations::AlgorithmEnums[]= {"Robust","Legacy",NULL};
+
 PROPERTY_SOURCE(Mesh::SetOperations, Mesh::Feature)
 
 
@@ -51,6 +54,9 @@ SetOperations::SetOperations(void)
     ADD_PROPERTY(Source1  ,(0));
     ADD_PROPERTY(Source2  ,(0));
     ADD_PROPERTY(OperationType, ("union"));
+    ADD_PROPERTY_TYPE(Algorithm, ((long)0), 0, App::Prop_None,
+        "The robust algorithm uses exact predicates, the legacy algorithm is tolerance based");
+    Algorithm.setEnums(AlgorithmEnums);
 }
 
 short SetOperations::mustExecute() const
@@ -62,11 +68,27 @@ short SetOperations::mustExecute() const
             return 1;
         if (OperationType.isTouched())
             return 1;
+        if (Algorithm.isTouched())
+            return 1;
     }
 
     return 0;
 }
 
+bool SetOperations::isExecuteThreadSafe(void) const
+{
+    return true;
+}
+
+void SetOperations::Restore(Base::XMLReader &reader)
+{
+    // Files written before the robust algorithm was added don't store the
+    // Algorithm property. To get the same results on recompute they must use
+    // the legacy algorithm while the stored value takes precedence otherwise.
+    Algorithm.setValue((long)1);
+    Mesh::Feature::Restore(reader);
+}
+
 App::DocumentObjectExecReturn *SetOperations::execute(void)
 {
     Mesh::Feature *mesh1  = dynamic_cast<Mesh::Feature*>(Source1.getValue());
@@ -94,9 +116,20 @@ App::DocumentObjectExecReturn *SetOperations::execute(void)
             throw new Base::Exception("Operation type must either be 'union' or 'intersection'"
                                       " or 'difference' or 'inner' or 'outer'");
 
-        MeshCore::SetOperations setOp(meshKernel1.getKernel(), meshKernel2.getKernel(), 
-            pcKernel->getKernel(), type, 1.0e-5f);
-        setOp.Do();
+        if (Algorithm.getValue() == 0) {
+            MeshCore::MeshBoolean boolOp(meshKernel1.getKernel(), meshKernel2.getKernel(),
+                pcKernel->getKernel(), type);
+            boolOp.Do();
+            unsigned long failed = boolOp.CountFailedFacets();
+            if (failed > 0)
+                Base::Console().Warning("%s: %lu facets could not be retriangulated\n",
+                    getNameInDocument(), failed);
+        }
+        else {
+            MeshCore::SetOperations setOp(meshKernel1.getKernel(), meshKernel2.getKernel(), 
+                pcKernel->getKernel(), type, 1.0e-5f);
+            setOp.Do();
+        }
         Mesh.setValuePtr(pcKernel.release());
     }
     else { 
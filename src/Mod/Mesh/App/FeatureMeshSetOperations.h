@@ -30,6 +30,7 @@
 
 #include <App/PropertyLinks.h>
 #include <App/PropertyGeo.h>
+#include <App/PropertyStandard.h>
 
 
 namespace Mesh
@@ -50,13 +51,22 @@ public:
     App::PropertyLink   Source1;
     App::PropertyLink   Source2;
     App::PropertyString OperationType;
+    App::PropertyEnumeration Algorithm;
 
     /** @name methods overide Feature */
     //@{
     /// recalculate the Feature
     App::DocumentObjectExecReturn *execute(void);
     short mustExecute() const;
+    /// execute() only reads Source1 and Source2
+    bool isExecuteThreadSafe(void) const;
     //@}
+
+    /// Documents without the Algorithm property keep the legacy algorithm
+    void Restore(Base::XMLReader &reader);
+
+private:
+    static const char* AlgorithmEnums[];
 };
 
 }
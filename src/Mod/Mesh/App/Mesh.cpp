@@ -38,6 +38,7 @@
 #include <Base/ViewProj.h>
 
 #include "Core/Builder.h"
+#include "Core/Decimation.h"
 #include "Core/MeshKernel.h"
 #include "Core/Grid.h"
 #include "Core/Iterator.h"
@@ -47,6 +48,7 @@
 #include "Core/Degeneration.h"
 #include "Core/Segmentation.h"
 #include "Core/SetOperations.h"
+#include "Core/Smoothing.h"
 #include "Core/Triangulation.h"
 #include "Core/Trim.h"
 #include "Core/Visitor.h"
@@ -820,6 +822,20 @@ void MeshObject::smooth(int iterations, float d_max)
     _kernel.Smooth(iterations, d_max);
 }
 
+void MeshObject::laplaceSmooth(int iterations, bool parallel)
+{
+    MeshCore::LaplaceSmoothing smooth(_kernel);
+    smooth.SetParallel(parallel);
+    smooth.Smooth(iterations);
+}
+
+void MeshObject::taubinSmooth(int iterations, bool parallel)
+{
+    MeshCore::TaubinSmoothing smooth(_kernel);
+    smooth.SetParallel(parallel);
+    smooth.Smooth(iterations);
+}
+
 Base::Vector3d MeshObject::getPointNormal(unsigned long index) const
 {
     std::vector<Base::Vector3f> temp = _kernel.CalcVertexNormals();
@@ -997,6 +1013,29 @@ void MeshObject::refine()
     this->_segments.clear();
 }
 
+void MeshObject::decimate(unsigned long targetSize, float fTolerance, float fFeatureAngle)
+{
+    MeshCore::MeshSimplify dm(_kernel);
+    dm.SetFeatureAngle(fFeatureAngle);
+    dm.Simplify(targetSize, fTolerance);
+
+    // clear the segments because we don't know how the new
+    // topology looks like
+    this->_segments.clear();
+}
+
+MeshObject* MeshObject::clusterVertices(float fCellSize) const
+{
+    MeshCore::MeshPointArray points;
+    MeshCore::MeshFacetArray facets;
+    MeshCore::MeshVertexClustering vc(_kernel.GetPoints(), _kernel.GetFacets());
+    vc.Simplify(fCellSize, points, facets);
+
+    MeshCore::MeshKernel kernel;
+    kernel.Adopt(points, facets, true);
+    return new MeshObject(kernel, _Mtrx);
+}
+
 void MeshObject::optimizeTopology(float fMaxAngle)
 {
     MeshCore::MeshTopoAlgorithm topalg(_kernel);
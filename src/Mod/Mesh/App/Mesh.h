@@ -204,6 +204,8 @@ public:
     void movePoint(unsigned long, const Base::Vector3d& v);
     void setPoint(unsigned long, const Base::Vector3d& v);
     void smooth(int iterations, float d_max);
+    void laplaceSmooth(int iterations, bool parallel);
+    void taubinSmooth(int iterations, bool parallel);
     Base::Vector3d getPointNormal(unsigned long) const;
     std::vector<Base::Vector3d> getPointNormals() const;
     void crossSections(const std::vector<TPlane>&, std::vector<TPolylines> &sections,
@@ -240,6 +242,8 @@ public:
     /** @name Topological operations */
     //@{
     void refine();
+    void decimate(unsigned long targetSize, float fTolerance, float fFeatureAngle);
+    MeshObject* clusterVertices(float fCellSize) const;
     void optimizeTopology(float);
     void optimizeEdges();
     void splitEdges();
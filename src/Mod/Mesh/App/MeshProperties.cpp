@@ -32,6 +32,7 @@
 #include <Base/Reader.h>
 #include <Base/Stream.h>
 #include <Base/VectorPy.h>
+#include <App/Application.h>
 
 #include "Core/MeshKernel.h"
 #include "Core/MeshIO.h"
@@ -447,6 +448,7 @@ PropertyMeshKernel::~PropertyMeshKernel()
 
 void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
 {
+    loadDeferred();
     // use the tmp. object to guarantee that the referenced mesh is not destroyed
     // before calling hasSetValue()
     Base::Reference<MeshObject> tmp(_meshObject);
@@ -457,6 +459,7 @@ void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
 
 void PropertyMeshKernel::setValue(const MeshObject& mesh)
 {
+    loadDeferred();
     aboutToSetValue();
     *_meshObject = mesh;
     hasSetValue();
@@ -464,6 +467,7 @@ void PropertyMeshKernel::setValue(const MeshObject& mesh)
 
 void PropertyMeshKernel::setValue(const MeshCore::MeshKernel& mesh)
 {
+    loadDeferred();
     aboutToSetValue();
     _meshObject->setKernel(mesh);
     hasSetValue();
@@ -471,6 +475,7 @@ void PropertyMeshKernel::setValue(const MeshCore::MeshKernel& mesh)
 
 void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 {
+    loadDeferred();
     aboutToSetValue();
     _meshObject->swap(mesh);
     hasSetValue();
@@ -478,6 +483,7 @@ void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 
 void PropertyMeshKernel::swapMesh(MeshCore::MeshKernel& mesh)
 {
+    loadDeferred();
     aboutToSetValue();
     _meshObject->swap(mesh);
     hasSetValue();
@@ -485,21 +491,25 @@ void PropertyMeshKernel::swapMesh(MeshCore::MeshKernel& mesh)
 
 const MeshObject& PropertyMeshKernel::getValue(void)const 
 {
+    loadDeferred();
     return *_meshObject;
 }
 
 const MeshObject* PropertyMeshKernel::getValuePtr(void)const 
 {
+    loadDeferred();
     return (MeshObject*)_meshObject;
 }
 
 const Data::ComplexGeoData* PropertyMeshKernel::getComplexData() const
 {
+    loadDeferred();
     return (MeshObject*)_meshObject;
 }
 
 Base::BoundBox3d PropertyMeshKernel::getBoundingBox() const
 {
+    loadDeferred();
     return _meshObject->getBoundBox();
 }
 
@@ -507,6 +517,7 @@ void PropertyMeshKernel::getFaces(std::vector<Base::Vector3d> &aPoints,
                                   std::vector<Data::ComplexGeoData::Facet> &aTopo,
                                   float accuracy, uint16_t flags) const
 {
+    loadDeferred();
     _meshObject->getFaces(aPoints, aTopo, accuracy, flags);
 }
 
@@ -520,6 +531,7 @@ unsigned int PropertyMeshKernel::getMemSize (void) const
 
 MeshObject* PropertyMeshKernel::startEditing()
 {
+    loadDeferred();
     aboutToSetValue();
     return (MeshObject*)_meshObject;
 }
@@ -531,6 +543,7 @@ void PropertyMeshKernel::finishEditing()
 
 void PropertyMeshKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    loadDeferred();
     aboutToSetValue();
     _meshObject->transformGeometry(rclMat);
     hasSetValue();
@@ -538,6 +551,7 @@ void PropertyMeshKernel::transformGeometry(const Base::Matrix4D &rclMat)
 
 void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned long, Base::Vector3f> >& inds)
 {
+    loadDeferred();
     aboutToSetValue();
     MeshCore::MeshKernel& kernel = _meshObject->getKernel();
     for (std::vector<std::pair<unsigned long, Base::Vector3f> >::const_iterator it = inds.begin(); it != inds.end(); ++it)
@@ -547,6 +561,7 @@ void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned lo
 
 PyObject *PropertyMeshKernel::getPyObject(void)
 {
+    loadDeferred();
     if (!meshPyObject) {
         meshPyObject = new MeshPy(&*_meshObject);
         meshPyObject->setConst(); // set immutable
@@ -582,12 +597,18 @@ void PropertyMeshKernel::setPyObject(PyObject *value)
 
 void PropertyMeshKernel::Save (Base::Writer &writer) const
 {
+    loadDeferred();
     if (writer.isForceXML()) {
         writer.Stream() << writer.ind() << "<Mesh>" << std::endl;
         MeshCore::MeshOutput saver(_meshObject->getKernel());
         saver.SaveXML(writer);
     }
     else {
+        // The compact format cannot be read by older versions, so it must be enabled
+        // explicitly. As it's a global setting pass it to SaveDocFile() via the writer.
+        if (App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Mesh")->GetBool("CompactFormat", false))
+            writer.setMode("CompactMesh");
         writer.Stream() << writer.ind() << "<Mesh file=\"" << 
         writer.addFile("MeshKernel.bms", this) << "\"/>" << std::endl;
     }
@@ -621,18 +642,43 @@ void PropertyMeshKernel::Restore(Base::XMLReader &reader)
 
 void PropertyMeshKernel::SaveDocFile (Base::Writer &writer) const
 {
-    _meshObject->save(writer.Stream());
+    loadDeferred();
+    if (writer.getMode("CompactMesh"))
+        _meshObject->getKernel().WriteCompact(writer.Stream());
+    else
+        _meshObject->save(writer.Stream());
 }
 
 void PropertyMeshKernel::RestoreDocFile(Base::Reader &reader)
 {
     aboutToSetValue();
+    _deferredFile = 0;
     _meshObject->load(reader);
     hasSetValue();
 }
 
+bool PropertyMeshKernel::deferRestoreDocFile(Base::DeferredFile* file)
+{
+    // Do not notify observers because they would access the data immediately.
+    // The transformation has already been restored from the XML part.
+    _deferredFile = file;
+    return true;
+}
+
+void PropertyMeshKernel::restoreDeferredDocFile(Base::Reader &reader)
+{
+    _meshObject->load(reader);
+}
+
+void PropertyMeshKernel::loadDeferred() const
+{
+    if (_deferredFile.isValid())
+        _deferredFile->restore(const_cast<PropertyMeshKernel*>(this));
+}
+
 App::Property *PropertyMeshKernel::Copy(void) const
 {
+    loadDeferred();
     // Note: Copy the content, do NOT reference the same mesh object
     PropertyMeshKernel *prop = new PropertyMeshKernel();
     *(prop->_meshObject) = *(this->_meshObject);
@@ -641,9 +687,11 @@ App::Property *PropertyMeshKernel::Copy(void) const
 
 void PropertyMeshKernel::Paste(const App::Property &from)
 {
+    loadDeferred();
     // Note: Copy the content, do NOT reference the same mesh object
     aboutToSetValue();
     const PropertyMeshKernel& prop = dynamic_cast<const PropertyMeshKernel&>(from);
+    prop.loadDeferred();
     *(this->_meshObject) = *(prop._meshObject);
     hasSetValue();
 }
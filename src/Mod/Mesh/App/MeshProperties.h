@@ -40,6 +40,9 @@
 #include "Core/MeshKernel.h"
 #include "Mesh.h"
 
+namespace Base {
+class DeferredFile;
+}
 
 namespace Mesh
 {
@@ -85,6 +88,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
 
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
 
     virtual App::Property *Copy(void) const;
@@ -141,6 +145,7 @@ public:
     void Restore(Base::XMLReader &reader);
 
     void SaveDocFile (Base::Writer &writer) const;
+    bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     void RestoreDocFile(Base::Reader &reader);
 
     /** @name Python interface */
@@ -239,14 +244,22 @@ public:
     void Restore(Base::XMLReader &reader);
 
     void SaveDocFile (Base::Writer &writer) const;
+    bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     void RestoreDocFile(Base::Reader &reader);
+    bool deferRestoreDocFile(Base::DeferredFile* file);
+    void restoreDeferredDocFile(Base::Reader &reader);
 
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
     //@}
 
+private:
+    /// reads in the mesh if its restore has been deferred
+    void loadDeferred() const;
+
 private:
     Base::Reference<MeshObject> _meshObject;
+    Base::Reference<Base::DeferredFile> _deferredFile;
     MeshPy* meshPyObject;
 };
 
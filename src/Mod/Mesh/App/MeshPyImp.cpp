@@ -41,6 +41,7 @@
 #include "Core/Degeneration.h"
 #include "Core/Elements.h"
 #include "Core/Grid.h"
+#include "Core/Tree.h"
 #include "Core/MeshKernel.h"
 #include "Core/Segmentation.h"
 #include "Core/Curvature.h"
@@ -1052,6 +1053,43 @@ PyObject*  MeshPy::refine(PyObject *args)
     Py_Return; 
 }
 
+PyObject*  MeshPy::decimate(PyObject *args)
+{
+    int targetSize;
+    float fTolerance=FLOAT_MAX;
+    float fFeatureAngle=0.0f;
+    if (!PyArg_ParseTuple(args, "i|ff", &targetSize, &fTolerance, &fFeatureAngle))
+        return NULL;
+    if (targetSize < 0) {
+        PyErr_SetString(PyExc_ValueError, "Target size must not be negative");
+        return NULL;
+    }
+
+    PY_TRY {
+        MeshPropertyLock lock(this->parentProperty);
+        getMeshObjectPtr()->decimate((unsigned long)targetSize, fTolerance,
+                                     fFeatureAngle * F_PI / 180.0f);
+    } PY_CATCH;
+
+    Py_Return; 
+}
+
+PyObject*  MeshPy::clusterVertices(PyObject *args)
+{
+    float fCellSize;
+    if (!PyArg_ParseTuple(args, "f", &fCellSize))
+        return NULL;
+    if (fCellSize <= 0.0f) {
+        PyErr_SetString(PyExc_ValueError, "Cell size must be positive");
+        return NULL;
+    }
+
+    PY_TRY {
+        MeshObject* mesh = getMeshObjectPtr()->clusterVertices(fCellSize);
+        return new MeshPy(mesh);
+    } PY_CATCH;
+}
+
 PyObject*  MeshPy::optimizeTopology(PyObject *args)
 {
     float fMaxAngle=-1.0f;
@@ -1423,16 +1461,29 @@ PyObject*  MeshPy::trim(PyObject *args)
     Py_Return; 
 }
 
-PyObject*  MeshPy::smooth(PyObject *args)
+PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
 {
     int iter=1;
     float d_max=FLOAT_MAX;
-    if (!PyArg_ParseTuple(args, "|if", &iter,&d_max))
+    const char* method="Laplace";
+    PyObject* parallel=Py_True;
+    static char* keywords_smooth[] = {"Iteration", "MaxDistance", "Method", "Parallel", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|ifsO!", keywords_smooth,
+                                     &iter, &d_max, &method, &PyBool_Type, &parallel))
+        return NULL;
+
+    std::string type(method);
+    if (type != "Laplace" && type != "Taubin") {
+        PyErr_SetString(PyExc_ValueError, "Method must be 'Laplace' or 'Taubin'");
         return NULL;
+    }
 
     PY_TRY {
         MeshPropertyLock lock(this->parentProperty);
-        getMeshObjectPtr()->smooth(iter, d_max);
+        if (type == "Taubin")
+            getMeshObjectPtr()->taubinSmooth(iter, PyObject_IsTrue(parallel) ? true : false);
+        else
+            getMeshObjectPtr()->laplaceSmooth(iter, PyObject_IsTrue(parallel) ? true : false);
     } PY_CATCH;
 
     Py_Return; 
@@ -1442,7 +1493,8 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
 {
     PyObject* pnt_p;
     PyObject* dir_p;
-    if (!PyArg_ParseTuple(args, "OO", &pnt_p, &dir_p))
+    PyObject* tree=Py_False;
+    if (!PyArg_ParseTuple(args, "OO|O!", &pnt_p, &dir_p, &PyBool_Type, &tree))
         return NULL;
 
     try {
@@ -1466,7 +1518,15 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
         if (alg.NearestFacetOnRay(pnt,  dir, grid, res, index) ||
             alg.NearestFacetOnRay(pnt, -dir, grid, res, index)) {
 #else
-        if (alg.NearestFacetOnRay(pnt, dir, res, index)) {
+        bool found;
+        if (PyObject_IsTrue(tree)) {
+            MeshCore::MeshFacetTree facetTree(getMeshObjectPtr()->getKernel());
+            found = alg.NearestFacetOnRay(pnt, dir, facetTree, res, index);
+        }
+        else {
+            found = alg.NearestFacetOnRay(pnt, dir, res, index);
+        }
+        if (found) {
 #endif
             Py::Tuple tuple(3);
             tuple.setItem(0, Py::Float(res.x));
@@ -1501,6 +1561,47 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
     }
 }
 
+PyObject* MeshPy::nearestFacetFromPoint(PyObject *args)
+{
+    PyObject* pnt_p;
+    PyObject* tree=Py_False;
+    if (!PyArg_ParseTuple(args, "O|O!", &pnt_p, &PyBool_Type, &tree))
+        return NULL;
+
+    try {
+        Py::Tuple pnt_t(pnt_p);
+        Py::Dict dict;
+        Base::Vector3f pnt((float)Py::Float(pnt_t.getItem(0)),
+                           (float)Py::Float(pnt_t.getItem(1)),
+                           (float)Py::Float(pnt_t.getItem(2)));
+
+        unsigned long index = 0;
+        Base::Vector3f res;
+        MeshCore::MeshAlgorithm alg(getMeshObjectPtr()->getKernel());
+
+        bool found;
+        if (PyObject_IsTrue(tree)) {
+            MeshCore::MeshFacetTree facetTree(getMeshObjectPtr()->getKernel());
+            found = alg.NearestPointFromPoint(pnt, facetTree, index, res);
+        }
+        else {
+            found = alg.NearestPointFromPoint(pnt, index, res);
+        }
+        if (found) {
+            Py::Tuple tuple(3);
+            tuple.setItem(0, Py::Float(res.x));
+            tuple.setItem(1, Py::Float(res.y));
+            tuple.setItem(2, Py::Float(res.z));
+            dict.setItem(Py::Int((int)index), tuple);
+        }
+
+        return Py::new_reference_to(dict);
+    }
+    catch (const Py::Exception&) {
+        return 0;
+    }
+}
+
 PyObject*  MeshPy::getPlanarSegments(PyObject *args)
 {
     float dev;
@@ -1566,6 +1667,73 @@ PyObject*  MeshPy::getSegmentsByCurvature(PyObject *args)
     return Py::new_reference_to(list);
 }
 
+PyObject*  MeshPy::getCurvaturePerVertex(PyObject *args)
+{
+    PyObject *parallel=Py_True;
+    if (!PyArg_ParseTuple(args, "|O!", &PyBool_Type, &parallel))
+        return NULL;
+
+    const MeshCore::MeshKernel& kernel = getMeshObjectPtr()->getKernel();
+    MeshCore::MeshCurvature meshCurv(kernel);
+    meshCurv.ComputePerVertex(PyObject_IsTrue(parallel) ? true : false);
+    const std::vector<MeshCore::CurvatureInfo>& curv = meshCurv.GetCurvature();
+
+    Py::List list;
+    for (std::vector<MeshCore::CurvatureInfo>::const_iterator it = curv.begin(); it != curv.end(); ++it) {
+        Py::Tuple t(4);
+        t.setItem(0, Py::Float(it->fMaxCurvature));
+        t.setItem(1, Py::Float(it->fMinCurvature));
+        t.setItem(2, Py::Vector(it->cMaxCurvDir));
+        t.setItem(3, Py::Vector(it->cMinCurvDir));
+        list.append(t);
+    }
+
+    return Py::new_reference_to(list);
+}
+
+namespace {
+template <class T>
+Py::List neighbourhoodList(const T& search, unsigned long count)
+{
+    Py::List list;
+    for (unsigned long i = 0; i < count; i++) {
+        MeshCore::MeshIndexRange range = search[i];
+        Py::List row;
+        for (MeshCore::MeshIndexRange::const_iterator it = range.begin(); it != range.end(); ++it)
+            row.append(Py::Int((int)*it));
+        list.append(row);
+    }
+    return list;
+}
+}
+
+PyObject*  MeshPy::getNeighbourhood(PyObject *args)
+{
+    char* type;
+    if (!PyArg_ParseTuple(args, "s", &type))
+        return NULL;
+
+    PY_TRY {
+        const MeshCore::MeshKernel& kernel = getMeshObjectPtr()->getKernel();
+        std::string t = type;
+        if (t == "PointToFacets") {
+            MeshCore::MeshRefPointToFacets search(kernel);
+            return Py::new_reference_to(neighbourhoodList(search, kernel.CountPoints()));
+        }
+        else if (t == "PointToPoints") {
+            MeshCore::MeshRefPointToPoints search(kernel);
+            return Py::new_reference_to(neighbourhoodList(search, kernel.CountPoints()));
+        }
+        else if (t == "FacetToFacets") {
+            MeshCore::MeshRefFacetToFacets search(kernel);
+            return Py::new_reference_to(neighbourhoodList(search, kernel.CountFacets()));
+        }
+
+        PyErr_SetString(PyExc_ValueError, "Expected 'PointToFacets', 'PointToPoints' or 'FacetToFacets'");
+        return NULL;
+    } PY_CATCH;
+}
+
 Py::Int MeshPy::getCountPoints(void) const
 {
     return Py::Int((long)getMeshObjectPtr()->countPoints());
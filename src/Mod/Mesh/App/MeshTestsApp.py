@@ -1,7 +1,7 @@
 #   (c) Juergen Riegel (juergen.riegel@web.de) 2007      LGPL
 
 import FreeCAD, os, sys, unittest, Mesh
-import thread, time, tempfile
+import thread, time, tempfile, glob, zipfile, random, math, struct
 
 
 #---------------------------------------------------------------------------
@@ -161,3 +161,847 @@ class LoadMeshInThreadsCases(unittest.TestCase):
 
     def tearDown(self):
         pass
+
+
+class MeshLazyLoadingCases(unittest.TestCase):
+    def setUp(self):
+        self.grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+        self.lazy = self.grp.GetBool("LazyLoading", False)
+        self.size = self.grp.GetInt("LazyLoadingMinSize", 1024)
+        self.grp.SetBool("LazyLoading", True)
+        self.grp.SetInt("LazyLoadingMinSize", 0)
+        self.fileName = tempfile.gettempdir() + os.sep + "LazyMesh.FCStd"
+        self.otherName = tempfile.gettempdir() + os.sep + "LazyMesh2.FCStd"
+
+    def testRestoreOnAccess(self):
+        doc = FreeCAD.newDocument("LazyMesh")
+        mesh = doc.addObject("Mesh::Feature", "Sphere")
+        mesh.Mesh = Mesh.createSphere(10.0, 50)
+        mesh.Placement.Base = FreeCAD.Vector(1, 2, 3)
+        count = mesh.Mesh.CountFacets
+        doc.saveAs(self.fileName)
+        FreeCAD.closeDocument("LazyMesh")
+
+        doc = FreeCAD.openDocument(self.fileName)
+        mesh = doc.getObject("Sphere")
+        self.failUnless(mesh.Mesh.CountFacets == count)
+        self.failUnless(mesh.Placement.Base == FreeCAD.Vector(1, 2, 3))
+
+        # saving under a new name must write the data that is not loaded yet
+        FreeCAD.closeDocument(doc.Name)
+        doc = FreeCAD.openDocument(self.fileName)
+        doc.saveAs(self.otherName)
+        FreeCAD.closeDocument(doc.Name)
+        doc = FreeCAD.openDocument(self.otherName)
+        self.failUnless(doc.getObject("Sphere").Mesh.CountFacets == count)
+        FreeCAD.closeDocument(doc.Name)
+
+    def testModifiedArchive(self):
+        doc = FreeCAD.newDocument("LazyMesh")
+        mesh = doc.addObject("Mesh::Feature", "Sphere")
+        mesh.Mesh = Mesh.createSphere(10.0, 50)
+        count = mesh.Mesh.CountFacets
+        doc.saveAs(self.fileName)
+        FreeCAD.closeDocument("LazyMesh")
+
+        doc = FreeCAD.openDocument(self.fileName)
+        stat = os.stat(self.fileName)
+        os.utime(self.fileName, (stat.st_atime, stat.st_mtime + 100))
+        # saving must fail instead of writing an empty mesh
+        self.assertRaises(Exception, doc.saveAs, self.otherName)
+
+        # the mesh is still not restored and can be read once the archive is unchanged
+        os.utime(self.fileName, (stat.st_atime, stat.st_mtime))
+        self.failUnless(doc.getObject("Sphere").Mesh.CountFacets == count)
+        FreeCAD.closeDocument(doc.Name)
+
+    def testFailedRead(self):
+        doc = FreeCAD.newDocument("LazyMesh")
+        mesh = doc.addObject("Mesh::Feature", "Sphere")
+        mesh.Mesh = Mesh.createSphere(10.0, 50)
+        count = mesh.Mesh.CountFacets
+        doc.saveAs(self.fileName)
+        FreeCAD.closeDocument("LazyMesh")
+
+        # replace the mesh file by a compact mesh whose facet block is missing
+        data = open(self.fileName, "rb").read()
+        archive = zipfile.ZipFile(self.fileName)
+        entries = [(i, archive.read(i.filename)) for i in archive.infolist()]
+        archive.close()
+        archive = zipfile.ZipFile(self.fileName, "w")
+        for info, content in entries:
+            if not info.filename.endswith(".xml"):
+                content = struct.pack("<IIIIII", 0xA0B0C0D0, 0x020000, 0, 1, 0, 0)
+            archive.writestr(info, content)
+        archive.close()
+
+        doc = FreeCAD.openDocument(self.fileName)
+        stat = os.stat(self.fileName)
+        # saving must fail instead of writing an empty mesh
+        self.assertRaises(Exception, doc.saveAs, self.otherName)
+
+        # the mesh is still not restored and can be read once the file is back
+        open(self.fileName, "wb").write(data)
+        os.utime(self.fileName, (stat.st_atime, stat.st_mtime))
+        self.failUnless(doc.getObject("Sphere").Mesh.CountFacets == count)
+        FreeCAD.closeDocument(doc.Name)
+
+    def tearDown(self):
+        self.grp.SetBool("LazyLoading", self.lazy)
+        self.grp.SetInt("LazyLoadingMinSize", self.size)
+        # a failed save leaves its temporary file behind
+        for name in glob.glob(self.fileName + "*") + glob.glob(self.otherName + "*"):
+            os.remove(name)
+
+
+class MeshCompactFormatCases(unittest.TestCase):
+    def setUp(self):
+        self.grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Mesh")
+        self.compact = self.grp.GetBool("CompactFormat", False)
+        self.grp.SetBool("CompactFormat", True)
+        self.fileName = tempfile.gettempdir() + os.sep + "CompactMesh.FCStd"
+
+    def testSaveAndRestore(self):
+        doc = FreeCAD.newDocument("CompactMesh")
+        mesh = Mesh.createSphere(10.0, 50)
+        mesh.translate(-1.5, 100.0, 1e4)
+        doc.addObject("Mesh::Feature", "Sphere").Mesh = mesh
+        doc.saveAs(self.fileName)
+        FreeCAD.closeDocument("CompactMesh")
+
+        doc = FreeCAD.openDocument(self.fileName)
+        other = doc.getObject("Sphere").Mesh
+        self.failUnless(other.Topology[1] == mesh.Topology[1])
+        self.failUnless(other.Topology[0] == mesh.Topology[0])
+        self.failUnless(other.BoundBox.isInside(mesh.BoundBox.Center))
+        self.failUnless(other.CountFacets == mesh.CountFacets)
+        self.failUnless(other.isSolid())
+        FreeCAD.closeDocument(doc.Name)
+
+    def tearDown(self):
+        self.grp.SetBool("CompactFormat", self.compact)
+        if os.path.exists(self.fileName):
+            os.remove(self.fileName)
+
+
+class MeshSelfIntersectionCases(unittest.TestCase):
+    def testSphere(self):
+        mesh = Mesh.createSphere(10.0, 100)
+        self.failUnless(mesh.CountFacets > 10000)
+        self.failIf(mesh.hasSelfIntersections())
+
+    def testOverlappingSpheres(self):
+        mesh = Mesh.createSphere(10.0, 100)
+        other = Mesh.createSphere(10.0, 100)
+        other.translate(5.0, 0.0, 0.0)
+        mesh.addMesh(other)
+        self.failUnless(mesh.hasSelfIntersections())
+
+
+class MeshDecimationCases(unittest.TestCase):
+    def testTargetSize(self):
+        mesh = Mesh.createSphere(10.0, 100)
+        mesh.decimate(1000)
+        self.failUnless(mesh.CountFacets <= 1000)
+        self.failUnless(mesh.isSolid())
+        self.failIf(mesh.hasNonManifolds())
+        for p in mesh.Points:
+            self.failUnless(abs(p.Vector.Length - 10.0) < 0.5)
+
+    def testTolerance(self):
+        mesh = Mesh.createSphere(10.0, 100)
+        count = mesh.CountFacets
+        mesh.decimate(0, 0.01)
+        self.failUnless(mesh.CountFacets < count)
+        self.failUnless(mesh.isSolid())
+
+    def testBorder(self):
+        mesh = Mesh.createSphere(10.0, 100)
+        border = mesh.Facets[0].Points
+        mesh.removeFacets([0])
+        mesh.decimate(500)
+        self.failUnless(mesh.CountFacets <= 500)
+        points = [p.Vector for p in mesh.Points]
+        for b in border:
+            v = FreeCAD.Vector(b)
+            self.failUnless(min([(p - v).Length for p in points]) < 1e-5)
+
+
+class MeshMappedSTLCases(unittest.TestCase):
+    def setUp(self):
+        self.fileName = tempfile.gettempdir() + os.sep + "MappedMesh.stl"
+
+    def testBinarySTL(self):
+        mesh = Mesh.createSphere(10.0, 100)
+        mesh.write(self.fileName, "STL")
+        other = Mesh.Mesh(self.fileName)
+        self.failUnless(other.CountPoints == mesh.CountPoints)
+        self.failUnless(other.CountFacets == mesh.CountFacets)
+        self.failUnless(other.isSolid())
+
+    def testAsciiSTL(self):
+        mesh = Mesh.createBox(1.0, 2.0, 3.0)
+        mesh.write(self.fileName, "AST")
+        other = Mesh.Mesh(self.fileName)
+        self.failUnless(other.CountPoints == mesh.CountPoints)
+        self.failUnless(other.CountFacets == mesh.CountFacets)
+
+    def testAsciiFormats(self):
+        mesh = Mesh.createSphere(10.0, 50)
+        base = tempfile.gettempdir() + os.sep + "AsciiMesh"
+        for ext, fmt in (("obj", "OBJ"), ("ply", "APLY")):
+            fileName = base + "." + ext
+            mesh.write(fileName, fmt)
+            other = Mesh.Mesh(fileName)
+            os.remove(fileName)
+            self.failUnless(other.CountPoints == mesh.CountPoints)
+            self.failUnless(other.CountFacets == mesh.CountFacets)
+            self.failUnless(other.isSolid())
+
+    def tearDown(self):
+        if os.path.exists(self.fileName):
+            os.remove(self.fileName)
+
+
+class MeshAsciiReaderCases(unittest.TestCase):
+    def setUp(self):
+        self.files = []
+
+    def writeFile(self, ext, text):
+        name = tempfile.gettempdir() + os.sep + "AsciiReader%d.%s" % (len(self.files), ext)
+        self.files.append(name)
+        f = open(name, "w")
+        f.write(text)
+        f.close()
+        return name
+
+    def toFloat(self, text):
+        # the value a float gets when the text is parsed exactly
+        return struct.unpack("f", struct.pack("f", float(text)))[0]
+
+    def testNumbers(self):
+        numbers = [["1.5e+01", "-2.5E-1", "+3"],
+                   [".5", "5.", "12345678901234567890.0e-19"],
+                   ["0.1234567890123456789012345", "1e-50", "-7E2"]]
+        text = "solid numbers\n  facet normal 0 0 0\n    outer loop\n"
+        for v in numbers:
+            text += "      vertex %s %s %s\n" % tuple(v)
+        text += "    endloop\n  endfacet\nendsolid numbers\n"
+        mesh = Mesh.Mesh(self.writeFile("stl", text))
+        self.failUnless(mesh.CountFacets == 1)
+        points = sorted([(p.x, p.y, p.z) for p in mesh.Topology[0]])
+        expected = sorted([tuple([self.toFloat(n) for n in v]) for v in numbers])
+        self.failUnless(points == expected, "%r != %r" % (points, expected))
+
+    def testMultiBlockSTL(self):
+        # files above 16 MB are split into blocks that are parsed in parallel
+        mesh = Mesh.createSphere(10.0, 300)
+        name = tempfile.gettempdir() + os.sep + "AsciiReaderBig.stl"
+        self.files.append(name)
+        mesh.write(name, "AST")
+        self.failUnless(os.path.getsize(name) > 2 * 16 * 1024 * 1024)
+        other = Mesh.Mesh(name)
+        self.failUnless(other.CountPoints == mesh.CountPoints)
+        self.failUnless(other.CountFacets == mesh.CountFacets)
+        self.failUnless(other.isSolid())
+        self.failUnless(not other.hasNonManifolds())
+
+    def testObjIndices(self):
+        # negative indices count from the last read vertex, texture and normal
+        # indices are skipped and polygons are split into a fan
+        text = ("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0.5 0.5 1\n"
+                "f 1/1/1 2/2/2 3/3/3 4/4/4\n"
+                "f -5 -4 -1\n"
+                "f 2//1 3//1 -1\n"
+                "f 3 4 5\n"
+                "f 4/2 1/3 5/4\n")
+        mesh = Mesh.Mesh(self.writeFile("obj", text))
+        self.failUnless(mesh.CountPoints == 5)
+        self.failUnless(mesh.Topology[1] == [(0,1,2),(0,2,3),(0,1,4),(1,2,4),(2,3,4),(3,0,4)])
+        self.failUnless(mesh.isSolid())
+
+    def testPlyEmptyLines(self):
+        text = ("ply\nformat ascii 1.0\nelement vertex 4\n"
+                "property float x\nproperty float y\nproperty float z\n"
+                "element face 4\nproperty list uchar int vertex_indices\nend_header\n"
+                "0 0 0\n\n1.5e0 0 0\n   \n0 -1.5 0\n0 0 +1.5\n\n"
+                "3 0 2 1\n\n3 0 1 3\n  \n3 1 2 3\n3 2 0 3\n\n")
+        mesh = Mesh.Mesh(self.writeFile("ply", text))
+        self.failUnless(mesh.CountPoints == 4)
+        self.failUnless(mesh.CountFacets == 4)
+        self.failUnless(mesh.isSolid())
+        points = [(p.x, p.y, p.z) for p in mesh.Topology[0]]
+        self.failUnless(points == [(0,0,0),(1.5,0,0),(0,-1.5,0),(0,0,1.5)])
+
+    def tearDown(self):
+        for name in self.files:
+            if os.path.exists(name):
+                os.remove(name)
+
+
+class MeshBooleanCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("MeshBoolean")
+
+    def boolean(self, mesh1, mesh2, operation):
+        source1 = self.doc.addObject("Mesh::Feature", "Source1")
+        source1.Mesh = mesh1
+        source2 = self.doc.addObject("Mesh::Feature", "Source2")
+        source2.Mesh = mesh2
+        result = self.doc.addObject("Mesh::SetOperations", "Boolean")
+        result.Source1 = source1
+        result.Source2 = source2
+        result.OperationType = operation
+        self.doc.recompute()
+        mesh = result.Mesh
+        self.failUnless(mesh.isSolid())
+        self.failUnless(not mesh.hasNonManifolds())
+        return mesh
+
+    def boxes(self, offset, operation):
+        mesh = Mesh.createBox(10.0, 10.0, 10.0)
+        mesh.translate(offset[0], offset[1], offset[2])
+        return self.boolean(Mesh.createBox(10.0, 10.0, 10.0), mesh, operation)
+
+    def spheres(self, operation):
+        # more than one block of 4096 facets, so the facet pairs are cut in parallel
+        sphere1 = Mesh.createSphere(10.0, 100)
+        sphere2 = Mesh.createSphere(10.0, 100)
+        sphere2.translate(10.0, 0.0, 0.0)
+        self.failUnless(sphere1.CountFacets > 4096)
+        return sphere1.Volume, self.boolean(sphere1, sphere2, operation)
+
+    def testUnion(self):
+        mesh = self.boxes((5.0, 5.0, 5.0), "union")
+        self.failUnless(abs(mesh.Volume - 1875.0) < 1e-3)
+
+    def testCoplanarUnion(self):
+        mesh = self.boxes((5.0, 0.0, 0.0), "union")
+        self.failUnless(abs(mesh.Volume - 1500.0) < 1e-3)
+
+    def testCoplanarIntersection(self):
+        mesh = self.boxes((5.0, 0.0, 0.0), "intersection")
+        self.failUnless(abs(mesh.Volume - 500.0) < 1e-3)
+
+    def testCoplanarDifference(self):
+        mesh = self.boxes((5.0, 0.0, 0.0), "difference")
+        self.failUnless(abs(mesh.Volume - 500.0) < 1e-3)
+
+    def testTouchingFaces(self):
+        # the boxes only share the face at x=10 that lies in both meshes
+        mesh = self.boxes((10.0, 0.0, 0.0), "union")
+        self.failUnless(abs(mesh.Volume - 2000.0) < 1e-3)
+        mesh = self.boxes((10.0, 5.0, 5.0), "union")
+        self.failUnless(abs(mesh.Volume - 2000.0) < 1e-3)
+
+    def testLargeUnion(self):
+        volume, union = self.spheres("union")
+        volume, intersection = self.spheres("intersection")
+        self.failUnless(volume < union.Volume < 2.0 * volume)
+        self.failUnless(0.0 < intersection.Volume < volume)
+        self.failUnless(abs(union.Volume + intersection.Volume - 2.0 * volume) < 1e-3 * volume)
+
+    def testLargeDifference(self):
+        volume, difference = self.spheres("difference")
+        volume, intersection = self.spheres("intersection")
+        self.failUnless(abs(difference.Volume + intersection.Volume - volume) < 1e-3 * volume)
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.doc.Name)
+
+
+class MeshOutOfCoreCases(unittest.TestCase):
+    def setUp(self):
+        base = tempfile.gettempdir() + os.sep + "OutOfCore"
+        self.input = base + "In.stl"
+        self.output = base + "Out.stl"
+        self.mesh = Mesh.createSphere(10.0, 100)
+        self.mesh.write(self.input, "STL")
+        self.chunkSize = self.mesh.CountFacets / 7
+
+    def testProcess(self):
+        ops = ["removeDuplicatedPoints", "harmonizeNormals", ("decimate", self.mesh.CountFacets / 2)]
+        Mesh.processOutOfCore(self.input, self.output, ops, self.chunkSize)
+        other = Mesh.Mesh(self.output)
+        self.failUnless(other.CountFacets < self.mesh.CountFacets)
+        self.failUnless(other.isSolid())
+        self.failUnless(other.Volume > 0.0)
+
+    def testCrossSections(self):
+        planes = [(FreeCAD.Vector(0, 0, z), FreeCAD.Vector(0, 0, 1)) for z in (-5.0, 0.5, 5.0)]
+        sections = Mesh.crossSectionsOutOfCore(self.input, planes, 1e-2, False, self.chunkSize)
+        expected = self.mesh.crossSections(planes)
+        self.failUnless(len(sections) == len(expected))
+        for section, other in zip(sections, expected):
+            self.failUnless(len(section) == len(other))
+            self.failUnless(sum(map(len, section)) == sum(map(len, other)))
+
+    def tearDown(self):
+        for fileName in (self.input, self.output):
+            if os.path.exists(fileName):
+                os.remove(fileName)
+
+
+class MeshIndexSizeCases(unittest.TestCase):
+    def testMemSize(self):
+        # a point takes 20 and a facet 32 bytes, independent of the platform
+        mesh = Mesh.createSphere(10.0, 50)
+        self.failUnless(mesh.MemSize == 20 * mesh.CountPoints + 32 * mesh.CountFacets)
+
+    def testOpenEdges(self):
+        mesh = Mesh.Mesh([[0,0,0],[1,0,0],[0,1,0],[1,0,0],[1,1,0],[0,1,0]])
+        first = mesh.Facets[0].NeighbourIndices
+        second = mesh.Facets[1].NeighbourIndices
+        self.failUnless(1 in first and 0 in second)
+        missing = [i for i in first + second if i > 1]
+        self.failUnless(len(missing) == 4)
+        self.failUnless(min(missing) == max(missing))
+        self.failUnless(min(missing) >= 2**32 - 1)
+
+    def testRemoveFacets(self):
+        mesh = Mesh.createSphere(10.0, 50)
+        count = mesh.CountFacets
+        mesh.removeFacets(range(0, count, 3))
+        missing = Mesh.Mesh([[0,0,0],[1,0,0],[0,1,0]]).Facets[0].NeighbourIndices[0]
+        for facet in mesh.Facets:
+            for i in facet.NeighbourIndices:
+                self.failUnless(i < mesh.CountFacets or i == missing)
+            for i in facet.PointIndices:
+                self.failUnless(i < mesh.CountPoints)
+
+    def testOldFormat(self):
+        # the unversioned format holds the raw structs of a 32-bit or 64-bit build
+        points = [(0,0,0),(1,0,0),(0,1,0),(1,1,0)]
+        facets = [(0,1,2,None,1,None),(1,3,2,None,None,0)]
+        layouts = [("=fffBxxxI", "=BxxxIIIIIII", 2**32-1), ("=fffBxxxQ", "=BxxxxxxxQQQQQQQ", 2**64-1)]
+        fileName = tempfile.gettempdir() + os.sep + "OldFormat.bms"
+        for point, facet, missing in layouts:
+            data = struct.pack("=II", len(points), len(facets))
+            for p in points:
+                data += struct.pack(point, p[0], p[1], p[2], 0, 0)
+            for f in facets:
+                data += struct.pack(facet, 0, 0, *[missing if i is None else i for i in f])
+            data += struct.pack("=ffffff", 0, 0, 0, 1, 1, 0)
+            open(fileName, "wb").write(data)
+            try:
+                mesh = Mesh.Mesh(fileName)
+            finally:
+                os.remove(fileName)
+            self.failUnless(mesh.CountPoints == 4)
+            self.failUnless(mesh.CountFacets == 2)
+            self.failUnless(mesh.Points[3].Vector == FreeCAD.Vector(1,1,0))
+            self.failUnless(mesh.Facets[1].PointIndices == (1,3,2))
+            self.failUnless(mesh.Facets[0].NeighbourIndices[1] == 1)
+            self.failUnless(mesh.Facets[1].NeighbourIndices[2] == 0)
+            self.failUnless(mesh.Facets[0].NeighbourIndices[0] >= 2**32 - 1)
+
+class MeshCurvatureCases(unittest.TestCase):
+    def testParallelPerVertex(self):
+        # a torus has points with positive, negative and zero Gaussian curvature
+        mesh = Mesh.createTorus(8.0, 2.0, 80)
+        mesh.transform(FreeCAD.Matrix(1,0.1,0,0, 0,1.5,0,0, 0,0,1,0, 0,0,0,1))
+        parallel = mesh.getCurvaturePerVertex(True)
+        serial = mesh.getCurvaturePerVertex(False)
+        self.failUnless(len(parallel) == mesh.CountPoints)
+        self.failUnless(len(serial) == mesh.CountPoints)
+        for p, s in zip(parallel, serial):
+            self.failUnless(abs(p[0] - s[0]) <= 1e-4 * max(1.0, abs(s[0])))
+            self.failUnless(abs(p[1] - s[1]) <= 1e-4 * max(1.0, abs(s[1])))
+            self.failUnless(abs(p[2].dot(s[2])) >= 0.999 or abs(s[0] - s[1]) < 1e-3)
+            self.failUnless(abs(p[3].dot(s[3])) >= 0.999 or abs(s[0] - s[1]) < 1e-3)
+
+
+class MeshParallelSaveCases(unittest.TestCase):
+    def setUp(self):
+        self.grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+        self.parallel = self.grp.GetBool("ParallelSave", False)
+        self.serialName = tempfile.gettempdir() + os.sep + "SerialMesh.FCStd"
+        self.parallelName = tempfile.gettempdir() + os.sep + "ParallelMesh.FCStd"
+
+    def save(self, doc, name, parallel):
+        self.grp.SetBool("ParallelSave", parallel)
+        doc.saveAs(name)
+
+    def testRoundTrip(self):
+        # more objects than entries are processed at the same time
+        doc = FreeCAD.newDocument("ParallelMesh")
+        meshes = []
+        for i in range(40):
+            mesh = doc.addObject("Mesh::Feature", "Mesh%d" % i)
+            mesh.Mesh = Mesh.createSphere(1.0 + i, 10 + i)
+            meshes.append(mesh.Mesh.Topology)
+        self.save(doc, self.serialName, False)
+        self.save(doc, self.parallelName, True)
+        FreeCAD.closeDocument(doc.Name)
+
+        # both archives have the same entries in the same order with the same content
+        serial = zipfile.ZipFile(self.serialName)
+        parallel = zipfile.ZipFile(self.parallelName)
+        self.failUnless(serial.namelist() == parallel.namelist())
+        for name in serial.namelist():
+            if name != "Document.xml":
+                self.failUnless(serial.read(name) == parallel.read(name), name)
+        serial.close()
+        parallel.close()
+
+        doc = FreeCAD.openDocument(self.parallelName)
+        for i in range(40):
+            self.failUnless(doc.getObject("Mesh%d" % i).Mesh.Topology == meshes[i])
+        FreeCAD.closeDocument(doc.Name)
+
+    def tearDown(self):
+        self.grp.SetBool("ParallelSave", self.parallel)
+        for name in glob.glob(self.serialName + "*") + glob.glob(self.parallelName + "*"):
+            os.remove(name)
+
+
+class MeshFacetTreeCases(unittest.TestCase):
+    def setUp(self):
+        # a finely tessellated sphere next to a few large facets
+        self.mesh = Mesh.createBox(20.0, 20.0, 20.0)
+        sphere = Mesh.createSphere(2.0, 60)
+        sphere.translate(12.0, 0.0, 0.0)
+        self.mesh.addMesh(sphere)
+        self.random = random.Random(4711)
+
+    def randomPoint(self, size):
+        return FreeCAD.Vector(self.random.uniform(-size, size),
+                              self.random.uniform(-size, size),
+                              self.random.uniform(-size, size))
+
+    def testNearestFromPoint(self):
+        for i in range(200):
+            pnt = self.randomPoint(20.0)
+            tree = self.mesh.nearestFacetFromPoint(tuple(pnt), True)
+            brute = self.mesh.nearestFacetFromPoint(tuple(pnt), False)
+            self.failUnless(len(tree) == 1 and len(brute) == 1)
+            # with several facets at the same distance the indices may differ
+            dist_tree = (FreeCAD.Vector(tree.values()[0]) - pnt).Length
+            dist_brute = (FreeCAD.Vector(brute.values()[0]) - pnt).Length
+            self.failUnless(abs(dist_tree - dist_brute) < 1e-4, "%g != %g" % (dist_tree, dist_brute))
+
+    def testNearestOnRay(self):
+        hits = 0
+        for i in range(200):
+            # start outside the bounding box, so there is nothing behind the ray
+            pnt = self.randomPoint(1.0)
+            pnt.normalize()
+            pnt = pnt * 40.0
+            dir = self.randomPoint(15.0) - pnt
+            tree = self.mesh.nearestFacetOnRay(tuple(pnt), tuple(dir), True)
+            brute = self.mesh.nearestFacetOnRay(tuple(pnt), tuple(dir), False)
+            self.failUnless(len(tree) == len(brute))
+            if len(brute) == 1:
+                hits += 1
+                dist_tree = (FreeCAD.Vector(tree.values()[0]) - pnt).Length
+                dist_brute = (FreeCAD.Vector(brute.values()[0]) - pnt).Length
+                self.failUnless(abs(dist_tree - dist_brute) < 1e-3, "%g != %g" % (dist_tree, dist_brute))
+            # pointing away from the mesh there is never a hit
+            self.failUnless(len(self.mesh.nearestFacetOnRay(tuple(pnt), tuple(-dir), True)) == 0)
+        self.failUnless(hits > 0)
+
+    def testEmptyMesh(self):
+        mesh = Mesh.Mesh()
+        self.failUnless(len(mesh.nearestFacetFromPoint((1,2,3), True)) == 0)
+        self.failUnless(len(mesh.nearestFacetOnRay((1,2,3), (0,0,1), True)) == 0)
+
+
+class MeshSetOperationsRestoreCases(unittest.TestCase):
+    def setUp(self):
+        self.fileName = tempfile.gettempdir() + os.sep + "MeshBoolean.FCStd"
+        self.oldName = tempfile.gettempdir() + os.sep + "MeshBooleanOld.FCStd"
+
+    def removeAlgorithm(self):
+        # write a copy of the project as older versions did without the Algorithm property
+        archive = zipfile.ZipFile(self.fileName)
+        xml = archive.read("Document.xml")
+        start = xml.index('<Property name="Algorithm"')
+        end = xml.index('</Property>', start) + len('</Property>')
+        count = xml.rindex('<Properties Count="', 0, start) + len('<Properties Count="')
+        quote = xml.index('"', count)
+        number = int(xml[count:quote]) - 1
+        xml = xml[:count] + str(number) + xml[quote:start] + xml[end:]
+        copy = zipfile.ZipFile(self.oldName, "w", zipfile.ZIP_DEFLATED)
+        for info in archive.infolist():
+            if info.filename == "Document.xml":
+                copy.writestr(info, xml)
+            else:
+                copy.writestr(info, archive.read(info.filename))
+        copy.close()
+        archive.close()
+
+    def testLegacyAlgorithm(self):
+        doc = FreeCAD.newDocument("MeshBoolean")
+        box1 = doc.addObject("Mesh::Feature", "Box1")
+        box1.Mesh = Mesh.createBox(1.0, 1.0, 1.0)
+        box2 = doc.addObject("Mesh::Feature", "Box2")
+        mesh = Mesh.createBox(1.0, 1.0, 1.0)
+        mesh.translate(0.5, 0.5, 0.5)
+        box2.Mesh = mesh
+        union = doc.addObject("Mesh::SetOperations", "Union")
+        union.Source1 = box1
+        union.Source2 = box2
+        self.failUnless(union.Algorithm == "Robust")
+        doc.saveAs(self.fileName)
+        FreeCAD.closeDocument(doc.Name)
+        self.removeAlgorithm()
+
+        doc = FreeCAD.openDocument(self.fileName)
+        self.failUnless(doc.getObject("Union").Algorithm == "Robust")
+        FreeCAD.closeDocument(doc.Name)
+
+        doc = FreeCAD.openDocument(self.oldName)
+        self.failUnless(doc.getObject("Union").Algorithm == "Legacy")
+        self.failUnless(doc.getObject("Box2").Mesh.CountFacets == 12)
+        FreeCAD.closeDocument(doc.Name)
+
+    def tearDown(self):
+        for name in glob.glob(self.fileName + "*") + glob.glob(self.oldName + "*"):
+            os.remove(name)
+
+
+class MeshNeighbourhoodCases(unittest.TestCase):
+    def setUp(self):
+        # enough facets to build the structures on several threads
+        self.mesh = Mesh.createTorus(8.0, 2.0, 200)
+        # three facets sharing an edge and two facets sharing only a point
+        self.mesh.addMesh(Mesh.Mesh([[20,0,0],[21,0,0],[20,1,0],
+                                     [20,0,0],[21,0,0],[20,-1,0],
+                                     [20,0,0],[21,0,0],[20,0,1],
+                                     [21,0,0],[22,0,0],[22,1,0]]))
+        self.points, self.facets = self.mesh.Topology
+
+    def pointToFacets(self):
+        # the std::set based structure used before
+        rows = [set() for p in self.points]
+        for i, f in enumerate(self.facets):
+            for p in f:
+                rows[p].add(i)
+        return rows
+
+    def checkRows(self, result, expected):
+        self.failUnless(len(result) == len(expected))
+        for r, e in zip(result, expected):
+            self.failUnless(r == sorted(e))
+
+    def testNonManifold(self):
+        self.failUnless(self.mesh.CountFacets > 65536)
+        self.failUnless(self.mesh.hasNonManifolds())
+
+    def testPointToFacets(self):
+        self.checkRows(self.mesh.getNeighbourhood("PointToFacets"), self.pointToFacets())
+
+    def testPointToPoints(self):
+        rows = [set() for p in self.points]
+        for f in self.facets:
+            for p in f:
+                rows[p].update(f)
+                rows[p].discard(p)
+        self.checkRows(self.mesh.getNeighbourhood("PointToPoints"), rows)
+
+    def testFacetToFacets(self):
+        pointFacets = self.pointToFacets()
+        rows = []
+        for f in self.facets:
+            rows.append(pointFacets[f[0]] | pointFacets[f[1]] | pointFacets[f[2]])
+        result = self.mesh.getNeighbourhood("FacetToFacets")
+        self.checkRows(result, rows)
+        # the facets at the non-manifold edge
+        count = self.mesh.CountFacets
+        self.failUnless(result[count - 4] == [count - 4, count - 3, count - 2, count - 1])
+
+    def testEmptyMesh(self):
+        mesh = Mesh.Mesh()
+        self.failUnless(mesh.getNeighbourhood("PointToFacets") == [])
+        self.failUnless(mesh.getNeighbourhood("FacetToFacets") == [])
+        self.failUnlessRaises(ValueError, mesh.getNeighbourhood, "EdgeToFacets")
+
+
+class MeshBuilderNeighbourCases(unittest.TestCase):
+    def oldNeighbours(self, facets, missing):
+        # the std::set based SetNeighbourhood of MeshBuilder used before
+        edges = {}
+        result = [[missing] * 3 for f in facets]
+        for i, f in enumerate(facets):
+            for j in range(3):
+                key = (min(f[j], f[(j+1)%3]), max(f[j], f[(j+1)%3]))
+                if key in edges:
+                    k, side = edges[key]
+                    result[k][side] = i
+                    result[i][j] = k
+                else:
+                    edges[key] = (i, j)
+        return result
+
+    def checkBuilder(self, triangles):
+        mesh = Mesh.Mesh(triangles)
+        missing = Mesh.Mesh([[0,0,0],[1,0,0],[0,1,0]]).Facets[0].NeighbourIndices[0]
+        facets = mesh.Topology[1]
+        expected = self.oldNeighbours(facets, missing)
+        for i, facet in enumerate(mesh.Facets):
+            self.failUnless(list(facet.NeighbourIndices) == expected[i])
+        return mesh
+
+    def testNonManifold(self):
+        # four facets at one edge
+        mesh = self.checkBuilder([[[0,0,0],[1,0,0],[0,1,0]],
+                                  [[0,0,0],[1,0,0],[0,-1,0]],
+                                  [[0,0,0],[1,0,0],[0,0,1]],
+                                  [[0,0,0],[1,0,0],[0,0,-1]],
+                                  [[1,0,0],[1,1,0],[0,1,0]]])
+        self.failUnless(mesh.hasNonManifolds())
+        self.failUnless(mesh.Facets[0].NeighbourIndices[0] == 3)
+        self.failUnless(mesh.Facets[1].NeighbourIndices[0] == 0)
+        self.failUnless(mesh.Facets[3].NeighbourIndices[0] == 0)
+
+    def testLargeNonManifold(self):
+        # enough facets to sort the edges on several threads
+        sphere = Mesh.createSphere(10.0, 120)
+        self.failUnless(sphere.CountFacets > 65536 / 3)
+        points, facets = sphere.Topology
+        triangles = [[points[i] for i in f] for f in facets]
+        p = points[facets[0][0]]
+        q = points[facets[0][1]]
+        for i in range(3):
+            triangles.append([p, q, p * 0.5 + q * 0.5 + FreeCAD.Vector(0, 0, 20 + i)])
+        mesh = self.checkBuilder(triangles)
+        self.failUnless(mesh.hasNonManifolds())
+
+
+class MeshVertexClusteringCases(unittest.TestCase):
+    def testSphere(self):
+        mesh = Mesh.createSphere(10.0, 100)
+        count = mesh.CountFacets
+        last = count
+        for size in (0.5, 1.0, 2.0, 4.0):
+            coarse = mesh.clusterVertices(size)
+            self.failUnless(coarse.CountFacets < last, "cell size %g" % size)
+            last = coarse.CountFacets
+            # every point moves by at most the diagonal of a cell
+            for p in coarse.Points:
+                self.failUnless(abs(p.Vector.Length - 10.0) < size * math.sqrt(3.0))
+            self.checkFacets(coarse)
+        self.failUnless(mesh.CountFacets == count)
+
+    def checkFacets(self, mesh):
+        points, facets = mesh.Topology
+        # neither degenerated nor duplicated facets
+        self.failUnless(len(set([tuple(sorted(f)) for f in facets])) == len(facets))
+        for f in facets:
+            self.failUnless(len(set(f)) == 3)
+            u = points[f[1]] - points[f[0]]
+            v = points[f[2]] - points[f[0]]
+            self.failUnless(u.cross(v).Length > 0.0)
+
+    def testEmptyMesh(self):
+        self.failUnless(Mesh.Mesh().clusterVertices(1.0).CountFacets == 0)
+        self.failUnlessRaises(ValueError, Mesh.createBox(1.0, 1.0, 1.0).clusterVertices, 0.0)
+
+
+class MeshParallelRecomputeCases(unittest.TestCase):
+    def setUp(self):
+        self.grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+        self.parallel = self.grp.GetBool("ParallelRecompute", False)
+        self.doc = FreeCAD.newDocument("MeshParallelRecompute")
+
+    def recompute(self, parallel):
+        self.grp.SetBool("ParallelRecompute", parallel)
+        for obj in self.sources:
+            obj.touch()
+        self.doc.RecomputeProfiling = True
+        self.doc.recompute()
+        stats = self.doc.getRecomputeStats()
+        self.doc.RecomputeProfiling = False
+        return [o.Mesh.Topology for o in self.results], stats
+
+    def testBranches(self):
+        # two independent branches that are joined by a boolean operation
+        self.sources = []
+        self.results = []
+        fixed = []
+        for i in range(2):
+            source = self.doc.addObject("Mesh::Feature", "Sphere%d" % i)
+            mesh = Mesh.createSphere(10.0, 60)
+            mesh.translate(5.0 * i, 0.0, 0.0)
+            source.Mesh = mesh
+            self.sources.append(source)
+            decimation = self.doc.addObject("Mesh::Decimation", "Decimation%d" % i)
+            decimation.Source = source
+            decimation.TargetSize = mesh.CountFacets / 2
+            self.results.append(decimation)
+            harmonize = self.doc.addObject("Mesh::HarmonizeNormals", "Harmonize%d" % i)
+            harmonize.Source = source
+            self.results.append(harmonize)
+            fixed.append(harmonize)
+        union = self.doc.addObject("Mesh::SetOperations", "Union")
+        union.Source1 = fixed[0]
+        union.Source2 = fixed[1]
+        union.OperationType = "union"
+        self.results.append(union)
+
+        serial, stats = self.recompute(False)
+        parallel, stats = self.recompute(True)
+        self.failUnless(len(stats) == 7)
+        for obj in self.results:
+            self.failUnless(obj.State == ["Up-to-date"])
+        # the branches give the same result as a serial recompute
+        self.failUnless(parallel == serial)
+        import multiprocessing
+        if multiprocessing.cpu_count() > 1:
+            self.failUnless(max([s["Thread"] for s in stats]) > 0)
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.doc.Name)
+        self.grp.SetBool("ParallelRecompute", self.parallel)
+
+
+class MeshSmoothingCases(unittest.TestCase):
+    def setUp(self):
+        # a sphere with radial noise of up to 2%
+        self.mesh = Mesh.createSphere(10.0, 60)
+        rand = random.Random(3)
+        for i, p in enumerate(self.mesh.Points):
+            self.mesh.setPoint(i, FreeCAD.Vector(p.Vector).multiply(1.0 + rand.uniform(-0.02, 0.02)))
+        self.volume = 4.0 / 3.0 * math.pi * 1000.0
+
+    def roughness(self, mesh):
+        # the mean distance of the points to the centre of their neighbours
+        points, facets = mesh.Topology
+        neighbours = [set() for p in points]
+        for f in facets:
+            for i in range(3):
+                neighbours[f[i]].update([f[(i + 1) % 3], f[(i + 2) % 3]])
+        dist = 0.0
+        for p, n in zip(points, neighbours):
+            centre = FreeCAD.Vector()
+            for j in n:
+                centre = centre + points[j]
+            dist += (centre.multiply(1.0 / len(n)) - p).Length
+        return dist / len(points)
+
+    def smooth(self, method):
+        parallel = self.mesh.copy()
+        parallel.smooth(Iteration=10, Method=method, Parallel=True)
+        serial = self.mesh.copy()
+        serial.smooth(Iteration=10, Method=method, Parallel=False)
+        # the points of one step don't depend on each other, so the results are identical
+        self.failUnless(parallel.Topology == serial.Topology)
+        self.failUnless(self.roughness(parallel) < 0.5 * self.roughness(self.mesh))
+        return parallel
+
+    def testLaplace(self):
+        mesh = self.smooth("Laplace")
+        # Laplace smoothing shrinks the sphere, but only a little
+        for p in mesh.Points:
+            self.failUnless(9.4 < p.Vector.Length < 10.2, p.Vector.Length)
+        self.failUnless(0.85 * self.volume < mesh.Volume < self.volume, mesh.Volume)
+
+    def testTaubin(self):
+        mesh = self.smooth("Taubin")
+        # Taubin smoothing nearly keeps the volume
+        for p in mesh.Points:
+            self.failUnless(9.7 < p.Vector.Length < 10.3, p.Vector.Length)
+        self.failUnless(abs(mesh.Volume / self.volume - 1.0) < 0.02, mesh.Volume)
+
+    def testInvalidMethod(self):
+        self.failUnlessRaises(ValueError, self.mesh.smooth, Method="Gauss")
@@ -63,6 +63,7 @@
 #include <bitset>
 #include <iostream>
 #include <iomanip>
+#include <iterator>
 #include <list>
 #include <map>
 #include <queue>
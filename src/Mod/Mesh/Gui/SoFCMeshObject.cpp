@@ -42,16 +42,24 @@
 # include <Inventor/actions/SoPickAction.h>
 # include <Inventor/actions/SoWriteAction.h>
 # include <Inventor/details/SoFaceDetail.h>
+# include <Inventor/elements/SoGLCacheContextElement.h>
+# include <Inventor/elements/SoModelMatrixElement.h>
+# include <Inventor/elements/SoViewportRegionElement.h>
+# include <Inventor/elements/SoViewVolumeElement.h>
 # include <Inventor/errors/SoReadError.h>
 # include <Inventor/misc/SoState.h>
 #endif
 
+#include <Inventor/elements/SoCacheElement.h>
+#include <Inventor/elements/SoGLDisplayList.h>
+
 #include "SoFCMeshObject.h"
 #include <Base/Console.h>
 #include <Base/Exception.h>
 #include <Gui/SoFCInteractiveElement.h>
 #include <Gui/SoFCSelectionAction.h>
 #include <Mod/Mesh/App/Core/Algorithm.h>
+#include <Mod/Mesh/App/Core/Decimation.h>
 #include <Mod/Mesh/App/Core/MeshIO.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Mesh/App/Core/Elements.h>
@@ -588,12 +596,36 @@ void SoFCMeshObjectShape::initClass()
     SO_NODE_INIT_CLASS(SoFCMeshObjectShape, SoShape, "Shape");
 }
 
-SoFCMeshObjectShape::SoFCMeshObjectShape() : renderTriangleLimit(100000), meshChanged(true)
+/**
+ * A coarser representation of the mesh together with its geometric error, i.e. the
+ * maximum distance a point has been moved, and the display list it is rendered with.
+ * While no display list can be compiled the vertex array is kept instead.
+ */
+struct SoFCMeshObjectShape::LevelOfDetail
+{
+    MeshCore::MeshPointArray points;
+    MeshCore::MeshFacetArray facets;
+    float error;
+    SoGLDisplayList* list;
+    SbBool needNormals;
+    SbBool ccw;
+    std::vector<float> array;
+    SbBool arrayNormals;
+    SbBool arrayCcw;
+};
+
+SoFCMeshObjectShape::SoFCMeshObjectShape()
+  : renderTriangleLimit(100000), lodPixelError(1.0f), meshChanged(true), lodMesh(0)
 {
     SO_NODE_CONSTRUCTOR(SoFCMeshObjectShape);
     setName(SoFCMeshObjectShape::getClassTypeId().getName());
 }
 
+SoFCMeshObjectShape::~SoFCMeshObjectShape()
+{
+    clearLevelsOfDetail(0);
+}
+
 void SoFCMeshObjectShape::notify(SoNotList * node)
 {
     inherited::notify(node);
@@ -630,7 +662,22 @@ void SoFCMeshObjectShape::GLRender(SoGLRenderAction *action)
         if (SoShapeHintsElement::getVertexOrdering(state) == SoShapeHintsElement::CLOCKWISE) 
             ccw = FALSE;
 
-        if (mode == false || mesh->countFacets() <= this->renderTriangleLimit) {
+        // The levels of detail don't support colors per face or vertex
+        LevelOfDetail* lod = 0;
+        if (mbind == OVERALL && mesh->countFacets() > this->renderTriangleLimit) {
+            if (this->meshChanged || this->lodMesh != mesh) {
+                clearLevelsOfDetail(state);
+                buildLevelsOfDetail(mesh);
+                this->lodMesh = mesh;
+                this->meshChanged = false;
+            }
+            lod = findLevelOfDetail(state, mesh, mode);
+        }
+
+        if (lod) {
+            drawLevelOfDetail(state, *lod, needNormals, ccw);
+        }
+        else if (mode == false || mesh->countFacets() <= this->renderTriangleLimit) {
             if (mbind != OVERALL)
                 drawFaces(mesh, &mb, mbind, needNormals, ccw);
             else
@@ -640,8 +687,9 @@ void SoFCMeshObjectShape::GLRender(SoGLRenderAction *action)
             drawPoints(mesh, needNormals, ccw);
         }
 
-        // Disable caching for this node
-        //SoGLCacheContextElement::shouldAutoCache(state, SoGLCacheContextElement::DONT_AUTO_CACHE);
+        // Disable caching for this node because the level depends on the view
+        if (!this->levels.empty())
+            SoGLCacheContextElement::shouldAutoCache(state, SoGLCacheContextElement::DONT_AUTO_CACHE);
     }
 }
 
@@ -842,6 +890,189 @@ void SoFCMeshObjectShape::drawPoints(const Mesh::MeshObject * mesh, SbBool needN
     }
 }
 
+/**
+ * Computes the levels of detail of the mesh by vertex clustering. Each level is
+ * created from the previous one with a doubled cell size until only a few
+ * triangles are left.
+ */
+void SoFCMeshObjectShape::buildLevelsOfDetail(const Mesh::MeshObject * mesh)
+{
+    const MeshCore::MeshKernel& kernel = mesh->getKernel();
+    const MeshCore::MeshPointArray& rPoints = kernel.GetPoints();
+    const MeshCore::MeshFacetArray& rFacets = kernel.GetFacets();
+    Base::BoundBox3f box = kernel.GetBoundBox();
+    float length = std::max<float>(box.LengthX(), std::max<float>(box.LengthY(), box.LengthZ()));
+    if (rFacets.empty() || length <= 0.0f)
+        return;
+
+    // start with twice the average edge length which roughly quarters the number of triangles
+    double sum = 0.0;
+    for (MeshCore::MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+        for (int i = 0; i < 3; i++)
+            sum += Base::Distance(rPoints[it->_aulPoints[i]], rPoints[it->_aulPoints[(i+1)%3]]);
+    }
+    float cellSize = (float)(2.0 * sum / (3.0 * rFacets.size()));
+    if (cellSize <= 0.0f)
+        return;
+
+    const unsigned long minFacets = 1000;
+    const MeshCore::MeshPointArray* points = &rPoints;
+    const MeshCore::MeshFacetArray* facets = &rFacets;
+    float error = 0.0f;
+    while (facets->size() > minFacets && cellSize < length) {
+        LevelOfDetail* lod = new LevelOfDetail();
+        MeshCore::MeshVertexClustering cluster(*points, *facets);
+        cluster.Simplify(cellSize, lod->points, lod->facets);
+
+        // a level that doesn't reduce the mesh significantly isn't worth it
+        if (lod->facets.empty() || 4 * lod->facets.size() > 3 * facets->size()) {
+            delete lod;
+        }
+        else {
+            // a point is moved by at most the diagonal of its cell
+            error += std::sqrt(3.0f) * cellSize;
+            lod->error = error;
+            lod->list = 0;
+            lod->needNormals = FALSE;
+            lod->ccw = TRUE;
+            lod->arrayNormals = FALSE;
+            lod->arrayCcw = TRUE;
+            this->levels.push_back(lod);
+            points = &lod->points;
+            facets = &lod->facets;
+        }
+
+        cellSize *= 2.0f;
+    }
+}
+
+void SoFCMeshObjectShape::clearLevelsOfDetail(SoState * state)
+{
+    for (std::vector<LevelOfDetail*>::iterator it = levels.begin(); it != levels.end(); ++it) {
+        if ((*it)->list)
+            (*it)->list->unref(state);
+        delete *it;
+    }
+    levels.clear();
+    lodMesh = 0;
+}
+
+/**
+ * Returns the coarsest level whose error on the screen is below \a lodPixelError pixels,
+ * or null if the mesh itself must be rendered. In interactive mode the level is coarsened
+ * further until it has no more than \a renderTriangleLimit triangles.
+ */
+SoFCMeshObjectShape::LevelOfDetail*
+SoFCMeshObjectShape::findLevelOfDetail(SoState * state, const Mesh::MeshObject * mesh,
+                                       SbBool interactive) const
+{
+    if (levels.empty())
+        return 0;
+
+    const SbViewVolume& vv = SoViewVolumeElement::get(state);
+    const SbViewportRegion& vp = SoViewportRegionElement::get(state);
+    const SbMatrix& mat = SoModelMatrixElement::get(state);
+
+    // take the point of the bounding box that is next to the eye
+    Base::BoundBox3f bbox = mesh->getKernel().GetBoundBox();
+    SbBox3f box(bbox.MinX, bbox.MinY, bbox.MinZ, bbox.MaxX, bbox.MaxY, bbox.MaxZ);
+    box.transform(mat);
+    SbVec3f eye = vv.getProjectionPoint();
+    SbVec3f pnt;
+    for (int i = 0; i < 3; i++)
+        pnt[i] = std::min<float>(std::max<float>(eye[i], box.getMin()[i]), box.getMax()[i]);
+
+    // size of a pixel in model coordinates
+    short height = std::max<short>(vp.getViewportSizePixels()[1], 1);
+    float pixel = vv.getWorldToScreenScale(pnt, 1.0f / height);
+    SbVec3f unit(1.0f, 0.0f, 0.0f);
+    mat.multDirMatrix(unit, unit);
+    if (unit.length() > 0.0f)
+        pixel /= unit.length();
+
+    int index = -1;
+    float maxError = this->lodPixelError * pixel;
+    for (std::size_t i = 0; i < levels.size() && levels[i]->error <= maxError; i++)
+        index = (int)i;
+
+    if (interactive) {
+        unsigned long count = index < 0 ? mesh->countFacets() : levels[index]->facets.size();
+        while (count > this->renderTriangleLimit && index + 1 < (int)levels.size()) {
+            index++;
+            count = levels[index]->facets.size();
+        }
+    }
+
+    return index < 0 ? 0 : levels[index];
+}
+
+/**
+ * Renders a level of detail with vertex arrays. If no render cache is open the arrays
+ * are compiled into a display list which is reused as long as the GL context and the
+ * parameters don't change. Otherwise the array is kept for the next call.
+ */
+void SoFCMeshObjectShape::drawLevelOfDetail(SoState * state, LevelOfDetail& lod,
+                                            SbBool needNormals, SbBool ccw) const
+{
+    if (lod.list && (lod.list->getContext() != SoGLCacheContextElement::get(state) ||
+                     lod.needNormals != needNormals || lod.ccw != ccw)) {
+        lod.list->unref(state);
+        lod.list = 0;
+    }
+
+    if (lod.list) {
+        lod.list->call(state);
+        return;
+    }
+
+    // interleaved array of normals and vertices
+    const MeshCore::MeshPointArray& rPoints = lod.points;
+    const MeshCore::MeshFacetArray& rFacets = lod.facets;
+    std::vector<float>& data = lod.array;
+    if (data.empty() || lod.arrayNormals != needNormals || lod.arrayCcw != ccw) {
+        int stride = needNormals ? 6 : 3;
+        data.resize(rFacets.size() * 3 * stride);
+        std::vector<float>::iterator jt = data.begin();
+        for (MeshCore::MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+            const MeshCore::MeshPoint& v0 = rPoints[it->_aulPoints[0]];
+            const MeshCore::MeshPoint& v1 = rPoints[it->_aulPoints[1]];
+            const MeshCore::MeshPoint& v2 = rPoints[it->_aulPoints[2]];
+            Base::Vector3f n = (v1 - v0) % (v2 - v0);
+            if (!ccw)
+                n = -n;
+            const MeshCore::MeshPoint* v[3] = { &v0, &v1, &v2 };
+            for (int i = 0; i < 3; i++) {
+                if (needNormals) {
+                    *jt++ = n.x; *jt++ = n.y; *jt++ = n.z;
+                }
+                *jt++ = v[i]->x; *jt++ = v[i]->y; *jt++ = v[i]->z;
+            }
+        }
+        lod.arrayNormals = needNormals;
+        lod.arrayCcw = ccw;
+    }
+
+    // a display list cannot be compiled while Coin is building a render cache
+    if (!SoCacheElement::anyOpen(state)) {
+        lod.list = new SoGLDisplayList(state, SoGLDisplayList::DISPLAY_LIST);
+        lod.list->ref();
+        lod.list->open(state);
+        lod.needNormals = needNormals;
+        lod.ccw = ccw;
+    }
+
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glInterleavedArrays(needNormals ? GL_N3F_V3F : GL_V3F, 0, &(data[0]));
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(rFacets.size() * 3));
+    glPopClientAttrib();
+
+    // the list is compiled and executed at once, then the array isn't needed anymore
+    if (lod.list) {
+        lod.list->close(state);
+        std::vector<float>().swap(data);
+    }
+}
+
 void SoFCMeshObjectShape::doAction(SoAction * action)
 {
     if (action->getTypeId() == Gui::SoGLSelectAction::getClassTypeId()) {
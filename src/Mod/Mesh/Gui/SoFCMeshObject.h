@@ -38,6 +38,8 @@ typedef unsigned int GLuint;
 typedef int GLint;
 typedef float GLfloat;
 
+class SoGLDisplayList;
+
 namespace MeshCore { class MeshFacetGrid; }
 
 namespace MeshGui {
@@ -152,6 +154,14 @@ protected:
  * The limit of maximum allowed triangles can be specified in \a renderTriangleLimit, the
  * default value is set to 100.000.
  *
+ * For meshes exceeding this limit a hierarchy of coarser levels is computed by vertex
+ * clustering the first time the mesh is rendered. Each level knows its geometric error
+ * and GLRender() uses the coarsest level whose error projected onto the screen is below
+ * \a lodPixelError pixels. In interactive mode levels with more than \a renderTriangleLimit
+ * triangles are skipped as well. The coarser levels are rendered with vertex arrays
+ * which are compiled into OpenGL display lists. The levels are rebuilt when the node
+ * gets touched.
+ *
  * The GLRender() method checks the status of the SoFCInteractiveElement to decide to be in
  * interactive mode or not.
  * To take advantage of this facility the client programmer must set the status of the
@@ -170,6 +180,7 @@ public:
     SoFCMeshObjectShape();
 
     unsigned int renderTriangleLimit;
+    float lodPixelError;
 
 protected:
     virtual void doAction(SoAction * action);
@@ -193,8 +204,10 @@ private:
     };
 
 private:
+    struct LevelOfDetail;
+
     // Force using the reference count mechanism.
-    virtual ~SoFCMeshObjectShape() {};
+    virtual ~SoFCMeshObjectShape();
     virtual void notify(SoNotList * list);
     Binding findMaterialBinding(SoState * const state) const;
     // Draw faces
@@ -203,12 +216,20 @@ private:
     void drawPoints(const Mesh::MeshObject *, SbBool needNormals, SbBool ccw) const;
     unsigned int countTriangles(SoAction * action) const;
 
+    // Level of detail
+    void buildLevelsOfDetail(const Mesh::MeshObject *);
+    void clearLevelsOfDetail(SoState * state);
+    LevelOfDetail* findLevelOfDetail(SoState * state, const Mesh::MeshObject *, SbBool interactive) const;
+    void drawLevelOfDetail(SoState * state, LevelOfDetail&, SbBool needNormals, SbBool ccw) const;
+
     void startSelection(SoAction * action, const Mesh::MeshObject*);
     void stopSelection(SoAction * action, const Mesh::MeshObject*);
     void renderSelectionGeometry(const Mesh::MeshObject*);
 
 private:
     bool meshChanged;
+    const Mesh::MeshObject* lodMesh;
+    std::vector<LevelOfDetail*> levels;
     GLuint *selectBuf;
     GLfloat modelview[16];
     GLfloat projection[16];
@@ -1469,8 +1469,9 @@ void ViewProviderMesh::faceInfo(unsigned long uFacet)
         MeshCore::MeshGeomFacet tria = rKernel.GetFacet(face);
         Base::Console().Message("Mesh: %s Facet %lu: Points: <%lu, %lu, %lu>, Neighbours: <%lu, %lu, %lu>\n"
             "Triangle: <[%.6f, %.6f, %.6f], [%.6f, %.6f, %.6f], [%.6f, %.6f, %.6f]>\n", fea->getNameInDocument(), uFacet, 
-            face._aulPoints[0], face._aulPoints[1], face._aulPoints[2], 
-            face._aulNeighbours[0], face._aulNeighbours[1], face._aulNeighbours[2],
+            (unsigned long)face._aulPoints[0], (unsigned long)face._aulPoints[1],
+            (unsigned long)face._aulPoints[2], (unsigned long)face._aulNeighbours[0],
+            (unsigned long)face._aulNeighbours[1], (unsigned long)face._aulNeighbours[2],
             tria._aclPoints[0].x, tria._aclPoints[0].y, tria._aclPoints[0].z,
             tria._aclPoints[1].x, tria._aclPoints[1].y, tria._aclPoints[1].z,
             tria._aclPoints[2].x, tria._aclPoints[2].y, tria._aclPoints[2].z);
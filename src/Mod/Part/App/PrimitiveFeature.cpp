@@ -100,6 +100,11 @@ short Primitive::mustExecute(void) const
     return Feature::mustExecute();
 }
 
+bool Primitive::isExecuteThreadSafe(void) const
+{
+    return true;
+}
+
 void Primitive::Restore(Base::XMLReader &reader)
 {
     reader.readElement("Properties");
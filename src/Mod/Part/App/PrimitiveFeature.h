@@ -43,6 +43,8 @@ public:
     /// recalculate the feature
     App::DocumentObjectExecReturn *execute(void) = 0;
     short mustExecute() const;
+    /// A primitive is built from its own properties only
+    bool isExecuteThreadSafe(void) const;
     //@}
 
 protected:
@@ -80,6 +80,7 @@ PropertyPartShape::~PropertyPartShape()
 
 void PropertyPartShape::setValue(const TopoShape& sh)
 {
+    loadDeferred();
     aboutToSetValue();
     _Shape = sh;
     hasSetValue();
@@ -87,6 +88,7 @@ void PropertyPartShape::setValue(const TopoShape& sh)
 
 void PropertyPartShape::setValue(const TopoDS_Shape& sh)
 {
+    loadDeferred();
     aboutToSetValue();
     _Shape._Shape = sh;
     hasSetValue();
@@ -94,21 +96,25 @@ void PropertyPartShape::setValue(const TopoDS_Shape& sh)
 
 const TopoDS_Shape& PropertyPartShape::getValue(void)const 
 {
+    loadDeferred();
     return _Shape._Shape;
 }
 
 const TopoShape& PropertyPartShape::getShape() const
 {
+    loadDeferred();
     return this->_Shape;
 }
 
 const Data::ComplexGeoData* PropertyPartShape::getComplexData() const
 {
+    loadDeferred();
     return &(this->_Shape);
 }
 
 Base::BoundBox3d PropertyPartShape::getBoundingBox() const
 {
+    loadDeferred();
     Base::BoundBox3d box;
     if (_Shape._Shape.IsNull())
         return box;
@@ -137,11 +143,13 @@ void PropertyPartShape::getFaces(std::vector<Base::Vector3d> &aPoints,
                                  std::vector<Data::ComplexGeoData::Facet> &aTopo,
                                  float accuracy, uint16_t flags) const
 {
+    loadDeferred();
     _Shape.getFaces(aPoints, aTopo, accuracy, flags);
 }
 
 void PropertyPartShape::transformGeometry(const Base::Matrix4D &rclTrf)
 {
+    loadDeferred();
     aboutToSetValue();
     _Shape.transformGeometry(rclTrf);
     hasSetValue();
@@ -149,6 +157,7 @@ void PropertyPartShape::transformGeometry(const Base::Matrix4D &rclTrf)
 
 PyObject *PropertyPartShape::getPyObject(void)
 {
+    loadDeferred();
     Base::PyObjectBase* prop;
     const TopoDS_Shape& sh = _Shape._Shape;
     if (sh.IsNull()) {
@@ -208,6 +217,7 @@ void PropertyPartShape::setPyObject(PyObject *value)
 
 App::Property *PropertyPartShape::Copy(void) const
 {
+    loadDeferred();
     PropertyPartShape *prop = new PropertyPartShape();
     prop->_Shape = this->_Shape;
     if (!_Shape._Shape.IsNull()) {
@@ -220,8 +230,11 @@ App::Property *PropertyPartShape::Copy(void) const
 
 void PropertyPartShape::Paste(const App::Property &from)
 {
+    loadDeferred();
+    const PropertyPartShape& prop = dynamic_cast<const PropertyPartShape&>(from);
+    prop.loadDeferred();
     aboutToSetValue();
-    _Shape = dynamic_cast<const PropertyPartShape&>(from)._Shape;
+    _Shape = prop._Shape;
     hasSetValue();
 }
 
@@ -274,6 +287,7 @@ void PropertyPartShape::Restore(Base::XMLReader &reader)
 
 void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
 {
+    loadDeferred();
     // If the shape is empty we simply store nothing. The file size will be 0 which
     // can be checked when reading in the data.
     if (_Shape._Shape.IsNull())
@@ -338,13 +352,47 @@ void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
     }
 }
 
+bool PropertyPartShape::isSaveDocFileThreadSafe (const Base::Writer &writer) const
+{
+    // the ASCII path goes through a static temporary file and thus
+    // must not run concurrently, the binary export only works on a copy
+    return writer.getMode("BinaryBrep");
+}
+
 void PropertyPartShape::RestoreDocFile(Base::Reader &reader)
+{
+    TopoDS_Shape shape;
+    loadFromStream(reader, shape);
+    _deferredFile = 0;
+    setValue(shape);
+}
+
+bool PropertyPartShape::deferRestoreDocFile(Base::DeferredFile* file)
+{
+    // Do not notify observers because they would access the data immediately.
+    // The transformation has already been restored from the XML part.
+    _deferredFile = file;
+    return true;
+}
+
+void PropertyPartShape::restoreDeferredDocFile(Base::Reader &reader)
+{
+    loadFromStream(reader, _Shape._Shape);
+}
+
+void PropertyPartShape::loadDeferred() const
+{
+    if (_deferredFile.isValid())
+        _deferredFile->restore(const_cast<PropertyPartShape*>(this));
+}
+
+void PropertyPartShape::loadFromStream(Base::Reader &reader, TopoDS_Shape& shape) const
 {
     Base::FileInfo brep(reader.getFileName());
     if (brep.hasExtension("bin")) {
-        TopoShape shape;
-        shape.importBinary(reader);
-        setValue(shape);
+        TopoShape topo;
+        topo.importBinary(reader);
+        shape = topo._Shape;
     }
     else {
         BRep_Builder builder;
@@ -365,7 +413,6 @@ void PropertyPartShape::RestoreDocFile(Base::Reader &reader)
 
         // Read the shape from the temp file, if the file is empty the stored shape was already empty.
         // If it's still empty after reading the (non-empty) file there must occurred an error.
-        TopoDS_Shape shape;
         if (ulSize > 0) {
             if (!BRepTools::Read(shape, (const Standard_CString)fi.filePath().c_str(), builder)) {
                 // Note: Do NOT throw an exception here because if the tmp. created file could
@@ -386,8 +433,6 @@ void PropertyPartShape::RestoreDocFile(Base::Reader &reader)
 
         // delete the temp file
         fi.deleteFile();
-
-        setValue(shape);
     }
 }
 
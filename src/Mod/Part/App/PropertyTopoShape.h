@@ -31,6 +31,10 @@
 #include <map>
 #include <vector>
 
+namespace Base {
+class DeferredFile;
+}
+
 namespace Part
 {
 
@@ -85,7 +89,10 @@ public:
     void Restore(Base::XMLReader &reader);
 
     void SaveDocFile (Base::Writer &writer) const;
+    bool isSaveDocFileThreadSafe (const Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    bool deferRestoreDocFile(Base::DeferredFile* file);
+    void restoreDeferredDocFile(Base::Reader &reader);
 
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
@@ -95,8 +102,14 @@ public:
     /// Get valid paths for this property; used by auto completer
     virtual void getPaths(std::vector<App::ObjectIdentifier> & paths) const;
 
+private:
+    /// reads in the shape if its restore has been deferred
+    void loadDeferred() const;
+    void loadFromStream(Base::Reader &reader, TopoDS_Shape& shape) const;
+
 private:
     TopoShape _Shape;
+    Base::Reference<Base::DeferredFile> _deferredFile;
 };
 
 struct PartExport ShapeHistory {
@@ -139,6 +152,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
 
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
 
     virtual Property *Copy(void) const;
@@ -192,6 +206,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
 
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
 
     virtual Property *Copy(void) const;
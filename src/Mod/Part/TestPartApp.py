@@ -40,3 +40,39 @@ class PartTestCases(unittest.TestCase):
 		#closing doc
 		FreeCAD.closeDocument("PartTest")
 		#print ("omit clos document for debuging")
+
+class PartParallelRecomputeCases(unittest.TestCase):
+	def setUp(self):
+		self.grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+		self.parallel = self.grp.GetBool("ParallelRecompute", False)
+		self.grp.SetBool("ParallelRecompute", True)
+		self.Doc = FreeCAD.newDocument("PartParallelTest")
+
+	def testPrimitives(self):
+		# independent primitives are built on the worker threads
+		boxes = []
+		cylinders = []
+		for i in range(8):
+			box = self.Doc.addObject("Part::Box","Box%d" % i)
+			box.Length = 1.0 + i
+			boxes.append(box)
+			cyl = self.Doc.addObject("Part::Cylinder","Cylinder%d" % i)
+			cyl.Radius = 1.0 + i
+			cylinders.append(cyl)
+		self.Doc.RecomputeProfiling = True
+		self.Doc.recompute()
+		stats = self.Doc.getRecomputeStats()
+		self.Doc.RecomputeProfiling = False
+		self.failUnless(len(stats) == 16)
+		for i in range(8):
+			self.failUnless(boxes[i].State == ["Up-to-date"])
+			self.failUnless(abs(boxes[i].Shape.Volume - (1.0 + i) * 100.0) < 1e-6)
+			self.failUnless(cylinders[i].State == ["Up-to-date"])
+			self.failUnless(len(cylinders[i].Shape.Faces) == 3)
+		import multiprocessing
+		if multiprocessing.cpu_count() > 1:
+			self.failUnless(max([s["Thread"] for s in stats]) > 0)
+
+	def tearDown(self):
+		FreeCAD.closeDocument("PartParallelTest")
+		self.grp.SetBool("ParallelRecompute", self.parallel)
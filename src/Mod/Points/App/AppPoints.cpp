@@ -31,9 +31,11 @@
 
 #include "Points.h"
 #include "PointsPy.h"
+#include "KdTreePy.h"
 #include "Properties.h"
 #include "PropertyPointKernel.h"
 #include "FeaturePointsImportAscii.h"
+#include "FeaturePointsFilter.h"
 
 
 /* registration table  */
@@ -51,6 +53,7 @@ void PointsExport initPoints()
 
     // add python types
     Base::Interpreter().addType(&Points::PointsPy  ::Type,pointsModule,"Points");
+    Base::Interpreter().addType(&Points::KdTreePy  ::Type,pointsModule,"KdTree");
 
     // add properties
     Points::PropertyGreyValue     ::init();
@@ -64,6 +67,12 @@ void PointsExport initPoints()
     Points::FeaturePython         ::init();
     Points::Export                ::init();
     Points::ImportAscii           ::init();
+    Points::Filter                ::init();
+    Points::VoxelGrid             ::init();
+    Points::RandomSample          ::init();
+    Points::PoissonSample         ::init();
+    Points::StatisticalOutlierRemoval::init();
+    Points::RadiusOutlierRemoval  ::init();
 }
 
 } // extern "C"
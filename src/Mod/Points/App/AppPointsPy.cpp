@@ -33,21 +33,59 @@
 #include <App/Document.h>
 #include <App/DocumentObject.h>
 #include <App/Property.h>
-
-// PCL test
-#ifdef HAVE_PCL_IO
-#  include <iostream>
-#  include <pcl/io/ply_io.h>
-#  include <pcl/point_types.h>
-#endif
+#include <App/PropertyStandard.h>
 
 #include "Points.h"
 #include "PointsPy.h"
 #include "PointsAlgos.h"
+#include "PointsIO.h"
+#include "Properties.h"
 #include "FeaturePointsImportAscii.h"
 
 using namespace Points;
 
+static bool isPointsFile(const Base::FileInfo& file)
+{
+    return file.hasExtension("asc") || file.hasExtension("xyz") ||
+           file.hasExtension("csv") || file.hasExtension("pts") ||
+           file.hasExtension("ply") || file.hasExtension("pcd");
+}
+
+static void importPoints(App::Document* pcDoc, const std::string& EncodedName, const Base::FileInfo& file)
+{
+    Points::PointKernel pkTemp;
+    std::vector<float> greyValues;
+    std::vector<Base::Vector3f> normals;
+    std::vector<App::Color> colors;
+    Points::PointsInput input(pkTemp, &greyValues, &normals, &colors);
+    if (!input.LoadAny(EncodedName.c_str()))
+        throw Base::FileException("Reading in points failed", EncodedName.c_str());
+
+    // only the Python feature can hold the additional properties
+    bool extra = !greyValues.empty() || !normals.empty() || !colors.empty();
+    Points::Feature *pcFeature = static_cast<Points::Feature *>(pcDoc->addObject(
+        extra ? "Points::FeaturePython" : "Points::Feature", file.fileNamePure().c_str()));
+    if (!greyValues.empty()) {
+        Points::PropertyGreyValueList* prop = static_cast<Points::PropertyGreyValueList*>
+            (pcFeature->addDynamicProperty("Points::PropertyGreyValueList", "Intensity"));
+        if (prop)
+            prop->setValues(greyValues);
+    }
+    if (!normals.empty()) {
+        Points::PropertyNormalList* prop = static_cast<Points::PropertyNormalList*>
+            (pcFeature->addDynamicProperty("Points::PropertyNormalList", "Normal"));
+        if (prop)
+            prop->setValues(normals);
+    }
+    if (!colors.empty()) {
+        App::PropertyColorList* prop = static_cast<App::PropertyColorList*>
+            (pcFeature->addDynamicProperty("App::PropertyColorList", "Color"));
+        if (prop)
+            prop->setValues(colors);
+    }
+    pcFeature->Points.setValue(pkTemp);
+}
+
 /* module functions */
 static PyObject *
 open(PyObject *self, PyObject *args)
@@ -66,31 +104,11 @@ open(PyObject *self, PyObject *args)
         if (file.extension() == "")
             Py_Error(Base::BaseExceptionFreeCADError,"no file ending");
 
-        if (file.hasExtension("asc")) {
+        if (isPointsFile(file)) {
             // create new document and add Import feature
             App::Document *pcDoc = App::GetApplication().newDocument("Unnamed");
-            Points::Feature *pcFeature = (Points::Feature *)pcDoc->addObject("Points::Feature", file.fileNamePure().c_str());
-            Points::PointKernel pkTemp;
-            pkTemp.load(EncodedName.c_str());
-            pcFeature->Points.setValue( pkTemp );
-
+            importPoints(pcDoc, EncodedName, file);
         }
-#ifdef HAVE_PCL_IO
-        else if (file.hasExtension("ply")) {
-            // create new document import
-            App::Document *pcDoc = App::GetApplication().newDocument("Unnamed");
-            Points::Feature *pcFeature = (Points::Feature *)pcDoc->addObject("Points::Feature", file.fileNamePure().c_str());
-            Points::PointKernel pkTemp;
-
-            // pcl test
-            pcl::PointCloud<pcl::PointXYZ> cloud_in;
-            pcl::io::loadPLYFile<pcl::PointXYZ>(EncodedName.c_str(),cloud_in); 
-
-            for (pcl::PointCloud<pcl::PointXYZ>::const_iterator it = cloud_in.begin();it!=cloud_in.end();++it)
-                pkTemp.push_back(Base::Vector3d(it->x,it->y,it->z));
-            pcFeature->Points.setValue( pkTemp );
-        }
-#endif
         else {
             Py_Error(Base::BaseExceptionFreeCADError,"unknown file ending");
         }
@@ -117,37 +135,15 @@ insert(PyObject *self, PyObject *args)
         if (file.extension() == "")
             Py_Error(Base::BaseExceptionFreeCADError,"no file ending");
 
-        if (file.hasExtension("asc")) {
+        if (isPointsFile(file)) {
             // add Import feature
             App::Document *pcDoc = App::GetApplication().getDocument(DocName);
             if (!pcDoc) {
                 pcDoc = App::GetApplication().newDocument(DocName);
             }
 
-            Points::Feature *pcFeature = (Points::Feature *)pcDoc->addObject("Points::Feature", file.fileNamePure().c_str());
-            Points::PointKernel pkTemp;
-            pkTemp.load(EncodedName.c_str());
-            pcFeature->Points.setValue( pkTemp );
+            importPoints(pcDoc, EncodedName, file);
         }
-#ifdef HAVE_PCL_IO
-        else if (file.hasExtension("ply")) {
-            App::Document *pcDoc = App::GetApplication().getDocument(DocName);
-            if (!pcDoc) {
-                pcDoc = App::GetApplication().newDocument(DocName);
-            }
-
-            Points::Feature *pcFeature = (Points::Feature *)pcDoc->addObject("Points::Feature", file.fileNamePure().c_str());
-            Points::PointKernel pkTemp;
-
-            // pcl test
-            pcl::PointCloud<pcl::PointXYZRGB> cloud_in;
-            pcl::io::loadPLYFile<pcl::PointXYZRGB>(EncodedName.c_str(),cloud_in); 
-
-            for (pcl::PointCloud<pcl::PointXYZRGB>::const_iterator it = cloud_in.begin();it!=cloud_in.end();++it)
-                pkTemp.push_back(Base::Vector3d(it->x,it->y,it->z));
-            pcFeature->Points.setValue( pkTemp );
-        }
-#endif
         else {
             Py_Error(Base::BaseExceptionFreeCADError,"unknown file ending");
         }
@@ -0,0 +1,235 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <climits>
+# include <cfloat>
+# include <map>
+#endif
+
+#include <Base/Exception.h>
+
+#include "FeaturePointsFilter.h"
+#include "PointsFilter.h"
+
+
+namespace Points {
+    const App::PropertyIntegerConstraint::Constraints intCount = {0,INT_MAX,1};
+    const App::PropertyIntegerConstraint::Constraints intNeighbours = {1,INT_MAX,1};
+    const App::PropertyFloatConstraint::Constraints floatLength = {1.0e-6,FLT_MAX,0.1};
+    const App::PropertyFloatConstraint::Constraints floatFactor = {0.0,100.0,0.1};
+}
+
+using namespace Points;
+
+PROPERTY_SOURCE_ABSTRACT(Points::Filter, Points::Feature)
+
+Filter::Filter(void)
+{
+    ADD_PROPERTY(Source,(0));
+    ADD_PROPERTY_TYPE(Intensity,(0.0f),"Attributes",(App::PropertyType)
+        (App::Prop_Output|App::Prop_ReadOnly),"Grey values of the kept points");
+    ADD_PROPERTY_TYPE(Normal,(Base::Vector3f()),"Attributes",(App::PropertyType)
+        (App::Prop_Output|App::Prop_ReadOnly),"Normals of the kept points");
+    ADD_PROPERTY_TYPE(Color,(App::Color()),"Attributes",(App::PropertyType)
+        (App::Prop_Output|App::Prop_ReadOnly),"Colors of the kept points");
+    Intensity.setSize(0);
+    Normal.setSize(0);
+    Color.setSize(0);
+}
+
+short Filter::mustExecute() const
+{
+    if (Source.isTouched())
+        return 1;
+    return 0;
+}
+
+bool Filter::isExecuteThreadSafe(void) const
+{
+    return true;
+}
+
+App::DocumentObjectExecReturn *Filter::execute(void)
+{
+    Points::Feature* source = dynamic_cast<Points::Feature*>(Source.getValue());
+    if (!source)
+        return new App::DocumentObjectExecReturn("Source is not a points object");
+
+    const PointKernel& points = source->Points.getValue();
+    std::vector<unsigned long> indices;
+    filter(points, indices);
+
+    // the attributes are found by their type like the view provider does
+    const PropertyGreyValueList* grey = 0;
+    const PropertyNormalList* normal = 0;
+    const App::PropertyColorList* color = 0;
+    std::map<std::string,App::Property*> Map;
+    source->getPropertyMap(Map);
+    for (std::map<std::string,App::Property*>::iterator it = Map.begin(); it != Map.end(); ++it) {
+        Base::Type t = it->second->getTypeId();
+        if (!grey && t == PropertyGreyValueList::getClassTypeId())
+            grey = static_cast<PropertyGreyValueList*>(it->second);
+        else if (!normal && t == PropertyNormalList::getClassTypeId())
+            normal = static_cast<PropertyNormalList*>(it->second);
+        else if (!color && t == App::PropertyColorList::getClassTypeId())
+            color = static_cast<App::PropertyColorList*>(it->second);
+    }
+
+    int size = (int)points.size();
+    std::vector<float> greyValues;
+    if (grey && grey->getSize() == size)
+        PointsFilter::Extract(grey->getValues(), indices, greyValues);
+    std::vector<Base::Vector3f> normals;
+    if (normal && normal->getSize() == size)
+        PointsFilter::Extract(normal->getValues(), indices, normals);
+    std::vector<App::Color> colors;
+    if (color && color->getSize() == size)
+        PointsFilter::Extract(color->getValues(), indices, colors);
+
+    PointKernel kernel;
+    PointsFilter::Extract(points, indices, kernel);
+    Intensity.setValues(greyValues);
+    Normal.setValues(normals);
+    Color.setValues(colors);
+    Points.setValue(kernel);
+
+    return App::DocumentObject::StdReturn;
+}
+
+// ------------------------------------------------------------------
+
+PROPERTY_SOURCE(Points::VoxelGrid, Points::Filter)
+
+VoxelGrid::VoxelGrid(void)
+{
+    ADD_PROPERTY(VoxelSize,(1.0));
+    VoxelSize.setConstraints(&floatLength);
+}
+
+short VoxelGrid::mustExecute() const
+{
+    if (VoxelSize.isTouched())
+        return 1;
+    return Filter::mustExecute();
+}
+
+void VoxelGrid::filter(const PointKernel& points, std::vector<unsigned long>& indices) const
+{
+    PointsFilter(points).VoxelGrid(VoxelSize.getValue(), indices);
+}
+
+// ------------------------------------------------------------------
+
+PROPERTY_SOURCE(Points::RandomSample, Points::Filter)
+
+RandomSample::RandomSample(void)
+{
+    ADD_PROPERTY(Count,(100000));
+    ADD_PROPERTY(Seed,(0));
+    Count.setConstraints(&intCount);
+}
+
+short RandomSample::mustExecute() const
+{
+    if (Count.isTouched() || Seed.isTouched())
+        return 1;
+    return Filter::mustExecute();
+}
+
+void RandomSample::filter(const PointKernel& points, std::vector<unsigned long>& indices) const
+{
+    PointsFilter(points).RandomSample(Count.getValue(), Seed.getValue(), indices);
+}
+
+// ------------------------------------------------------------------
+
+PROPERTY_SOURCE(Points::PoissonSample, Points::Filter)
+
+PoissonSample::PoissonSample(void)
+{
+    ADD_PROPERTY(Radius,(1.0));
+    ADD_PROPERTY(Seed,(0));
+    Radius.setConstraints(&floatLength);
+}
+
+short PoissonSample::mustExecute() const
+{
+    if (Radius.isTouched() || Seed.isTouched())
+        return 1;
+    return Filter::mustExecute();
+}
+
+void PoissonSample::filter(const PointKernel& points, std::vector<unsigned long>& indices) const
+{
+    PointsFilter(points).PoissonSample(Radius.getValue(), Seed.getValue(), indices);
+}
+
+// ------------------------------------------------------------------
+
+PROPERTY_SOURCE(Points::StatisticalOutlierRemoval, Points::Filter)
+
+StatisticalOutlierRemoval::StatisticalOutlierRemoval(void)
+{
+    ADD_PROPERTY(Neighbours,(8));
+    ADD_PROPERTY(StdDevFactor,(1.0));
+    Neighbours.setConstraints(&intNeighbours);
+    StdDevFactor.setConstraints(&floatFactor);
+}
+
+short StatisticalOutlierRemoval::mustExecute() const
+{
+    if (Neighbours.isTouched() || StdDevFactor.isTouched())
+        return 1;
+    return Filter::mustExecute();
+}
+
+void StatisticalOutlierRemoval::filter(const PointKernel& points, std::vector<unsigned long>& indices) const
+{
+    PointsFilter(points).StatisticalOutlierRemoval(Neighbours.getValue(), StdDevFactor.getValue(), indices);
+}
+
+// ------------------------------------------------------------------
+
+PROPERTY_SOURCE(Points::RadiusOutlierRemoval, Points::Filter)
+
+RadiusOutlierRemoval::RadiusOutlierRemoval(void)
+{
+    ADD_PROPERTY(Radius,(1.0));
+    ADD_PROPERTY(MinNeighbours,(2));
+    Radius.setConstraints(&floatLength);
+    MinNeighbours.setConstraints(&intCount);
+}
+
+short RadiusOutlierRemoval::mustExecute() const
+{
+    if (Radius.isTouched() || MinNeighbours.isTouched())
+        return 1;
+    return Filter::mustExecute();
+}
+
+void RadiusOutlierRemoval::filter(const PointKernel& points, std::vector<unsigned long>& indices) const
+{
+    PointsFilter(points).RadiusOutlierRemoval(Radius.getValue(), MinNeighbours.getValue(), indices);
+}
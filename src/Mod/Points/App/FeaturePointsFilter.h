@@ -0,0 +1,166 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef FEATURE_POINTS_FILTER_H
+#define FEATURE_POINTS_FILTER_H
+
+#include <vector>
+
+#include "PointsFeature.h"
+#include "Properties.h"
+
+#include <App/PropertyStandard.h>
+#include <App/PropertyLinks.h>
+
+
+namespace Points
+{
+
+/**
+ * The Filter class is the base of the features that reduce the points of a
+ * source feature. If the source has grey values, normals or colors for all
+ * of its points they are reduced the same way.
+ */
+class Filter : public Points::Feature
+{
+  PROPERTY_HEADER(Points::Filter);
+
+public:
+  Filter();
+
+  App::PropertyLink        Source;
+  PropertyGreyValueList    Intensity;
+  PropertyNormalList       Normal;
+  App::PropertyColorList   Color;
+
+  /** @name methods override Feature */
+  //@{
+  /// recalculate the Feature
+  App::DocumentObjectExecReturn *execute(void);
+  short mustExecute() const;
+  /// The filters only read the source and may run in a parallel recompute
+  bool isExecuteThreadSafe(void) const;
+  //@}
+
+protected:
+  /// Determines the indices of the points to keep in ascending order
+  virtual void filter(const PointKernel&, std::vector<unsigned long>&) const = 0;
+};
+
+/**
+ * Keeps one point of each voxel, see PointsFilter::VoxelGrid().
+ */
+class VoxelGrid : public Points::Filter
+{
+  PROPERTY_HEADER(Points::VoxelGrid);
+
+public:
+  VoxelGrid();
+
+  App::PropertyFloatConstraint VoxelSize;
+
+  short mustExecute() const;
+
+protected:
+  void filter(const PointKernel&, std::vector<unsigned long>&) const;
+};
+
+/**
+ * Keeps a given number of random points, see PointsFilter::RandomSample().
+ */
+class RandomSample : public Points::Filter
+{
+  PROPERTY_HEADER(Points::RandomSample);
+
+public:
+  RandomSample();
+
+  App::PropertyIntegerConstraint Count;
+  App::PropertyInteger Seed;
+
+  short mustExecute() const;
+
+protected:
+  void filter(const PointKernel&, std::vector<unsigned long>&) const;
+};
+
+/**
+ * Keeps random points with a minimum distance, see PointsFilter::PoissonSample().
+ */
+class PoissonSample : public Points::Filter
+{
+  PROPERTY_HEADER(Points::PoissonSample);
+
+public:
+  PoissonSample();
+
+  App::PropertyFloatConstraint Radius;
+  App::PropertyInteger Seed;
+
+  short mustExecute() const;
+
+protected:
+  void filter(const PointKernel&, std::vector<unsigned long>&) const;
+};
+
+/**
+ * Removes points far away from their neighbours, see PointsFilter::StatisticalOutlierRemoval().
+ */
+class StatisticalOutlierRemoval : public Points::Filter
+{
+  PROPERTY_HEADER(Points::StatisticalOutlierRemoval);
+
+public:
+  StatisticalOutlierRemoval();
+
+  App::PropertyIntegerConstraint Neighbours;
+  App::PropertyFloatConstraint StdDevFactor;
+
+  short mustExecute() const;
+
+protected:
+  void filter(const PointKernel&, std::vector<unsigned long>&) const;
+};
+
+/**
+ * Removes points with too few neighbours, see PointsFilter::RadiusOutlierRemoval().
+ */
+class RadiusOutlierRemoval : public Points::Filter
+{
+  PROPERTY_HEADER(Points::RadiusOutlierRemoval);
+
+public:
+  RadiusOutlierRemoval();
+
+  App::PropertyFloatConstraint Radius;
+  App::PropertyIntegerConstraint MinNeighbours;
+
+  short mustExecute() const;
+
+protected:
+  void filter(const PointKernel&, std::vector<unsigned long>&) const;
+};
+
+}
+
+#endif // FEATURE_POINTS_FILTER_H
@@ -41,11 +41,20 @@ PROPERTY_SOURCE(Points::ImportAscii, Points::Feature)
 ImportAscii::ImportAscii(void)
 {
   ADD_PROPERTY(FileName,(""));
+  ADD_PROPERTY(Columns,(0));
+  ADD_PROPERTY(Separator,(""));
+  ADD_PROPERTY(SkipLines,(0));
+  std::vector<long> columns;
+  columns.push_back(0);
+  columns.push_back(1);
+  columns.push_back(2);
+  Columns.setValues(columns);
 }
 
 short ImportAscii::mustExecute() const
 {
-    if (FileName.isTouched())
+    if (FileName.isTouched() || Columns.isTouched() ||
+        Separator.isTouched() || SkipLines.isTouched())
         return 1;
     return 0;
 }
@@ -61,7 +70,25 @@ App::DocumentObjectExecReturn *ImportAscii::execute(void)
     }
 
     PointKernel kernel;
-    PointsAlgos::Load(kernel,FileName.getValue());
+    if (fi.hasExtension("asc") || fi.hasExtension("xyz") ||
+        fi.hasExtension("csv") || fi.hasExtension("pts")) {
+        const std::vector<long>& columns = Columns.getValues();
+        if (columns.size() != 3 || columns[0] < 0 || columns[1] < 0 || columns[2] < 0)
+            return new App::DocumentObjectExecReturn("Three non-negative columns are needed for x, y and z");
+        if (SkipLines.getValue() < 0)
+            return new App::DocumentObjectExecReturn("The number of skipped lines must not be negative");
+
+        AsciiFormat format;
+        format.x = (int)columns[0];
+        format.y = (int)columns[1];
+        format.z = (int)columns[2];
+        format.separator = Separator.getStrValue().empty() ? 0 : Separator.getStrValue()[0];
+        format.skipLines = SkipLines.getValue();
+        PointsAlgos::LoadAscii(kernel,FileName.getValue(),format);
+    }
+    else {
+        PointsAlgos::Load(kernel,FileName.getValue());
+    }
     Points.setValue(kernel);
 
     return App::DocumentObject::StdReturn;
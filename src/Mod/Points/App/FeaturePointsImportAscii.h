@@ -45,6 +45,12 @@ public:
   ImportAscii();
 
   App::PropertyString FileName;
+  /// The columns of x, y and z, starting with 0
+  App::PropertyIntegerList Columns;
+  /// The column separator, if empty white spaces, commas and semicolons separate the columns
+  App::PropertyString Separator;
+  /// The number of lines at the beginning of the file that are skipped
+  App::PropertyInteger SkipLines;
 
   /** @name methods overide Feature */
   //@{
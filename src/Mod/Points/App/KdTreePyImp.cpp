@@ -0,0 +1,169 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <climits>
+# include <sstream>
+#endif
+
+#include "Mod/Points/App/Points.h"
+#include "Mod/Points/App/PointsPy.h"
+#include <Base/VectorPy.h>
+#include <Base/GeometryPyCXX.h>
+
+// inclusion of the generated files (generated out of KdTreePy.xml)
+#include "KdTreePy.h"
+#include "KdTreePy.cpp"
+
+using namespace Points;
+
+// returns a string which represents the object e.g. when printed in python
+std::string KdTreePy::representation(void) const
+{
+    std::stringstream str;
+    str << "<KdTree object with " << getPointsKdTreePtr()->CountPoints() << " points>";
+    return str.str();
+}
+
+PyObject *KdTreePy::PyMake(struct _typeobject *, PyObject *, PyObject *)  // Python wrapper
+{
+    // create a new instance of KdTreePy and the Twin object 
+    return new KdTreePy(new PointsKdTree);
+}
+
+// constructor method
+int KdTreePy::PyInit(PyObject* args, PyObject* /*kwd*/)
+{
+    PyObject *pcObj;
+    if (!PyArg_ParseTuple(args, "O!", &(PointsPy::Type), &pcObj))
+        return -1;
+
+    try {
+        // the tree copies the points, so it doesn't depend on the kernel afterwards
+        PointsKdTree* tree = getPointsKdTreePtr();
+        tree->Attach(*static_cast<PointsPy*>(pcObj)->getPointKernelPtr());
+        tree->Detach();
+    }
+    catch (const Base::Exception& e) {
+        PyErr_SetString(Base::BaseExceptionFreeCADError, e.what());
+        return -1;
+    }
+
+    return 0;
+}
+
+PyObject* KdTreePy::searchNearest(const PointsKdTree& tree, PyObject * args)
+{
+    PyObject *obj;
+    int k = 1;
+    if (!PyArg_ParseTuple(args, "O|i", &obj, &k))
+        return 0;
+    if (k < 1) {
+        PyErr_SetString(PyExc_ValueError, "number of nearest points must be positive");
+        return 0;
+    }
+
+    // a vector or a tuple of three numbers is a single point
+    bool single = PyObject_TypeCheck(obj, &(Base::VectorPy::Type)) != 0;
+    if (!single && PyTuple_Check(obj) && PyTuple_Size(obj) == 3)
+        single = PyNumber_Check(PyTuple_GetItem(obj, 0)) != 0;
+
+    PY_TRY {
+        std::vector<Base::Vector3d> points;
+        if (single) {
+            points.push_back(Py::Vector(obj, false).toVector());
+        }
+        else {
+            Py::Sequence list(obj);
+            points.reserve(list.size());
+            for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it)
+                points.push_back(Py::Vector(*it).toVector());
+        }
+
+        std::vector<unsigned long> indices;
+        std::vector<double> distances;
+        tree.SearchNearest(points, (unsigned long)k, indices, distances);
+
+        Py::List result;
+        for (std::size_t i = 0; i < points.size(); i++) {
+            Py::List neighbours;
+            for (std::size_t j = i * k; j < (i + 1) * k && indices[j] != ULONG_MAX; j++) {
+                Py::Tuple item(2);
+                item.setItem(0, Py::Int((long)indices[j]));
+                item.setItem(1, Py::Float(distances[j]));
+                neighbours.append(item);
+            }
+            if (single)
+                return Py::new_reference_to(neighbours);
+            result.append(neighbours);
+        }
+
+        return Py::new_reference_to(result);
+    } PY_CATCH;
+}
+
+PyObject* KdTreePy::searchRadius(const PointsKdTree& tree, PyObject * args)
+{
+    PyObject *obj;
+    double radius;
+    if (!PyArg_ParseTuple(args, "Od", &obj, &radius))
+        return 0;
+
+    PY_TRY {
+        Base::Vector3d point = Py::Vector(obj, false).toVector();
+        std::vector<unsigned long> indices;
+        tree.SearchRadius(point, radius, indices);
+
+        Py::List result;
+        for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it)
+            result.append(Py::Int((long)*it));
+        return Py::new_reference_to(result);
+    } PY_CATCH;
+}
+
+PyObject* KdTreePy::nearestPoints(PyObject * args)
+{
+    return searchNearest(*getPointsKdTreePtr(), args);
+}
+
+PyObject* KdTreePy::pointsInRadius(PyObject * args)
+{
+    return searchRadius(*getPointsKdTreePtr(), args);
+}
+
+Py::Int KdTreePy::getCountPoints(void) const
+{
+    return Py::Int((long)getPointsKdTreePtr()->CountPoints());
+}
+
+PyObject *KdTreePy::getCustomAttributes(const char* /*attr*/) const
+{
+    return 0;
+}
+
+int KdTreePy::setCustomAttributes(const char* /*attr*/, PyObject* /*obj*/)
+{
+    return 0; 
+}
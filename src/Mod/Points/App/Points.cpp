@@ -28,6 +28,7 @@
 #endif
 
 #include <Base/Exception.h>
+#include <Base/FileInfo.h>
 #include <Base/Matrix.h>
 #include <Base/Persistence.h>
 #include <Base/Stream.h>
@@ -35,6 +36,7 @@
 
 #include "Points.h"
 #include "PointsAlgos.h"
+#include "PointsIO.h"
 #include "PointsPy.h"
 
 using namespace Points;
@@ -149,7 +151,15 @@ void PointKernel::RestoreDocFile(Base::Reader &reader)
 
 void PointKernel::save(const char* file) const
 {
-    Base::ofstream out(file, std::ios::out);
+    Base::FileInfo fi(file);
+    if (fi.hasExtension("ply") || fi.hasExtension("pcd")) {
+        PointsOutput output(*this);
+        if (!output.SaveAny(file))
+            throw Base::FileException("Writing points failed", file);
+        return;
+    }
+
+    Base::ofstream out(fi, std::ios::out);
     save(out);
 }
 
@@ -26,11 +26,17 @@
 #ifdef FC_OS_LINUX
 # include <unistd.h>
 #endif
+# include <algorithm>
+# include <cmath>
+# include <cstring>
 # include <sstream>
 #endif
 
+#include <QThread>
+#include <QtConcurrentMap>
 
 #include "PointsAlgos.h"
+#include "PointsIO.h"
 #include "Points.h"
 
 #include <Base/Exception.h>
@@ -39,10 +45,308 @@
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
 
-#include <boost/regex.hpp>
-
 using namespace Points;
 
+AsciiFormat::AsciiFormat()
+  : separator(0), skipLines(0), x(0), y(1), z(2), intensity(-1)
+  , nx(-1), ny(-1), nz(-1), r(-1), g(-1), b(-1), colorMax(255.0f)
+{
+}
+
+namespace Points {
+
+/**
+ * The AsciiReader parses blocks of an ASCII point cloud file. A block is split
+ * at line ends into ranges that are parsed in parallel. At first the lines of
+ * every range are counted to get the position of its first point, then the
+ * points of all ranges are written directly into the resized arrays and at last
+ * the gaps of skipped lines are closed.
+ */
+class AsciiReader
+{
+public:
+    struct Range
+    {
+        const char* begin;
+        const char* end;
+        unsigned long lines;
+        unsigned long offset;
+        unsigned long valid;
+        const AsciiReader* reader;
+    };
+
+    AsciiReader(const AsciiFormat& format, std::vector<Base::Vector3f>& points,
+                std::vector<float>* greyValues, std::vector<Base::Vector3f>* normals,
+                std::vector<App::Color>* colors)
+      : format(format), points(points)
+      , greyValues(format.hasIntensity() ? greyValues : 0)
+      , normals(format.hasNormals() ? normals : 0)
+      , colors(format.hasColors() ? colors : 0)
+    {
+        UseColumn(format.x);
+        UseColumn(format.y);
+        UseColumn(format.z);
+        if (this->greyValues)
+            UseColumn(format.intensity);
+        if (this->normals) {
+            UseColumn(format.nx);
+            UseColumn(format.ny);
+            UseColumn(format.nz);
+        }
+        if (this->colors) {
+            UseColumn(format.r);
+            UseColumn(format.g);
+            UseColumn(format.b);
+        }
+    }
+
+    unsigned long ReadBlock(const char* begin, const char* end)
+    {
+        // a range of about 1 MB keeps all threads busy
+        const std::size_t rangeSize = 1 << 20;
+        std::vector<Range> ranges;
+        while (begin < end) {
+            const char* next = end;
+            if ((std::size_t)(end - begin) > rangeSize) {
+                next = static_cast<const char*>(memchr(begin + rangeSize, '\n', end - begin - rangeSize));
+                next = next ? next + 1 : end;
+            }
+            Range r;
+            r.begin = begin;
+            r.end = next;
+            r.lines = 0;
+            r.offset = 0;
+            r.valid = 0;
+            r.reader = this;
+            ranges.push_back(r);
+            begin = next;
+        }
+
+        bool parallel = ranges.size() > 1 && QThread::idealThreadCount() > 1;
+        if (parallel)
+            QtConcurrent::blockingMap(ranges, &AsciiReader::CountLines);
+        else
+            std::for_each(ranges.begin(), ranges.end(), &AsciiReader::CountLines);
+
+        unsigned long base = points.size();
+        unsigned long count = base;
+        for (std::vector<Range>::iterator it = ranges.begin(); it != ranges.end(); ++it) {
+            it->offset = count;
+            count += it->lines;
+        }
+        Resize(count);
+
+        if (parallel)
+            QtConcurrent::blockingMap(ranges, &AsciiReader::ParseLines);
+        else
+            std::for_each(ranges.begin(), ranges.end(), &AsciiReader::ParseLines);
+
+        // close the gaps of comments and other lines that are no points
+        count = base;
+        for (std::vector<Range>::iterator it = ranges.begin(); it != ranges.end(); ++it) {
+            if (it->offset != count)
+                Move(it->offset, it->valid, count);
+            count += it->valid;
+        }
+        Resize(count);
+        return count - base;
+    }
+
+    bool ParseLine(const char* p, const char* e, double* values) const
+    {
+        char sep = format.separator;
+        int numColumns = (int)used.size();
+        for (int col = 0; col < numColumns; col++) {
+            if (sep && col > 0) {
+                while (p < e && *p != sep)
+                    ++p;
+                if (p == e)
+                    return false;
+                ++p;
+            }
+            while (p < e && IsSeparator(*p, sep))
+                ++p;
+            if (used[col]) {
+                if (!ParseNumber(p, e, values[col]))
+                    return false;
+                if (p < e && !IsSeparator(*p, sep) && *p != sep)
+                    return false;
+            }
+            else if (!sep) {
+                while (p < e && !IsSeparator(*p, sep))
+                    ++p;
+            }
+        }
+        return true;
+    }
+
+    /** Parses a floating point number and moves \a p behind it. Returns false if there
+     * is no number at \a p. */
+    static bool ParseNumber(const char*& p, const char* e, double& value)
+    {
+        static const double powersOfTen[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        const char* s = p;
+        bool negative = false;
+        if (s < e && (*s == '-' || *s == '+')) {
+            negative = (*s == '-');
+            ++s;
+        }
+
+        // the first 19 significant digits fit into the mantissa, the others only
+        // change the exponent
+        uint64_t mantissa = 0;
+        int significant = 0, exponent = 0, digits = 0;
+        for (; s < e && *s >= '0' && *s <= '9'; ++s, ++digits) {
+            if (significant < 19) {
+                mantissa = 10 * mantissa + (*s - '0');
+                if (mantissa)
+                    significant++;
+            }
+            else {
+                exponent++;
+            }
+        }
+        if (s < e && *s == '.') {
+            for (++s; s < e && *s >= '0' && *s <= '9'; ++s, ++digits) {
+                if (significant < 19) {
+                    mantissa = 10 * mantissa + (*s - '0');
+                    if (mantissa)
+                        significant++;
+                    exponent--;
+                }
+            }
+        }
+        if (digits == 0)
+            return false;
+
+        if (s < e && (*s == 'e' || *s == 'E')) {
+            const char* t = s + 1;
+            bool negativeExp = false;
+            if (t < e && (*t == '-' || *t == '+')) {
+                negativeExp = (*t == '-');
+                ++t;
+            }
+            if (t < e && *t >= '0' && *t <= '9') {
+                int exp = 0;
+                for (; t < e && *t >= '0' && *t <= '9'; ++t) {
+                    if (exp < 10000)
+                        exp = 10 * exp + (*t - '0');
+                }
+                exponent += negativeExp ? -exp : exp;
+                s = t;
+            }
+        }
+
+        value = (double)mantissa;
+        if (mantissa != 0 && exponent != 0) {
+            if (exponent > 0 && exponent <= 22)
+                value *= powersOfTen[exponent];
+            else if (exponent < 0 && exponent >= -22)
+                value /= powersOfTen[-exponent];
+            else
+                value *= std::pow(10.0, exponent);
+        }
+        if (negative)
+            value = -value;
+        p = s;
+        return true;
+    }
+
+    /** With the default separator all white spaces, commas and semicolons separate
+     * the columns. Otherwise white spaces are only skipped around the separator. */
+    static bool IsSeparator(char c, char sep)
+    {
+        if (c == ' ' || c == '\t' || c == '\r')
+            return true;
+        return !sep && (c == ',' || c == ';');
+    }
+
+private:
+    void UseColumn(int col)
+    {
+        if (col < 0)
+            throw Base::Exception("Column of a coordinate is not set");
+        if (col >= (int)used.size())
+            used.resize(col + 1, false);
+        used[col] = true;
+    }
+
+    static void CountLines(Range& range)
+    {
+        range.lines = std::count(range.begin, range.end, '\n');
+        if (range.end > range.begin && range.end[-1] != '\n')
+            range.lines++;
+    }
+
+    static void ParseLines(Range& range)
+    {
+        const AsciiReader* reader = range.reader;
+        const AsciiFormat& format = reader->format;
+        std::vector<double> values(reader->used.size());
+        unsigned long index = range.offset;
+
+        const char* p = range.begin;
+        while (p < range.end) {
+            const char* eol = static_cast<const char*>(memchr(p, '\n', range.end - p));
+            if (!eol)
+                eol = range.end;
+            if (reader->ParseLine(p, eol, &values[0])) {
+                reader->points[index].Set((float)values[format.x], (float)values[format.y],
+                                          (float)values[format.z]);
+                if (reader->greyValues)
+                    (*reader->greyValues)[index] = (float)values[format.intensity];
+                if (reader->normals)
+                    (*reader->normals)[index].Set((float)values[format.nx], (float)values[format.ny],
+                                                  (float)values[format.nz]);
+                if (reader->colors)
+                    (*reader->colors)[index].set((float)values[format.r] / format.colorMax,
+                                                 (float)values[format.g] / format.colorMax,
+                                                 (float)values[format.b] / format.colorMax);
+                index++;
+            }
+            p = eol + 1;
+        }
+
+        range.valid = index - range.offset;
+    }
+
+    void Resize(unsigned long count)
+    {
+        points.resize(count);
+        if (greyValues)
+            greyValues->resize(count);
+        if (normals)
+            normals->resize(count);
+        if (colors)
+            colors->resize(count);
+    }
+
+    void Move(unsigned long first, unsigned long count, unsigned long dest)
+    {
+        std::copy(points.begin() + first, points.begin() + first + count, points.begin() + dest);
+        if (greyValues)
+            std::copy(greyValues->begin() + first, greyValues->begin() + first + count, greyValues->begin() + dest);
+        if (normals)
+            std::copy(normals->begin() + first, normals->begin() + first + count, normals->begin() + dest);
+        if (colors)
+            std::copy(colors->begin() + first, colors->begin() + first + count, colors->begin() + dest);
+    }
+
+public:
+    const AsciiFormat& format;
+    std::vector<Base::Vector3f>& points;
+    std::vector<float>* greyValues;
+    std::vector<Base::Vector3f>* normals;
+    std::vector<App::Color>* colors;
+    std::vector<bool> used;
+};
+
+}
+
 void PointsAlgos::Load(PointKernel &points, const char *FileName)
 {
     Base::FileInfo File(FileName);
@@ -51,63 +355,231 @@ void PointsAlgos::Load(PointKernel &points, const char *FileName)
     if (!File.isReadable())
         throw Base::FileException("File to load not existing or not readable", FileName);
 
-    if (File.extension() == "asc" ||File.extension() == "ASC")
+    if (File.hasExtension("asc") || File.hasExtension("xyz") ||
+        File.hasExtension("csv") || File.hasExtension("pts")) {
         LoadAscii(points,FileName);
-    else
+    }
+    else if (File.hasExtension("ply") || File.hasExtension("pcd")) {
+        PointsInput input(points);
+        if (!input.LoadAny(FileName))
+            throw Base::FileException("Reading in points failed", FileName);
+    }
+    else {
         throw Base::Exception("Unknown ending");
+    }
 }
 
 void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
 {
-    boost::regex rx("^\\s*([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    //boost::regex rx("(\\b[0-9]+\\.([0-9]+\\b)?|\\.[0-9]+\\b)");
-    //boost::regex rx("^\\s*(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s*$");
-    boost::cmatch what;
-
-    Base::Vector3d pt;
-    int LineCnt=0;
-    std::string line;
+    LoadAscii(points, FileName, AsciiFormat());
+}
+
+void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName, const AsciiFormat& format,
+                            std::vector<float>* greyValues,
+                            std::vector<Base::Vector3f>* normals,
+                            std::vector<App::Color>* colors)
+{
     Base::FileInfo fi(FileName);
+    Base::ifstream file(fi, std::ios::in | std::ios::binary);
+    if (!file)
+        throw Base::FileException("File to load not existing or not readable", FileName);
 
-    Base::ifstream tmp_str(fi, std::ios::in);
+    std::vector<Base::Vector3f>& pts = points.getBasicPoints();
+    pts.clear();
+    if (greyValues)
+        greyValues->clear();
+    if (normals)
+        normals->clear();
+    if (colors)
+        colors->clear();
 
-    // estimating size
-    while (std::getline(tmp_str,line))
-        LineCnt++;
+    // the file is read in blocks, the incomplete line at the end of a block is
+    // moved to the beginning of the next block
+    const std::size_t blockSize = 32 << 20;
+    file.seekg(0, std::ios::end);
+    std::size_t fileSize = (std::size_t)file.tellg();
+    file.seekg(0, std::ios::beg);
 
-    // resize the PointKernel
-    points.resize(LineCnt);
+    Base::SequencerLauncher seq("Loading points...", fileSize / blockSize + 1);
 
-    Base::SequencerLauncher seq( "Loading points...", LineCnt );
+    try {
+        AsciiReader reader(format, pts, greyValues, normals, colors);
+        std::vector<char> buffer(blockSize);
+        std::size_t carry = 0;
+        int skipLines = format.skipLines;
+        bool first = true;
+        bool eof = false;
+        while (!eof) {
+            // a single line doesn't fit into the block
+            if (carry == buffer.size())
+                buffer.resize(2 * buffer.size());
+            file.read(&buffer[carry], buffer.size() - carry);
+            std::size_t size = carry + file.gcount();
+            eof = !file;
 
-    // again to the beginning
-    Base::ifstream file(fi, std::ios::in);
-    LineCnt = 0;
+            const char* begin = &buffer[0];
+            const char* end = begin + size;
+            const char* last = end;
+            if (!eof) {
+                while (last > begin && last[-1] != '\n')
+                    --last;
+                if (last == begin) {
+                    carry = size;
+                    continue;
+                }
+            }
 
-    try {
-        // read file
-        while (std::getline(file, line)) {
-            if (boost::regex_match(line.c_str(), what, rx)) {
-                pt.x = std::atof(what[1].first);
-                pt.y = std::atof(what[4].first);
-                pt.z = std::atof(what[7].first);
-
-                points.setPoint(LineCnt,pt);
-                seq.next();
-                LineCnt++;
+            while (skipLines > 0 && begin < last) {
+                const char* eol = static_cast<const char*>(memchr(begin, '\n', last - begin));
+                begin = eol ? eol + 1 : last;
+                skipLines--;
+            }
+
+            unsigned long count = reader.ReadBlock(begin, last);
+
+            // estimate the number of points of the whole file by the first block
+            if (first && !eof) {
+                std::size_t capacity = (std::size_t)((double)count * fileSize / (last - &buffer[0]) * 1.05);
+                pts.reserve(capacity);
+                if (reader.greyValues)
+                    greyValues->reserve(capacity);
+                if (reader.normals)
+                    normals->reserve(capacity);
+                if (reader.colors)
+                    colors->reserve(capacity);
             }
+            first = false;
+
+            carry = end - last;
+            if (carry > 0)
+                memmove(&buffer[0], last, carry);
+            seq.next();
         }
     }
+    catch (const Base::Exception&) {
+        points.clear();
+        throw;
+    }
     catch (...) {
         points.clear();
         throw Base::Exception("Reading in points failed.");
     }
 
-    // now remove the last points from the kernel
-    // Note: first we allocate memory corresponding to the number of lines (points and comments)
-    //       and read in the file twice. But then the size of the kernel is too high
-    if (LineCnt < (int)points.size())
-        points.erase(LineCnt, points.size());
+    if (greyValues && format.hasIntensity())
+        NormalizeGreyValues(*greyValues);
+}
+
+void PointsAlgos::NormalizeGreyValues(std::vector<float>& greyValues)
+{
+    // the grey values are used as colors and must be in the range [0,1]
+    if (greyValues.empty())
+        return;
+    float minValue = greyValues.front();
+    float maxValue = greyValues.front();
+    for (std::vector<float>::iterator it = greyValues.begin(); it != greyValues.end(); ++it) {
+        minValue = std::min<float>(minValue, *it);
+        maxValue = std::max<float>(maxValue, *it);
+    }
+    if (minValue < 0.0f || maxValue > 1.0f) {
+        float scale = maxValue > minValue ? 1.0f / (maxValue - minValue) : 0.0f;
+        for (std::vector<float>::iterator it = greyValues.begin(); it != greyValues.end(); ++it)
+            *it = (*it - minValue) * scale;
+    }
+}
+
+/** Three columns are colors if they only have integers in [0,255] and not only 0 and 1,
+ * \a colorMax is then 255. They are colors with \a colorMax 1 if they only have values
+ * in [0,1] and not all non-zero triples have unit length, as they would as normals.
+ */
+static bool IsColorColumn(const std::vector<std::vector<double> >& lines, int col, float& colorMax)
+{
+    bool integer = true;
+    bool greaterOne = false;
+    bool unitLength = true;
+    for (std::vector<std::vector<double> >::const_iterator it = lines.begin(); it != lines.end(); ++it) {
+        double len = 0.0;
+        for (int i = col; i < col + 3; i++) {
+            double v = (*it)[i];
+            if (v < 0.0 || v > 255.0)
+                return false;
+            if (v != std::floor(v))
+                integer = false;
+            if (v > 1.0)
+                greaterOne = true;
+            len += v * v;
+        }
+        if (len > 0.0 && std::fabs(std::sqrt(len) - 1.0) > 0.01)
+            unitLength = false;
+    }
+
+    if (greaterOne) {
+        colorMax = 255.0f;
+        return integer;
+    }
+    colorMax = 1.0f;
+    return !unitLength;
+}
+
+AsciiFormat PointsAlgos::GuessAsciiFormat(const char *FileName)
+{
+    AsciiFormat format;
+
+    Base::FileInfo fi(FileName);
+    Base::ifstream file(fi, std::ios::in | std::ios::binary);
+    if (!file)
+        throw Base::FileException("File to load not existing or not readable", FileName);
+
+    // take the lines with the same number of columns as the first line with a point
+    const int maxColumns = 16;
+    const int maxLines = 100;
+    std::vector<std::vector<double> > lines;
+    std::string line;
+    int numColumns = 0;
+    for (int i = 0; i < 10 * maxLines && lines.size() < (std::size_t)maxLines && std::getline(file, line); i++) {
+        std::vector<double> values;
+        const char* p = line.c_str();
+        const char* e = p + line.size();
+        while (p < e && AsciiReader::IsSeparator(*p, 0))
+            ++p;
+        while (p < e && (int)values.size() < maxColumns) {
+            double value;
+            if (!AsciiReader::ParseNumber(p, e, value) || (p < e && !AsciiReader::IsSeparator(*p, 0)))
+                break;
+            values.push_back(value);
+            while (p < e && AsciiReader::IsSeparator(*p, 0))
+                ++p;
+        }
+        if (p < e || values.size() < 3)
+            continue;
+        if (numColumns == 0)
+            numColumns = (int)values.size();
+        if ((int)values.size() == numColumns)
+            lines.push_back(values);
+    }
+
+    int col = 3;
+    if (numColumns == 4 || numColumns == 7 || numColumns == 10)
+        format.intensity = col++;
+    if (numColumns - col == 3 || numColumns - col == 6) {
+        bool color = IsColorColumn(lines, col, format.colorMax);
+        if (color) {
+            format.r = col; format.g = col + 1; format.b = col + 2;
+        }
+        else {
+            format.nx = col; format.ny = col + 1; format.nz = col + 2;
+        }
+        col += 3;
+        if (numColumns - col == 3) {
+            if (!color) {
+                if (IsColorColumn(lines, col, format.colorMax)) {
+                    format.r = col; format.g = col + 1; format.b = col + 2;
+                }
+            }
+            else {
+                format.nx = col; format.ny = col + 1; format.nz = col + 2;
+            }
+        }
+    }
+
+    return format;
 }
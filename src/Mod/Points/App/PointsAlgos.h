@@ -24,11 +24,48 @@
 #ifndef _PointsAlgos_h_
 #define _PointsAlgos_h_
 
+#include <vector>
+
 #include "Points.h"
+#include <App/Material.h>
 
 namespace Points
 {
 
+/** The AsciiFormat class describes the columns of an ASCII point cloud file.
+ * Every line of the file holds one point, the column indices start with 0 and
+ * a negative index means that the field doesn't exist. Lines that don't have
+ * a number in each of the used columns, e.g. comments, are skipped.
+ */
+struct PointsExport AsciiFormat
+{
+  /// Construction, the default format has x, y and z in the first three columns
+  AsciiFormat();
+
+  /** The column separator. If it is 0 white spaces, commas and semicolons separate
+   * the columns and subsequent separators count as one. */
+  char separator;
+  /// The number of lines at the beginning of the file that are skipped
+  int skipLines;
+  /// The columns of the coordinates
+  int x, y, z;
+  /// The column of the intensity, the grey values are scaled to [0,1] if they exceed this range
+  int intensity;
+  /// The columns of the normal
+  int nx, ny, nz;
+  /// The columns of the color
+  int r, g, b;
+  /// The value of the color components that corresponds to full intensity
+  float colorMax;
+
+  bool hasIntensity() const
+  { return intensity >= 0; }
+  bool hasNormals() const
+  { return nx >= 0 && ny >= 0 && nz >= 0; }
+  bool hasColors() const
+  { return r >= 0 && g >= 0 && b >= 0; }
+};
+
 /** The Points algorithms container class
  */
 class PointsExport PointsAlgos
@@ -40,10 +77,30 @@ public:
   /** Load a point cloud
    */
   static void LoadAscii(PointKernel&, const char *FileName);
+  /** Loads the point cloud of an ASCII file with the columns described by \a format.
+   * The file is read in large blocks whose lines are parsed in parallel directly
+   * into the point kernel. If the format has an intensity, normal or color and the
+   * corresponding pointer is set, the values are stored in this list.
+   */
+  static void LoadAscii(PointKernel&, const char *FileName, const AsciiFormat& format,
+                        std::vector<float>* greyValues = 0,
+                        std::vector<Base::Vector3f>* normals = 0,
+                        std::vector<App::Color>* colors = 0);
+  /** Guesses the format of an ASCII point cloud file by the number of columns and the
+   * values of its first lines. Files with 4, 7 or 10 columns are expected to have the
+   * intensity in the fourth column. Three further columns are taken as colors if
+   * they are integers in the range [0,255] and not only 0 and 1, or if they are in the
+   * range [0,1] and not of unit length, otherwise as normals. With six further columns
+   * the other three are the normals or colors respectively.
+   */
+  static AsciiFormat GuessAsciiFormat(const char *FileName);
+  /** Scales the grey values to the range [0,1] if they exceed it.
+   */
+  static void NormalizeGreyValues(std::vector<float>&);
 
 };
 
 } // namespace Points
 
 
-#endif 
+#endif
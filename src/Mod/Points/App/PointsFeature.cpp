@@ -25,6 +25,7 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <map>
 #endif
 #include <vector>
 
@@ -32,9 +33,12 @@
 #include <Base/Exception.h>
 #include <Base/Stream.h>
 #include <Base/Writer.h>
+#include <App/PropertyStandard.h>
 
 
 #include "PointsFeature.h"
+#include "PointsIO.h"
+#include "Properties.h"
 
 using namespace Points;
 
@@ -125,6 +129,61 @@ App::DocumentObjectExecReturn *Export::execute(void)
         str << it->x << " " << it->y << " " << it->z << std::endl;
     }
   }
+  else if (fi.hasExtension("ply") || fi.hasExtension("pcd"))
+  {
+    // an attribute is only written if all sources have it
+    PointKernel kernel;
+    std::vector<float> greyValues;
+    std::vector<Base::Vector3f> normals;
+    std::vector<App::Color> colors;
+    bool hasGreyValues = true, hasNormals = true, hasColors = true;
+
+    const std::vector<App::DocumentObject*>& features = Sources.getValues();
+    for ( std::vector<App::DocumentObject*>::const_iterator it = features.begin(); it != features.end(); ++it )
+    {
+      Feature *pcFeat  = dynamic_cast<Feature*>(*it);
+      if (!pcFeat)
+        continue;
+      const PointKernel& points = pcFeat->Points.getValue();
+      for ( PointKernel::const_iterator jt = points.begin(); jt != points.end(); ++jt )
+        kernel.push_back(*jt);
+
+      const PropertyGreyValueList* grey = 0;
+      const PropertyNormalList* normal = 0;
+      const App::PropertyColorList* color = 0;
+      std::map<std::string,App::Property*> Map;
+      pcFeat->getPropertyMap(Map);
+      for ( std::map<std::string,App::Property*>::iterator jt = Map.begin(); jt != Map.end(); ++jt )
+      {
+        Base::Type t = jt->second->getTypeId();
+        if (!grey && t == PropertyGreyValueList::getClassTypeId())
+          grey = static_cast<PropertyGreyValueList*>(jt->second);
+        else if (!normal && t == PropertyNormalList::getClassTypeId())
+          normal = static_cast<PropertyNormalList*>(jt->second);
+        else if (!color && t == App::PropertyColorList::getClassTypeId())
+          color = static_cast<App::PropertyColorList*>(jt->second);
+      }
+
+      int size = (int)points.size();
+      hasGreyValues = hasGreyValues && grey && grey->getSize() == size;
+      if (hasGreyValues)
+        greyValues.insert(greyValues.end(), grey->getValues().begin(), grey->getValues().end());
+      hasNormals = hasNormals && normal && normal->getSize() == size;
+      if (hasNormals)
+        normals.insert(normals.end(), normal->getValues().begin(), normal->getValues().end());
+      hasColors = hasColors && color && color->getSize() == size;
+      if (hasColors)
+        colors.insert(colors.end(), color->getValues().begin(), color->getValues().end());
+    }
+
+    PointsOutput output(kernel, hasGreyValues ? &greyValues : 0,
+                        hasNormals ? &normals : 0, hasColors ? &colors : 0);
+    bool ok = fi.hasExtension("ply")
+        ? output.SaveBinaryPLY(str)
+        : output.SaveBinaryPCD(str, std::string(Format.getValue()) == "binary_compressed");
+    if (!ok)
+      return new App::DocumentObjectExecReturn("Writing points failed");
+  }
   else
   {
       return new App::DocumentObjectExecReturn("File format not supported");
@@ -88,7 +88,7 @@ public:
 
     App::PropertyLinkList   Sources;
     App::PropertyString FileName;
-    App::PropertyString Format;
+    App::PropertyString Format; /**< "binary_compressed" compresses the data of PCD files */
 
     /** @name methods override Feature */
     //@{
@@ -0,0 +1,574 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cfloat>
+# include <cmath>
+#endif
+
+#include <QThread>
+#include <QtConcurrentMap>
+#include <boost/random/linear_congruential.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+#include <Base/Exception.h>
+#include <Base/BoundBox.h>
+
+#include "PointsFilter.h"
+#include "PointsKdTree.h"
+
+using namespace Points;
+
+namespace {
+  // the number of points handled by one task
+  const unsigned long BlockSize = 65536;
+  // the number of points handled by one task of the neighbour searches
+  const unsigned long SearchBlockSize = 4096;
+  // the number of cells handled by one task of the Poisson sampling
+  const unsigned long CellBlockSize = 1024;
+  // the number of bits per axis of a cell key
+  const int CellBits = 21;
+  const uint64_t CellMask = (uint64_t(1) << CellBits) - 1;
+
+  template <class T>
+  void runRanges (std::vector<T> &raclRanges, void (*pfnFunc)(T&), bool bParallel)
+  {
+    if (bParallel && raclRanges.size() > 1 && QThread::idealThreadCount() > 1)
+      QtConcurrent::blockingMap(raclRanges, pfnFunc);
+    else
+      std::for_each(raclRanges.begin(), raclRanges.end(), pfnFunc);
+  }
+
+  /** A regular grid of cubes over the bounding box of the points. A cell is identified by
+   * a key holding its coordinates with CellBits bits per axis. */
+  struct CellGrid
+  {
+    Base::Vector3d clOrigin;
+    double fSize;
+
+    uint64_t Key (const Base::Vector3d &rclPt) const
+    {
+      uint64_t x = (uint64_t)((rclPt.x - clOrigin.x) / fSize);
+      uint64_t y = (uint64_t)((rclPt.y - clOrigin.y) / fSize);
+      uint64_t z = (uint64_t)((rclPt.z - clOrigin.z) / fSize);
+      return (x << (2 * CellBits)) | (y << CellBits) | z;
+    }
+  };
+
+  inline uint64_t cellCoord (uint64_t ulKey, int iAxis)
+  {
+    return (ulKey >> ((2 - iAxis) * CellBits)) & CellMask;
+  }
+
+  /** The key of the cell of a point and the index of the point. */
+  struct CellPoint
+  {
+    uint64_t ulKey;
+    unsigned long ulIndex;
+
+    bool operator < (const CellPoint &rclP) const
+    {
+      return ulKey < rclP.ulKey || (ulKey == rclP.ulKey && ulIndex < rclP.ulIndex);
+    }
+  };
+
+  struct BoxRange
+  {
+    const Points::PointKernel* pclPoints;
+    unsigned long ulBegin, ulEnd;
+    Base::BoundBox3d clBox;
+  };
+
+  void computeBox (BoxRange &rclRange)
+  {
+    for (unsigned long i = rclRange.ulBegin; i < rclRange.ulEnd; i++)
+      rclRange.clBox.Add(rclRange.pclPoints->getPoint(i));
+  }
+
+  /** A run of points to sort or two adjacent sorted runs to merge. */
+  struct SortRange
+  {
+    const Points::PointKernel* pclPoints;
+    const CellGrid* pclGrid;
+    CellPoint* pclCells;
+    unsigned long ulBegin, ulMiddle, ulEnd;
+  };
+
+  void sortCells (SortRange &rclRange)
+  {
+    for (unsigned long i = rclRange.ulBegin; i < rclRange.ulEnd; i++) {
+      rclRange.pclCells[i].ulKey = rclRange.pclGrid->Key(rclRange.pclPoints->getPoint(i));
+      rclRange.pclCells[i].ulIndex = i;
+    }
+    std::sort(rclRange.pclCells + rclRange.ulBegin, rclRange.pclCells + rclRange.ulEnd);
+  }
+
+  void mergeCells (SortRange &rclRange)
+  {
+    std::inplace_merge(rclRange.pclCells + rclRange.ulBegin,
+                       rclRange.pclCells + rclRange.ulMiddle,
+                       rclRange.pclCells + rclRange.ulEnd);
+  }
+
+  /** Sorts the points by the cells of a grid with the cell size \a fSize. Each thread sorts
+   * a run of points, afterwards the runs are merged pairwise. */
+  void sortIntoCells (const Points::PointKernel &rclPoints, double fSize, bool bParallel,
+                      CellGrid &rclGrid, std::vector<CellPoint> &raclCells)
+  {
+    unsigned long ulCtPoints = rclPoints.size();
+    std::vector<BoxRange> aclBoxes;
+    for (unsigned long i = 0; i < ulCtPoints; i += BlockSize) {
+      BoxRange r;
+      r.pclPoints = &rclPoints;
+      r.ulBegin = i;
+      r.ulEnd = std::min<unsigned long>(i + BlockSize, ulCtPoints);
+      aclBoxes.push_back(r);
+    }
+    runRanges(aclBoxes, &computeBox, bParallel);
+
+    Base::BoundBox3d clBox;
+    for (std::vector<BoxRange>::iterator it = aclBoxes.begin(); it != aclBoxes.end(); ++it)
+      clBox.Add(it->clBox);
+
+    // the coordinates of the neighbours of the last cell must fit into a key as well
+    double fLength = std::max(clBox.LengthX(), std::max(clBox.LengthY(), clBox.LengthZ()));
+    if (fLength / fSize >= (double)(CellMask - 1))
+      throw Base::ValueError("The cell size is too small for the extent of the points");
+    rclGrid.clOrigin.Set(clBox.MinX, clBox.MinY, clBox.MinZ);
+    rclGrid.fSize = fSize;
+
+    raclCells.resize(ulCtPoints);
+    int iThreads = bParallel ? std::max<int>(QThread::idealThreadCount(), 1) : 1;
+    unsigned long ulRun = std::max<unsigned long>(BlockSize, ulCtPoints / iThreads + 1);
+    std::vector<SortRange> aclRanges;
+    std::vector<unsigned long> aulBounds;
+    for (unsigned long i = 0; i < ulCtPoints; i += ulRun) {
+      SortRange r;
+      r.pclPoints = &rclPoints;
+      r.pclGrid = &rclGrid;
+      r.pclCells = &(raclCells[0]);
+      r.ulBegin = r.ulMiddle = i;
+      r.ulEnd = std::min<unsigned long>(i + ulRun, ulCtPoints);
+      aclRanges.push_back(r);
+      aulBounds.push_back(i);
+    }
+    aulBounds.push_back(ulCtPoints);
+    runRanges(aclRanges, &sortCells, bParallel);
+
+    while (aulBounds.size() > 2) {
+      std::vector<unsigned long> aulNext;
+      aclRanges.clear();
+      std::size_t j = 0;
+      for (; j + 2 < aulBounds.size(); j += 2) {
+        SortRange r;
+        r.pclPoints = &rclPoints;
+        r.pclGrid = &rclGrid;
+        r.pclCells = &(raclCells[0]);
+        r.ulBegin = aulBounds[j];
+        r.ulMiddle = aulBounds[j + 1];
+        r.ulEnd = aulBounds[j + 2];
+        aclRanges.push_back(r);
+        aulNext.push_back(aulBounds[j]);
+      }
+      // a run without partner is merged in the next pass
+      for (; j < aulBounds.size(); j++)
+        aulNext.push_back(aulBounds[j]);
+      runRanges(aclRanges, &mergeCells, bParallel);
+      aulBounds.swap(aulNext);
+    }
+  }
+
+  struct VoxelRange
+  {
+    const Points::PointKernel* pclPoints;
+    const CellPoint* pclCells;
+    unsigned long ulBegin, ulEnd;
+    std::vector<unsigned long> aulIndices;
+  };
+
+  void reduceVoxels (VoxelRange &rclRange)
+  {
+    const CellPoint* pclCells = rclRange.pclCells;
+    unsigned long i = rclRange.ulBegin;
+    while (i < rclRange.ulEnd) {
+      unsigned long j = i + 1;
+      while (j < rclRange.ulEnd && pclCells[j].ulKey == pclCells[i].ulKey)
+        j++;
+
+      Base::Vector3d clCenter;
+      for (unsigned long k = i; k < j; k++)
+        clCenter += rclRange.pclPoints->getPoint(pclCells[k].ulIndex);
+      clCenter /= (double)(j - i);
+
+      unsigned long ulNearest = pclCells[i].ulIndex;
+      double fMinDist2 = DBL_MAX;
+      for (unsigned long k = i; k < j; k++) {
+        double fDist2 = Base::DistanceP2(clCenter, rclRange.pclPoints->getPoint(pclCells[k].ulIndex));
+        if (fDist2 < fMinDist2) {
+          fMinDist2 = fDist2;
+          ulNearest = pclCells[k].ulIndex;
+        }
+      }
+
+      rclRange.aulIndices.push_back(ulNearest);
+      i = j;
+    }
+  }
+
+  /** The points of a cell are at the positions ulBegin to ulEnd of the sorted points, the
+   * first ulAccepted of them are kept. */
+  struct PoissonCell
+  {
+    uint64_t ulKey;
+    unsigned long ulBegin, ulEnd, ulAccepted;
+
+    bool operator < (const PoissonCell &rclC) const
+    {
+      return ulKey < rclC.ulKey;
+    }
+  };
+
+  struct PoissonRange
+  {
+    const Points::PointKernel* pclPoints;
+    CellPoint* pclSorted;
+    PoissonCell* pclCells;
+    unsigned long ulCtCells;
+    const unsigned long* pulPhase;
+    unsigned long ulBegin, ulEnd;
+    double fRadius;
+    unsigned long ulSeed;
+  };
+
+  void samplePoisson (PoissonRange &rclRange)
+  {
+    const Points::PointKernel &rclPoints = *rclRange.pclPoints;
+    double fRadius2 = rclRange.fRadius * rclRange.fRadius;
+    std::vector<unsigned long> aulNeighbours;
+
+    for (unsigned long c = rclRange.ulBegin; c < rclRange.ulEnd; c++) {
+      PoissonCell &rclCell = rclRange.pclCells[rclRange.pulPhase[c]];
+
+      // the cell itself and its neighbours that contain points
+      aulNeighbours.clear();
+      uint64_t x = cellCoord(rclCell.ulKey, 0);
+      uint64_t y = cellCoord(rclCell.ulKey, 1);
+      uint64_t z = cellCoord(rclCell.ulKey, 2);
+      PoissonCell* pclEnd = rclRange.pclCells + rclRange.ulCtCells;
+      for (uint64_t i = (x > 0 ? x - 1 : x); i <= x + 1; i++) {
+        for (uint64_t j = (y > 0 ? y - 1 : y); j <= y + 1; j++) {
+          // the three cells along z have consecutive keys
+          PoissonCell clKey;
+          clKey.ulKey = (i << (2 * CellBits)) | (j << CellBits) | (z > 0 ? z - 1 : z);
+          uint64_t ulLast = (i << (2 * CellBits)) | (j << CellBits) | (z + 1);
+          PoissonCell* pclFound = std::lower_bound(rclRange.pclCells, pclEnd, clKey);
+          for (; pclFound != pclEnd && pclFound->ulKey <= ulLast; ++pclFound)
+            aulNeighbours.push_back(pclFound - rclRange.pclCells);
+        }
+      }
+
+      // the random order depends only on the seed and the cell, not on the number of threads
+      uint64_t ulHash = rclCell.ulKey * 0x9E3779B97F4A7C15ULL + rclRange.ulSeed;
+      boost::minstd_rand clGen((boost::uint32_t)(ulHash ^ (ulHash >> 32)));
+      CellPoint* pclFirst = rclRange.pclSorted + rclCell.ulBegin;
+      unsigned long ulCount = rclCell.ulEnd - rclCell.ulBegin;
+      for (unsigned long k = ulCount; k > 1; k--)
+        std::swap(pclFirst[k - 1], pclFirst[clGen() % k]);
+
+      // a point is kept if no kept point is within the radius, it's moved to the kept ones
+      rclCell.ulAccepted = 0;
+      for (unsigned long k = 0; k < ulCount; k++) {
+        Base::Vector3d clPt = rclPoints.getPoint(pclFirst[k].ulIndex);
+        bool bFree = true;
+        for (std::vector<unsigned long>::iterator it = aulNeighbours.begin(); bFree && it != aulNeighbours.end(); ++it) {
+          const PoissonCell &rclNeighbour = rclRange.pclCells[*it];
+          const CellPoint* pclKept = rclRange.pclSorted + rclNeighbour.ulBegin;
+          for (unsigned long m = 0; m < rclNeighbour.ulAccepted; m++) {
+            if (Base::DistanceP2(clPt, rclPoints.getPoint(pclKept[m].ulIndex)) < fRadius2) {
+              bFree = false;
+              break;
+            }
+          }
+        }
+
+        if (bFree) {
+          std::swap(pclFirst[rclCell.ulAccepted], pclFirst[k]);
+          rclCell.ulAccepted++;
+        }
+      }
+    }
+  }
+
+  struct NeighbourRange
+  {
+    const Points::PointsKdTree* pclTree;
+    const Points::PointKernel* pclPoints;
+    unsigned long ulBegin, ulEnd;
+    unsigned long ulNeighbours;
+    double fRadius;
+    double* pfValues;
+  };
+
+  void meanDistances (NeighbourRange &rclRange)
+  {
+    std::vector<unsigned long> aulIndices;
+    std::vector<double> afDistances;
+    for (unsigned long i = rclRange.ulBegin; i < rclRange.ulEnd; i++) {
+      // the nearest point is the point itself
+      unsigned long ulFound = rclRange.pclTree->SearchNearest(rclRange.pclPoints->getPoint(i),
+          rclRange.ulNeighbours + 1, aulIndices, afDistances);
+      double fSum = 0.0;
+      for (unsigned long k = 1; k < ulFound; k++)
+        fSum += afDistances[k];
+      rclRange.pfValues[i] = ulFound > 1 ? fSum / (double)(ulFound - 1) : 0.0;
+    }
+  }
+
+  void countNeighbours (NeighbourRange &rclRange)
+  {
+    std::vector<unsigned long> aulIndices;
+    for (unsigned long i = rclRange.ulBegin; i < rclRange.ulEnd; i++) {
+      // the point itself is found as well
+      unsigned long ulFound = rclRange.pclTree->SearchRadius(rclRange.pclPoints->getPoint(i),
+          rclRange.fRadius, aulIndices);
+      rclRange.pfValues[i] = ulFound > 0 ? (double)(ulFound - 1) : 0.0;
+    }
+  }
+
+  void searchNeighbours (const Points::PointKernel &rclPoints, const Points::PointsKdTree &rclTree,
+                         unsigned long ulNeighbours, double fRadius, void (*pfnFunc)(NeighbourRange&),
+                         bool bParallel, std::vector<double> &rafValues)
+  {
+    unsigned long ulCtPoints = rclPoints.size();
+    rafValues.resize(ulCtPoints);
+    std::vector<NeighbourRange> aclRanges;
+    for (unsigned long i = 0; i < ulCtPoints; i += SearchBlockSize) {
+      NeighbourRange r;
+      r.pclTree = &rclTree;
+      r.pclPoints = &rclPoints;
+      r.ulBegin = i;
+      r.ulEnd = std::min<unsigned long>(i + SearchBlockSize, ulCtPoints);
+      r.ulNeighbours = ulNeighbours;
+      r.fRadius = fRadius;
+      r.pfValues = &(rafValues[0]);
+      aclRanges.push_back(r);
+    }
+    runRanges(aclRanges, pfnFunc, bParallel);
+  }
+}
+
+PointsFilter::PointsFilter (const PointKernel &rclM, bool bParallel)
+  : _rclPoints(rclM), _bParallel(bParallel)
+{
+}
+
+PointsFilter::~PointsFilter (void)
+{
+}
+
+void PointsFilter::VoxelGrid (double fSize, std::vector<unsigned long> &raulIndices) const
+{
+  raulIndices.clear();
+  if (!(fSize > 0.0))
+    throw Base::ValueError("The voxel size must be positive");
+  if (_rclPoints.size() == 0)
+    return;
+
+  CellGrid clGrid;
+  std::vector<CellPoint> aclCells;
+  sortIntoCells(_rclPoints, fSize, _bParallel, clGrid, aclCells);
+
+  // the ranges must not split the points of a voxel
+  std::vector<VoxelRange> aclRanges;
+  unsigned long ulCtPoints = aclCells.size();
+  unsigned long ulBegin = 0;
+  while (ulBegin < ulCtPoints) {
+    unsigned long ulEnd = std::min<unsigned long>(ulBegin + BlockSize, ulCtPoints);
+    while (ulEnd < ulCtPoints && aclCells[ulEnd].ulKey == aclCells[ulEnd - 1].ulKey)
+      ulEnd++;
+    VoxelRange r;
+    r.pclPoints = &_rclPoints;
+    r.pclCells = &(aclCells[0]);
+    r.ulBegin = ulBegin;
+    r.ulEnd = ulEnd;
+    aclRanges.push_back(r);
+    ulBegin = ulEnd;
+  }
+  runRanges(aclRanges, &reduceVoxels, _bParallel);
+
+  for (std::vector<VoxelRange>::iterator it = aclRanges.begin(); it != aclRanges.end(); ++it)
+    raulIndices.insert(raulIndices.end(), it->aulIndices.begin(), it->aulIndices.end());
+  std::sort(raulIndices.begin(), raulIndices.end());
+}
+
+void PointsFilter::RandomSample (unsigned long ulCount, unsigned long ulSeed,
+                                 std::vector<unsigned long> &raulIndices) const
+{
+  raulIndices.clear();
+  unsigned long ulCtPoints = _rclPoints.size();
+  if (ulCount >= ulCtPoints) {
+    raulIndices.resize(ulCtPoints);
+    for (unsigned long i = 0; i < ulCtPoints; i++)
+      raulIndices[i] = i;
+    return;
+  }
+
+  // selection sampling: a point is chosen with the probability of the number of points
+  // still needed divided by the number of remaining points
+  boost::mt19937 clGen((boost::uint32_t)ulSeed);
+  raulIndices.reserve(ulCount);
+  unsigned long ulNeeded = ulCount;
+  for (unsigned long i = 0; i < ulCtPoints && ulNeeded > 0; i++) {
+    // a random number in [0,1)
+    double fRandom = (double)clGen() / 4294967296.0;
+    if ((double)(ulCtPoints - i) * fRandom < (double)ulNeeded) {
+      raulIndices.push_back(i);
+      ulNeeded--;
+    }
+  }
+}
+
+void PointsFilter::PoissonSample (double fRadius, unsigned long ulSeed,
+                                  std::vector<unsigned long> &raulIndices) const
+{
+  raulIndices.clear();
+  if (!(fRadius > 0.0))
+    throw Base::ValueError("The radius must be positive");
+  if (_rclPoints.size() == 0)
+    return;
+
+  // with the radius as cell size all points closer than the radius are in neighbouring cells
+  CellGrid clGrid;
+  std::vector<CellPoint> aclSorted;
+  sortIntoCells(_rclPoints, fRadius, _bParallel, clGrid, aclSorted);
+
+  std::vector<PoissonCell> aclCells;
+  unsigned long ulCtPoints = aclSorted.size();
+  for (unsigned long i = 0; i < ulCtPoints; ) {
+    PoissonCell clCell;
+    clCell.ulKey = aclSorted[i].ulKey;
+    clCell.ulBegin = i;
+    while (i < ulCtPoints && aclSorted[i].ulKey == clCell.ulKey)
+      i++;
+    clCell.ulEnd = i;
+    clCell.ulAccepted = 0;
+    aclCells.push_back(clCell);
+  }
+
+  // The cells are processed in 27 phases. The cells of a phase have the same coordinates
+  // modulo 3, so that none of them is a neighbour of another one and they can be processed
+  // in parallel while their neighbours don't change.
+  std::vector<std::vector<unsigned long> > aulPhases(27);
+  for (unsigned long i = 0; i < aclCells.size(); i++) {
+    uint64_t ulKey = aclCells[i].ulKey;
+    int iPhase = (int)(cellCoord(ulKey, 0) % 3) * 9 + (int)(cellCoord(ulKey, 1) % 3) * 3
+               + (int)(cellCoord(ulKey, 2) % 3);
+    aulPhases[iPhase].push_back(i);
+  }
+
+  for (std::vector<std::vector<unsigned long> >::iterator it = aulPhases.begin(); it != aulPhases.end(); ++it) {
+    std::vector<PoissonRange> aclRanges;
+    for (unsigned long i = 0; i < it->size(); i += CellBlockSize) {
+      PoissonRange r;
+      r.pclPoints = &_rclPoints;
+      r.pclSorted = &(aclSorted[0]);
+      r.pclCells = &(aclCells[0]);
+      r.ulCtCells = aclCells.size();
+      r.pulPhase = &((*it)[0]);
+      r.ulBegin = i;
+      r.ulEnd = std::min<unsigned long>(i + CellBlockSize, it->size());
+      r.fRadius = fRadius;
+      r.ulSeed = ulSeed;
+      aclRanges.push_back(r);
+    }
+    runRanges(aclRanges, &samplePoisson, _bParallel);
+  }
+
+  for (std::vector<PoissonCell>::iterator it = aclCells.begin(); it != aclCells.end(); ++it) {
+    for (unsigned long i = it->ulBegin; i < it->ulBegin + it->ulAccepted; i++)
+      raulIndices.push_back(aclSorted[i].ulIndex);
+  }
+  std::sort(raulIndices.begin(), raulIndices.end());
+}
+
+void PointsFilter::StatisticalOutlierRemoval (unsigned long ulNeighbours, double fStdDevFactor,
+                                              std::vector<unsigned long> &raulIndices) const
+{
+  raulIndices.clear();
+  if (ulNeighbours == 0)
+    throw Base::ValueError("The number of neighbours must be positive");
+  unsigned long ulCtPoints = _rclPoints.size();
+  if (ulCtPoints == 0)
+    return;
+
+  PointsKdTree clTree(_rclPoints);
+  std::vector<double> afMeanDist;
+  searchNeighbours(_rclPoints, clTree, ulNeighbours, 0.0, &meanDistances, _bParallel, afMeanDist);
+
+  double fSum = 0.0, fSum2 = 0.0;
+  for (std::vector<double>::iterator it = afMeanDist.begin(); it != afMeanDist.end(); ++it) {
+    fSum += *it;
+    fSum2 += *it * *it;
+  }
+  double fMean = fSum / (double)ulCtPoints;
+  double fVariance = std::max<double>(fSum2 / (double)ulCtPoints - fMean * fMean, 0.0);
+  double fLimit = fMean + fStdDevFactor * sqrt(fVariance);
+
+  for (unsigned long i = 0; i < ulCtPoints; i++) {
+    if (afMeanDist[i] <= fLimit)
+      raulIndices.push_back(i);
+  }
+}
+
+void PointsFilter::RadiusOutlierRemoval (double fRadius, unsigned long ulMinNeighbours,
+                                         std::vector<unsigned long> &raulIndices) const
+{
+  raulIndices.clear();
+  if (fRadius < 0.0)
+    throw Base::ValueError("The radius must not be negative");
+  unsigned long ulCtPoints = _rclPoints.size();
+  if (ulCtPoints == 0)
+    return;
+
+  PointsKdTree clTree(_rclPoints);
+  std::vector<double> afNeighbours;
+  searchNeighbours(_rclPoints, clTree, 0, fRadius, &countNeighbours, _bParallel, afNeighbours);
+
+  for (unsigned long i = 0; i < ulCtPoints; i++) {
+    if (afNeighbours[i] >= (double)ulMinNeighbours)
+      raulIndices.push_back(i);
+  }
+}
+
+void PointsFilter::Extract (const PointKernel &rclIn, const std::vector<unsigned long> &raulIndices,
+                            PointKernel &rclOut)
+{
+  std::vector<PointKernel::value_type> aclPoints;
+  Extract(rclIn.getBasicPoints(), raulIndices, aclPoints);
+  Base::Matrix4D clMat = rclIn.getTransform();
+  rclOut.getBasicPoints().swap(aclPoints);
+  rclOut.setTransform(clMat);
+}
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTS_FILTER_H
+#define POINTS_FILTER_H
+
+#include <vector>
+
+#include "Points.h"
+
+namespace Points {
+
+/**
+ * The PointsFilter class reduces a point cloud by downsampling it or by removing outliers.
+ *
+ * None of the filters moves or creates a point. Each of them determines the indices of
+ * the points to keep in ascending order, so that Extract() reduces the point kernel and
+ * its grey values, normals or colors the same way. The filters work with the transformed
+ * points and distribute the work over all available cores unless the filter is constructed
+ * with \a bParallel set to false. Either way they keep the same points.
+ */
+class PointsExport PointsFilter
+{
+public:
+  /// Construction
+  PointsFilter (const PointKernel &rclM, bool bParallel = true);
+  /// Destruction
+  ~PointsFilter (void);
+
+  /** @name Downsampling */
+  //@{
+  /** Divides the space into cubes with the edge length \a fSize and keeps of every cube
+   * that contains points the one next to the centroid of these points. */
+  void VoxelGrid (double fSize, std::vector<unsigned long> &raulIndices) const;
+  /** Keeps \a ulCount points where each point has the same chance to be chosen. If there
+   * are not more points than \a ulCount all of them are kept. */
+  void RandomSample (unsigned long ulCount, unsigned long ulSeed,
+                     std::vector<unsigned long> &raulIndices) const;
+  /** Keeps a random subset of the points where no two points are closer than \a fRadius
+   * while every removed point is closer than \a fRadius to a kept point. */
+  void PoissonSample (double fRadius, unsigned long ulSeed,
+                      std::vector<unsigned long> &raulIndices) const;
+  //@}
+
+  /** @name Outlier removal */
+  //@{
+  /** Computes for every point the mean distance to its \a ulNeighbours nearest points and
+   * removes the points whose mean distance exceeds the average of all mean distances by more
+   * than \a fStdDevFactor times their standard deviation. */
+  void StatisticalOutlierRemoval (unsigned long ulNeighbours, double fStdDevFactor,
+                                  std::vector<unsigned long> &raulIndices) const;
+  /** Removes the points that have less than \a ulMinNeighbours other points within \a fRadius. */
+  void RadiusOutlierRemoval (double fRadius, unsigned long ulMinNeighbours,
+                             std::vector<unsigned long> &raulIndices) const;
+  //@}
+
+  /** @name Extraction */
+  //@{
+  /** Copies the points with the given indices to \a rclOut which gets the transformation
+   * of \a rclIn. */
+  static void Extract (const PointKernel &rclIn, const std::vector<unsigned long> &raulIndices,
+                       PointKernel &rclOut);
+  /** Copies the values with the given indices, e.g. the grey values of the points. */
+  template <class T>
+  static void Extract (const std::vector<T> &raclIn, const std::vector<unsigned long> &raulIndices,
+                       std::vector<T> &raclOut)
+  {
+    raclOut.resize(raulIndices.size());
+    for (std::size_t i = 0; i < raulIndices.size(); i++)
+      raclOut[i] = raclIn[raulIndices[i]];
+  }
+  //@}
+
+private:
+  const PointKernel &_rclPoints; /**< The point kernel. */
+  bool _bParallel; /**< Whether the work is distributed over several threads. */
+};
+
+} // namespace Points
+
+#endif // POINTS_FILTER_H
@@ -0,0 +1,1078 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cstdlib>
+# include <cstring>
+# include <istream>
+# include <limits>
+# include <locale>
+# include <ostream>
+# include <sstream>
+# include <string>
+#endif
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#include <Base/FileInfo.h>
+#include <Base/Stream.h>
+#include <Base/Swap.h>
+
+#include "PointsIO.h"
+#include "PointsAlgos.h"
+
+using namespace Points;
+
+namespace Points {
+namespace IO {
+
+enum Number {
+    int8, uint8, int16, uint16, int32, uint32, float32, float64, unsupported
+};
+
+enum Attribute {
+    None, X, Y, Z, Intensity, NX, NY, NZ, Red, Green, Blue, RGB, NumAttributes
+};
+
+/** A property of a PLY vertex or a field of a PCD point. The first value of the
+ * i-th point is at offset + i * stride of a block of data. */
+struct Field
+{
+    Number type;
+    int size;
+    int count;
+    std::size_t offset;
+    std::size_t stride;
+    Attribute attribute;
+};
+
+static Number plyNumber(const std::string& type)
+{
+    if (type == "char" || type == "int8")
+        return int8;
+    else if (type == "uchar" || type == "uint8")
+        return uint8;
+    else if (type == "short" || type == "int16")
+        return int16;
+    else if (type == "ushort" || type == "uint16")
+        return uint16;
+    else if (type == "int" || type == "int32")
+        return int32;
+    else if (type == "uint" || type == "uint32")
+        return uint32;
+    else if (type == "float" || type == "float32")
+        return float32;
+    else if (type == "double" || type == "float64")
+        return float64;
+    return unsupported;
+}
+
+static Number pcdNumber(char type, int size)
+{
+    if (type == 'I') {
+        if (size == 1) return int8;
+        if (size == 2) return int16;
+        if (size == 4) return int32;
+    }
+    else if (type == 'U') {
+        if (size == 1) return uint8;
+        if (size == 2) return uint16;
+        if (size == 4) return uint32;
+    }
+    else if (type == 'F') {
+        if (size == 4) return float32;
+        if (size == 8) return float64;
+    }
+    return unsupported;
+}
+
+static int numberSize(Number type)
+{
+    switch (type) {
+    case int8:
+    case uint8:
+        return 1;
+    case int16:
+    case uint16:
+        return 2;
+    case int32:
+    case uint32:
+    case float32:
+        return 4;
+    case float64:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+static Attribute plyAttribute(std::string name)
+{
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (name == "x") return X;
+    if (name == "y") return Y;
+    if (name == "z") return Z;
+    if (name == "nx") return NX;
+    if (name == "ny") return NY;
+    if (name == "nz") return NZ;
+    if (name == "red" || name == "diffuse_red") return Red;
+    if (name == "green" || name == "diffuse_green") return Green;
+    if (name == "blue" || name == "diffuse_blue") return Blue;
+    if (name == "intensity" || name == "scalar_intensity") return Intensity;
+    return None;
+}
+
+static Attribute pcdAttribute(const std::string& name, Number type)
+{
+    if (name == "x") return X;
+    if (name == "y") return Y;
+    if (name == "z") return Z;
+    if (name == "normal_x") return NX;
+    if (name == "normal_y") return NY;
+    if (name == "normal_z") return NZ;
+    if (name == "intensity") return Intensity;
+    if ((name == "rgb" || name == "rgba") && numberSize(type) == 4) return RGB;
+    return None;
+}
+
+template <class T>
+static T readValue(const char* data, bool swap)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    if (swap)
+        Base::SwapEndian<T>(value);
+    return value;
+}
+
+template <class T>
+static void writeValue(char* data, T value)
+{
+    memcpy(data, &value, sizeof(T));
+}
+
+static double toDouble(const char* data, Number type, bool swap)
+{
+    switch (type) {
+    case int8:
+        return readValue<signed char>(data, false);
+    case uint8:
+        return readValue<unsigned char>(data, false);
+    case int16:
+        return readValue<int16_t>(data, swap);
+    case uint16:
+        return readValue<uint16_t>(data, swap);
+    case int32:
+        return readValue<int32_t>(data, swap);
+    case uint32:
+        return readValue<uint32_t>(data, swap);
+    case float32:
+        return readValue<float>(data, swap);
+    case float64:
+        return readValue<double>(data, swap);
+    default:
+        return 0.0;
+    }
+}
+
+static void fromDouble(char* data, Number type, double value)
+{
+    switch (type) {
+    case int8:
+        writeValue<signed char>(data, (signed char)value);
+        break;
+    case uint8:
+        writeValue<unsigned char>(data, (unsigned char)value);
+        break;
+    case int16:
+        writeValue<int16_t>(data, (int16_t)value);
+        break;
+    case uint16:
+        writeValue<uint16_t>(data, (uint16_t)value);
+        break;
+    case int32:
+        writeValue<int32_t>(data, (int32_t)value);
+        break;
+    case uint32:
+        writeValue<uint32_t>(data, (uint32_t)value);
+        break;
+    case float32:
+        writeValue<float>(data, (float)value);
+        break;
+    case float64:
+        writeValue<double>(data, value);
+        break;
+    default:
+        break;
+    }
+}
+
+static unsigned char toByte(float value)
+{
+    return (unsigned char)(std::min<float>(std::max<float>(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+/**
+ * The Decoder converts the fields of the points to the coordinates and attributes
+ * and appends them to the point kernel and the attribute lists.
+ */
+class Decoder
+{
+public:
+    Decoder(const std::vector<Field>& fields, bool swap, std::vector<Base::Vector3f>& points,
+            std::vector<float>* greyValues, std::vector<Base::Vector3f>* normals,
+            std::vector<App::Color>* colors)
+      : swap(swap), colorScale(1.0f), packedColor(false), points(points)
+      , greyValues(0), normals(0), colors(0)
+    {
+        bool found[NumAttributes] = {false};
+        for (std::vector<Field>::const_iterator it = fields.begin(); it != fields.end(); ++it) {
+            if (it->attribute != None && it->type != unsupported && !found[it->attribute]) {
+                found[it->attribute] = true;
+                used.push_back(*it);
+                if (it->attribute == Red) {
+                    if (it->type == uint8)
+                        colorScale = 1.0f / 255.0f;
+                    else if (it->type == uint16)
+                        colorScale = 1.0f / 65535.0f;
+                }
+            }
+        }
+
+        valid = found[X] && found[Y] && found[Z];
+        if (found[Intensity])
+            this->greyValues = greyValues;
+        if (found[NX] && found[NY] && found[NZ])
+            this->normals = normals;
+        if (found[RGB]) {
+            this->colors = colors;
+            packedColor = true;
+        }
+        else if (found[Red] && found[Green] && found[Blue]) {
+            this->colors = colors;
+        }
+    }
+
+    bool IsValid() const
+    {
+        return valid;
+    }
+
+    void Reserve(std::size_t count)
+    {
+        points.reserve(count);
+        if (greyValues)
+            greyValues->reserve(count);
+        if (normals)
+            normals->reserve(count);
+        if (colors)
+            colors->reserve(count);
+    }
+
+    /** Decodes the \a i-th point of \a data. Points with an invalid coordinate are skipped. */
+    void Decode(const char* data, std::size_t i)
+    {
+        double values[NumAttributes];
+        uint32_t packed = 0;
+        for (std::vector<Field>::const_iterator it = used.begin(); it != used.end(); ++it) {
+            const char* value = data + it->offset + i * it->stride;
+            if (it->attribute == RGB)
+                packed = readValue<uint32_t>(value, swap);
+            else
+                values[it->attribute] = toDouble(value, it->type, swap);
+        }
+
+        if (!boost::math::isfinite(values[X]) ||
+            !boost::math::isfinite(values[Y]) ||
+            !boost::math::isfinite(values[Z]))
+            return;
+
+        points.push_back(Base::Vector3f((float)values[X], (float)values[Y], (float)values[Z]));
+        if (greyValues)
+            greyValues->push_back((float)values[Intensity]);
+        if (normals)
+            normals->push_back(Base::Vector3f((float)values[NX], (float)values[NY], (float)values[NZ]));
+        if (colors) {
+            if (packedColor) {
+                colors->push_back(App::Color((float)((packed >> 16) & 0xff) / 255.0f,
+                                             (float)((packed >> 8) & 0xff) / 255.0f,
+                                             (float)(packed & 0xff) / 255.0f));
+            }
+            else {
+                colors->push_back(App::Color((float)values[Red] * colorScale,
+                                             (float)values[Green] * colorScale,
+                                             (float)values[Blue] * colorScale));
+            }
+        }
+    }
+
+    void Finish()
+    {
+        if (greyValues)
+            PointsAlgos::NormalizeGreyValues(*greyValues);
+    }
+
+private:
+    std::vector<Field> used;
+    bool swap;
+    bool valid;
+    float colorScale;
+    bool packedColor;
+    std::vector<Base::Vector3f>& points;
+    std::vector<float>* greyValues;
+    std::vector<Base::Vector3f>* normals;
+    std::vector<App::Color>* colors;
+};
+
+/** Reads \a count points with records of \a recordSize bytes in blocks of about 4 MB. */
+static bool readBinary(std::istream& inp, std::size_t recordSize, std::size_t count, Decoder& decoder)
+{
+    std::size_t blockPoints = std::max<std::size_t>(1, (1 << 22) / recordSize);
+    std::vector<char> buffer(std::min<std::size_t>(blockPoints, count) * recordSize + 1);
+    for (std::size_t done = 0; done < count; ) {
+        std::size_t n = std::min<std::size_t>(blockPoints, count - done);
+        inp.read(&buffer[0], n * recordSize);
+        if ((std::size_t)inp.gcount() != n * recordSize)
+            return false;
+        for (std::size_t i = 0; i < n; i++)
+            decoder.Decode(&buffer[0], i);
+        done += n;
+    }
+    return true;
+}
+
+/** Reads \a count points whose values are separated by white spaces. The values are
+ * converted to their binary representation to decode them like binary data. The values
+ * are parsed in the classic locale, values that are no numbers such as "nan" become NaN
+ * for floating point fields and zero for integer fields. */
+static bool readAscii(std::istream& inp, const std::vector<Field>& fields, std::size_t recordSize,
+                      std::size_t count, Decoder& decoder)
+{
+    std::vector<char> record(recordSize + 1);
+    std::string token;
+    std::istringstream str;
+    str.imbue(std::locale::classic());
+    for (std::size_t i = 0; i < count; i++) {
+        for (std::vector<Field>::const_iterator it = fields.begin(); it != fields.end(); ++it) {
+            for (int j = 0; j < it->count; j++) {
+                if (!(inp >> token))
+                    return false;
+                if (j == 0) {
+                    double value;
+                    str.clear();
+                    str.str(token);
+                    if (!(str >> value)) {
+                        bool real = (it->type == float32 || it->type == float64);
+                        value = real ? std::numeric_limits<double>::quiet_NaN() : 0.0;
+                    }
+                    fromDouble(&record[it->offset], it->type, value);
+                }
+            }
+        }
+        decoder.Decode(&record[0], 0);
+    }
+    return true;
+}
+
+/** Decompresses the LZF compressed \a in into \a out. Returns false if the data is corrupt. */
+static bool lzfDecompress(const unsigned char* in, std::size_t inLen, unsigned char* out, std::size_t outLen)
+{
+    const unsigned char* ip = in;
+    const unsigned char* inEnd = in + inLen;
+    unsigned char* op = out;
+    unsigned char* outEnd = out + outLen;
+
+    while (ip < inEnd) {
+        unsigned int ctrl = *ip++;
+        if (ctrl < 32) {
+            // a run of ctrl + 1 literal bytes
+            ctrl++;
+            if (op + ctrl > outEnd || ip + ctrl > inEnd)
+                return false;
+            memcpy(op, ip, ctrl);
+            op += ctrl;
+            ip += ctrl;
+        }
+        else {
+            // a back reference
+            unsigned int len = ctrl >> 5;
+            if (len == 7) {
+                if (ip >= inEnd)
+                    return false;
+                len += *ip++;
+            }
+            if (ip >= inEnd)
+                return false;
+            const unsigned char* ref = op - ((ctrl & 0x1f) << 8) - 1 - *ip++;
+            len += 2;
+            if (ref < out || op + len > outEnd)
+                return false;
+            for (unsigned int i = 0; i < len; i++)
+                *op++ = *ref++;
+        }
+    }
+
+    return op == outEnd;
+}
+
+/** Compresses \a in with the LZF format. The output buffer must be at least
+ * inLen + inLen / 32 + 1 bytes large. Returns the size of the compressed data. */
+static std::size_t lzfCompress(const unsigned char* in, std::size_t inLen, unsigned char* out)
+{
+    const unsigned int hashLog = 14;
+    const std::size_t maxOffset = 1 << 13;
+    const std::size_t maxLength = (1 << 8) + (1 << 3);
+    std::vector<std::size_t> table(1 << hashLog, 0);
+
+    const unsigned char* ip = in;
+    const unsigned char* inEnd = in + inLen;
+    const unsigned char* literals = in;
+    unsigned char* op = out;
+
+    while (ip + 2 < inEnd) {
+        uint32_t key = ((uint32_t)ip[0] << 16) | ((uint32_t)ip[1] << 8) | ip[2];
+        uint32_t slot = (key * 2654435761u) >> (32 - hashLog);
+        std::size_t pos = table[slot];
+        table[slot] = (ip - in) + 1;
+        if (pos > 0) {
+            const unsigned char* ref = in + pos - 1;
+            std::size_t off = ip - ref - 1;
+            if (off < maxOffset && ref[0] == ip[0] && ref[1] == ip[1] && ref[2] == ip[2]) {
+                std::size_t maxLen = std::min<std::size_t>(inEnd - ip, maxLength);
+                std::size_t len = 3;
+                while (len < maxLen && ref[len] == ip[len])
+                    len++;
+
+                // flush the pending literals in runs of at most 32 bytes
+                while (literals < ip) {
+                    std::size_t run = std::min<std::size_t>(ip - literals, 32);
+                    *op++ = (unsigned char)(run - 1);
+                    memcpy(op, literals, run);
+                    op += run;
+                    literals += run;
+                }
+
+                len -= 2;
+                if (len < 7) {
+                    *op++ = (unsigned char)((off >> 8) + (len << 5));
+                }
+                else {
+                    *op++ = (unsigned char)((off >> 8) + (7 << 5));
+                    *op++ = (unsigned char)(len - 7);
+                }
+                *op++ = (unsigned char)(off & 0xff);
+                ip += len + 2;
+                literals = ip;
+                continue;
+            }
+        }
+        ip++;
+    }
+
+    while (literals < inEnd) {
+        std::size_t run = std::min<std::size_t>(inEnd - literals, 32);
+        *op++ = (unsigned char)(run - 1);
+        memcpy(op, literals, run);
+        op += run;
+        literals += run;
+    }
+
+    return op - out;
+}
+
+static void addField(std::vector<Field>& fields, Number type, Attribute attribute, std::size_t& recordSize)
+{
+    Field f;
+    f.type = type;
+    f.size = numberSize(type);
+    f.count = 1;
+    f.offset = recordSize;
+    f.stride = 0;
+    f.attribute = attribute;
+    fields.push_back(f);
+    recordSize += f.size;
+}
+
+/** Writes the \a i-th point of \a data at the positions given by \a fields. The
+ * attributes are taken from the \a index-th entry of the lists. */
+static void encode(char* data, std::size_t i, const std::vector<Field>& fields, const Base::Vector3f& pt,
+                   std::size_t index, const std::vector<float>* greyValues,
+                   const std::vector<Base::Vector3f>* normals, const std::vector<App::Color>* colors)
+{
+    for (std::vector<Field>::const_iterator it = fields.begin(); it != fields.end(); ++it) {
+        char* value = data + it->offset + i * it->stride;
+        switch (it->attribute) {
+        case X:
+            writeValue<float>(value, pt.x);
+            break;
+        case Y:
+            writeValue<float>(value, pt.y);
+            break;
+        case Z:
+            writeValue<float>(value, pt.z);
+            break;
+        case NX:
+            writeValue<float>(value, (*normals)[index].x);
+            break;
+        case NY:
+            writeValue<float>(value, (*normals)[index].y);
+            break;
+        case NZ:
+            writeValue<float>(value, (*normals)[index].z);
+            break;
+        case Intensity:
+            writeValue<float>(value, (*greyValues)[index]);
+            break;
+        case Red:
+            writeValue<unsigned char>(value, toByte((*colors)[index].r));
+            break;
+        case Green:
+            writeValue<unsigned char>(value, toByte((*colors)[index].g));
+            break;
+        case Blue:
+            writeValue<unsigned char>(value, toByte((*colors)[index].b));
+            break;
+        case RGB:
+            {
+                const App::Color& c = (*colors)[index];
+                uint32_t packed = ((uint32_t)toByte(c.r) << 16) | ((uint32_t)toByte(c.g) << 8) | toByte(c.b);
+                writeValue<uint32_t>(value, packed);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+} // namespace IO
+} // namespace Points
+
+// ----------------------------------------------------------------------------
+
+PointsInput::PointsInput (PointKernel &kernel, std::vector<float>* greyValues,
+                          std::vector<Base::Vector3f>* normals,
+                          std::vector<App::Color>* colors)
+  : _kernel(kernel), _greyValues(greyValues), _normals(normals), _colors(colors)
+{
+}
+
+void PointsInput::Clear()
+{
+    _kernel.clear();
+    if (_greyValues)
+        _greyValues->clear();
+    if (_normals)
+        _normals->clear();
+    if (_colors)
+        _colors->clear();
+}
+
+bool PointsInput::LoadAny(const char* FileName)
+{
+    Base::FileInfo fi(FileName);
+    if (!fi.isReadable())
+        return false;
+
+    if (fi.hasExtension("ply")) {
+        Base::ifstream str(fi, std::ios::in | std::ios::binary);
+        return LoadPLY(str);
+    }
+    else if (fi.hasExtension("pcd")) {
+        Base::ifstream str(fi, std::ios::in | std::ios::binary);
+        return LoadPCD(str);
+    }
+    else if (fi.hasExtension("asc") || fi.hasExtension("xyz") ||
+             fi.hasExtension("csv") || fi.hasExtension("pts")) {
+        AsciiFormat format = PointsAlgos::GuessAsciiFormat(FileName);
+        PointsAlgos::LoadAscii(_kernel, FileName, format, _greyValues, _normals, _colors);
+        return true;
+    }
+
+    return false;
+}
+
+bool PointsInput::LoadPLY (std::istream &inp)
+{
+    // http://paulbourke.net/dataformats/ply/
+    using namespace IO;
+
+    Clear();
+    if (!inp || inp.bad() == true)
+        return false;
+
+    std::string line;
+    if (!std::getline(inp, line) || line.compare(0, 3, "ply") != 0)
+        return false; // wrong header
+
+    struct Element
+    {
+        std::string name;
+        std::size_t count;
+        std::size_t recordSize;
+        bool list;
+        std::vector<Field> fields;
+    };
+
+    enum {
+        unknown, ascii, binary_little_endian, binary_big_endian
+    } format = unknown;
+
+    std::vector<Element> elements;
+    while (std::getline(inp, line)) {
+        std::istringstream str(line);
+        std::string kw;
+        if (!(str >> kw))
+            continue; // empty line
+        if (kw == "format") {
+            std::string format_string, version;
+            str >> format_string >> version;
+            if (format_string == "ascii")
+                format = ascii;
+            else if (format_string == "binary_little_endian")
+                format = binary_little_endian;
+            else if (format_string == "binary_big_endian")
+                format = binary_big_endian;
+            else
+                return false; // wrong format version
+        }
+        else if (kw == "element") {
+            Element element;
+            if (!(str >> element.name >> element.count))
+                return false;
+            element.recordSize = 0;
+            element.list = false;
+            elements.push_back(element);
+        }
+        else if (kw == "property") {
+            if (elements.empty())
+                return false;
+            Element& element = elements.back();
+            std::string type, name;
+            str >> type;
+            if (type == "list") {
+                element.list = true;
+                continue;
+            }
+            str >> name;
+            Field f;
+            f.type = plyNumber(type);
+            if (f.type == unsupported)
+                return false; // no valid number type
+            f.size = numberSize(f.type);
+            f.count = 1;
+            f.offset = element.recordSize;
+            f.attribute = element.name == "vertex" ? plyAttribute(name) : None;
+            element.fields.push_back(f);
+            element.recordSize += f.size;
+        }
+        else if (kw == "end_header") {
+            break; // end of the header, now read the data
+        }
+    }
+
+    if (format == unknown)
+        return false;
+
+    // skip the elements in front of the vertices
+    std::vector<Element>::iterator vertex = elements.begin();
+    for (; vertex != elements.end() && vertex->name != "vertex"; ++vertex) {
+        if (format == ascii) {
+            for (std::size_t i = 0; i < vertex->count; i++)
+                std::getline(inp, line);
+        }
+        else if (vertex->list) {
+            return false; // the size of lists is unknown
+        }
+        else {
+            inp.ignore(vertex->count * vertex->recordSize);
+        }
+    }
+    if (vertex == elements.end() || vertex->list)
+        return false;
+
+    for (std::vector<Field>::iterator it = vertex->fields.begin(); it != vertex->fields.end(); ++it)
+        it->stride = vertex->recordSize;
+    Decoder decoder(vertex->fields, format == binary_big_endian, _kernel.getBasicPoints(),
+                    _greyValues, _normals, _colors);
+    if (!decoder.IsValid())
+        return false;
+
+    try {
+        decoder.Reserve(vertex->count);
+        bool ok = (format == ascii)
+            ? readAscii(inp, vertex->fields, vertex->recordSize, vertex->count, decoder)
+            : readBinary(inp, vertex->recordSize, vertex->count, decoder);
+        if (!ok) {
+            Clear();
+            return false;
+        }
+    }
+    catch (const std::bad_alloc&) {
+        Clear();
+        return false;
+    }
+
+    decoder.Finish();
+    return true;
+}
+
+bool PointsInput::LoadPCD (std::istream &inp)
+{
+    // http://pointclouds.org/documentation/tutorials/pcd_file_format.php
+    using namespace IO;
+
+    Clear();
+    if (!inp || inp.bad() == true)
+        return false;
+
+    std::vector<std::string> names;
+    std::vector<int> sizes, counts;
+    std::vector<char> types;
+    std::size_t width = 0, height = 1, points = 0;
+    std::string data, line;
+    while (std::getline(inp, line)) {
+        std::istringstream str(line);
+        std::string kw;
+        if (!(str >> kw) || kw[0] == '#')
+            continue; // empty line or comment
+        if (kw == "FIELDS" || kw == "COLUMNS") {
+            std::string name;
+            while (str >> name)
+                names.push_back(name);
+        }
+        else if (kw == "SIZE") {
+            int size;
+            while (str >> size)
+                sizes.push_back(size);
+        }
+        else if (kw == "TYPE") {
+            char type;
+            while (str >> type)
+                types.push_back(type);
+        }
+        else if (kw == "COUNT") {
+            int count;
+            while (str >> count)
+                counts.push_back(count);
+        }
+        else if (kw == "WIDTH") {
+            str >> width;
+        }
+        else if (kw == "HEIGHT") {
+            str >> height;
+        }
+        else if (kw == "POINTS") {
+            str >> points;
+        }
+        else if (kw == "DATA") {
+            str >> data;
+            break; // end of the header, now read the data
+        }
+    }
+
+    if (counts.empty())
+        counts.resize(names.size(), 1);
+    if (names.empty() || sizes.size() != names.size() ||
+        types.size() != names.size() || counts.size() != names.size())
+        return false;
+    if (points == 0)
+        points = width * height;
+
+    std::vector<Field> fields;
+    std::size_t recordSize = 0;
+    for (std::size_t i = 0; i < names.size(); i++) {
+        Field f;
+        f.type = pcdNumber(types[i], sizes[i]);
+        f.size = sizes[i];
+        f.count = counts[i];
+        f.offset = recordSize;
+        f.attribute = pcdAttribute(names[i], f.type);
+        fields.push_back(f);
+        recordSize += f.size * f.count;
+    }
+    if (recordSize == 0)
+        return false;
+
+    // the compressed data is stored field by field
+    std::vector<char> uncompressed;
+    if (data == "binary_compressed") {
+        uint32_t compressedSize, uncompressedSize;
+        inp.read((char*)&compressedSize, sizeof(uint32_t));
+        inp.read((char*)&uncompressedSize, sizeof(uint32_t));
+        if (!inp || uncompressedSize != points * recordSize)
+            return false;
+
+        try {
+            std::vector<char> compressed(compressedSize + 1);
+            inp.read(&compressed[0], compressedSize);
+            if ((std::size_t)inp.gcount() != compressedSize)
+                return false;
+            uncompressed.resize(uncompressedSize + 1);
+            if (!lzfDecompress((const unsigned char*)&compressed[0], compressedSize,
+                               (unsigned char*)&uncompressed[0], uncompressedSize))
+                return false;
+        }
+        catch (const std::bad_alloc&) {
+            return false;
+        }
+
+        for (std::vector<Field>::iterator it = fields.begin(); it != fields.end(); ++it) {
+            it->offset *= points;
+            it->stride = it->size * it->count;
+        }
+    }
+    else {
+        for (std::vector<Field>::iterator it = fields.begin(); it != fields.end(); ++it)
+            it->stride = recordSize;
+    }
+
+    Decoder decoder(fields, false, _kernel.getBasicPoints(), _greyValues, _normals, _colors);
+    if (!decoder.IsValid())
+        return false;
+
+    try {
+        decoder.Reserve(points);
+        bool ok = true;
+        if (data == "ascii") {
+            ok = readAscii(inp, fields, recordSize, points, decoder);
+        }
+        else if (data == "binary") {
+            ok = readBinary(inp, recordSize, points, decoder);
+        }
+        else if (data == "binary_compressed") {
+            for (std::size_t i = 0; i < points; i++)
+                decoder.Decode(&uncompressed[0], i);
+        }
+        else {
+            ok = false;
+        }
+        if (!ok) {
+            Clear();
+            return false;
+        }
+    }
+    catch (const std::bad_alloc&) {
+        Clear();
+        return false;
+    }
+
+    decoder.Finish();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+PointsOutput::PointsOutput (const PointKernel &kernel, const std::vector<float>* greyValues,
+                            const std::vector<Base::Vector3f>* normals,
+                            const std::vector<App::Color>* colors)
+  : _kernel(kernel), _greyValues(0), _normals(0), _colors(0)
+{
+    if (greyValues && greyValues->size() == kernel.size())
+        _greyValues = greyValues;
+    if (normals && normals->size() == kernel.size())
+        _normals = normals;
+    if (colors && colors->size() == kernel.size())
+        _colors = colors;
+}
+
+bool PointsOutput::SaveAny(const char* FileName) const
+{
+    Base::FileInfo fi(FileName);
+    Base::FileInfo di(fi.dirPath().c_str());
+    if ((fi.exists() && !fi.isWritable()) || !di.exists() || !di.isWritable())
+        return false;
+
+    Base::ofstream str(fi, std::ios::out | std::ios::binary);
+    if (fi.hasExtension("ply"))
+        return SaveBinaryPLY(str);
+    else if (fi.hasExtension("pcd"))
+        return SaveBinaryPCD(str);
+    else if (fi.hasExtension("asc")) {
+        _kernel.save(str);
+        return true;
+    }
+
+    return false;
+}
+
+bool PointsOutput::SaveBinaryPLY (std::ostream &out) const
+{
+    using namespace IO;
+
+    if (!out || out.bad() == true)
+        return false;
+
+    std::size_t count = _kernel.size();
+    std::vector<Field> fields;
+    std::size_t recordSize = 0;
+    out << "ply" << std::endl
+        << "format binary_little_endian 1.0" << std::endl
+        << "comment Created by FreeCAD <http://www.freecadweb.org>" << std::endl
+        << "element vertex " << count << std::endl
+        << "property float32 x" << std::endl
+        << "property float32 y" << std::endl
+        << "property float32 z" << std::endl;
+    addField(fields, float32, X, recordSize);
+    addField(fields, float32, Y, recordSize);
+    addField(fields, float32, Z, recordSize);
+    if (_normals) {
+        out << "property float32 nx" << std::endl
+            << "property float32 ny" << std::endl
+            << "property float32 nz" << std::endl;
+        addField(fields, float32, NX, recordSize);
+        addField(fields, float32, NY, recordSize);
+        addField(fields, float32, NZ, recordSize);
+    }
+    if (_greyValues) {
+        out << "property float32 intensity" << std::endl;
+        addField(fields, float32, Intensity, recordSize);
+    }
+    if (_colors) {
+        out << "property uchar red" << std::endl
+            << "property uchar green" << std::endl
+            << "property uchar blue" << std::endl;
+        addField(fields, uint8, Red, recordSize);
+        addField(fields, uint8, Green, recordSize);
+        addField(fields, uint8, Blue, recordSize);
+    }
+    out << "end_header" << std::endl;
+
+    // the points are written in blocks of about 4 MB
+    for (std::vector<Field>::iterator it = fields.begin(); it != fields.end(); ++it)
+        it->stride = recordSize;
+    std::size_t blockPoints = (1 << 22) / recordSize;
+    std::vector<char> buffer(blockPoints * recordSize);
+    for (std::size_t done = 0; done < count; ) {
+        std::size_t n = std::min<std::size_t>(blockPoints, count - done);
+        for (std::size_t i = 0; i < n; i++) {
+            Base::Vector3d pt = _kernel.getPoint(done + i);
+            encode(&buffer[0], i, fields, Base::Vector3f((float)pt.x, (float)pt.y, (float)pt.z),
+                   done + i, _greyValues, _normals, _colors);
+        }
+        out.write(&buffer[0], n * recordSize);
+        done += n;
+    }
+
+    return out.good();
+}
+
+bool PointsOutput::SaveBinaryPCD (std::ostream &out, bool compressed) const
+{
+    using namespace IO;
+
+    if (!out || out.bad() == true)
+        return false;
+
+    std::size_t count = _kernel.size();
+    std::vector<Field> fields;
+    std::size_t recordSize = 0;
+    std::string names = "x y z", sizes = "4 4 4", types = "F F F", counts = "1 1 1";
+    addField(fields, float32, X, recordSize);
+    addField(fields, float32, Y, recordSize);
+    addField(fields, float32, Z, recordSize);
+    if (_normals) {
+        names += " normal_x normal_y normal_z";
+        sizes += " 4 4 4";
+        types += " F F F";
+        counts += " 1 1 1";
+        addField(fields, float32, NX, recordSize);
+        addField(fields, float32, NY, recordSize);
+        addField(fields, float32, NZ, recordSize);
+    }
+    if (_greyValues) {
+        names += " intensity";
+        sizes += " 4";
+        types += " F";
+        counts += " 1";
+        addField(fields, float32, Intensity, recordSize);
+    }
+    if (_colors) {
+        // like the PCL the color is packed into a float
+        names += " rgb";
+        sizes += " 4";
+        types += " F";
+        counts += " 1";
+        addField(fields, uint32, RGB, recordSize);
+    }
+
+    // the compressed data must not exceed the range of its 32 bit size
+    if (compressed && (double)count * recordSize > 4294967295.0)
+        return false;
+
+    out << "# .PCD v0.7 - Point Cloud Data file format" << '\n'
+        << "VERSION 0.7" << '\n'
+        << "FIELDS " << names << '\n'
+        << "SIZE " << sizes << '\n'
+        << "TYPE " << types << '\n'
+        << "COUNT " << counts << '\n'
+        << "WIDTH " << count << '\n'
+        << "HEIGHT 1" << '\n'
+        << "VIEWPOINT 0 0 0 1 0 0 0" << '\n'
+        << "POINTS " << count << '\n'
+        << "DATA " << (compressed ? "binary_compressed" : "binary") << '\n';
+
+    if (compressed) {
+        // the values of a field are stored one after another, this compresses much better
+        for (std::vector<Field>::iterator it = fields.begin(); it != fields.end(); ++it) {
+            it->offset *= count;
+            it->stride = it->size;
+        }
+        std::vector<char> data(count * recordSize + 1);
+        for (std::size_t i = 0; i < count; i++) {
+            Base::Vector3d pt = _kernel.getPoint(i);
+            encode(&data[0], i, fields, Base::Vector3f((float)pt.x, (float)pt.y, (float)pt.z),
+                   i, _greyValues, _normals, _colors);
+        }
+
+        std::size_t size = count * recordSize;
+        std::vector<char> buffer(size + size / 32 + 2);
+        uint32_t compressedSize = (uint32_t)lzfCompress((const unsigned char*)&data[0], size,
+                                                        (unsigned char*)&buffer[0]);
+        uint32_t uncompressedSize = (uint32_t)size;
+        out.write((const char*)&compressedSize, sizeof(uint32_t));
+        out.write((const char*)&uncompressedSize, sizeof(uint32_t));
+        out.write(&buffer[0], compressedSize);
+    }
+    else {
+        for (std::vector<Field>::iterator it = fields.begin(); it != fields.end(); ++it)
+            it->stride = recordSize;
+        std::size_t blockPoints = (1 << 22) / recordSize;
+        std::vector<char> buffer(blockPoints * recordSize);
+        for (std::size_t done = 0; done < count; ) {
+            std::size_t n = std::min<std::size_t>(blockPoints, count - done);
+            for (std::size_t i = 0; i < n; i++) {
+                Base::Vector3d pt = _kernel.getPoint(done + i);
+                encode(&buffer[0], i, fields, Base::Vector3f((float)pt.x, (float)pt.y, (float)pt.z),
+                       done + i, _greyValues, _normals, _colors);
+            }
+            out.write(&buffer[0], n * recordSize);
+            done += n;
+        }
+    }
+
+    return out.good();
+}
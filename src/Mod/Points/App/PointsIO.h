@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTS_POINTSIO_H
+#define POINTS_POINTSIO_H
+
+#include <iosfwd>
+#include <vector>
+
+#include "Points.h"
+#include <App/Material.h>
+
+namespace Points
+{
+
+/**
+ * The PointsInput class reads a point cloud and the grey values, normals and
+ * colors of its points from an input stream.
+ *
+ * The binary formats are read in blocks of points that are decoded directly into
+ * the point kernel, so the file itself never has to fit into memory. Only the data
+ * of compressed PCD files is decompressed as a whole. Points with an invalid
+ * coordinate are skipped and the lists of attributes the file doesn't have are
+ * left empty.
+ *
+ * The grey values are used as colors. So, like for ASCII files, intensities that
+ * are not all inside [0,1] are scaled linearly to this range with
+ * PointsAlgos::NormalizeGreyValues() and the raw values of the file are lost.
+ */
+class PointsExport PointsInput
+{
+public:
+    PointsInput (PointKernel &kernel, std::vector<float>* greyValues = 0,
+                 std::vector<Base::Vector3f>* normals = 0,
+                 std::vector<App::Color>* colors = 0);
+
+    /// Loads the file, decided by extension
+    bool LoadAny(const char* FileName);
+    /** Loads an ASCII or binary PLY file. Grey values are taken from an 'intensity'
+     * property, normals from 'nx', 'ny', 'nz' and colors from 'red', 'green', 'blue'.
+     */
+    bool LoadPLY (std::istream &rstrIn);
+    /** Loads a PCD file with ASCII, binary or compressed binary data. Grey values
+     * are taken from an 'intensity' field, normals from 'normal_x', 'normal_y',
+     * 'normal_z' and colors from an 'rgb' or 'rgba' field.
+     */
+    bool LoadPCD (std::istream &rstrIn);
+
+private:
+    void Clear();
+
+private:
+    PointKernel &_kernel;
+    std::vector<float>* _greyValues;
+    std::vector<Base::Vector3f>* _normals;
+    std::vector<App::Color>* _colors;
+};
+
+/**
+ * The PointsOutput class writes a point cloud and the grey values, normals and
+ * colors of its points to an output stream. The points are written with the
+ * transformation of the kernel. Attribute lists that don't have an entry for
+ * every point are ignored.
+ */
+class PointsExport PointsOutput
+{
+public:
+    PointsOutput (const PointKernel &kernel, const std::vector<float>* greyValues = 0,
+                  const std::vector<Base::Vector3f>* normals = 0,
+                  const std::vector<App::Color>* colors = 0);
+
+    /// Saves the file, decided by extension
+    bool SaveAny(const char* FileName) const;
+    /** Saves the points into a binary little endian PLY file. */
+    bool SaveBinaryPLY (std::ostream &rstrOut) const;
+    /** Saves the points into a PCD file with binary data. If \a compressed is true the
+     * data is compressed with LZF like the binary_compressed format of the PCL does.
+     */
+    bool SaveBinaryPCD (std::ostream &rstrOut, bool compressed = false) const;
+
+private:
+    const PointKernel &_kernel;
+    const std::vector<float>* _greyValues;
+    const std::vector<Base::Vector3f>* _normals;
+    const std::vector<App::Color>* _colors;
+};
+
+} // namespace Points
+
+#endif // POINTS_POINTSIO_H
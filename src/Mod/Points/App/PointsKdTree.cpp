@@ -0,0 +1,364 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <climits>
+# include <cfloat>
+#endif
+
+#include <QtConcurrentMap>
+
+#include "PointsKdTree.h"
+
+using namespace Points;
+
+namespace Points {
+struct PointsKdTree::Neighbour
+{
+  double fDist2;
+  unsigned long ulIndex;
+
+  bool operator < (const Neighbour &rclN) const
+  {
+    return fDist2 < rclN.fDist2;
+  }
+};
+
+struct PointsKdTree::Range
+{
+  const PointsKdTree* pclTree;
+  const std::vector<Base::Vector3d>* paclPts;
+  unsigned long ulBegin, ulEnd, ulCount;
+  unsigned long* pulIndices;
+  double* pfDistances;
+};
+}
+
+namespace {
+  const unsigned long MaxLeafSize = 8;
+
+  struct AxisLess
+  {
+    AxisLess (const std::vector<Base::Vector3d> &raclPts, int axis) : _raclPts(raclPts), _axis(axis) {}
+    bool operator () (unsigned long i, unsigned long j) const
+    {
+      return _raclPts[i][_axis] < _raclPts[j][_axis];
+    }
+    const std::vector<Base::Vector3d> &_raclPts;
+    unsigned short _axis;
+  };
+}
+
+PointsKdTree::PointsKdTree (void)
+  : _pclPoints(0), _ulCtElements(0)
+{
+}
+
+PointsKdTree::PointsKdTree (const PointKernel &rclM)
+  : _pclPoints(&rclM), _ulCtElements(0)
+{
+  Rebuild();
+}
+
+PointsKdTree::~PointsKdTree (void)
+{
+}
+
+void PointsKdTree::Attach (const PointKernel &rclM)
+{
+  _pclPoints = &rclM;
+  Rebuild();
+}
+
+void PointsKdTree::Detach (void)
+{
+  _pclPoints = 0;
+}
+
+void PointsKdTree::Validate (const PointKernel &rclM)
+{
+  if (_pclPoints != &rclM)
+    Attach(rclM);
+  else if (rclM.size() != _ulCtElements)
+    Rebuild();
+}
+
+void PointsKdTree::Clear (void)
+{
+  _aclNodes.clear();
+  _aclPoints.clear();
+  _aulPoints.clear();
+  _clBoundBox = Base::BoundBox3d();
+  _ulCtElements = 0;
+}
+
+Base::BoundBox3d PointsKdTree::GetBoundBox (void) const
+{
+  return _clBoundBox;
+}
+
+void PointsKdTree::Rebuild (void)
+{
+  Clear();
+  if (!_pclPoints)
+    return;
+
+  _ulCtElements = _pclPoints->size();
+  if (_ulCtElements == 0)
+    return;
+
+  // the points are sorted in the order of the leaves while building the tree
+  _aclPoints.reserve(_ulCtElements);
+  for (PointKernel::const_point_iterator it = _pclPoints->begin(); it != _pclPoints->end(); ++it) {
+    _aclPoints.push_back(*it);
+    _clBoundBox.Add(*it);
+  }
+
+  _aulPoints.resize(_ulCtElements);
+  for (unsigned long i = 0; i < _ulCtElements; i++)
+    _aulPoints[i] = i;
+  // a binary tree with at least half a leaf of points per leaf has less than 4n/MaxLeafSize nodes
+  _aclNodes.reserve(4 * (_ulCtElements / MaxLeafSize + 1));
+
+  BuildNode(_aulPoints, 0, _ulCtElements);
+
+  std::vector<Base::Vector3d> aclPoints(_ulCtElements);
+  for (unsigned long i = 0; i < _ulCtElements; i++)
+    aclPoints[i] = _aclPoints[_aulPoints[i]];
+  _aclPoints.swap(aclPoints);
+}
+
+void PointsKdTree::BuildNode (std::vector<unsigned long> &raulItems, unsigned long ulBegin, unsigned long ulEnd)
+{
+  unsigned long ulNode = _aclNodes.size();
+  _aclNodes.push_back(Node());
+
+  if (ulEnd - ulBegin <= MaxLeafSize) {
+    Node &rclNode = _aclNodes[ulNode];
+    rclNode.fSplit = 0.0;
+    rclNode.ulIndex = ulBegin;
+    rclNode.ulCount = ulEnd - ulBegin;
+    rclNode.iAxis = -1;
+    return;
+  }
+
+  // split at the median of the axis with the largest extent
+  Base::BoundBox3d clBox;
+  for (unsigned long i = ulBegin; i < ulEnd; i++)
+    clBox.Add(_aclPoints[raulItems[i]]);
+  int iAxis = 0;
+  if (clBox.LengthY() > clBox.LengthX())
+    iAxis = 1;
+  if (clBox.LengthZ() > std::max<double>(clBox.LengthX(), clBox.LengthY()))
+    iAxis = 2;
+
+  unsigned long ulMid = (ulBegin + ulEnd) / 2;
+  std::nth_element(raulItems.begin() + ulBegin, raulItems.begin() + ulMid, raulItems.begin() + ulEnd,
+                   AxisLess(_aclPoints, iAxis));
+
+  _aclNodes[ulNode].fSplit = _aclPoints[raulItems[ulMid]][iAxis];
+  _aclNodes[ulNode].ulCount = 0;
+  _aclNodes[ulNode].iAxis = iAxis;
+
+  BuildNode(raulItems, ulBegin, ulMid);
+  _aclNodes[ulNode].ulIndex = _aclNodes.size();
+  BuildNode(raulItems, ulMid, ulEnd);
+}
+
+unsigned long PointsKdTree::SearchNearest (const Base::Vector3d &rclPt) const
+{
+  double fDist;
+  return SearchNearest(rclPt, DBL_MAX, fDist);
+}
+
+unsigned long PointsKdTree::SearchNearest (const Base::Vector3d &rclPt, double fMaxDist, double &rfDist) const
+{
+  if (_aclNodes.empty())
+    return ULONG_MAX;
+
+  unsigned long ulIndex = ULONG_MAX;
+  double fDist2 = fMaxDist < DBL_MAX ? fMaxDist * fMaxDist : DBL_MAX;
+  SearchNearest(0, rclPt, ulIndex, fDist2);
+  if (ulIndex == ULONG_MAX)
+    return ULONG_MAX;
+
+  rfDist = sqrt(fDist2);
+  return _aulPoints[ulIndex];
+}
+
+void PointsKdTree::SearchNearest (unsigned long ulNode, const Base::Vector3d &rclPt,
+                                  unsigned long &rulIndex, double &rfDist2) const
+{
+  const Node &rclNode = _aclNodes[ulNode];
+  if (rclNode.iAxis < 0) {
+    for (unsigned long i = rclNode.ulIndex; i < rclNode.ulIndex + rclNode.ulCount; i++) {
+      double fDist2 = Base::DistanceP2(rclPt, _aclPoints[i]);
+      if (fDist2 <= rfDist2) {
+        rfDist2 = fDist2;
+        rulIndex = i;
+      }
+    }
+    return;
+  }
+
+  // visit the side of the point first, the other side only if it can contain a nearer point
+  double fDiff = rclPt[rclNode.iAxis] - rclNode.fSplit;
+  unsigned long ulNear = fDiff < 0.0 ? ulNode + 1 : rclNode.ulIndex;
+  unsigned long ulFar  = fDiff < 0.0 ? rclNode.ulIndex : ulNode + 1;
+  SearchNearest(ulNear, rclPt, rulIndex, rfDist2);
+  if (fDiff * fDiff <= rfDist2)
+    SearchNearest(ulFar, rclPt, rulIndex, rfDist2);
+}
+
+unsigned long PointsKdTree::SearchNearest (const Base::Vector3d &rclPt, unsigned long ulCount,
+                                           std::vector<unsigned long> &raulIndices,
+                                           std::vector<double> &rafDistances) const
+{
+  raulIndices.clear();
+  rafDistances.clear();
+  if (_aclNodes.empty() || ulCount == 0)
+    return 0;
+
+  // max-heap of the nearest points found so far
+  std::vector<Neighbour> aclHeap;
+  aclHeap.reserve(ulCount + 1);
+  SearchNearest(0, rclPt, ulCount, aclHeap);
+  std::sort_heap(aclHeap.begin(), aclHeap.end());
+
+  raulIndices.reserve(aclHeap.size());
+  rafDistances.reserve(aclHeap.size());
+  for (std::vector<Neighbour>::iterator it = aclHeap.begin(); it != aclHeap.end(); ++it) {
+    raulIndices.push_back(_aulPoints[it->ulIndex]);
+    rafDistances.push_back(sqrt(it->fDist2));
+  }
+
+  return raulIndices.size();
+}
+
+void PointsKdTree::SearchNearest (unsigned long ulNode, const Base::Vector3d &rclPt, unsigned long ulCount,
+                                  std::vector<Neighbour> &raclHeap) const
+{
+  const Node &rclNode = _aclNodes[ulNode];
+  if (rclNode.iAxis < 0) {
+    for (unsigned long i = rclNode.ulIndex; i < rclNode.ulIndex + rclNode.ulCount; i++) {
+      Neighbour clN;
+      clN.fDist2 = Base::DistanceP2(rclPt, _aclPoints[i]);
+      clN.ulIndex = i;
+      if (raclHeap.size() < ulCount) {
+        raclHeap.push_back(clN);
+        std::push_heap(raclHeap.begin(), raclHeap.end());
+      }
+      else if (clN.fDist2 < raclHeap.front().fDist2) {
+        std::pop_heap(raclHeap.begin(), raclHeap.end());
+        raclHeap.back() = clN;
+        std::push_heap(raclHeap.begin(), raclHeap.end());
+      }
+    }
+    return;
+  }
+
+  double fDiff = rclPt[rclNode.iAxis] - rclNode.fSplit;
+  unsigned long ulNear = fDiff < 0.0 ? ulNode + 1 : rclNode.ulIndex;
+  unsigned long ulFar  = fDiff < 0.0 ? rclNode.ulIndex : ulNode + 1;
+  SearchNearest(ulNear, rclPt, ulCount, raclHeap);
+  if (raclHeap.size() < ulCount || fDiff * fDiff < raclHeap.front().fDist2)
+    SearchNearest(ulFar, rclPt, ulCount, raclHeap);
+}
+
+unsigned long PointsKdTree::SearchRadius (const Base::Vector3d &rclPt, double fRadius,
+                                          std::vector<unsigned long> &raulIndices) const
+{
+  raulIndices.clear();
+  if (_aclNodes.empty() || fRadius < 0.0)
+    return 0;
+
+  SearchRadius(0, rclPt, fRadius * fRadius, raulIndices);
+  std::sort(raulIndices.begin(), raulIndices.end());
+  return raulIndices.size();
+}
+
+void PointsKdTree::SearchRadius (unsigned long ulNode, const Base::Vector3d &rclPt, double fRadius2,
+                                 std::vector<unsigned long> &raulIndices) const
+{
+  const Node &rclNode = _aclNodes[ulNode];
+  if (rclNode.iAxis < 0) {
+    for (unsigned long i = rclNode.ulIndex; i < rclNode.ulIndex + rclNode.ulCount; i++) {
+      if (Base::DistanceP2(rclPt, _aclPoints[i]) <= fRadius2)
+        raulIndices.push_back(_aulPoints[i]);
+    }
+    return;
+  }
+
+  double fDiff = rclPt[rclNode.iAxis] - rclNode.fSplit;
+  if (fDiff <= 0.0 || fDiff * fDiff <= fRadius2)
+    SearchRadius(ulNode + 1, rclPt, fRadius2, raulIndices);
+  if (fDiff >= 0.0 || fDiff * fDiff <= fRadius2)
+    SearchRadius(rclNode.ulIndex, rclPt, fRadius2, raulIndices);
+}
+
+void PointsKdTree::SearchNearest (const std::vector<Base::Vector3d> &raclPts, unsigned long ulCount,
+                                  std::vector<unsigned long> &raulIndices,
+                                  std::vector<double> &rafDistances) const
+{
+  raulIndices.clear();
+  rafDistances.clear();
+  if (ulCount == 0)
+    return;
+  raulIndices.resize(raclPts.size() * ulCount, ULONG_MAX);
+  rafDistances.resize(raclPts.size() * ulCount, DBL_MAX);
+  if (raclPts.empty())
+    return;
+
+  std::vector<Range> aclRanges;
+  const unsigned long ulBlockSize = 4096;
+  for (unsigned long i = 0; i < raclPts.size(); i += ulBlockSize) {
+    Range r;
+    r.pclTree = this;
+    r.paclPts = &raclPts;
+    r.ulBegin = i;
+    r.ulEnd = std::min<unsigned long>(i + ulBlockSize, raclPts.size());
+    r.ulCount = ulCount;
+    r.pulIndices = &(raulIndices[0]);
+    r.pfDistances = &(rafDistances[0]);
+    aclRanges.push_back(r);
+  }
+
+  if (aclRanges.size() > 1)
+    QtConcurrent::blockingMap(aclRanges, &PointsKdTree::SearchRange);
+  else
+    std::for_each(aclRanges.begin(), aclRanges.end(), &PointsKdTree::SearchRange);
+}
+
+void PointsKdTree::SearchRange (Range &rclRange)
+{
+  std::vector<unsigned long> aulIndices;
+  std::vector<double> afDistances;
+  for (unsigned long i = rclRange.ulBegin; i < rclRange.ulEnd; i++) {
+    rclRange.pclTree->SearchNearest((*rclRange.paclPts)[i], rclRange.ulCount, aulIndices, afDistances);
+    std::copy(aulIndices.begin(), aulIndices.end(), rclRange.pulIndices + i * rclRange.ulCount);
+    std::copy(afDistances.begin(), afDistances.end(), rclRange.pfDistances + i * rclRange.ulCount);
+  }
+}
@@ -0,0 +1,137 @@
+/***************************************************************************
+ *   Copyright (c) 2016 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTS_KDTREE_H
+#define POINTS_KDTREE_H
+
+#include <vector>
+
+#include "Points.h"
+#include <Base/Vector3D.h>
+#include <Base/BoundBox.h>
+
+namespace Points {
+
+/**
+ * The PointsKdTree is a k-d tree over the points of a point kernel to search for
+ * nearest neighbours.
+ *
+ * In contrast to the PointsGrid it adapts to the distribution of the points and
+ * doesn't need a search radius to be efficient. The tree keeps its own copy of the
+ * points in the order of its leaves, so that the points of a leaf are stored next
+ * to each other. Like PointKernel::getPoint() it works with the transformed points.
+ * All search methods are const and can be used from several threads at once.
+ */
+class PointsExport PointsKdTree
+{
+public:
+  /** @name Construction */
+  //@{
+  /// Construction
+  PointsKdTree (void);
+  /// Construction
+  PointsKdTree (const PointKernel &rclM);
+  /// Destruction
+  ~PointsKdTree (void);
+  //@}
+
+  /** Attaches the point kernel to this tree, an already attached point kernel gets detached.
+   * The tree gets rebuilt automatically. */
+  void Attach (const PointKernel &rclM);
+  /** Detaches the point kernel. The tree keeps its points and can still be searched, so it
+   * may outlive the kernel. */
+  void Detach (void);
+  /** Rebuilds the tree structure. */
+  void Rebuild (void);
+  /** Validates the tree structure and rebuilds it if needed. */
+  void Validate (const PointKernel &rclM);
+  /** Returns the number of points in the tree. */
+  unsigned long CountPoints (void) const
+  { return _aulPoints.size(); }
+  /** Returns the bounding box of all points. */
+  Base::BoundBox3d GetBoundBox (void) const;
+
+  /** @name Search */
+  //@{
+  /** Searches for the nearest point to \a rclPt. If the tree is empty ULONG_MAX is returned. */
+  unsigned long SearchNearest (const Base::Vector3d &rclPt) const;
+  /** Searches for the nearest point not farther away than \a fMaxDist from \a rclPt and returns
+   * its distance with \a rfDist. If there is no such point ULONG_MAX is returned. */
+  unsigned long SearchNearest (const Base::Vector3d &rclPt, double fMaxDist, double &rfDist) const;
+  /** Searches for the \a ulCount nearest points to \a rclPt. The indices and distances are
+   * sorted by increasing distance. Returns the number of found points. */
+  unsigned long SearchNearest (const Base::Vector3d &rclPt, unsigned long ulCount,
+                               std::vector<unsigned long> &raulIndices,
+                               std::vector<double> &rafDistances) const;
+  /** Searches for all points not farther away than \a fRadius from \a rclPt. The indices are
+   * sorted in ascending order. Returns the number of found points. */
+  unsigned long SearchRadius (const Base::Vector3d &rclPt, double fRadius,
+                              std::vector<unsigned long> &raulIndices) const;
+  /** Searches for the \a ulCount nearest points of every point of \a raclPts in parallel.
+   * For the i-th point the results are stored at the positions i*ulCount to (i+1)*ulCount-1
+   * of \a raulIndices and \a rafDistances. If less points are found the remaining indices
+   * are set to ULONG_MAX and the distances to DBL_MAX. */
+  void SearchNearest (const std::vector<Base::Vector3d> &raclPts, unsigned long ulCount,
+                      std::vector<unsigned long> &raulIndices,
+                      std::vector<double> &rafDistances) const;
+  //@}
+
+private:
+  /** A node of the tree. For inner nodes the left child directly follows its parent and
+   * \a ulIndex is the index of the right child. For leaves \a ulIndex is the position of
+   * the first point in _aclPoints and \a ulCount the number of points. */
+  struct Node
+  {
+    double fSplit;
+    unsigned long ulIndex;
+    unsigned long ulCount;
+    int iAxis;
+  };
+  struct Neighbour;
+  struct Range;
+
+  PointsKdTree (const PointsKdTree&);
+  void operator = (const PointsKdTree&);
+
+  void Clear (void);
+  void BuildNode (std::vector<unsigned long> &raulItems, unsigned long ulBegin, unsigned long ulEnd);
+  void SearchNearest (unsigned long ulNode, const Base::Vector3d &rclPt,
+                      unsigned long &rulIndex, double &rfDist2) const;
+  void SearchNearest (unsigned long ulNode, const Base::Vector3d &rclPt, unsigned long ulCount,
+                      std::vector<Neighbour> &raclHeap) const;
+  void SearchRadius (unsigned long ulNode, const Base::Vector3d &rclPt, double fRadius2,
+                     std::vector<unsigned long> &raulIndices) const;
+  static void SearchRange (Range &);
+
+private:
+  const PointKernel*            _pclPoints;    /**< The point kernel. */
+  unsigned long                 _ulCtElements; /**< Number of points for validation issues. */
+  std::vector<Node>             _aclNodes;     /**< Nodes of the tree in depth-first order. */
+  std::vector<Base::Vector3d>   _aclPoints;    /**< Points in the order of the leaves. */
+  std::vector<unsigned long>    _aulPoints;    /**< Kernel indices of the points in _aclPoints. */
+  Base::BoundBox3d              _clBoundBox;   /**< Bounding box of all points. */
+};
+
+} // namespace Points
+
+#endif // POINTS_KDTREE_H
@@ -24,6 +24,8 @@
 #include "PreCompiled.h"
 
 #include "Mod/Points/App/Points.h"
+#include "Mod/Points/App/PointsFilter.h"
+#include "Mod/Points/App/PointsKdTree.h"
 #include <Base/Builder3D.h>
 #include <Base/VectorPy.h>
 #include <Base/GeometryPyCXX.h>
@@ -31,9 +33,20 @@
 // inclusion of the generated files (generated out of PointsPy.xml)
 #include "PointsPy.h"
 #include "PointsPy.cpp"
+#include "KdTreePy.h"
 
 using namespace Points;
 
+namespace {
+    Py::List indexList(const std::vector<unsigned long>& indices)
+    {
+        Py::List list(indices.size());
+        for (std::size_t i = 0; i < indices.size(); i++)
+            list.setItem(i, Py::Int((long)indices[i]));
+        return list;
+    }
+}
+
 // returns a string which represents the object e.g. when printed in python
 std::string PointsPy::representation(void) const
 {
@@ -168,6 +181,132 @@ PyObject* PointsPy::addPoints(PyObject * args)
     Py_Return;
 }
 
+PyObject* PointsPy::nearestPoints(PyObject * args)
+{
+    // for many separate queries Points.KdTree avoids rebuilding the tree
+    PY_TRY {
+        PointsKdTree tree(*getPointKernelPtr());
+        return KdTreePy::searchNearest(tree, args);
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::pointsInRadius(PyObject * args)
+{
+    PY_TRY {
+        PointsKdTree tree(*getPointKernelPtr());
+        return KdTreePy::searchRadius(tree, args);
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::fromSegment(PyObject * args)
+{
+    PyObject *obj;
+    if (!PyArg_ParseTuple(args, "O", &obj))
+        return 0;
+
+    PY_TRY {
+        const PointKernel* points = getPointKernelPtr();
+        std::vector<unsigned long> indices;
+        Py::Sequence list(obj);
+        indices.reserve(list.size());
+        for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+            long index = (long)Py::Int(*it);
+            if (index < 0 || index >= (long)points->size()) {
+                PyErr_SetString(PyExc_IndexError, "point index out of range");
+                return 0;
+            }
+            indices.push_back(index);
+        }
+
+        PointKernel* kernel = new PointKernel();
+        PointsFilter::Extract(*points, indices, *kernel);
+        return new PointsPy(kernel);
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::voxelGrid(PyObject * args)
+{
+    double size;
+    if (!PyArg_ParseTuple(args, "d", &size))
+        return 0;
+
+    PY_TRY {
+        std::vector<unsigned long> indices;
+        PointsFilter(*getPointKernelPtr()).VoxelGrid(size, indices);
+        return Py::new_reference_to(indexList(indices));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::randomSample(PyObject * args)
+{
+    long count;
+    long seed = 0;
+    if (!PyArg_ParseTuple(args, "l|l", &count, &seed))
+        return 0;
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError, "number of points must not be negative");
+        return 0;
+    }
+
+    PY_TRY {
+        std::vector<unsigned long> indices;
+        PointsFilter(*getPointKernelPtr()).RandomSample(count, seed, indices);
+        return Py::new_reference_to(indexList(indices));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::poissonSample(PyObject * args)
+{
+    double radius;
+    long seed = 0;
+    PyObject *parallel=Py_True;
+    if (!PyArg_ParseTuple(args, "d|lO!", &radius, &seed, &PyBool_Type, &parallel))
+        return 0;
+
+    PY_TRY {
+        std::vector<unsigned long> indices;
+        PointsFilter(*getPointKernelPtr(), PyObject_IsTrue(parallel) ? true : false)
+            .PoissonSample(radius, seed, indices);
+        return Py::new_reference_to(indexList(indices));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::statisticalOutlierRemoval(PyObject * args)
+{
+    int k = 8;
+    double factor = 1.0;
+    if (!PyArg_ParseTuple(args, "|id", &k, &factor))
+        return 0;
+    if (k < 1) {
+        PyErr_SetString(PyExc_ValueError, "number of nearest points must be positive");
+        return 0;
+    }
+
+    PY_TRY {
+        std::vector<unsigned long> indices;
+        PointsFilter(*getPointKernelPtr()).StatisticalOutlierRemoval(k, factor, indices);
+        return Py::new_reference_to(indexList(indices));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::radiusOutlierRemoval(PyObject * args)
+{
+    double radius;
+    int minNeighbours;
+    if (!PyArg_ParseTuple(args, "di", &radius, &minNeighbours))
+        return 0;
+    if (minNeighbours < 0) {
+        PyErr_SetString(PyExc_ValueError, "number of neighbours must not be negative");
+        return 0;
+    }
+
+    PY_TRY {
+        std::vector<unsigned long> indices;
+        PointsFilter(*getPointKernelPtr()).RadiusOutlierRemoval(radius, minNeighbours, indices);
+        return Py::new_reference_to(indexList(indices));
+    } PY_CATCH;
+}
+
 Py::Int PointsPy::getCountPoints(void) const
 {
     return Py::Int((long)getPointKernelPtr()->size());
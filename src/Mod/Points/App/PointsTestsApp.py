@@ -0,0 +1,547 @@
+#   (c) FreeCAD Developers 2016      LGPL
+
+import FreeCAD, os, math, unittest, tempfile, random, itertools
+import Points
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD points module
+#---------------------------------------------------------------------------
+
+
+class PointsIOCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("PointsIO")
+        rand = random.Random(42)
+        self.points = [FreeCAD.Vector(rand.uniform(-100, 100), rand.uniform(-100, 100),
+                                      rand.uniform(-100, 100)) for i in range(500)]
+        self.intensity = [rand.uniform(0, 1) for i in range(500)]
+        self.normals = []
+        for i in range(500):
+            n = FreeCAD.Vector(rand.uniform(-1, 1), rand.uniform(-1, 1), rand.uniform(-1, 1) + 3)
+            self.normals.append(n.normalize())
+        # colors are stored with 8 bits per channel
+        self.colors = [(rand.randint(0, 255) / 255.0, rand.randint(0, 255) / 255.0,
+                        rand.randint(0, 255) / 255.0) for i in range(500)]
+        self.files = []
+
+    def fileName(self, ext):
+        name = tempfile.gettempdir() + os.sep + "PointsIO%d.%s" % (len(self.files), ext)
+        self.files.append(name)
+        return name
+
+    def addSource(self, intensity, normals, colors):
+        source = self.doc.addObject("Points::FeaturePython", "Source")
+        source.Points = Points.Points(self.points)
+        if intensity:
+            source.addProperty("Points::PropertyGreyValueList", "Intensity")
+            source.Intensity = self.intensity
+        if normals:
+            source.addProperty("Points::PropertyNormalList", "Normal")
+            source.Normal = self.normals
+        if colors:
+            source.addProperty("App::PropertyColorList", "Color")
+            source.Color = self.colors
+        return source
+
+    def export(self, sources, ext, format=""):
+        name = self.fileName(ext)
+        export = self.doc.addObject("Points::Export", "Export")
+        export.Sources = sources
+        export.FileName = name
+        export.Format = format
+        self.doc.recompute()
+        self.failUnless(export.State == ["Up-to-date"])
+        return name
+
+    def load(self, name):
+        count = len(self.doc.Objects)
+        Points.insert(name, self.doc.Name)
+        return self.doc.Objects[count]
+
+    def checkPoints(self, points, expected):
+        self.failUnless(len(points) == len(expected))
+        for p, q in zip(points, expected):
+            self.failUnless((FreeCAD.Vector(p) - q).Length < 1e-4)
+
+    def checkRoundTrip(self, ext, format=""):
+        for intensity, normals, colors in itertools.product((False, True), repeat=3):
+            source = self.addSource(intensity, normals, colors)
+            result = self.load(self.export([source], ext, format))
+            self.checkPoints(result.Points.Points, self.points)
+
+            self.failUnless(hasattr(result, "Intensity") == intensity)
+            if intensity:
+                for v, w in zip(result.Intensity, self.intensity):
+                    self.failUnless(abs(v - w) < 1e-6)
+            self.failUnless(hasattr(result, "Normal") == normals)
+            if normals:
+                for v, w in zip(result.Normal, self.normals):
+                    self.failUnless((FreeCAD.Vector(v) - w).Length < 1e-6)
+            self.failUnless(hasattr(result, "Color") == colors)
+            if colors:
+                for v, w in zip(result.Color, self.colors):
+                    for i in range(3):
+                        self.failUnless(abs(v[i] - w[i]) < 1e-3)
+
+    def testBinaryPLY(self):
+        self.checkRoundTrip("ply")
+
+    def testBinaryPCD(self):
+        self.checkRoundTrip("pcd")
+
+    def testBinaryCompressedPCD(self):
+        self.checkRoundTrip("pcd", "binary_compressed")
+
+    def testMergedSources(self):
+        # an attribute is only written if all sources have it
+        first = self.addSource(True, True, False)
+        second = self.addSource(True, False, True)
+        for ext in ("ply", "pcd"):
+            result = self.load(self.export([first, second], ext))
+            self.checkPoints(result.Points.Points, self.points + self.points)
+            self.failUnless(len(result.Intensity) == 2 * len(self.points))
+            self.failUnless(not hasattr(result, "Normal"))
+            self.failUnless(not hasattr(result, "Color"))
+
+    def testNormalizedIntensity(self):
+        # grey values outside [0,1] are scaled to this range when reading
+        source = self.addSource(True, False, False)
+        source.Intensity = [1000.0 * v + 500.0 for v in self.intensity]
+        low = min(self.intensity)
+        scale = max(self.intensity) - low
+        for ext in ("ply", "pcd"):
+            result = self.load(self.export([source], ext))
+            for v, w in zip(result.Intensity, self.intensity):
+                self.failUnless(abs(v - (w - low) / scale) < 1e-4)
+
+    def testKernel(self):
+        kernel = Points.Points(self.points)
+        for ext in ("ply", "pcd"):
+            name = self.fileName(ext)
+            kernel.write(name)
+            other = Points.Points()
+            other.read(name)
+            self.checkPoints(other.Points, self.points)
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.doc.Name)
+        for name in self.files:
+            if os.path.exists(name):
+                os.remove(name)
+
+
+class PointsAsciiCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("PointsAscii")
+        self.files = []
+
+    def writeFile(self, lines, newline="\n", ext="asc"):
+        name = tempfile.gettempdir() + os.sep + "PointsAscii%d.%s" % (len(self.files), ext)
+        self.files.append(name)
+        f = open(name, "wb")
+        f.write(newline.join(lines) + newline)
+        f.close()
+        return name
+
+    def read(self, lines, newline="\n"):
+        kernel = Points.Points()
+        kernel.read(self.writeFile(lines, newline))
+        return kernel.Points
+
+    def insert(self, lines):
+        count = len(self.doc.Objects)
+        Points.insert(self.writeFile(lines), self.doc.Name)
+        return self.doc.Objects[count]
+
+    def checkValue(self, value, expected):
+        self.failUnless(abs(value - expected) <= 1e-6 * max(1.0, abs(expected)), "%r != %r" % (value, expected))
+
+    def testNumbers(self):
+        points = self.read(["1.5e3 -2E-2 +3e+1",
+                            "12345678901234567890123 0.000000000000000000000123456789 -98765432109876543210.5",
+                            "007.50 -000.25 00012",
+                            ".5 -.25 5.",
+                            "1e-30 2.5E+30 0e12"])
+        expected = [(1500.0, -0.02, 30.0),
+                    (1.2345678901234567e22, 1.23456789e-22, -9.8765432109876543e19),
+                    (7.5, -0.25, 12.0),
+                    (0.5, -0.25, 5.0),
+                    (1e-30, 2.5e30, 0.0)]
+        self.failUnless(len(points) == len(expected))
+        for p, q in zip(points, expected):
+            for i in range(3):
+                self.checkValue(p[i], q[i])
+
+    def testSkippedLines(self):
+        lines = ["# a comment", "// another comment", "x y z", "",
+                 "1 2 3", "4,5,6", "7;8;9", "1 2", "10 11 12 # trailing text", "1 2 three",
+                 "  13\t14  15  "]
+        for newline in ("\n", "\r\n"):
+            points = self.read(lines, newline)
+            # only the used columns must be numbers
+            self.failUnless([tuple(p) for p in points] == [(1,2,3), (4,5,6), (7,8,9), (10,11,12), (13,14,15)])
+
+    def testBlocks(self):
+        # the file is read in blocks of 32 MB that are split at line ends into
+        # ranges of 1 MB, so lines are cut at the end of blocks and ranges
+        count = 700000
+        lines = []
+        for i in range(count):
+            if i % 1000 == 0:
+                lines.append("# comment line %d" % i)
+            lines.append("%d.25 %d.5 -%d.125 0.000000000100000000000 1.0000000000" % (i, i, i))
+        for newline in ("\n", "\r\n"):
+            points = self.read(lines, newline)
+            self.failUnless(len(points) == count)
+            for i in range(0, count, 997):
+                p = points[i]
+                self.failUnless(p.x == i + 0.25 and p.y == i + 0.5 and p.z == -(i + 0.125), "%d: %r" % (i, p))
+            del points
+
+    def checkFormat(self, lines, intensity, normals, colors):
+        result = self.insert(lines)
+        self.failUnless(len(result.Points.Points) == len(lines))
+        self.failUnless(hasattr(result, "Intensity") == intensity)
+        self.failUnless(hasattr(result, "Normal") == normals)
+        self.failUnless(hasattr(result, "Color") == colors)
+        return result
+
+    def testGuessFormat(self):
+        xyz = ["%d %d %d" % (i, 2 * i, 3 * i) for i in range(10)]
+        grey = [" %g" % (i / 10.0) for i in range(10)]
+        normal = [" %.6f 0.6 %.6f" % (0.8 * math.cos(0.1 * i), 0.8 * math.sin(0.1 * i)) for i in range(10)]
+        n3 = FreeCAD.Vector(0.8 * math.cos(0.3), 0.6, 0.8 * math.sin(0.3))
+        color = [" %d 128 255" % (10 * i) for i in range(10)]
+        join = lambda *cols: ["".join(t) for t in zip(*cols)]
+
+        self.checkFormat(xyz, False, False, False)
+        result = self.checkFormat(join(xyz, grey), True, False, False)
+        for v, i in zip(result.Intensity, range(10)):
+            self.checkValue(v, i / 10.0)
+        result = self.checkFormat(join(xyz, normal), False, True, False)
+        self.failUnless((FreeCAD.Vector(result.Normal[3]) - n3).Length < 1e-6)
+        result = self.checkFormat(join(xyz, color), False, False, True)
+        self.checkValue(result.Color[3][0], 30 / 255.0)
+        self.checkFormat(join(xyz, grey, normal), True, True, False)
+        self.checkFormat(join(xyz, grey, color), True, False, True)
+        self.checkFormat(join(xyz, normal, color), False, True, True)
+        result = self.checkFormat(join(xyz, color, normal), False, True, True)
+        self.checkValue(result.Color[3][0], 30 / 255.0)
+        self.failUnless((FreeCAD.Vector(result.Normal[3]) - n3).Length < 1e-6)
+        self.checkFormat(join(xyz, grey, normal, color), True, True, True)
+
+        # three columns with only 0 and 1 are normals, not colors
+        self.checkFormat(join(xyz, [" 0 0 1"] * 10), False, True, False)
+
+        # floats in [0,1] that are not of unit length are colors
+        fcolor = [" %.1f 0.5 0.25" % (i / 10.0) for i in range(10)]
+        result = self.checkFormat(join(xyz, fcolor), False, False, True)
+        self.checkValue(result.Color[3][0], 0.3)
+        self.checkValue(result.Color[3][2], 0.25)
+        result = self.checkFormat(join(xyz, normal, fcolor), False, True, True)
+        self.checkValue(result.Color[3][0], 0.3)
+        result = self.checkFormat(join(xyz, fcolor, normal), False, True, True)
+        self.failUnless((FreeCAD.Vector(result.Normal[3]) - n3).Length < 1e-6)
+
+    def testImportAscii(self):
+        lines = ["x;y;z", "unit: mm"] + ["%d;%d;%d;%d" % (i, 2 * i, 3 * i, 4 * i) for i in range(10)]
+        feature = self.doc.addObject("Points::ImportAscii", "Import")
+        feature.FileName = self.writeFile(lines, ext="csv")
+        feature.Columns = [3, 1, 0]
+        feature.Separator = ";"
+        feature.SkipLines = 2
+        self.doc.recompute()
+        self.failUnless(feature.State == ["Up-to-date"])
+        points = feature.Points.Points
+        self.failUnless([tuple(p) for p in points] == [(4 * i, 2 * i, i) for i in range(10)])
+
+        # two columns are not enough
+        feature.Columns = [0, 1]
+        self.doc.recompute()
+        self.failUnless("Invalid" in feature.State)
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.doc.Name)
+        for name in self.files:
+            if os.path.exists(name):
+                os.remove(name)
+
+
+class PointsKdTreeCases(unittest.TestCase):
+    def setUp(self):
+        # a lattice has many points at the same distance, some points are duplicated
+        self.points = [FreeCAD.Vector(x, y, z) for x in range(8) for y in range(8) for z in range(4)]
+        self.points += self.points[::7]
+        rand = random.Random(7)
+        self.points += [FreeCAD.Vector(rand.uniform(0, 7), rand.uniform(0, 7), rand.uniform(0, 3)) for i in range(200)]
+        self.kernel = Points.Points(self.points)
+        self.queries = [FreeCAD.Vector(3.5, 3.5, 1.5), FreeCAD.Vector(2, 2, 2), FreeCAD.Vector(0.5, 0, 0),
+                        FreeCAD.Vector(-3, 10, 1)]
+        self.queries += [FreeCAD.Vector(rand.uniform(-2, 9), rand.uniform(-2, 9), rand.uniform(-2, 5)) for i in range(50)]
+
+    def bruteForce(self, query):
+        return sorted([((p - query).Length, i) for i, p in enumerate(self.points)])
+
+    def checkNearest(self, query, result, k):
+        brute = self.bruteForce(query)
+        self.failUnless(len(result) == min(k, len(self.points)))
+        indices = [i for i, d in result]
+        self.failUnless(len(set(indices)) == len(indices))
+        for (i, d), (e, j) in zip(result, brute):
+            # with ties any of the equally near points may be returned
+            self.failUnless(abs(d - e) < 1e-9)
+            self.failUnless(abs((self.points[i] - query).Length - d) < 1e-9)
+        if result:
+            # all points nearer than the last one must be found
+            last = result[-1][1]
+            nearer = set([j for e, j in brute if e < last - 1e-9])
+            self.failUnless(nearer.issubset(set(indices)))
+
+    def testNearestPoints(self):
+        for k in (1, 6, 27, 100):
+            for query in self.queries:
+                self.checkNearest(query, self.kernel.nearestPoints(query, k), k)
+
+    def testNearestPointsList(self):
+        # more neighbours than points
+        k = len(self.points) + 10
+        results = self.kernel.nearestPoints(self.queries[:5], k)
+        self.failUnless(len(results) == 5)
+        for query, result in zip(self.queries[:5], results):
+            self.checkNearest(query, result, k)
+        results = self.kernel.nearestPoints([tuple(q) for q in self.queries], 8)
+        for query, result in zip(self.queries, results):
+            self.checkNearest(query, result, 8)
+
+        # enough queries to be processed by several threads
+        rand = random.Random(11)
+        queries = [FreeCAD.Vector(rand.uniform(-2, 9), rand.uniform(-2, 9), rand.uniform(-2, 5)) for i in range(10000)]
+        results = self.kernel.nearestPoints(queries, 3)
+        self.failUnless(len(results) == len(queries))
+        for i in range(0, len(queries), 97):
+            self.checkNearest(queries[i], results[i], 3)
+
+    def testPointsInRadius(self):
+        for radius in (0.0, 0.5, 1.0, math.sqrt(2.0), 2.5):
+            for query in self.queries[:3] + self.queries[10:20]:
+                result = self.kernel.pointsInRadius(query, radius)
+                # points on the sphere are included
+                brute = [i for i, p in enumerate(self.points) if (p - query).Length <= radius + 1e-9]
+                self.failUnless(result == brute, "radius %g, %r" % (radius, query))
+
+    def testEmptyKernel(self):
+        kernel = Points.Points()
+        self.failUnless(kernel.nearestPoints(FreeCAD.Vector(1, 2, 3), 5) == [])
+        self.failUnless(kernel.nearestPoints([FreeCAD.Vector(1, 2, 3)] * 3, 5) == [[], [], []])
+        self.failUnless(kernel.pointsInRadius(FreeCAD.Vector(1, 2, 3), 10.0) == [])
+        tree = Points.KdTree(kernel)
+        self.failUnless(tree.CountPoints == 0)
+        self.failUnless(tree.nearestPoints(FreeCAD.Vector(1, 2, 3), 5) == [])
+
+    def testKdTree(self):
+        tree = Points.KdTree(self.kernel)
+        self.failUnless(tree.CountPoints == len(self.points))
+        nearest = self.kernel.nearestPoints(self.queries, 6)
+        inRadius = [self.kernel.pointsInRadius(q, 1.5) for q in self.queries]
+        for query, result in zip(self.queries, tree.nearestPoints(self.queries, 6)):
+            self.checkNearest(query, result, 6)
+        for query, result in zip(self.queries, nearest):
+            self.failUnless(tree.nearestPoints(query, 6) == result)
+        for query, result in zip(self.queries, inRadius):
+            self.failUnless(tree.pointsInRadius(query, 1.5) == result)
+        self.failUnlessRaises(ValueError, tree.nearestPoints, self.queries[0], 0)
+        self.failUnlessRaises(TypeError, Points.KdTree, self.points)
+
+        # the tree keeps its points when the kernel changes or is gone
+        self.kernel.addPoints([self.queries[0]])
+        del self.kernel
+        self.failUnless(tree.CountPoints == len(self.points))
+        for query, result in zip(self.queries, nearest):
+            self.failUnless(tree.nearestPoints(query, 6) == result)
+
+
+class PointsFilterCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("PointsFilter")
+        # the coordinates are multiples of 1/8 so that they are exact as floats and the cells
+        # of a point are the same here and in the filters
+        rand = random.Random(5)
+        self.points = [FreeCAD.Vector(rand.randint(0, 160) / 8.0, rand.randint(0, 160) / 8.0,
+                                      rand.randint(0, 40) / 8.0) for i in range(3000)]
+        self.kernel = Points.Points(self.points)
+
+    def cells(self, points, size):
+        origin = FreeCAD.Vector(min([p.x for p in points]), min([p.y for p in points]),
+                                min([p.z for p in points]))
+        cells = {}
+        for i, p in enumerate(points):
+            key = (int((p.x - origin.x) / size), int((p.y - origin.y) / size), int((p.z - origin.z) / size))
+            cells.setdefault(key, []).append(i)
+        return cells
+
+    def checkSorted(self, indices, count):
+        self.failUnless(len(indices) == len(set(indices)))
+        self.failUnless(indices == sorted(indices))
+        self.failUnless(len(indices) == 0 or (indices[0] >= 0 and indices[-1] < count))
+
+    def testVoxelGrid(self):
+        for size in (0.5, 1.0, 2.5):
+            indices = self.kernel.voxelGrid(size)
+            self.checkSorted(indices, len(self.points))
+            cells = self.cells(self.points, size)
+            # exactly one point of every cell that contains points
+            self.failUnless(len(indices) == len(cells), "size %g" % size)
+            kept = set(indices)
+            for key, members in cells.items():
+                found = [i for i in members if i in kept]
+                self.failUnless(len(found) == 1, "size %g, cell %r" % (size, key))
+                # the kept point is the one next to the centroid of the cell
+                center = FreeCAD.Vector()
+                for i in members:
+                    center = center + self.points[i]
+                center = center * (1.0 / len(members))
+                dist = min([(self.points[i] - center).Length for i in members])
+                self.failUnless(abs((self.points[found[0]] - center).Length - dist) < 1e-9)
+
+    def testRandomSample(self):
+        for count in (0, 1, 17, 1000, 2999):
+            indices = self.kernel.randomSample(count, 3)
+            self.failUnless(len(indices) == count)
+            self.checkSorted(indices, len(self.points))
+            self.failUnless(indices == self.kernel.randomSample(count, 3))
+        self.failUnless(self.kernel.randomSample(1000, 3) != self.kernel.randomSample(1000, 4))
+        # all points are kept if there are not more than requested
+        self.failUnless(self.kernel.randomSample(3000) == range(3000))
+        self.failUnless(self.kernel.randomSample(5000) == range(3000))
+        self.failUnless(Points.Points().randomSample(10) == [])
+
+    def checkPoisson(self, points, indices, radius):
+        self.checkSorted(indices, len(points))
+        kept = Points.Points([points[i] for i in indices])
+        # no two kept points are closer than the radius
+        for i in range(len(indices)):
+            self.failUnless(kept.pointsInRadius(points[indices[i]], radius * 0.999) == [i])
+        # every other point is closer than the radius to a kept point
+        for i in range(0, len(points), 7):
+            self.failUnless(len(kept.pointsInRadius(points[i], radius)) > 0)
+
+    def testPoissonSample(self):
+        for radius in (0.5, 1.0, 3.0):
+            indices = self.kernel.poissonSample(radius, 9)
+            self.checkPoisson(self.points, indices, radius)
+            self.failUnless(indices == self.kernel.poissonSample(radius, 9))
+            self.failUnless(indices == self.kernel.poissonSample(radius, 9, False))
+
+    def testPoissonSampleThreads(self):
+        # enough points and cells to sort and sample them on several threads
+        rand = random.Random(8)
+        points = [FreeCAD.Vector(rand.uniform(0, 100), rand.uniform(0, 100), rand.uniform(0, 10))
+                  for i in range(150000)]
+        kernel = Points.Points(points)
+        indices = kernel.poissonSample(0.5, 2)
+        self.failUnless(len(indices) > 50000)
+        # the result doesn't depend on the number of threads
+        self.failUnless(indices == kernel.poissonSample(0.5, 2, False))
+        self.failUnless(indices == kernel.poissonSample(0.5, 2))
+        self.failUnless(indices != kernel.poissonSample(0.5, 3))
+        sample = random.Random(1).sample(indices, 2000)
+        kept = Points.Points([points[i] for i in indices])
+        for i in sample:
+            self.failUnless(len(kept.pointsInRadius(points[i], 0.499)) == 1)
+
+    def cluster(self):
+        # a dense cube of points with isolated points and an isolated pair around it, the
+        # second list tells which points belong to the cube (0), the pair (1) or are alone (2).
+        # Like above all coordinates are multiples of 1/8.
+        points = [FreeCAD.Vector(x * 0.5, y * 0.5, z * 0.5)
+                  for x in range(10) for y in range(10) for z in range(10)]
+        kinds = [0] * len(points)
+        stray = []
+        for i in range(10):
+            a = 2.0 * math.pi * i / 10
+            stray.append((FreeCAD.Vector(round(800.0 * math.cos(a)) / 8.0 + 2.25,
+                                         round(800.0 * math.sin(a)) / 8.0 + 2.25,
+                                         2.25 + 10.0 * i), 2))
+        stray.append((FreeCAD.Vector(2.25, 2.25, -60.0), 1))
+        stray.append((FreeCAD.Vector(2.25, 2.25, -60.5), 1))
+        rand = random.Random(3)
+        for p, k in stray:
+            pos = rand.randint(0, len(points))
+            points.insert(pos, p)
+            kinds.insert(pos, k)
+        return points, kinds
+
+    def testOutlierRemoval(self):
+        points, kinds = self.cluster()
+        kernel = Points.Points(points)
+        cube = [i for i, k in enumerate(kinds) if k == 0]
+        pair = [i for i, k in enumerate(kinds) if k <= 1]
+        self.failUnless(kernel.statisticalOutlierRemoval(8, 1.0) == cube)
+        self.failUnless(kernel.radiusOutlierRemoval(1.0, 2) == cube)
+        self.failUnless(kernel.radiusOutlierRemoval(1.0, 1) == pair)
+        self.failUnless(kernel.radiusOutlierRemoval(1.0, 0) == range(len(points)))
+
+    def testFilterAttributes(self):
+        points, kinds = self.cluster()
+        count = len(points)
+        # the values are exact as floats and unique for every point
+        intensity = [i / 1024.0 for i in range(count)]
+        normals = [FreeCAD.Vector(i % 7, i // 7, 1) for i in range(count)]
+        colors = [((i % 256) / 255.0, (i // 256) / 255.0, 0.0) for i in range(count)]
+        source = self.doc.addObject("Points::FeaturePython", "Source")
+        source.Points = Points.Points(points)
+        source.addProperty("Points::PropertyGreyValueList", "Intensity")
+        source.Intensity = intensity
+        source.addProperty("Points::PropertyNormalList", "Normal")
+        source.Normal = normals
+        source.addProperty("App::PropertyColorList", "Color")
+        source.Color = colors
+        statistical = self.doc.addObject("Points::StatisticalOutlierRemoval", "Statistical")
+        statistical.Source = source
+        radius = self.doc.addObject("Points::RadiusOutlierRemoval", "Radius")
+        radius.Source = source
+        radius.Radius = 1.0
+        radius.MinNeighbours = 1
+        self.doc.recompute()
+        for feature, indices in ((statistical, [i for i, k in enumerate(kinds) if k == 0]),
+                                 (radius, [i for i, k in enumerate(kinds) if k <= 1])):
+            self.failUnless(feature.Points.Points == [points[i] for i in indices], feature.Name)
+            self.failUnless(list(feature.Intensity) == [intensity[i] for i in indices], feature.Name)
+            self.failUnless(list(feature.Normal) == [normals[i] for i in indices], feature.Name)
+            self.failUnless(len(feature.Color) == len(indices), feature.Name)
+            for c, i in zip(feature.Color, indices):
+                for v, w in zip(c, colors[i]):
+                    self.failUnless(abs(v - w) < 1e-6, feature.Name)
+
+    def testFeatures(self):
+        source = self.doc.addObject("Points::Feature", "Source")
+        source.Points = self.kernel
+        voxel = self.doc.addObject("Points::VoxelGrid", "VoxelGrid")
+        voxel.Source = source
+        voxel.VoxelSize = 1.0
+        sample = self.doc.addObject("Points::RandomSample", "RandomSample")
+        sample.Source = source
+        sample.Count = 100
+        sample.Seed = 4
+        poisson = self.doc.addObject("Points::PoissonSample", "PoissonSample")
+        poisson.Source = source
+        poisson.Radius = 1.5
+        poisson.Seed = 6
+        self.doc.recompute()
+        for feature, indices in ((voxel, self.kernel.voxelGrid(1.0)),
+                                 (sample, self.kernel.randomSample(100, 4)),
+                                 (poisson, self.kernel.poissonSample(1.5, 6))):
+            self.failUnless(feature.Points.Points == [self.points[i] for i in indices], feature.Name)
+
+        # the lengths can't become zero
+        voxel.VoxelSize = 0.0
+        poisson.Radius = 0.0
+        outlier = self.doc.addObject("Points::RadiusOutlierRemoval", "RadiusOutlierRemoval")
+        outlier.Radius = -1.0
+        self.failUnless(voxel.VoxelSize > 0.0)
+        self.failUnless(poisson.Radius > 0.0)
+        self.failUnless(outlier.Radius > 0.0)
+
+    def tearDown(self):
+        FreeCAD.closeDocument("PointsFilter")
@@ -46,6 +46,7 @@
 // standard
 #include <stdio.h>
 #include <assert.h>
+#include <string.h>
 
 // STL
 #include <algorithm>
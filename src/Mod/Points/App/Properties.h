@@ -85,6 +85,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
     
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
     
     virtual App::Property *Copy(void) const;
@@ -135,6 +136,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
 
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
 
     virtual App::Property *Copy(void) const;
@@ -195,6 +197,7 @@ public:
     void Restore(Base::XMLReader &reader);
 
     void SaveDocFile (Base::Writer &writer) const;
+    bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     void RestoreDocFile(Base::Reader &reader);
     //@}
 
@@ -31,6 +31,7 @@
 
 #include <Base/Exception.h>
 #include <Base/Matrix.h>
+#include <Base/Reader.h>
 #include <Base/Stream.h>
 #include <Base/Writer.h>
 
@@ -53,6 +54,7 @@ PropertyPointKernel::~PropertyPointKernel()
 
 void PropertyPointKernel::setValue(const PointKernel& m)
 {
+    loadDeferred();
     aboutToSetValue();
     *_cPoints = m;
     hasSetValue();
@@ -60,16 +62,19 @@ void PropertyPointKernel::setValue(const PointKernel& m)
 
 const PointKernel& PropertyPointKernel::getValue(void) const 
 {
+    loadDeferred();
     return *_cPoints;
 }
 
 const Data::ComplexGeoData* PropertyPointKernel::getComplexData() const
 {
+    loadDeferred();
     return _cPoints;
 }
 
 Base::BoundBox3d PropertyPointKernel::getBoundingBox() const
 {
+    loadDeferred();
     Base::BoundBox3d box;
     for (PointKernel::const_iterator it = _cPoints->begin(); it != _cPoints->end(); ++it)
         box.Add(*it);
@@ -80,11 +85,13 @@ void PropertyPointKernel::getFaces(std::vector<Base::Vector3d> &Points,
                                    std::vector<Data::ComplexGeoData::Facet> &Topo,
                                    float Accuracy, uint16_t flags) const
 {
+    loadDeferred();
     _cPoints->getFaces(Points, Topo, Accuracy, flags);
 }
 
 PyObject *PropertyPointKernel::getPyObject(void)
 {
+    loadDeferred();
     PointsPy* points = new PointsPy(&*_cPoints);
     points->setConst(); // set immutable
     return points;
@@ -105,6 +112,7 @@ void PropertyPointKernel::setPyObject(PyObject *value)
 
 void PropertyPointKernel::Save (Base::Writer &writer) const
 {
+    loadDeferred();
     _cPoints->Save(writer);
 }
 
@@ -137,12 +145,33 @@ void PropertyPointKernel::SaveDocFile (Base::Writer &writer) const
 void PropertyPointKernel::RestoreDocFile(Base::Reader &reader)
 {
     aboutToSetValue();
+    _deferredFile = 0;
     _cPoints->RestoreDocFile(reader);
     hasSetValue();
 }
 
+bool PropertyPointKernel::deferRestoreDocFile(Base::DeferredFile* file)
+{
+    // Do not notify observers because they would access the data immediately.
+    // The transformation has already been restored from the XML part.
+    _deferredFile = file;
+    return true;
+}
+
+void PropertyPointKernel::restoreDeferredDocFile(Base::Reader &reader)
+{
+    _cPoints->RestoreDocFile(reader);
+}
+
+void PropertyPointKernel::loadDeferred() const
+{
+    if (_deferredFile.isValid())
+        _deferredFile->restore(const_cast<PropertyPointKernel*>(this));
+}
+
 App::Property *PropertyPointKernel::Copy(void) const 
 {
+    loadDeferred();
     PropertyPointKernel* prop = new PropertyPointKernel();
     (*prop->_cPoints) = (*this->_cPoints);
     return prop;
@@ -150,8 +179,10 @@ App::Property *PropertyPointKernel::Copy(void) const
 
 void PropertyPointKernel::Paste(const App::Property &from)
 {
+    loadDeferred();
     aboutToSetValue();
     const PropertyPointKernel& prop = dynamic_cast<const PropertyPointKernel&>(from);
+    prop.loadDeferred();
     *(this->_cPoints) = *(prop._cPoints);
     hasSetValue();
 }
@@ -163,6 +194,7 @@ unsigned int PropertyPointKernel::getMemSize (void) const
 
 void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndices )
 {
+    loadDeferred();
     // We need a sorted array
     std::vector<unsigned long> uSortedInds = uIndices;
     std::sort(uSortedInds.begin(), uSortedInds.end());
@@ -191,6 +223,7 @@ void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndi
 
 void PropertyPointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    loadDeferred();
     aboutToSetValue();
     _cPoints->transformGeometry(rclMat);
     hasSetValue();
@@ -26,6 +26,10 @@
 
 #include "Points.h"
 
+namespace Base {
+class DeferredFile;
+}
+
 namespace Points
 {
 
@@ -78,7 +82,10 @@ public:
     void Save (Base::Writer &writer) const;
     void Restore(Base::XMLReader &reader);
     void SaveDocFile (Base::Writer &writer) const;
+    bool isSaveDocFileThreadSafe (const Base::Writer &) const { return true; }
     void RestoreDocFile(Base::Reader &reader);
+    bool deferRestoreDocFile(Base::DeferredFile* file);
+    void restoreDeferredDocFile(Base::Reader &reader);
     //@}
 
     /** @name Modification */
@@ -88,8 +95,13 @@ public:
     void removeIndices( const std::vector<unsigned long>& );
     //@}
 
+private:
+    /// reads in the points if their restore has been deferred
+    void loadDeferred() const;
+
 private:
     Base::Reference<PointKernel> _cPoints;
+    Base::Reference<Base::DeferredFile> _deferredFile;
 };
 
 } // namespace Points
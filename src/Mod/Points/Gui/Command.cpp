@@ -69,7 +69,7 @@ CmdPointsImport::CmdPointsImport()
 void CmdPointsImport::activated(int iMsg)
 {
   QString fn = Gui::FileDialog::getOpenFileName(Gui::getMainWindow(),
-      QString::null, QString(), QObject::tr("Ascii Points (*.asc);;All Files (*.*)"));
+      QString::null, QString(), QObject::tr("Point formats (*.asc *.xyz *.csv *.pts *.ply *.pcd);;All Files (*.*)"));
   if ( fn.isEmpty() )
     return;
 
@@ -112,7 +112,7 @@ CmdPointsExport::CmdPointsExport()
 void CmdPointsExport::activated(int iMsg)
 {
   QString fn = Gui::FileDialog::getSaveFileName(Gui::getMainWindow(),
-      QString::null, QString(), QObject::tr("Ascii Points (*.asc);;All Files (*.*)"));
+      QString::null, QString(), QObject::tr("Ascii Points (*.asc);;PLY points (*.ply);;PCD points (*.pcd);;All Files (*.*)"));
   if ( fn.isEmpty() )
     return;
 
@@ -28,5 +28,6 @@
 
 
 # Append the open handler
-FreeCAD.addImportType("Point formats (*.asc)","Points")
+FreeCAD.addImportType("Point formats (*.asc *.xyz *.csv *.pts)","Points")
 FreeCAD.addImportType("PLY points (*.ply)","Points")
+FreeCAD.addImportType("PCD points (*.pcd)","Points")
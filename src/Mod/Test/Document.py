@@ -246,11 +246,122 @@ class DocumentRecomputeCases(unittest.TestCase):
     self.L1.Link = self.L2
     self.L2.Link = self.L3
 
+  def testRecomputeStats(self):
+    self.Doc.RecomputeProfiling = True
+    self.L1.Link = self.L2
+    self.L2.Link = self.L3
+    self.Doc.recompute()
+    names = [s["Name"] for s in self.Doc.getRecomputeStats()]
+    self.failUnless("Label_1" in names and "Label_2" in names)
+    self.failUnless(names.index("Label_2") < names.index("Label_1"))
+    self.failUnless(self.Doc.exportRecomputeTrace().startswith('{"traceEvents":['))
+    self.Doc.RecomputeProfiling = False
+
+  def testRecomputeTraceFile(self):
+    self.Doc.RecomputeProfiling = True
+    self.L1.Link = self.L2
+    self.Doc.recompute()
+    self.Doc.RecomputeProfiling = False
+    FileName = tempfile.gettempdir() + os.sep + "RecomputeTrace.json"
+    self.Doc.exportRecomputeTrace(FileName)
+    trace = open(FileName).read()
+    os.remove(FileName)
+    self.failUnless(trace == self.Doc.exportRecomputeTrace())
+    # the directory doesn't exist
+    FileName = tempfile.gettempdir() + os.sep + "NoSuchDirectory" + os.sep + "RecomputeTrace.json"
+    self.failUnlessRaises(IOError, self.Doc.exportRecomputeTrace, FileName)
+
+  def testIncrementalGraph(self):
+    self.L1.Link = self.L2
+    self.L2.Link = self.L3
+    self.Doc.recompute()
+    self.failUnless([o.ExecCount for o in (self.L1, self.L2, self.L3)] == [1, 1, 1])
+    # reversed links would form a cycle with an outdated edge
+    self.L2.Link = None
+    self.L3.Link = self.L2
+    self.Doc.recompute()
+    self.failUnless([o.ExecCount for o in (self.L1, self.L2, self.L3)] == [2, 2, 2])
+    # a removed dynamic link must not stay in the graph
+    Obj = self.Doc.addObject("App::FeaturePython","Dynamic")
+    Obj.addProperty("App::PropertyLink","Source")
+    Obj.Source = self.L1
+    self.Doc.recompute()
+    Obj.removeProperty("Source")
+    self.L1.Link = Obj
+    self.Doc.recompute()
+    self.failUnless(self.L1.ExecCount == 3)
+    self.failIf("Touched" in self.L1.State)
+
+  def testDownstreamRecompute(self):
+    self.L1.Link = self.L2
+    self.Doc.recompute()
+    self.failUnless([o.ExecCount for o in (self.L1, self.L2, self.L3)] == [1, 1, 1])
+    # only the touched object and the objects depending on it are recomputed
+    self.L2.touch()
+    self.Doc.recompute()
+    self.failUnless([o.ExecCount for o in (self.L1, self.L2, self.L3)] == [2, 2, 1])
+    self.L1.touch()
+    self.Doc.recompute()
+    self.failUnless([o.ExecCount for o in (self.L1, self.L2, self.L3)] == [3, 2, 1])
 
   def tearDown(self):
     #closing doc
     FreeCAD.closeDocument("RecomputeTests")
 
+class DocumentParallelRecomputeCases(unittest.TestCase):
+  def setUp(self):
+    self.grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+    self.parallel = self.grp.GetBool("ParallelRecompute", False)
+    self.grp.SetBool("ParallelRecompute", True)
+    self.Doc = FreeCAD.newDocument("ParallelRecomputeTests")
+    # a diamond: Top depends on Left and Right which both depend on Base
+    self.Base = self.Doc.addObject("App::FeatureTest","Base")
+    self.Left = self.Doc.addObject("App::FeatureTest","Left")
+    self.Right = self.Doc.addObject("App::FeatureTest","Right")
+    self.Top = self.Doc.addObject("App::FeatureTest","Top")
+    self.Left.Link = self.Base
+    self.Right.Link = self.Base
+    self.Top.LinkList = [self.Left, self.Right]
+
+  def testDiamond(self):
+    self.Doc.RecomputeProfiling = True
+    self.Doc.recompute()
+    for obj in (self.Base, self.Left, self.Right, self.Top):
+      self.failUnless(obj.ExecCount == 1)
+      self.failUnless(obj.State == ["Up-to-date"])
+    names = [s["Name"] for s in self.Doc.getRecomputeStats()]
+    self.failUnless(names.index("Base") < names.index("Left"))
+    self.failUnless(names.index("Base") < names.index("Right"))
+    self.failUnless(names.index("Left") < names.index("Top"))
+    self.failUnless(names.index("Right") < names.index("Top"))
+    self.Doc.RecomputeProfiling = False
+
+    # only the touched object and the objects depending on it are recomputed
+    self.Right.Integer = 2
+    self.Doc.recompute()
+    self.failUnless([o.ExecCount for o in (self.Base, self.Left, self.Right, self.Top)] == [1, 1, 2, 2])
+
+  def testAbort(self):
+    # Left throws an unknown exception which aborts the recompute
+    self.Left.ExceptionType = 1
+    self.Doc.recompute()
+    self.failUnless(self.Base.ExecCount == 1)
+    self.failUnless(self.Left.ExecCount == 0)
+    self.failUnless("Invalid" in self.Left.State)
+    self.failUnless(self.Top.ExecCount == 0)
+
+    # after fixing the error the recompute completes
+    self.Left.ExceptionType = 0
+    self.Doc.recompute()
+    self.failUnless(self.Left.ExecCount == 1)
+    self.failUnless(self.Top.ExecCount == 1)
+    for obj in (self.Base, self.Left, self.Right, self.Top):
+      self.failUnless(obj.State == ["Up-to-date"])
+
+  def tearDown(self):
+    FreeCAD.closeDocument("ParallelRecomputeTests")
+    self.grp.SetBool("ParallelRecompute", self.parallel)
+
 class UndoRedoCases(unittest.TestCase):
   def setUp(self):
     self.Doc = FreeCAD.newDocument("UndoTest")
@@ -46,6 +46,8 @@ def All():
     # add the module tests
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("TestFem"))
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("MeshTestsApp"))
+    suite.addTest(unittest.defaultTestLoader.loadTestsFromName("PointsTestsApp"))
+    suite.addTest(unittest.defaultTestLoader.loadTestsFromName("InspectionTestsApp"))
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("TestSketcherApp"))
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("TestPartApp"))
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("TestPartDesignApp"))
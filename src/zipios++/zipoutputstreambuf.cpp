@@ -81,6 +81,32 @@ void ZipOutputStreambuf::putNextEntry( const ZipCDirEntry &entry ) {
 }
 
 
+void ZipOutputStreambuf::putRawEntry( const ZipCDirEntry &entry, StorageMethod method,
+                                      const char *data, uint32 compressed_size,
+                                      uint32 size, uint32 crc ) {
+  if ( _open_entry )
+    closeEntry() ;
+
+  _entries.push_back( entry ) ;
+  ZipCDirEntry &ent = _entries.back() ;
+
+  ostream os( _outbuf ) ;
+
+  // all header fields are known in advance, so no need to seek back
+  ent.setLocalHeaderOffset( os.tellp() ) ;
+  ent.setMethod( method ) ;
+  ent.setSize( size ) ;
+  ent.setCrc( crc ) ;
+  ent.setCompressedSize( compressed_size ) ;
+  ent.setTime( currentDosTime() ) ;
+
+  os << static_cast< ZipLocalEntry >( ent ) ;
+  os.flush() ;
+  if ( compressed_size > 0 )
+    _outbuf->sputn( data, compressed_size ) ;
+}
+
+
 void ZipOutputStreambuf::setComment( const string &comment ) {
   _zip_comment = comment ;
 }
@@ -147,18 +173,23 @@ void ZipOutputStreambuf::updateEntryHeaderInfo() {
 			   - entry.getLocalHeaderSize() ) ;
 
   // Mark Donszelmann: added current date and time
+  entry.setTime( currentDosTime() ) ;
+
+  // write ZipLocalEntry header to header position
+  os.seekp( entry.getLocalHeaderOffset() ) ;
+  os << static_cast< ZipLocalEntry >( entry ) ;
+  os.seekp( curr_pos ) ;
+}
+
+
+int ZipOutputStreambuf::currentDosTime() {
   time_t ltime;
   time( &ltime );
   struct tm *now;
   now = localtime( &ltime );
   int dosTime = (now->tm_year - 80) << 25 | (now->tm_mon + 1) << 21 | now->tm_mday << 16 |
               now->tm_hour << 11 | now->tm_min << 5 | now->tm_sec >> 1;
-  entry.setTime(dosTime);
-
-  // write ZipLocalEntry header to header position
-  os.seekp( entry.getLocalHeaderOffset() ) ;
-  os << static_cast< ZipLocalEntry >( entry ) ;
-  os.seekp( curr_pos ) ;
+  return dosTime;
 }
 
 
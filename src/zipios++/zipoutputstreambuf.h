@@ -49,6 +49,19 @@ public:
       entry. */
   void putNextEntry( const ZipCDirEntry &entry ) ;
 
+  /** Writes an entry whose data has already been compressed by the caller.
+      Any open entry is closed first, the new entry is closed on return.
+      @param entry the entry to write.
+      @param method the storage method that has been used for data, i.e.
+      STORED or DEFLATED (raw deflate stream without zlib header).
+      @param data the stored or deflated data.
+      @param compressed_size the number of bytes in data.
+      @param size the uncompressed size of the entry.
+      @param crc the crc32 of the uncompressed data. */
+  void putRawEntry( const ZipCDirEntry &entry, StorageMethod method,
+                    const char *data, uint32 compressed_size,
+                    uint32 size, uint32 crc ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const string &comment ) ;
 
@@ -68,6 +81,7 @@ protected:
 
   void setEntryClosedState() ;
   void updateEntryHeaderInfo() ;
+  static int currentDosTime() ;
 
   // Should/could be moved to zipheadio.h ?!
   static void writeCentralDirectory( const vector< ZipCDirEntry > &entries, 